@@ -139,9 +139,9 @@ syntax keyword vifmOption contained aproposprg autochpos caseoptions cdpath cd
 		\ chaselinks classify columns co confirm cf cpoptions cpo cvoptions
 		\ deleteprg dotdirs dotfiles dirsize fastrun fillchars fcs findprg
 		\ followlinks fusehome gdefault grepprg histcursor history hi hlsearch hls
-		\ iec ignorecase ic iooptions incsearch is laststatus lines locateprg ls
-		\ lsoptions lsview mediaprg milleroptions millerview mintimeoutlen number nu
-		\ numberwidth nuw previewoptions previewprg quickview relativenumber rnu
+		\ iec ignorecase ic iojobs iooptions incsearch is laststatus lines locateprg
+		\ ls lsoptions lsview mediaprg milleroptions millerview mintimeoutlen number
+		\ nu numberwidth nuw previewoptions previewprg quickview relativenumber rnu
 		\ rulerformat ruf runexec scrollbind scb scrolloff sessionoptions ssop so
 		\ sort sortgroups sortorder sortnumbers shell sh shellflagcmd shcf shortmess
 		\ shm showtabline stal sizefmt slowfs smartcase scs statusline stl
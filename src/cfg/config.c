@@ -219,6 +219,8 @@ cfg_init(void)
 	cfg.name_dec_count = 0;
 
 	cfg.fast_file_cloning = 0;
+	cfg.dense_copy = 0;
+	cfg.io_jobs = 1;
 	cfg.cvoptions = 0;
 
 	cfg.case_override = 0;
@@ -310,6 +310,12 @@ typedef struct config_t
 	/* Controls use of fast file cloning for file systems that support it. */
 	int fast_file_cloning;
 
+	/* Whether holes of sparse files are filled with zeroes on copying. */
+	int dense_copy;
+
+	/* Maximum number of files that are copied or moved at the same time. */
+	int io_jobs;
+
 	/* Whether various things should be reset on entering/leaving custom views. */
 	int cvoptions;
 
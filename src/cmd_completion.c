@@ -479,6 +479,8 @@ complete_compare(const char str[])
 		{ "grouppaths", "group files in two panes by paths" },
 
 		{ "skipempty",  "exclude empty files from comparison" },
+
+		{ "inbg",       "compare in background" },
 	};
 
 	complete_from_string_list(str, lines, ARRAY_LEN(lines), 0);
@@ -152,7 +152,8 @@ static int command_cmd(const cmd_info_t *cmd_info);
 static int compare_cmd(const cmd_info_t *cmd_info);
 static int copen_cmd(const cmd_info_t *cmd_info);
 static int parse_compare_properties(const cmd_info_t *cmd_info, CompareType *ct,
-		ListType *lt, int *single_pane, int *group_ids, int *skip_empty);
+		ListType *lt, int *single_pane, int *group_ids, int *skip_empty,
+		int *in_bg);
 static int cunmap_cmd(const cmd_info_t *cmd_info);
 static int delete_cmd(const cmd_info_t *cmd_info);
 static int delmarks_cmd(const cmd_info_t *cmd_info);
@@ -1987,13 +1988,20 @@ compare_cmd(const cmd_info_t *cmd_info)
 {
 	CompareType ct = CT_CONTENTS;
 	ListType lt = LT_ALL;
-	int single_pane = 0, group_ids = 0, skip_empty = 0;
+	int single_pane = 0, group_ids = 0, skip_empty = 0, in_bg = 0;
 	if(parse_compare_properties(cmd_info, &ct, &lt, &single_pane,
-				&group_ids, &skip_empty) != 0)
+				&group_ids, &skip_empty, &in_bg) != 0)
 	{
 		return 1;
 	}
 
+	if(in_bg)
+	{
+		return single_pane
+		     ? (compare_one_pane_bg(curr_view, ct, lt, skip_empty) != 0)
+		     : (compare_two_panes_bg(ct, lt, !group_ids, skip_empty) != 0);
+	}
+
 	return single_pane
 	     ? (compare_one_pane(curr_view, ct, lt, skip_empty) != 0)
 	     : (compare_two_panes(ct, lt, !group_ids, skip_empty) != 0);
@@ -2012,7 +2020,8 @@ copen_cmd(const cmd_info_t *cmd_info)
  * error message is displayed on the status bar. */
 static int
 parse_compare_properties(const cmd_info_t *cmd_info, CompareType *ct,
-		ListType *lt, int *single_pane, int *group_ids, int *skip_empty)
+		ListType *lt, int *single_pane, int *group_ids, int *skip_empty,
+		int *in_bg)
 {
 	int i;
 	for(i = 0; i < cmd_info->argc; ++i)
@@ -2029,6 +2038,7 @@ parse_compare_properties(const cmd_info_t *cmd_info, CompareType *ct,
 		else if(strcmp(property, "groupids") == 0)   *group_ids = 1;
 		else if(strcmp(property, "grouppaths") == 0) *group_ids = 0;
 		else if(strcmp(property, "skipempty") == 0)  *skip_empty = 1;
+		else if(strcmp(property, "inbg") == 0)       *in_bg = 1;
 		else
 		{
 			ui_sb_errf("Unknown comparison property: %s", property);
@@ -20,27 +20,34 @@
 
 #include <assert.h> /* assert() */
 #include <stddef.h> /* size_t */
-#include <stdint.h> /* INTPTR_MAX INT64_MAX */
-#include <stdio.h> /* FILE fclose() feof() fopen() fread() */
-#include <stdlib.h> /* free() malloc() */
-#include <string.h> /* memcmp() */
+#include <stdint.h> /* INTPTR_MAX INT64_MAX intptr_t uint64_t */
+#include <stdio.h> /* FILE fclose() feof() ferror() fopen() fread() */
+#include <stdlib.h> /* calloc() free() */
+#include <string.h> /* memcmp() strcmp() strdup() */
 
+#include "cfg/config.h"
 #include "compat/fs_limits.h"
 #include "compat/os.h"
+#include "compat/pthread.h"
 #include "compat/reallocarray.h"
+#include "engine/mode.h"
 #include "modes/dialogs/msg_dialog.h"
+#include "modes/modes.h"
 #include "ui/cancellation.h"
 #include "ui/statusbar.h"
 #include "ui/ui.h"
 #include "utils/dynarray.h"
 #include "utils/fs.h"
 #include "utils/fsdata.h"
+#include "utils/hcache.h"
 #include "utils/macros.h"
+#include "utils/parallel.h"
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
 #include "utils/trie.h"
 #include "utils/utils.h"
+#include "background.h"
 #include "filelist.h"
 #include "fops_cpmv.h"
 #include "fops_misc.h"
@@ -56,41 +63,266 @@
 /* Amount of data to hash for coarse comparison. */
 #define PREFIX_SIZE (4*1024)
 
-/* Entry in singly-bounded list of files that have matched fingerprints. */
-typedef struct compare_record_t
+/* Seeds of two hashes that make up a digest of the whole file. */
+#define DIGEST_SEED_A 0U
+#define DIGEST_SEED_B 0x9e3779b9U
+
+/* Width of hashes used for coarse comparison. */
+#if INTPTR_MAX == INT64_MAX
+#define XX_BITS 64
+#else
+#define XX_BITS 32
+#endif
+#define XX__(name, bits) XXH ## bits ## _ ## name
+#define XX_(name, bits) XX__(name, bits)
+#define XX(name) XX_(name, XX_BITS)
+
+/* Maximum number of files hashed by a thread at a time. */
+#define HASH_BATCH 8
+
+/* Value of id field of entries, which should be dropped from results. */
+#define NO_ID 0
+
+/* Number of progress reports of a background comparison per update of its
+ * description. */
+#define BG_REPORT_PERIOD 64
+
+/* What a view displayed when a comparison was started. */
+typedef struct
+{
+	unsigned int id; /* Id of the view, which is different for every tab. */
+	char *dir;       /* Location of the view. */
+	int custom;      /* Whether custom view was active. */
+	CVType type;     /* Type of custom view. */
+	char *title;     /* Title of custom view or NULL. */
+}
+view_state_t;
+
+/* State of a single comparison of one or two views. */
+typedef struct compare_job_t compare_job_t;
+struct compare_job_t
 {
-	char *path;                    /* Full path to file with sample content. */
-	int id;                        /* Chosen id. */
-	struct compare_record_t *next; /* Next entry in the list. */
+	CompareType ct;     /* Type of comparison. */
+	ListType lt;        /* Files to be listed. */
+	int group_paths;    /* Whether diff is grouped by paths rather than ids. */
+	int skip_empty;     /* Whether empty files are ignored. */
+	int nviews;         /* Number of compared views. */
+	view_t *views[2];   /* Compared views. */
+	char *roots[2];     /* Directories to traverse or NULL for custom views. */
+	int hide_dot[2];    /* Whether dot files of directories are skipped. */
+	strlist_t files[2]; /* Files of views, listed in advance for custom ones. */
+	entries_t lists[2]; /* Entries of compared files. */
+	int cancelled;      /* Whether comparison was cancelled. */
+
+	/* What views displayed when the comparison was started.  Results of
+	 * background comparison are applied only if views still display the same
+	 * thing. */
+	view_state_t states[2];
+
+	bg_op_t *bg_op;                /* Operation of background job or NULL. */
+	pthread_mutex_t progress_lock; /* Protects fields below. */
+	const char *stage;             /* Description of current stage. */
+	int listed;                    /* Number of found files. */
+	int hashed;                    /* Number of hashed files. */
+	uint64_t read;                 /* Number of read bytes. */
+	int nreports;                  /* Number of progress reports. */
+
+	int orphaned;                /* Whether a compared view was freed.  Protected
+	                                by jobs_lock. */
+	compare_job_t *next;         /* Next finished job. */
+	compare_job_t *next_running; /* Next job that's running in background. */
+};
+
+/* File that takes part in comparison by contents. */
+typedef struct
+{
+	dir_entry_t *entry; /* Entry of the file. */
+	char *path;         /* Full path to the file. */
+	int list;           /* Index of the list of the entry. */
+	int pos;            /* Position among all files. */
+	int group;          /* Position of the first file with the same contents or
+	                       -1 if not known yet. */
+	int failed;         /* Whether the file couldn't be read. */
+	int cacheable;      /* Whether key field is set. */
+	hcache_key_t key;   /* Identity of the file for the cache. */
+	uint64_t prefix;    /* Hash of a prefix of the file. */
+	uint64_t digest[2]; /* Digest of the whole file. */
+}
+cmp_file_t;
+
+/* Files to be hashed by worker threads. */
+typedef struct
+{
+	cmp_file_t **files; /* Files to hash. */
+	compare_job_t *job; /* Job of the files. */
 }
-compare_record_t;
+cmp_todo_t;
 
-static void make_unique_lists(entries_t curr, entries_t other);
-static void leave_only_dups(entries_t *curr, entries_t *other);
+/* Runs of files with identical digests, which are to be compared byte by
+ * byte. */
+typedef struct
+{
+	compare_job_t *job; /* Job of the files. */
+	cmp_file_t **files; /* Files sorted by digests and positions. */
+	size_t *starts;     /* Start of each run in files array. */
+	size_t *lens;       /* Length of each run. */
+}
+cmp_runs_t;
+
+static compare_job_t * make_two_panes_job(CompareType ct, ListType lt,
+		int group_paths, int skip_empty);
+static compare_job_t * make_job(view_t *views[], int nviews, CompareType ct,
+		ListType lt, int group_paths, int skip_empty);
+static void free_job(compare_job_t *job);
+static int capture_view_state(const view_t *view, view_state_t *state);
+static void free_view_state(view_state_t *state);
+static int job_is_stale(compare_job_t *job);
+static int run_in_fg(compare_job_t *job);
+static int run_in_bg(compare_job_t *job);
+static void remove_running_job(compare_job_t *job);
+static void compare_in_bg(bg_op_t *bg_op, void *arg);
+static void run_job(compare_job_t *job);
+static int finish_job(compare_job_t *job);
+static int show_two_panes(compare_job_t *job);
+static int show_one_pane(compare_job_t *job);
+static int job_cancelled(compare_job_t *job);
+static void set_stage(compare_job_t *job, const char stage[], int period);
+static void report_progress(compare_job_t *job, int listed, int hashed,
+		uint64_t read);
+static void publish_progress(compare_job_t *job);
+static void make_unique_lists(view_t *views[], entries_t curr,
+		entries_t other);
+static void leave_only_dups(view_t *views[], entries_t *curr,
+		entries_t *other);
 static int is_not_duplicate(view_t *view, const dir_entry_t *entry, void *arg);
-static void fill_side_by_side(entries_t curr, entries_t other, int group_paths);
+static void fill_side_by_side(view_t *views[], entries_t curr, entries_t other,
+		int group_paths);
 static int id_sorter(const void *first, const void *second);
 static void put_or_free(view_t *view, dir_entry_t *entry, int id, int take);
-static entries_t make_diff_list(trie_t *trie, view_t *view, int *next_id,
-		CompareType ct, int skip_empty, int dups_only);
+static hcache_t * open_hash_cache(CompareType ct);
+static void close_hash_cache(hcache_t *cache);
+static entries_t list_entries(compare_job_t *job, int idx);
+static void identify_files(compare_job_t *job);
+static void identify_by_fingerprint(compare_job_t *job, int dups_only);
+static void identify_by_contents(compare_job_t *job, int dups_only);
+static void group_by_size(cmp_file_t **files, size_t nfiles, cmp_file_t **need,
+		size_t *nneed);
+static void group_by_prefix(cmp_file_t **files, size_t nfiles,
+		cmp_file_t **need, size_t *nneed);
+static void group_by_digest(compare_job_t *job, cmp_file_t **files,
+		size_t nfiles, int trusted);
+static void hash_files(compare_job_t *job, cmp_file_t **files, size_t nfiles,
+		hcache_t *cache, int full);
+static void hash_prefixes(size_t from, size_t to, void *arg);
+static void hash_whole_files(size_t from, size_t to, void *arg);
+static void compare_runs(size_t from, size_t to, void *arg);
+static size_t drop_failed(cmp_file_t **files, size_t nfiles);
+static int size_sorter(const void *first, const void *second);
+static int prefix_sorter(const void *first, const void *second);
+static int digest_sorter(const void *first, const void *second);
+static void remove_unidentified(view_t *view, entries_t *list);
 static void list_view_entries(const view_t *view, strlist_t *list);
 static int append_valid_nodes(const char name[], int valid,
 		const void *parent_data, void *data, void *arg);
-static void list_files_recursively(const char path[], int skip_dot_files,
-		strlist_t *list);
+static void list_files_recursively(compare_job_t *job, const char path[],
+		int skip_dot_files, strlist_t *list);
 static char * get_file_fingerprint(const char path[], const dir_entry_t *entry,
-		CompareType ct);
+		CompareType ct, hcache_t *cache);
 static char * get_contents_fingerprint(const char path[],
-		const dir_entry_t *entry);
-static int get_file_id(trie_t *trie, const char path[],
-		const char fingerprint[], int *id, CompareType ct);
-static int files_are_identical(const char a[], const char b[]);
-static void put_file_id(trie_t *trie, const char path[],
-		const char fingerprint[], int id, CompareType ct);
-static void free_compare_records(void *ptr);
+		const dir_entry_t *entry, hcache_t *cache);
+static int hash_prefix(const char path[], uint64_t *hash);
+static int files_are_identical(const char a[], const char b[],
+		hcache_t *cache);
+static int get_file_digest(const char path[], hcache_t *cache,
+		uint64_t digest[2]);
+static int hash_contents(const char path[], uint64_t digest[2]);
+static int compare_contents(const char a[], const char b[]);
+
+/* Comparisons that are running in background. */
+static compare_job_t *running_jobs;
+/* Comparisons finished in background, which are waiting to be displayed. */
+static compare_job_t *finished_jobs;
+/* Protects running_jobs, finished_jobs and orphaned field of jobs. */
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Serializes saving of the cache of hashes, which can be done by several
+ * comparisons at once. */
+static pthread_mutex_t hash_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
 int
 compare_two_panes(CompareType ct, ListType lt, int group_paths, int skip_empty)
+{
+	compare_job_t *const job = make_two_panes_job(ct, lt, group_paths,
+			skip_empty);
+	return (job == NULL) ? 1 : run_in_fg(job);
+}
+
+int
+compare_two_panes_bg(CompareType ct, ListType lt, int group_paths,
+		int skip_empty)
+{
+	compare_job_t *const job = make_two_panes_job(ct, lt, group_paths,
+			skip_empty);
+	return (job == NULL) ? 1 : run_in_bg(job);
+}
+
+void
+compare_check_bg(void)
+{
+	/* Views shouldn't change under the feet of other modes. */
+	if(!vle_mode_is(NORMAL_MODE))
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&jobs_lock);
+	compare_job_t *job = finished_jobs;
+	finished_jobs = NULL;
+	pthread_mutex_unlock(&jobs_lock);
+
+	while(job != NULL)
+	{
+		compare_job_t *const next = job->next;
+		if(job_is_stale(job))
+		{
+			ui_sb_msg("Comparison results were dropped as panes have changed");
+			free_job(job);
+		}
+		else
+		{
+			(void)finish_job(job);
+		}
+		job = next;
+	}
+}
+
+void
+compare_view_freed(const view_t *view)
+{
+	pthread_mutex_lock(&jobs_lock);
+	compare_job_t *const lists[] = { running_jobs, finished_jobs };
+	size_t i;
+	for(i = 0U; i < ARRAY_LEN(lists); ++i)
+	{
+		compare_job_t *job = lists[i];
+		while(job != NULL)
+		{
+			int j;
+			for(j = 0; j < job->nviews; ++j)
+			{
+				job->orphaned |= (job->states[j].id == view->id);
+			}
+			job = (i == 0U ? job->next_running : job->next);
+		}
+	}
+	pthread_mutex_unlock(&jobs_lock);
+}
+
+/* Prepares comparison of two panes.  Returns the job or NULL on error, in which
+ * case error message is displayed on the status bar. */
+static compare_job_t *
+make_two_panes_job(CompareType ct, ListType lt, int group_paths,
+		int skip_empty)
 {
 	/* We don't compare lists of files, so skip the check if at least one of the
 	 * views is a custom one. */
@@ -98,37 +330,283 @@ compare_two_panes(CompareType ct, ListType lt, int group_paths, int skip_empty)
 			paths_are_same(flist_get_dir(&lwin), flist_get_dir(&rwin)))
 	{
 		ui_sb_err("Both views are at the same location");
+		return NULL;
+	}
+
+	view_t *views[] = { curr_view, other_view };
+	return make_job(views, 2, ct, lt, group_paths, skip_empty);
+}
+
+/* Prepares comparison of the views.  Everything that needs access to the views
+ * is done here, so that the rest can be done on another thread.  Returns the
+ * job or NULL on error, in which case error message is displayed on the status
+ * bar. */
+static compare_job_t *
+make_job(view_t *views[], int nviews, CompareType ct, ListType lt,
+		int group_paths, int skip_empty)
+{
+	compare_job_t *const job = calloc(1, sizeof(*job));
+	if(job == NULL)
+	{
+		ui_sb_err("Not enough memory");
+		return NULL;
+	}
+
+	job->ct = ct;
+	job->lt = lt;
+	job->group_paths = group_paths;
+	job->skip_empty = skip_empty;
+	job->nviews = nviews;
+	job->stage = "Listing...";
+	pthread_mutex_init(&job->progress_lock, NULL);
+
+	int i;
+	for(i = 0; i < nviews; ++i)
+	{
+		view_t *const view = views[i];
+		job->views[i] = view;
+
+		if(capture_view_state(view, &job->states[i]) != 0)
+		{
+			free_job(job);
+			ui_sb_err("Not enough memory");
+			return NULL;
+		}
+
+		if(flist_custom_active(view) &&
+				ONE_OF(view->custom.type, CV_REGULAR, CV_VERY))
+		{
+			list_view_entries(view, &job->files[i]);
+			continue;
+		}
+
+		job->roots[i] = strdup(flist_get_dir(view));
+		job->hide_dot[i] = view->hide_dot;
+		if(job->roots[i] == NULL)
+		{
+			free_job(job);
+			ui_sb_err("Not enough memory");
+			return NULL;
+		}
+	}
+
+	return job;
+}
+
+/* Frees the job along with all data it still owns. */
+static void
+free_job(compare_job_t *job)
+{
+	int i;
+	for(i = 0; i < job->nviews; ++i)
+	{
+		free(job->roots[i]);
+		free_string_array(job->files[i].items, job->files[i].nitems);
+		/* Entries of the job own their origins, so they aren't related to the
+		 * view, which might display something else by now. */
+		free_dir_entries(NULL, &job->lists[i].entries, &job->lists[i].nentries);
+		free_view_state(&job->states[i]);
+	}
+
+	pthread_mutex_destroy(&job->progress_lock);
+	free(job);
+}
+
+/* Remembers what the view displays.  Returns zero on success. */
+static int
+capture_view_state(const view_t *view, view_state_t *state)
+{
+	state->id = view->id;
+	state->custom = flist_custom_active(view);
+	state->type = view->custom.type;
+	state->dir = strdup(flist_get_dir(view));
+	if(state->custom && view->custom.title != NULL)
+	{
+		state->title = strdup(view->custom.title);
+		if(state->title == NULL)
+		{
+			return 1;
+		}
+	}
+	return (state->dir == NULL);
+}
+
+/* Frees resources of a view state. */
+static void
+free_view_state(view_state_t *state)
+{
+	free(state->dir);
+	free(state->title);
+}
+
+/* Checks whether views of the job were freed or display something else since
+ * the job was started.  Returns non-zero if so. */
+static int
+job_is_stale(compare_job_t *job)
+{
+	pthread_mutex_lock(&jobs_lock);
+	const int orphaned = job->orphaned;
+	pthread_mutex_unlock(&jobs_lock);
+	if(orphaned)
+	{
 		return 1;
 	}
 
-	int next_id = 1;
-	entries_t curr, other;
+	int i;
+	for(i = 0; i < job->nviews; ++i)
+	{
+		const view_t *const view = job->views[i];
+		const view_state_t *const state = &job->states[i];
+		const int custom = flist_custom_active(view);
 
-	trie_t *const trie = trie_create();
-	ui_cancellation_push_on();
+		if(view->id != state->id || custom != state->custom ||
+				strcmp(flist_get_dir(view), state->dir) != 0)
+		{
+			return 1;
+		}
+
+		if(custom && (view->custom.type != state->type ||
+					strcmp(view->custom.title == NULL ? "" : view->custom.title,
+						state->title == NULL ? "" : state->title) != 0))
+		{
+			return 1;
+		}
+	}
 
-	curr = make_diff_list(trie, curr_view, &next_id, ct, skip_empty, 0);
-	other = make_diff_list(trie, other_view, &next_id, ct, skip_empty,
-			lt == LT_DUPS);
+	return 0;
+}
 
+/* Performs comparison and displays its results.  Returns non-zero if status bar
+ * message should be preserved. */
+static int
+run_in_fg(compare_job_t *job)
+{
+	ui_cancellation_push_on();
+	run_job(job);
 	ui_cancellation_pop();
-	trie_free_with_data(trie, &free_compare_records);
 
-	/* Clear progress message displayed by make_diff_list(). */
+	/* Clear progress message displayed while comparing. */
 	ui_sb_quick_msg_clear();
 
-	if(ui_cancellation_requested())
+	return finish_job(job);
+}
+
+/* Starts comparison as a background job, results of which are displayed by
+ * compare_check_bg().  Returns non-zero if status bar message should be
+ * preserved. */
+static int
+run_in_bg(compare_job_t *job)
+{
+	pthread_mutex_lock(&jobs_lock);
+	job->next_running = running_jobs;
+	running_jobs = job;
+	pthread_mutex_unlock(&jobs_lock);
+
+	if(bg_execute("Comparison", job->stage, BG_UNDEFINED_TOTAL, 1,
+				&compare_in_bg, job) != 0)
 	{
-		free_dir_entries(curr_view, &curr.entries, &curr.nentries);
-		free_dir_entries(other_view, &other.entries, &other.nentries);
-		ui_sb_msg("Comparison has been cancelled");
+		pthread_mutex_lock(&jobs_lock);
+		remove_running_job(job);
+		pthread_mutex_unlock(&jobs_lock);
+
+		free_job(job);
+		ui_sb_err("Failed to start comparison in background");
 		return 1;
 	}
+	return 0;
+}
+
+/* Entry point of background comparison. */
+static void
+compare_in_bg(bg_op_t *bg_op, void *arg)
+{
+	compare_job_t *const job = arg;
+
+	job->bg_op = bg_op;
+	run_job(job);
+	/* The operation doesn't outlive this function. */
+	job->bg_op = NULL;
+
+	pthread_mutex_lock(&jobs_lock);
+	remove_running_job(job);
+	compare_job_t **last = &finished_jobs;
+	while(*last != NULL)
+	{
+		last = &(*last)->next;
+	}
+	*last = job;
+	pthread_mutex_unlock(&jobs_lock);
+}
+
+/* Removes the job from the list of jobs running in background.  Must be called
+ * with jobs_lock held. */
+static void
+remove_running_job(compare_job_t *job)
+{
+	compare_job_t **link = &running_jobs;
+	while(*link != job)
+	{
+		link = &(*link)->next_running;
+	}
+	*link = job->next_running;
+}
+
+/* Lists and identifies files of the job.  Doesn't access views, so can be
+ * called from any thread. */
+static void
+run_job(compare_job_t *job)
+{
+	int i;
+	for(i = 0; i < job->nviews; ++i)
+	{
+		job->lists[i] = list_entries(job, i);
+	}
+
+	identify_files(job);
+
+	job->cancelled = job_cancelled(job);
+}
+
+/* Displays results of the job and frees it.  Returns non-zero if status bar
+ * message should be preserved. */
+static int
+finish_job(compare_job_t *job)
+{
+	int result;
+	if(job->cancelled)
+	{
+		ui_sb_msg("Comparison has been cancelled");
+		result = 1;
+	}
+	else
+	{
+		result = (job->nviews == 2) ? show_two_panes(job) : show_one_pane(job);
+	}
+
+	free_job(job);
+	return result;
+}
+
+/* Fills both panes with results of their comparison.  Returns non-zero if
+ * status bar message should be preserved. */
+static int
+show_two_panes(compare_job_t *job)
+{
+	view_t *const curr_view = job->views[0];
+	view_t *const other_view = job->views[1];
+	const CompareType ct = job->ct;
+	const ListType lt = job->lt;
+	const int group_paths = job->group_paths;
+
+	/* Lists are consumed here. */
+	entries_t curr = job->lists[0], other = job->lists[1];
+	job->lists[0] = (entries_t){};
+	job->lists[1] = (entries_t){};
 
 	if(!group_paths || lt != LT_ALL)
 	{
 		/* Sort both lists according to unique file numbers to group identical files
-		 * (sorting is stable, tags are set in make_diff_list()). */
+		 * (sorting is stable, tags are set in list_entries()). */
 		safe_qsort(curr.entries, curr.nentries, sizeof(*curr.entries), &id_sorter);
 		safe_qsort(other.entries, other.nentries, sizeof(*other.entries),
 				&id_sorter);
@@ -136,19 +614,19 @@ compare_two_panes(CompareType ct, ListType lt, int group_paths, int skip_empty)
 
 	if(lt == LT_UNIQUE)
 	{
-		make_unique_lists(curr, other);
+		make_unique_lists(job->views, curr, other);
 		return 0;
 	}
 
 	if(lt == LT_DUPS)
 	{
-		leave_only_dups(&curr, &other);
+		leave_only_dups(job->views, &curr, &other);
 	}
 
 	flist_custom_start(curr_view, lt == LT_ALL ? "diff" : "dups diff");
 	flist_custom_start(other_view, lt == LT_ALL ? "diff" : "dups diff");
 
-	fill_side_by_side(curr, other, group_paths);
+	fill_side_by_side(job->views, curr, other, group_paths);
 
 	if(flist_custom_finish(curr_view, CV_DIFF, 0) != 0)
 	{
@@ -175,11 +653,87 @@ compare_two_panes(CompareType ct, ListType lt, int group_paths, int skip_empty)
 	return 0;
 }
 
+/* Checks whether comparison should be stopped.  Returns non-zero if so. */
+static int
+job_cancelled(compare_job_t *job)
+{
+	if(job->bg_op == NULL)
+	{
+		return ui_cancellation_requested();
+	}
+
+	pthread_mutex_lock(&jobs_lock);
+	const int orphaned = job->orphaned;
+	pthread_mutex_unlock(&jobs_lock);
+
+	/* There is no point in finishing comparison of a view that's gone. */
+	return orphaned || bg_op_cancelled(job->bg_op);
+}
+
+/* Reports start of a new stage of the comparison.  The period is passed to
+ * show_progress() for comparisons in foreground. */
+static void
+set_stage(compare_job_t *job, const char stage[], int period)
+{
+	if(job->bg_op == NULL)
+	{
+		show_progress(stage, period);
+		return;
+	}
+
+	pthread_mutex_lock(&job->progress_lock);
+	job->stage = stage;
+	pthread_mutex_unlock(&job->progress_lock);
+
+	publish_progress(job);
+}
+
+/* Accounts progress of a background comparison, which is published once in a
+ * while.  Can be called from any thread. */
+static void
+report_progress(compare_job_t *job, int listed, int hashed, uint64_t read)
+{
+	if(job->bg_op == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&job->progress_lock);
+	job->listed += listed;
+	job->hashed += hashed;
+	job->read += read;
+	const int publish = (++job->nreports%BG_REPORT_PERIOD == 0);
+	pthread_mutex_unlock(&job->progress_lock);
+
+	if(publish)
+	{
+		publish_progress(job);
+	}
+}
+
+/* Updates description of background operation of the job. */
+static void
+publish_progress(compare_job_t *job)
+{
+	char read[64];
+	char descr[256];
+
+	pthread_mutex_lock(&job->progress_lock);
+	friendly_size_notation(job->read, sizeof(read), read);
+	snprintf(descr, sizeof(descr), "%s %d listed, %d hashed, %s read",
+			job->stage, job->listed, job->hashed, read);
+	pthread_mutex_unlock(&job->progress_lock);
+
+	bg_op_set_descr(job->bg_op, descr);
+}
+
 /* Composes two views containing only files that are unique to each of them.
  * Assumes that both lists are sorted by id. */
 static void
-make_unique_lists(entries_t curr, entries_t other)
+make_unique_lists(view_t *views[], entries_t curr, entries_t other)
 {
+	view_t *const curr_view = views[0];
+	view_t *const other_view = views[1];
 	int i, j = 0;
 
 	flist_custom_start(curr_view, "unique");
@@ -230,8 +784,10 @@ make_unique_lists(entries_t curr, entries_t other)
 /* Synchronizes two lists of entries so that they contain only items that
  * present in both of the lists.  Assumes that both lists are sorted by id. */
 static void
-leave_only_dups(entries_t *curr, entries_t *other)
+leave_only_dups(view_t *views[], entries_t *curr, entries_t *other)
 {
+	view_t *const curr_view = views[0];
+	view_t *const other_view = views[1];
 	int new_id = 0;
 	int i = 0, j = 0;
 
@@ -295,8 +851,11 @@ is_not_duplicate(view_t *view, const dir_entry_t *entry, void *arg)
 
 /* Composes side-by-side comparison of files in two views. */
 static void
-fill_side_by_side(entries_t curr, entries_t other, int group_paths)
+fill_side_by_side(view_t *views[], entries_t curr, entries_t other,
+		int group_paths)
 {
+	view_t *const curr_view = views[0];
+	view_t *const other_view = views[1];
 	enum { UP, LEFT, DIAG };
 
 	int i, j;
@@ -376,32 +935,34 @@ fill_side_by_side(entries_t curr, entries_t other, int group_paths)
 
 int
 compare_one_pane(view_t *view, CompareType ct, ListType lt, int skip_empty)
+{
+	compare_job_t *const job = make_job(&view, 1, ct, lt, 0, skip_empty);
+	return (job == NULL) ? 1 : run_in_fg(job);
+}
+
+int
+compare_one_pane_bg(view_t *view, CompareType ct, ListType lt, int skip_empty)
+{
+	compare_job_t *const job = make_job(&view, 1, ct, lt, 0, skip_empty);
+	return (job == NULL) ? 1 : run_in_bg(job);
+}
+
+/* Replaces the view of one pane comparison with its results.  Returns non-zero
+ * if status bar message should be preserved. */
+static int
+show_one_pane(compare_job_t *job)
 {
 	int i, dup_id;
-	view_t *other = (view == curr_view) ? other_view : curr_view;
+	view_t *const view = job->views[0];
+	view_t *const other = (view == curr_view) ? other_view : curr_view;
+	const ListType lt = job->lt;
 	const char *const title = (lt == LT_ALL)  ? "compare"
 	                        : (lt == LT_DUPS) ? "dups" : "nondups";
 
-	int next_id = 1;
-	entries_t curr;
-
-	trie_t *trie = trie_create();
-	ui_cancellation_push_on();
-
-	curr = make_diff_list(trie, view, &next_id, ct, skip_empty, 0);
-
-	ui_cancellation_pop();
-	trie_free_with_data(trie, &free_compare_records);
-
-	/* Clear progress message displayed by make_diff_list(). */
-	ui_sb_quick_msg_clear();
-
-	if(ui_cancellation_requested())
-	{
-		free_dir_entries(view, &curr.entries, &curr.nentries);
-		ui_sb_msg("Comparison has been cancelled");
-		return 1;
-	}
+	int next_id;
+	/* The list is consumed here. */
+	entries_t curr = job->lists[0];
+	job->lists[0] = (entries_t){};
 
 	safe_qsort(curr.entries, curr.nentries, sizeof(*curr.entries), &id_sorter);
 
@@ -487,77 +1048,82 @@ put_or_free(view_t *view, dir_entry_t *entry, int id, int take)
 	}
 }
 
-/* Makes sorted by path list of entries that.  The trie is used to keep track of
- * identical files.  With non-zero dups_only, new files aren't added to the
- * trie. */
+/* Opens persistent cache of hashes of files if it's applicable.  Returns the
+ * cache or NULL. */
+static hcache_t *
+open_hash_cache(CompareType ct)
+{
+	if(ct != CT_CONTENTS || cfg.config_dir[0] == '\0')
+	{
+		return NULL;
+	}
+
+	char path[PATH_MAX + 32];
+	snprintf(path, sizeof(path), "%s/compare-cache", cfg.config_dir);
+	return hcache_open(path, XX_BITS);
+}
+
+/* Stores and frees the cache.  cache can be NULL. */
+static void
+close_hash_cache(hcache_t *cache)
+{
+	if(cache != NULL)
+	{
+		pthread_mutex_lock(&hash_cache_lock);
+		(void)hcache_save(cache);
+		pthread_mutex_unlock(&hash_cache_lock);
+		hcache_free(cache);
+	}
+}
+
+/* Makes list of entries of files of idx-th view of the job in the order in
+ * which they are listed.  Files aren't identified yet, so their id field is set
+ * to NO_ID. */
 static entries_t
-make_diff_list(trie_t *trie, view_t *view, int *next_id, CompareType ct,
-		int skip_empty, int dups_only)
+list_entries(compare_job_t *job, int idx)
 {
 	int i;
-	strlist_t files = {};
+	view_t *const view = job->views[idx];
+	strlist_t files = job->files[idx];
 	entries_t r = {};
 	int last_progress = 0;
 
-	show_progress("Listing...", 0);
-	if(flist_custom_active(view) &&
-			ONE_OF(view->custom.type, CV_REGULAR, CV_VERY))
+	job->files[idx] = (strlist_t){};
+
+	set_stage(job, "Listing...", 0);
+	if(job->roots[idx] == NULL)
 	{
-		list_view_entries(view, &files);
+		report_progress(job, files.nitems, 0, 0U);
 	}
 	else
 	{
-		list_files_recursively(flist_get_dir(view), view->hide_dot, &files);
+		list_files_recursively(job, job->roots[idx], job->hide_dot[idx], &files);
 	}
 
-	show_progress("Querying...", 0);
-	for(i = 0; i < files.nitems && !ui_cancellation_requested(); ++i)
+	set_stage(job, "Querying...", 0);
+	for(i = 0; i < files.nitems && !job_cancelled(job); ++i)
 	{
 		int progress;
-		int existing_id;
-		char *fingerprint;
 		const char *const path = files.items[i];
 		dir_entry_t *const entry = entry_list_add(view, &r.entries, &r.nentries,
 				path);
-
-		if(skip_empty && entry->size == 0)
+		if(entry == NULL)
 		{
-			fentry_free(view, entry);
-			--r.nentries;
 			continue;
 		}
 
-		fingerprint = get_file_fingerprint(path, entry, ct);
-		/* In case we couldn't obtain fingerprint (e.g., comparing by contents and
-		 * files isn't readable), ignore the file and keep going. */
-		if(is_null_or_empty(fingerprint))
+		if(job->skip_empty && entry->size == 0)
 		{
-			free(fingerprint);
 			fentry_free(view, entry);
 			--r.nentries;
 			continue;
 		}
 
+		entry->id = NO_ID;
 		entry->tag = i;
-		if(get_file_id(trie, path, fingerprint, &existing_id, ct))
-		{
-			entry->id = existing_id;
-		}
-		else if(dups_only)
-		{
-			entry->id = -1;
-		}
-		else
-		{
-			entry->id = *next_id;
-			++*next_id;
-			put_file_id(trie, path, fingerprint, entry->id, ct);
-		}
-
-		free(fingerprint);
 
 		progress = (i*100)/files.nitems;
-		if(progress != last_progress)
+		if(progress != last_progress && job->bg_op == NULL)
 		{
 			char progress_msg[128];
 
@@ -572,21 +1138,538 @@ make_diff_list(trie_t *trie, view_t *view, int *next_id, CompareType ct,
 	return r;
 }
 
-/* Fills the list with entries of the view in hierarchical order (pre-order tree
- * traversal). */
+/* Assigns ids to entries of the lists of the job so that identical files
+ * (according to type of comparison) share the same id and then drops entries
+ * that couldn't be processed.  Ids are allocated in the order in which files
+ * appear in the lists.  When listing duplicates of two views, files of the
+ * second list only get ids of files from the first list and -1 otherwise. */
 static void
-list_view_entries(const view_t *view, strlist_t *list)
+identify_files(compare_job_t *job)
 {
-	int i;
-
-	fsdata_t *const tree = fsdata_create(0, 0);
+	/* Only two pane comparison treats lists differently. */
+	const int dups_only = (job->nviews == 2 && job->lt == LT_DUPS);
 
-	for(i = 0; i < view->list_rows; ++i)
+	if(job->ct == CT_CONTENTS)
 	{
-		if(!fentry_is_dir(&view->dir_entry[i]))
-		{
-			char full_path[PATH_MAX + 1];
-			void *data = &view->dir_entry[i];
+		identify_by_contents(job, dups_only);
+	}
+	else
+	{
+		identify_by_fingerprint(job, dups_only);
+	}
+
+	int i;
+	for(i = 0; i < job->nviews; ++i)
+	{
+		remove_unidentified(job->views[i], &job->lists[i]);
+	}
+}
+
+/* Identifies files by looking up their fingerprints in a trie.  Used for types
+ * of comparison where fingerprints are exact. */
+static void
+identify_by_fingerprint(compare_job_t *job, int dups_only)
+{
+	int next_id = 1;
+	trie_t *const trie = trie_create();
+
+	int l;
+	for(l = 0; l < job->nviews; ++l)
+	{
+		entries_t *const list = &job->lists[l];
+
+		int i;
+		for(i = 0; i < list->nentries && !job_cancelled(job); ++i)
+		{
+			dir_entry_t *const entry = &list->entries[i];
+
+			char path[PATH_MAX + 1];
+			get_full_path_of(entry, sizeof(path), path);
+
+			char *const fingerprint = get_file_fingerprint(path, entry, job->ct,
+					NULL);
+			void *data;
+			if(is_null_or_empty(fingerprint))
+			{
+				entry->id = NO_ID;
+			}
+			else if(trie_get(trie, fingerprint, &data) == 0)
+			{
+				entry->id = (intptr_t)data;
+			}
+			else if(dups_only && l != 0)
+			{
+				entry->id = -1;
+			}
+			else
+			{
+				entry->id = next_id++;
+				(void)trie_set(trie, fingerprint, (void *)(intptr_t)entry->id);
+			}
+			free(fingerprint);
+		}
+	}
+
+	trie_free(trie);
+}
+
+/* Identifies files by their contents in stages, each of which considers only
+ * files that weren't told apart by the previous one: grouping by size, hashing
+ * of prefixes, hashing of whole files and (unless digests are cached) byte by
+ * byte comparison.  Hashing is done on several threads. */
+static void
+identify_by_contents(compare_job_t *job, int dups_only)
+{
+	entries_t *const lists = job->lists;
+
+	size_t nfiles = 0U;
+	int l, i;
+	for(l = 0; l < job->nviews; ++l)
+	{
+		nfiles += lists[l].nentries;
+	}
+
+	cmp_file_t *const files = calloc(nfiles, sizeof(*files));
+	cmp_file_t **const sorted = reallocarray(NULL, nfiles, sizeof(*sorted));
+	cmp_file_t **const need = reallocarray(NULL, nfiles, sizeof(*need));
+	if(nfiles == 0U || files == NULL || sorted == NULL || need == NULL)
+	{
+		/* Entries remain unidentified and are dropped. */
+		free(files);
+		free(sorted);
+		free(need);
+		return;
+	}
+
+	size_t n = 0U;
+	for(l = 0; l < job->nviews; ++l)
+	{
+		for(i = 0; i < lists[l].nentries; ++i, ++n)
+		{
+			char path[PATH_MAX + 1];
+			get_full_path_of(&lists[l].entries[i], sizeof(path), path);
+
+			files[n].entry = &lists[l].entries[i];
+			files[n].path = strdup(path);
+			files[n].list = l;
+			files[n].pos = n;
+			files[n].group = -1;
+			files[n].failed = (files[n].path == NULL);
+			sorted[n] = &files[n];
+		}
+	}
+
+	hcache_t *const cache = open_hash_cache(CT_CONTENTS);
+
+	size_t nneed;
+	group_by_size(sorted, nfiles, need, &nneed);
+
+	set_stage(job, "Hashing prefixes...", -1);
+	hash_files(job, need, nneed, cache, 0);
+	nneed = drop_failed(need, nneed);
+	/* Candidates for the next stage are a subset of current ones, so they can
+	 * be written into the array of sorted files, which isn't used anymore. */
+	group_by_prefix(need, nneed, sorted, &nneed);
+
+	set_stage(job, "Hashing files...", -1);
+	hash_files(job, sorted, nneed, cache, 1);
+	nneed = drop_failed(sorted, nneed);
+	/* Cached digests replace byte by byte comparison. */
+	group_by_digest(job, sorted, nneed, cache != NULL);
+
+	close_hash_cache(cache);
+
+	int next_id = 1;
+	for(n = 0U; n < nfiles; ++n)
+	{
+		cmp_file_t *const file = &files[n];
+		if(file->failed || file->group < 0 || job_cancelled(job))
+		{
+			file->entry->id = NO_ID;
+		}
+		else if(file->group != file->pos)
+		{
+			file->entry->id = files[file->group].entry->id;
+		}
+		else
+		{
+			file->entry->id = (dups_only && file->list != 0) ? -1 : next_id++;
+		}
+		free(file->path);
+	}
+
+	free(files);
+	free(sorted);
+	free(need);
+}
+
+/* Makes files of unique size form groups of their own and collects the rest
+ * for further processing. */
+static void
+group_by_size(cmp_file_t **files, size_t nfiles, cmp_file_t **need,
+		size_t *nneed)
+{
+	safe_qsort(files, nfiles, sizeof(*files), &size_sorter);
+
+	*nneed = 0U;
+
+	size_t i, j;
+	for(i = 0U; i < nfiles; i = j)
+	{
+		for(j = i + 1U; j < nfiles &&
+				files[j]->entry->size == files[i]->entry->size; ++j)
+		{
+			/* Find end of the run. */
+		}
+
+		if(j - i == 1U)
+		{
+			/* The file isn't read, but it should be readable to be compared. */
+			files[i]->failed |= (os_access(files[i]->path, R_OK) != 0);
+			files[i]->group = files[i]->pos;
+			continue;
+		}
+
+		for(; i < j; ++i)
+		{
+			if(!files[i]->failed)
+			{
+				need[(*nneed)++] = files[i];
+			}
+		}
+	}
+}
+
+/* Makes files of unique size and prefix hash form groups of their own and
+ * collects the rest for further processing. */
+static void
+group_by_prefix(cmp_file_t **files, size_t nfiles, cmp_file_t **need,
+		size_t *nneed)
+{
+	safe_qsort(files, nfiles, sizeof(*files), &prefix_sorter);
+
+	*nneed = 0U;
+
+	size_t i, j;
+	for(i = 0U; i < nfiles; i = j)
+	{
+		for(j = i + 1U; j < nfiles &&
+				files[j]->entry->size == files[i]->entry->size &&
+				files[j]->prefix == files[i]->prefix; ++j)
+		{
+			/* Find end of the run. */
+		}
+
+		if(j - i == 1U)
+		{
+			files[i]->group = files[i]->pos;
+			continue;
+		}
+
+		for(; i < j; ++i)
+		{
+			need[(*nneed)++] = files[i];
+		}
+	}
+}
+
+/* Groups files by their digests.  Unless digests are trusted, files with equal
+ * digests are also compared byte by byte. */
+static void
+group_by_digest(compare_job_t *job, cmp_file_t **files, size_t nfiles,
+		int trusted)
+{
+	safe_qsort(files, nfiles, sizeof(*files), &digest_sorter);
+
+	cmp_runs_t runs = {
+		.job = job,
+		.files = files,
+		.starts = reallocarray(NULL, nfiles, sizeof(*runs.starts)),
+		.lens = reallocarray(NULL, nfiles, sizeof(*runs.lens)),
+	};
+	size_t nruns = 0U;
+
+	size_t i, j;
+	for(i = 0U; i < nfiles; i = j)
+	{
+		for(j = i + 1U; j < nfiles &&
+				files[j]->entry->size == files[i]->entry->size &&
+				files[j]->prefix == files[i]->prefix &&
+				files[j]->digest[0] == files[i]->digest[0] &&
+				files[j]->digest[1] == files[i]->digest[1]; ++j)
+		{
+			/* Find end of the run. */
+		}
+
+		size_t k;
+		if(j - i == 1U || trusted)
+		{
+			/* Files of the run are sorted by their positions. */
+			for(k = i; k < j; ++k)
+			{
+				files[k]->group = files[i]->pos;
+			}
+			continue;
+		}
+
+		if(runs.starts == NULL || runs.lens == NULL)
+		{
+			/* Not enough memory to compare contents, so consider the files to be
+			 * different. */
+			for(k = i; k < j; ++k)
+			{
+				files[k]->group = files[k]->pos;
+			}
+			continue;
+		}
+
+		runs.starts[nruns] = i;
+		runs.lens[nruns] = j - i;
+		++nruns;
+	}
+
+	if(nruns != 0U)
+	{
+		set_stage(job, "Comparing...", -1);
+		par_for(nruns, 1U, &compare_runs, &runs);
+	}
+
+	free(runs.starts);
+	free(runs.lens);
+}
+
+/* Computes prefix hashes or digests of the files.  Files that couldn't be read
+ * are marked as failed. */
+static void
+hash_files(compare_job_t *job, cmp_file_t **files, size_t nfiles,
+		hcache_t *cache, int full)
+{
+	cmp_file_t **const todo = reallocarray(NULL, nfiles, sizeof(*todo));
+	if(todo == NULL)
+	{
+		size_t i;
+		for(i = 0U; i < nfiles; ++i)
+		{
+			files[i]->failed = 1;
+		}
+		return;
+	}
+
+	/* The cache isn't thread-safe, so it's used only by this thread. */
+	size_t i, ntodo = 0U;
+	for(i = 0U; i < nfiles; ++i)
+	{
+		cmp_file_t *const file = files[i];
+		if(cache != NULL && !file->cacheable)
+		{
+			file->cacheable = (hcache_key_of(file->path, &file->key) == 0);
+		}
+
+		const int found = file->cacheable && (full
+		                ? hcache_get_digest(cache, &file->key, file->digest)
+		                : hcache_get_prefix(cache, &file->key, &file->prefix));
+		if(!found)
+		{
+			todo[ntodo++] = file;
+		}
+	}
+
+	cmp_todo_t arg = { .files = todo, .job = job };
+	par_for(ntodo, HASH_BATCH, full ? &hash_whole_files : &hash_prefixes, &arg);
+
+	for(i = 0U; i < ntodo; ++i)
+	{
+		cmp_file_t *const file = todo[i];
+		if(file->failed || !file->cacheable)
+		{
+			continue;
+		}
+
+		if(full)
+		{
+			hcache_set_digest(cache, &file->key, file->digest);
+		}
+		else
+		{
+			hcache_set_prefix(cache, &file->key, file->prefix);
+		}
+	}
+
+	free(todo);
+}
+
+/* Computes hashes of prefixes of a range of files.  Implements
+ * par_range_func. */
+static void
+hash_prefixes(size_t from, size_t to, void *arg)
+{
+	cmp_todo_t *const todo = arg;
+	for(; from < to; ++from)
+	{
+		cmp_file_t *const file = todo->files[from];
+		file->failed = job_cancelled(todo->job)
+		            || hash_prefix(file->path, &file->prefix) != 0;
+		report_progress(todo->job, 0, 1, MIN(file->entry->size, PREFIX_SIZE));
+	}
+}
+
+/* Computes digests of a range of files.  Implements par_range_func. */
+static void
+hash_whole_files(size_t from, size_t to, void *arg)
+{
+	cmp_todo_t *const todo = arg;
+	for(; from < to; ++from)
+	{
+		cmp_file_t *const file = todo->files[from];
+		file->failed = job_cancelled(todo->job)
+		            || hash_contents(file->path, file->digest) != 0;
+		report_progress(todo->job, 0, 1, file->entry->size);
+	}
+}
+
+/* Groups files of a range of runs with identical digests by comparing them
+ * byte by byte.  Implements par_range_func. */
+static void
+compare_runs(size_t from, size_t to, void *arg)
+{
+	cmp_runs_t *const runs = arg;
+	for(; from < to && !job_cancelled(runs->job); ++from)
+	{
+		cmp_file_t **const files = runs->files + runs->starts[from];
+		const size_t nfiles = runs->lens[from];
+
+		/* Files are sorted by their positions, so each one is compared only
+		 * against earlier files that started new groups. */
+		size_t i;
+		for(i = 0U; i < nfiles; ++i)
+		{
+			files[i]->group = files[i]->pos;
+
+			size_t j;
+			for(j = 0U; j < i; ++j)
+			{
+				if(files[j]->group == files[j]->pos &&
+						compare_contents(files[j]->path, files[i]->path))
+				{
+					files[i]->group = files[j]->pos;
+					break;
+				}
+			}
+			report_progress(runs->job, 0, 0, 2U*files[i]->entry->size);
+		}
+	}
+}
+
+/* Removes files marked as failed from the array preserving order of the rest.
+ * Returns new size of the array. */
+static size_t
+drop_failed(cmp_file_t **files, size_t nfiles)
+{
+	size_t i, n = 0U;
+	for(i = 0U; i < nfiles; ++i)
+	{
+		if(!files[i]->failed)
+		{
+			files[n++] = files[i];
+		}
+	}
+	return n;
+}
+
+/* qsort() comparer that sorts files by size and position.  Returns standard
+ * -1, 0, 1 for comparisons. */
+static int
+size_sorter(const void *first, const void *second)
+{
+	const cmp_file_t *const a = *(const cmp_file_t **)first;
+	const cmp_file_t *const b = *(const cmp_file_t **)second;
+
+	if(a->entry->size != b->entry->size)
+	{
+		return (a->entry->size < b->entry->size) ? -1 : 1;
+	}
+	return (a->pos < b->pos) ? -1 : (a->pos > b->pos);
+}
+
+/* qsort() comparer that sorts files by size, prefix hash and position.
+ * Returns standard -1, 0, 1 for comparisons. */
+static int
+prefix_sorter(const void *first, const void *second)
+{
+	const cmp_file_t *const a = *(const cmp_file_t **)first;
+	const cmp_file_t *const b = *(const cmp_file_t **)second;
+
+	if(a->entry->size != b->entry->size)
+	{
+		return (a->entry->size < b->entry->size) ? -1 : 1;
+	}
+	if(a->prefix != b->prefix)
+	{
+		return (a->prefix < b->prefix) ? -1 : 1;
+	}
+	return (a->pos < b->pos) ? -1 : (a->pos > b->pos);
+}
+
+/* qsort() comparer that sorts files by size, prefix hash, digest and
+ * position.  Returns standard -1, 0, 1 for comparisons. */
+static int
+digest_sorter(const void *first, const void *second)
+{
+	const cmp_file_t *const a = *(const cmp_file_t **)first;
+	const cmp_file_t *const b = *(const cmp_file_t **)second;
+
+	if(a->entry->size != b->entry->size)
+	{
+		return (a->entry->size < b->entry->size) ? -1 : 1;
+	}
+	if(a->prefix != b->prefix)
+	{
+		return (a->prefix < b->prefix) ? -1 : 1;
+	}
+	if(a->digest[0] != b->digest[0])
+	{
+		return (a->digest[0] < b->digest[0]) ? -1 : 1;
+	}
+	if(a->digest[1] != b->digest[1])
+	{
+		return (a->digest[1] < b->digest[1]) ? -1 : 1;
+	}
+	return (a->pos < b->pos) ? -1 : (a->pos > b->pos);
+}
+
+/* Frees entries that weren't identified and removes them from the list
+ * preserving order of the rest. */
+static void
+remove_unidentified(view_t *view, entries_t *list)
+{
+	int i, n = 0;
+	for(i = 0; i < list->nentries; ++i)
+	{
+		if(list->entries[i].id == NO_ID)
+		{
+			fentry_free(view, &list->entries[i]);
+		}
+		else
+		{
+			list->entries[n++] = list->entries[i];
+		}
+	}
+	list->nentries = n;
+}
+
+static void
+list_view_entries(const view_t *view, strlist_t *list)
+{
+	int i;
+
+	fsdata_t *const tree = fsdata_create(0, 0);
+
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		if(!fentry_is_dir(&view->dir_entry[i]))
+		{
+			char full_path[PATH_MAX + 1];
+			void *data = &view->dir_entry[i];
 			get_full_path_of(&view->dir_entry[i], sizeof(full_path), full_path);
 			fsdata_set(tree, full_path, &data, sizeof(data));
 		}
@@ -617,7 +1700,8 @@ append_valid_nodes(const char name[], int valid, const void *parent_data,
 
 /* Collects files under specified file system tree. */
 static void
-list_files_recursively(const char path[], int skip_dot_files, strlist_t *list)
+list_files_recursively(compare_job_t *job, const char path[],
+		int skip_dot_files, strlist_t *list)
 {
 	int i;
 
@@ -630,7 +1714,7 @@ list_files_recursively(const char path[], int skip_dot_files, strlist_t *list)
 	}
 
 	/* Visit all subdirectories ignoring symbolic links to directories. */
-	for(i = 0; i < len && !ui_cancellation_requested(); ++i)
+	for(i = 0; i < len && !job_cancelled(job); ++i)
 	{
 		char *full_path;
 		if(skip_dot_files && lst[i][0] == '.')
@@ -644,7 +1728,7 @@ list_files_recursively(const char path[], int skip_dot_files, strlist_t *list)
 		{
 			if(!is_symlink(full_path))
 			{
-				list_files_recursively(full_path, skip_dot_files, list);
+				list_files_recursively(job, full_path, skip_dot_files, list);
 			}
 			free(full_path);
 			update_string(&lst[i], NULL);
@@ -653,9 +1737,13 @@ list_files_recursively(const char path[], int skip_dot_files, strlist_t *list)
 		{
 			free(lst[i]);
 			lst[i] = full_path;
+			report_progress(job, 1, 0, 0U);
 		}
 
-		show_progress("Listing...", 1000);
+		if(job->bg_op == NULL)
+		{
+			show_progress("Listing...", 1000);
+		}
 	}
 
 	/* Append files. */
@@ -671,11 +1759,12 @@ list_files_recursively(const char path[], int skip_dot_files, strlist_t *list)
 }
 
 /* Computes fingerprint of the file specified by path and entry.  Type of the
- * fingerprint is determined by ct parameter.  Returns newly allocated string
- * with the fingerprint, which is empty or NULL on error. */
+ * fingerprint is determined by ct parameter.  The cache can be NULL.  Returns
+ * newly allocated string with the fingerprint, which is empty or NULL on
+ * error. */
 static char *
 get_file_fingerprint(const char path[], const dir_entry_t *entry,
-		CompareType ct)
+		CompareType ct, hcache_t *cache)
 {
 	switch(ct)
 	{
@@ -691,33 +1780,57 @@ get_file_fingerprint(const char path[], const dir_entry_t *entry,
 		case CT_SIZE:
 			return format_str("%" PRINTF_ULL, (unsigned long long)entry->size);
 		case CT_CONTENTS:
-			return get_contents_fingerprint(path, entry);
+			return get_contents_fingerprint(path, entry, cache);
 	}
 	assert(0 && "Unexpected diffing type.");
 	return strdup("");
 }
 
-/* Makes fingerprint of file contents (all or part of it of fixed size).
- * Returns the fingerprint as a string, which is empty or NULL on error. */
+/* Makes fingerprint of file contents (all or part of it of fixed size).  The
+ * cache can be NULL.  Returns the fingerprint as a string, which is empty or
+ * NULL on error. */
 static char *
-get_contents_fingerprint(const char path[], const dir_entry_t *entry)
+get_contents_fingerprint(const char path[], const dir_entry_t *entry,
+		hcache_t *cache)
 {
-#if INTPTR_MAX == INT64_MAX
-#define XX_BITS 64
-#else
-#define XX_BITS 32
-#endif
-#define XX__(name, bits) XXH ## bits ## _ ## name
-#define XX_(name, bits) XX__(name, bits)
-#define XX(name) XX_(name, XX_BITS)
+	hcache_key_t key;
+	const int cacheable = (cache != NULL && hcache_key_of(path, &key) == 0);
+
+	uint64_t hash;
+	if(cacheable && hcache_get_prefix(cache, &key, &hash))
+	{
+		return format_str("%" PRINTF_ULL "|%" PRINTF_ULL,
+				(unsigned long long)entry->size, (unsigned long long)hash);
+	}
 
+	if(hash_prefix(path, &hash) != 0)
+	{
+		return strdup("");
+	}
+
+	if(cacheable)
+	{
+		/* The key was obtained before reading the file, so if the file was being
+		 * changed meanwhile, the record will just never be found. */
+		hcache_set_prefix(cache, &key, hash);
+	}
+
+	return format_str("%" PRINTF_ULL "|%" PRINTF_ULL,
+			(unsigned long long)entry->size, (unsigned long long)hash);
+}
+
+/* Computes hash of a prefix of the file of fixed size.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+hash_prefix(const char path[], uint64_t *hash)
+{
 	XX(state_t) st;
 	char block[BLOCK_SIZE];
 	size_t to_read = PREFIX_SIZE;
 	FILE *in = os_fopen(path, "rb");
 	if(in == NULL)
 	{
-		return strdup("");
+		return 1;
 	}
 
 	XX(reset)(&st, 0U);
@@ -735,57 +1848,91 @@ get_contents_fingerprint(const char path[], const dir_entry_t *entry)
 	}
 	fclose(in);
 
-	return format_str("%" PRINTF_ULL "|%" PRINTF_ULL,
-			(unsigned long long)entry->size, (unsigned long long)XX(digest)(&st));
+	*hash = XX(digest)(&st);
+	return 0;
+}
+
+/* Checks whether two files specified by their names hold identical content.
+ * With a cache, digests of whole files are compared instead of their contents.
+ * Returns non-zero if so, otherwise zero is returned. */
+static int
+files_are_identical(const char a[], const char b[], hcache_t *cache)
+{
+	uint64_t a_digest[2], b_digest[2];
+	if(cache != NULL && get_file_digest(a, cache, a_digest) == 0 &&
+			get_file_digest(b, cache, b_digest) == 0)
+	{
+		return a_digest[0] == b_digest[0] && a_digest[1] == b_digest[1];
+	}
 
-#undef XX_BITS
-#undef XX__
-#undef XX_
-#undef XX
+	return compare_contents(a, b);
 }
 
-/* Retrieves file from the trie by its fingerprint.  Returns non-zero if it was
- * in the trie and sets *id, otherwise zero is returned. */
+/* Retrieves digest of the whole file from the cache or computes and caches it.
+ * Returns zero on success, otherwise non-zero is returned. */
 static int
-get_file_id(trie_t *trie, const char path[], const char fingerprint[], int *id,
-		CompareType ct)
+get_file_digest(const char path[], hcache_t *cache, uint64_t digest[2])
 {
-	void *data;
-	compare_record_t *record;
-	if(trie_get(trie, fingerprint, &data) != 0)
+	hcache_key_t key;
+	if(hcache_key_of(path, &key) != 0)
+	{
+		return 1;
+	}
+
+	if(hcache_get_digest(cache, &key, digest))
 	{
 		return 0;
 	}
-	record = data;
 
-	/* Comparison by contents is the only one when we need to resolve fingerprint
-	 * conflicts. */
-	if(ct != CT_CONTENTS)
+	if(hash_contents(path, digest) != 0)
 	{
-		*id = record->id;
 		return 1;
 	}
 
-	/* Fingerprint does not guarantee a match, go through files and find file with
-	 * identical content. */
-	do
+	hcache_set_digest(cache, &key, digest);
+	return 0;
+}
+
+/* Computes digest of the whole file.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+hash_contents(const char path[], uint64_t digest[2])
+{
+	FILE *const in = os_fopen(path, "rb");
+	if(in == NULL)
 	{
-		if(files_are_identical(path, record->path))
-		{
-			*id = record->id;
-			return 1;
-		}
-		record = record->next;
+		return 1;
+	}
+
+	/* Two hashes with different seeds to make collisions negligible. */
+	XXH64_state_t a, b;
+	XXH64_reset(&a, DIGEST_SEED_A);
+	XXH64_reset(&b, DIGEST_SEED_B);
+
+	char block[BLOCK_SIZE];
+	size_t nread;
+	while((nread = fread(&block, 1, sizeof(block), in)) != 0U)
+	{
+		XXH64_update(&a, block, nread);
+		XXH64_update(&b, block, nread);
+	}
+
+	const int error = ferror(in);
+	fclose(in);
+	if(error)
+	{
+		return 1;
 	}
-	while(record != NULL);
 
+	digest[0] = XXH64_digest(&a);
+	digest[1] = XXH64_digest(&b);
 	return 0;
 }
 
-/* Checks whether two files specified by their names hold identical content.
- * Returns non-zero if so, otherwise zero is returned. */
+/* Compares contents of two files byte by byte.  Returns non-zero if they are
+ * identical, otherwise zero is returned. */
 static int
-files_are_identical(const char a[], const char b[])
+compare_contents(const char a[], const char b[])
 {
 	char a_block[BLOCK_SIZE], b_block[BLOCK_SIZE];
 	FILE *const a_file = fopen(a, "rb");
@@ -828,49 +1975,12 @@ files_are_identical(const char a[], const char b[])
 	return 1;
 }
 
-/* Stores id of a file with given fingerprint in the trie. */
-static void
-put_file_id(trie_t *trie, const char path[], const char fingerprint[], int id,
-		CompareType ct)
-{
-	compare_record_t *const record = malloc(sizeof(*record));
-	void *data = NULL;
-	(void)trie_get(trie, fingerprint, &data);
-
-	record->id = id;
-	record->next = data;
-
-	/* Comparison by contents is the only one when we need to resolve fingerprint
-	 * conflicts. */
-	record->path = (ct == CT_CONTENTS ? strdup(path) : NULL);
-
-	if(trie_set(trie, fingerprint, record) < 0)
-	{
-		free(record->path);
-		free(record);
-	}
-}
-
-/* Frees list of compare entries.  Implements data free function for
- * trie_free_with_data(). */
-static void
-free_compare_records(void *ptr)
-{
-	compare_record_t *record = ptr;
-	while(record != NULL)
-	{
-		compare_record_t *const current = record;
-		record = record->next;
-		free(current->path);
-		free(current);
-	}
-}
-
 int
 compare_move(view_t *from, view_t *to)
 {
 	char from_path[PATH_MAX + 1], to_path[PATH_MAX + 1];
 	char *from_fingerprint, *to_fingerprint;
+	hcache_t *cache;
 
 	const CompareType ct = from->custom.diff_cmp_type;
 
@@ -917,8 +2027,8 @@ compare_move(view_t *from, view_t *to)
 
 		/* Update the other entry to not be fake. */
 		remove_last_path_component(canonical);
-		replace_string(&other->name, curr->name);
-		replace_string(&other->origin, canonical);
+		(void)fentry_set_name(other, curr->name);
+		(void)fentry_set_origin(other, canonical);
 	}
 	else
 	{
@@ -934,15 +2044,16 @@ compare_move(view_t *from, view_t *to)
 	/* Try to update id of the other entry by computing fingerprint of both files
 	 * and checking if they match. */
 
-	from_fingerprint = get_file_fingerprint(from_path, curr, ct);
-	to_fingerprint = get_file_fingerprint(to_path, other, ct);
+	cache = open_hash_cache(ct);
+	from_fingerprint = get_file_fingerprint(from_path, curr, ct, cache);
+	to_fingerprint = get_file_fingerprint(to_path, other, ct, cache);
 
 	if(!is_null_or_empty(from_fingerprint) && !is_null_or_empty(to_fingerprint))
 	{
 		int match = (strcmp(from_fingerprint, to_fingerprint) == 0);
 		if(match && ct == CT_CONTENTS)
 		{
-			match = files_are_identical(from_path, to_path);
+			match = files_are_identical(from_path, to_path, cache);
 		}
 		if(match)
 		{
@@ -952,6 +2063,7 @@ compare_move(view_t *from, view_t *to)
 
 	free(from_fingerprint);
 	free(to_fingerprint);
+	close_hash_cache(cache);
 
 	return 0;
 }
@@ -36,10 +36,31 @@ ListType;
 int compare_two_panes(CompareType ct, ListType lt, int group_paths,
 		int skip_empty);
 
+/* Same as compare_two_panes(), but compares files in background.  Results are
+ * displayed by compare_check_bg() once they are ready.  Returns non-zero if
+ * status bar message should be preserved. */
+int compare_two_panes_bg(CompareType ct, ListType lt, int group_paths,
+		int skip_empty);
+
 /* Replaces single pane with information derived from its files.  Returns
  * non-zero if status bar message should be preserved. */
 int compare_one_pane(view_t *view, CompareType ct, ListType lt, int skip_empty);
 
+/* Same as compare_one_pane(), but compares files in background.  Results are
+ * displayed by compare_check_bg() once they are ready.  Returns non-zero if
+ * status bar message should be preserved. */
+int compare_one_pane_bg(view_t *view, CompareType ct, ListType lt,
+		int skip_empty);
+
+/* Displays results of comparisons that were finished in background.  Does
+ * nothing outside of normal mode.  Should be called periodically on the main
+ * thread. */
+void compare_check_bg(void);
+
+/* Notifies the unit that the view is being freed.  Background comparisons of
+ * the view are cancelled and their results are never displayed. */
+void compare_view_freed(const view_t *view);
+
 /* Moves current file from one view to the other.  Returns non-zero if status
  * bar message should be preserved. */
 int compare_move(view_t *from, view_t *to);
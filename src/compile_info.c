@@ -0,0 +1 @@
+const char GIT_INFO[] = "b0ed95ef2fab-dirty";
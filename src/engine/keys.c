@@ -137,6 +137,7 @@ static const wchar_t * get_count(const wchar_t keys[], int *count);
 static int is_at_count(const wchar_t keys[]);
 static int combine_counts(int count_a, int count_b);
 static key_chunk_t * find_user_keys(const wchar_t *keys, int mode);
+static key_chunk_t * find_user_chunk(const wchar_t keys[], int mode);
 static int add_list_of_keys(key_chunk_t *root, keys_add_info_t cmds[],
 		size_t len);
 static key_chunk_t * add_keys_inner(key_chunk_t *root, const wchar_t *keys);
@@ -972,6 +973,13 @@ vle_keys_user_exists(const wchar_t keys[], int mode)
 	return find_user_keys(keys, mode) != NULL;
 }
 
+int
+vle_keys_user_starts_with(const wchar_t keys[], int mode)
+{
+	const key_chunk_t *const chunk = find_user_chunk(keys, mode);
+	return chunk != NULL && (chunk->type == USER_CMD || chunk->child != NULL);
+}
+
 int
 vle_keys_user_remove(const wchar_t keys[], int mode)
 {
@@ -1015,6 +1023,15 @@ vle_keys_user_remove(const wchar_t keys[], int mode)
 
 static key_chunk_t *
 find_user_keys(const wchar_t *keys, int mode)
+{
+	key_chunk_t *const curr = find_user_chunk(keys, mode);
+	return (curr != NULL && curr->type == USER_CMD) ? curr : NULL;
+}
+
+/* Looks up node of user mappings tree that corresponds to the keys.  Returns
+ * the node or NULL if there is none. */
+static key_chunk_t *
+find_user_chunk(const wchar_t keys[], int mode)
 {
 	key_chunk_t *curr = &user_cmds_root[mode];
 
@@ -1033,7 +1050,7 @@ find_user_keys(const wchar_t *keys, int mode)
 		curr = p;
 		keys++;
 	}
-	return (curr->type == USER_CMD) ? curr : NULL;
+	return curr;
 }
 
 int
@@ -179,6 +179,10 @@ int vle_keys_user_add(const wchar_t keys[], const wchar_t rhs[], int mode,
  * zero is returned. */
 int vle_keys_user_exists(const wchar_t keys[], int mode);
 
+/* Checks whether given keys form a user mapping or a beginning of one.  Returns
+ * non-zero if so, otherwise zero is returned. */
+int vle_keys_user_starts_with(const wchar_t keys[], int mode);
+
 /* Removes user mapping from the mode.  Returns non-zero if given key sequence
  * wasn't found. */
 int vle_keys_user_remove(const wchar_t keys[], int mode);
@@ -27,7 +27,8 @@
 #include <stddef.h> /* NULL size_t wchar_t */
 #include <stdlib.h> /* free() */
 #include <string.h> /* memmove() strncpy() */
-#include <wchar.h> /* wint_t wcslen() wcscmp() wcsncat() wmemcpy() */
+#include <wchar.h> /* wint_t wcslen() wcscmp() wcsncat() wmemcpy()
+                      wmemmove() */
 
 #include "cfg/config.h"
 #include "compat/curses.h"
@@ -46,11 +47,13 @@
 #include "utils/log.h"
 #include "utils/macros.h"
 #include "utils/path.h"
+#include "utils/selector.h"
 #include "utils/test_helpers.h"
 #include "utils/utf8.h"
 #include "utils/utils.h"
 #include "background.h"
 #include "bracket_notation.h"
+#include "compare.h"
 #include "filelist.h"
 #include "ipc.h"
 #include "registers.h"
@@ -60,6 +63,8 @@
 
 static int ensure_term_is_ready(void);
 static int get_char_async_loop(WINDOW *win, wint_t *c, int timeout);
+static selector_t * get_input_selector(void);
+static int wait_for_events(selector_t *selector, int timeout);
 static int is_previewed(const char path[]);
 static void process_scheduled_updates(void);
 TSTATIC int process_scheduled_updates_of_view(view_t *view);
@@ -146,6 +151,7 @@ event_loop(const int *quit)
 			modes_periodic();
 
 			bg_check();
+			compare_check_bg();
 
 			got_input = (get_char_async_loop(status_bar, &c, actual_timeout) != ERR);
 
@@ -349,12 +355,15 @@ ensure_term_is_ready(void)
  *  - checks for new IPC messages;
  *  - checks whether contents of displayed directories changed;
  *  - redraws UI if requested.
- * Returns KEY_CODE_YES for functional keys (preprocesses *c in this case), OK
- * for wide character and ERR otherwise (e.g. after timeout). */
+ * Where possible, sleeps until one of the sources of events becomes ready
+ * instead of checking all of them in short intervals.  Returns KEY_CODE_YES
+ * for functional keys (preprocesses *c in this case), OK for wide character
+ * and ERR otherwise (e.g. after timeout). */
 static int
 get_char_async_loop(WINDOW *win, wint_t *c, int timeout)
 {
-	const int IPC_F = ipc_enabled() ? 10 : 1;
+	selector_t *const selector = get_input_selector();
+	const int IPC_F = (ipc_enabled() && selector == NULL) ? 10 : 1;
 
 	do
 	{
@@ -386,8 +395,16 @@ get_char_async_loop(WINDOW *win, wint_t *c, int timeout)
 				stats_redraw_later();
 			}
 
-			wtimeout(win, delay_slice);
-			timeout -= delay_slice;
+			if(selector == NULL)
+			{
+				wtimeout(win, delay_slice);
+				timeout -= delay_slice;
+			}
+			else
+			{
+				/* Waiting is done below, curses only fetches what's available. */
+				wtimeout(win, 0);
+			}
 
 			if(suggestions_are_visible)
 			{
@@ -409,6 +426,14 @@ get_char_async_loop(WINDOW *win, wint_t *c, int timeout)
 			}
 
 			int result = compat_wget_wch(win, c);
+			if(result == ERR && selector != NULL)
+			{
+				/* Input could have been buffered by curses, hence reading it before
+				 * waiting. */
+				timeout -= wait_for_events(selector, timeout);
+				result = compat_wget_wch(win, c);
+			}
+
 			if(result != ERR)
 			{
 				if(result == KEY_CODE_YES)
@@ -430,6 +455,71 @@ get_char_async_loop(WINDOW *win, wint_t *c, int timeout)
 	return ERR;
 }
 
+/* Retrieves selector for waiting on input along with other events.  Returns
+ * the selector or NULL if waiting is done by curses. */
+static selector_t *
+get_input_selector(void)
+{
+#if defined(_WIN32) || defined(__PDCURSES__)
+	return NULL;
+#else
+	static selector_t *selector;
+	static int initialized;
+
+	if(!initialized && !vifm_testing())
+	{
+		selector = selector_alloc();
+		initialized = 1;
+	}
+	return selector;
+#endif
+}
+
+/* Sleeps until input arrives, one of the sources of events becomes ready or
+ * the timeout (in milliseconds) expires.  Sources of events that can't be
+ * waited on cause periodical wake ups.  Returns number of milliseconds spent
+ * waiting. */
+static int
+wait_for_events(selector_t *selector, int timeout)
+{
+#if defined(_WIN32) || defined(__PDCURSES__)
+	return timeout;
+#else
+	selector_reset(selector);
+	selector_add(selector, STDIN_FILENO);
+
+	/* Background jobs update state of the UI. */
+	int poll = bg_has_active_jobs(0);
+
+	if(curr_stats.ipc != NULL)
+	{
+		poll |= ipc_add_to_selector(curr_stats.ipc, selector);
+	}
+
+	poll |= vcache_add_to_selector(selector);
+
+	if(should_check_views_for_changes())
+	{
+		if(window_shows_dirlist(curr_view))
+		{
+			poll |= flist_add_to_selector(curr_view, selector);
+		}
+		if(window_shows_dirlist(other_view))
+		{
+			poll |= flist_add_to_selector(other_view, selector);
+		}
+	}
+
+	const int delay = poll ? MIN(cfg.min_timeout_len, timeout) : timeout;
+
+	const long long start = time_in_ms();
+	(void)selector_wait(selector, delay);
+	const long long elapsed = time_in_ms() - start;
+
+	return (elapsed < 0 || elapsed > delay) ? delay : (int)elapsed;
+#endif
+}
+
 /* Checks if preview of specified path is visible.  Returns non-zero if so and
  * zero otherwise. */
 static int
@@ -565,6 +655,49 @@ is_input_buf_empty(void)
 	return curr_input_buf_pos == NULL || *curr_input_buf_pos == 0;
 }
 
+int
+get_pending_key(wchar_t *c)
+{
+	if(input_queue[0] != L'\0')
+	{
+		*c = input_queue[0];
+		wmemmove(input_queue, input_queue + 1, wcslen(input_queue));
+		return 1;
+	}
+
+	/* Poll without waiting, but leave the delay as it was for other readers. */
+	const int delay = wgetdelay(status_bar);
+	wtimeout(status_bar, 0);
+	wint_t wc;
+	const int result = compat_wget_wch(status_bar, &wc);
+	wtimeout(status_bar, delay);
+	if(result == ERR)
+	{
+		return 0;
+	}
+
+	if(result == KEY_CODE_YES)
+	{
+		*c = K(wc);
+	}
+	else
+	{
+		*c = (wc == L'\0' ? WC_C_SPACE : (wchar_t)wc);
+	}
+	return 1;
+}
+
+void
+unget_key(wchar_t c)
+{
+	const size_t len = wcslen(input_queue);
+	if(len + 1 < ARRAY_LEN(input_queue))
+	{
+		wmemmove(input_queue + 1, input_queue, len + 1);
+		input_queue[0] = c;
+	}
+}
+
 /* Empties input buffer and resets input position. */
 static void
 reset_input_buf(wchar_t curr_input_buf[], size_t *curr_input_buf_pos)
@@ -20,6 +20,8 @@
 #ifndef VIFM__EVENT_LOOP_H__
 #define VIFM__EVENT_LOOP_H__
 
+#include <stddef.h> /* wchar_t */
+
 #include "utils/test_helpers.h"
 
 /* Everything is driven from this function with the exception of signals which
@@ -31,6 +33,14 @@ void update_input_buf(void);
 
 int is_input_buf_empty(void);
 
+/* Retrieves a key that is available without waiting for it, keys queued by
+ * unget_key() come first.  Returns non-zero if *c was set. */
+int get_pending_key(wchar_t *c);
+
+/* Puts the key back to be read next by get_pending_key() or the event loop.
+ * Drops it if there isn't enough space. */
+void unget_key(wchar_t c);
+
 TSTATIC_DEFS(
 	struct view_t;
 	int process_scheduled_updates_of_view(struct view_t *view);
@@ -28,7 +28,11 @@
 
 #include <curses.h>
 
-#include <sys/stat.h> /* stat */
+#include <sys/stat.h> /* stat fstatat() */
+#ifndef _WIN32
+#include <fcntl.h> /* AT_SYMLINK_NOFOLLOW O_DIRECTORY O_RDONLY open() */
+#include <unistd.h> /* close() */
+#endif
 
 #include <assert.h> /* assert() */
 #include <errno.h> /* errno */
@@ -39,17 +43,22 @@
 #include <stdlib.h> /* calloc() free() */
 #include <string.h> /* memcmp() memcpy() memset() strcat() strcmp() strcpy()
                        strdup() strlen() */
+#include <wchar.h> /* wcslen() */
 
 #include "cfg/config.h"
+#include "compat/curses.h"
 #include "compat/fs_limits.h"
 #include "compat/os.h"
 #include "compat/pthread.h"
+#include "compat/reallocarray.h"
 #include "engine/autocmds.h"
+#include "engine/keys.h"
 #include "engine/mode.h"
 #include "int/fuse.h"
 #include "modes/dialogs/msg_dialog.h"
 #include "modes/modes.h"
 #include "modes/view.h"
+#include "modes/wk.h"
 #include "ui/cancellation.h"
 #include "ui/column_view.h"
 #include "ui/fileview.h"
@@ -65,14 +74,20 @@
 #include "utils/log.h"
 #include "utils/macros.h"
 #include "utils/matcher.h"
+#include "utils/name_index.h"
+#include "utils/parallel.h"
 #include "utils/path.h"
 #include "utils/regexp.h"
+#include "utils/selector.h"
+#include "utils/slab.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
 #include "utils/test_helpers.h"
 #include "utils/trie.h"
 #include "utils/utf8.h"
 #include "utils/utils.h"
+#include "compare.h"
+#include "event_loop.h"
 #include "filtering.h"
 #include "flist_hist.h"
 #include "flist_pos.h"
@@ -87,6 +102,99 @@
 #include "status.h"
 #include "types.h"
 
+/* Maximum number of entries whose information is loaded by a thread at once. */
+#define LOAD_BATCH_SIZE 256
+
+/* Maximum number of entries whose information is pending to be loaded while
+ * directory is being read. */
+#define LOAD_PENDING_MAX (LOAD_BATCH_SIZE*64)
+
+/* Maximum number of directories of a tree view that are watched for changes.
+ * Larger trees are polled. */
+#define MAX_TREE_WATCHES 4096
+
+/* Minimal interval between displaying partially loaded list of a directory.
+ * Directories that are read faster are displayed only when fully loaded. */
+#define PARTIAL_PAINT_DELAY_MS 100
+
+/* Number of entries read between checks for keys that move cursor over
+ * partially loaded list. */
+#define LOAD_INPUT_CHECK_PERIOD 256
+
+/* Upper limit on count of a command that moves cursor during loading, keeps
+ * arithmetic on positions from overflowing. */
+#define MAX_LOAD_COUNT 1000000
+
+#ifndef _WIN32
+
+/* State of loading information about entries of a directory. */
+typedef struct
+{
+	dir_entry_t *entries; /* Entries to be filled. */
+	const char *dir;      /* Path to the directory that contains them. */
+	int dir_fd;           /* Descriptor of that directory. */
+}
+load_info_t;
+
+#endif
+
+/* State of loading list of files of a directory. */
+typedef struct
+{
+	view_t *view;              /* View whose list is being loaded. */
+	int progressive;           /* Whether partial list is displayed. */
+	int nloaded;               /* Number of entries with complete information. */
+	int next_paint;            /* Size of the list to display it next time. */
+	long long last_paint_time; /* When the list was last displayed. */
+	int ndisplayed;            /* Number of sorted entries that are displayed. */
+	int handle_input;          /* Whether cursor can be moved during loading. */
+	int cursor_moved;          /* Whether the user has moved the cursor. */
+	wchar_t keys[16];          /* Keys of a command that isn't complete yet. */
+}
+dir_load_t;
+
+/* Summary of changes of a single file of a directory. */
+typedef struct
+{
+	const char *name; /* Name of the file. */
+	int existed;      /* Whether the file existed before the changes. */
+	int exists;       /* Whether the file exists after the changes. */
+	int pos;          /* Position of file entry in the list or -1. */
+}
+file_change_t;
+
+/* Directory of a tree that is being built. */
+typedef struct tree_dir_t tree_dir_t;
+
+/* File of a directory of a tree that is being built. */
+typedef struct
+{
+	dir_entry_t entry;  /* Entry of the file, its type is FT_UNK on error. */
+	int is_dir;         /* Whether this is a directory or a link to one. */
+	tree_dir_t *subdir; /* Contents of a directory to descend into or NULL. */
+}
+tree_file_t;
+
+struct tree_dir_t
+{
+	char *path;         /* Path to the directory. */
+	tree_file_t *files; /* Files of the directory in the order of listing. */
+	int nfiles;         /* Number of files or negative value on error. */
+	slab_t *slab;       /* Arena for strings of the files. */
+};
+
+/* State of scanning of a tree, which is shared among threads. */
+typedef struct
+{
+	view_t *view;           /* View for which the tree is being built. */
+	trie_t *excluded_paths; /* Paths that should be skipped. */
+	pthread_t ui_thread;    /* Thread that can report progress. */
+	size_t nscanned;        /* Number of files scanned so far. */
+	size_t nreported;       /* Value of nscanned that was last reported. */
+	pthread_mutex_t lock;   /* Protects the counters and filters of the view. */
+}
+tree_scan_t;
+
 static void init_flist(view_t *view);
 static void reset_view(view_t *view);
 static void init_view_history(view_t *view);
@@ -96,6 +204,11 @@ static int fill_dir_entry_by_path(dir_entry_t *entry, const char path[]);
 #ifndef _WIN32
 static int fill_dir_entry(dir_entry_t *entry, const char path[],
 		const struct dirent *d);
+static int fill_dir_entry_from_stat(dir_entry_t *entry, const char path[],
+		const struct stat *s);
+static void load_entries_info(view_t *view, int from);
+static void load_entries_info_range(size_t from, size_t to, void *arg);
+static int load_entry_info(dir_entry_t *entry, int dir_fd, const char dir[]);
 static int data_is_dir_entry(const struct dirent *d, const char path[]);
 #else
 static int fill_dir_entry(dir_entry_t *entry, const char path[],
@@ -128,24 +241,45 @@ static int is_dead_or_filtered(view_t *view, const dir_entry_t *entry,
 static void update_entries_data(view_t *view);
 static int is_dir_big(const char path[]);
 static void free_view_entries(view_t *view);
-static int update_dir_list(view_t *view, int reload);
+static int update_dir_list(view_t *view, int reload, int *pos_chosen);
 static void start_dir_list_change(view_t *view, dir_entry_t **entries, int *len,
 		int reload);
 static void finish_dir_list_change(view_t *view, dir_entry_t *entries, int len);
 static int add_file_entry_to_view(const char name[], const void *data,
 		void *param);
+static void show_partial_list(dir_load_t *load);
+static void handle_load_input(dir_load_t *load);
+static int exec_load_keys(dir_load_t *load);
+static void stop_load_input(dir_load_t *load);
+static void goto_entry_by_name_ptr(view_t *view, const char name[],
+		int top_delta);
 static void sort_dir_list(int msg, view_t *view);
 static void merge_lists(view_t *view, dir_entry_t *entries, int len);
 TSTATIC void check_file_uniqueness(view_t *view);
-static void add_to_trie(trie_t *trie, view_t *view, dir_entry_t *entry);
-static int is_in_trie(trie_t *trie, view_t *view, dir_entry_t *entry,
-		void **data);
+static void add_to_index(nindex_t *index, view_t *view, dir_entry_t *entry,
+		int pos);
+static const char * get_index_dir(const view_t *view,
+		const dir_entry_t *entry);
 static void merge_entries(dir_entry_t *new, const dir_entry_t *prev);
 static int correct_pos(view_t *view, int pos, int dist, int closest);
 static int rescue_from_empty_filelist(view_t *view);
 static void add_parent_entry(view_t *view, dir_entry_t **entries, int *count);
-static void init_dir_entry(view_t *view, dir_entry_t *entry, const char name[]);
+static void init_dir_entry(view_t *view, dir_entry_t *entry, const char name[],
+		slab_t *slab);
+static slab_t * list_slab(const dir_entry_t list[], int list_size);
+static void ref_entry_slabs(const dir_entry_t entries[], int count);
 static dir_entry_t * alloc_dir_entry(dir_entry_t **list, int list_size);
+static int apply_dir_changes(view_t *view);
+static int patch_dir_list(view_t *view, const fswatch_change_t changes[],
+		int count);
+static int summarize_changes(view_t *view, const fswatch_change_t changes[],
+		int count, file_change_t files[]);
+static void patch_dir_entry(view_t *view, const file_change_t *file,
+		dir_entry_t *added, int *nadded);
+static int tree_needs_reload(view_t *view);
+static uint64_t get_tree_dirs_sum(const view_t *view, int *ndirs);
+static fswatch_t * create_tree_watch(const view_t *view);
+static void reset_tree_watch(view_t *view);
 static int tree_has_changed(const dir_entry_t *entries, size_t nchildren);
 static FSWatchState poll_watcher(fswatch_t *watch, const char path[]);
 static void find_dir_in_cdpath(const char base_dir[], const char dst[],
@@ -170,12 +304,20 @@ static void reset_entry_list(view_t *view, dir_entry_t **entries, int *count);
 static void drop_tops(view_t *view, dir_entry_t *entries, int *nentries,
 		int extra);
 static int add_files_recursively(view_t *view, const char path[],
-		trie_t *excluded_paths, int parent_pos, int no_direct_parent);
+		trie_t *excluded_paths);
+static tree_dir_t * alloc_tree_dir(const char path[]);
+static void free_tree_dir(view_t *view, tree_dir_t *dir);
+static void scan_tree_dir(par_tasks_t *tasks, void *task, void *arg);
+static void scan_tree_file(tree_scan_t *scan, tree_file_t *file,
+		const char path[], slab_t *slab);
+static void report_tree_scan(tree_scan_t *scan, int nfiles);
+static int add_tree_dir(view_t *view, tree_dir_t *dir, int parent_pos,
+		int no_direct_parent);
 static int file_is_visible(view_t *view, const char name[], int is_dir,
 		const void *data, int apply_local_filter);
 static int add_directory_leaf(view_t *view, const char path[], int parent_pos);
 static int init_parent_entry(view_t *view, dir_entry_t *entry,
-		const char path[]);
+		const char path[], slab_t *slab);
 
 void
 init_filelists(void)
@@ -213,6 +355,8 @@ init_flist(view_t *view)
 	view->has_dups = 0;
 
 	view->watched_dir = NULL;
+	view->tree_watch = NULL;
+	view->tree_watch_sum = 0U;
 	view->last_dir = NULL;
 
 	view->matches = 0;
@@ -238,6 +382,8 @@ flist_free_view(view_t *view)
 	/* For the application, we don't need to zero out fields after freeing them,
 	 * but doing so allows reusing this function in tests. */
 
+	compare_view_freed(view);
+
 	int i;
 
 	for(i = 0; i < view->list_rows; ++i)
@@ -282,6 +428,10 @@ flist_free_view(view_t *view)
 	update_string(&view->local_filter.prev, NULL);
 	free(view->local_filter.poshist);
 	view->local_filter.poshist = NULL;
+	free(view->local_filter.matches);
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_count = 0;
+	update_string(&view->local_filter.matches_for, NULL);
 
 	filter_dispose(&view->local_filter.filter);
 	filter_dispose(&view->auto_filter);
@@ -295,6 +445,7 @@ flist_free_view(view_t *view)
 	fswatch_free(view->watch);
 	view->watch = NULL;
 	update_string(&view->watched_dir, NULL);
+	reset_tree_watch(view);
 
 	update_string(&view->last_dir, NULL);
 
@@ -790,7 +941,8 @@ fill_with_shared(view_t *view)
 
 				utf8_name = utf8_from_utf16((wchar_t *)p->shi0_netname);
 
-				init_dir_entry(view, dir_entry, utf8_name);
+				init_dir_entry(view, dir_entry, utf8_name,
+						list_slab(view->dir_entry, view->list_rows));
 				dir_entry->type = FT_DIR;
 
 				free(utf8_name);
@@ -883,9 +1035,9 @@ flist_custom_add_separator(view_t *view, int id)
 			view->custom.entry_count);
 	if(dir_entry != NULL)
 	{
-		init_dir_entry(view, dir_entry, "");
-		dir_entry->origin = strdup(flist_get_dir(view));
-		dir_entry->owns_origin = 1;
+		init_dir_entry(view, dir_entry, "",
+				list_slab(view->custom.entries, view->custom.entry_count));
+		(void)fentry_set_origin(dir_entry, flist_get_dir(view));
 		dir_entry->id = id;
 		++view->custom.entry_count;
 	}
@@ -921,31 +1073,161 @@ fill_dir_entry(dir_entry_t *entry, const char path[], const struct dirent *d)
 	{
 		entry->type = (d == NULL) ? FT_UNK : type_from_dir_entry(d, path);
 	}
+
+	if(fill_dir_entry_from_stat(entry, path, &s) != 0)
+	{
+		return 1;
+	}
+
+	if(entry->type == FT_LINK)
+	{
+		const SymLinkType symlink_type = get_symlink_type(path);
+		entry->dir_link = (symlink_type != SLT_UNKNOWN);
+
+		/* Query mode of symbolic link target. */
+		if(symlink_type != SLT_SLOW && os_stat(path, &s) == 0)
+		{
+			entry->mode = s.st_mode;
+		}
+	}
+
+	return 0;
+}
+
+/* Fills fields of the entry, whose type was already determined, from stat
+ * information of the file specified by its path.  Target of a symbolic link
+ * isn't examined.  Returns zero on success, otherwise non-zero is returned. */
+static int
+fill_dir_entry_from_stat(dir_entry_t *entry, const char path[],
+		const struct stat *s)
+{
 	if(entry->type == FT_UNK)
 	{
 		LOG_ERROR_MSG("Can't determine type of \"%s\"", path);
 		return 1;
 	}
 
-	entry->size = (uintmax_t)s.st_size;
-	entry->uid = s.st_uid;
-	entry->gid = s.st_gid;
-	entry->mode = s.st_mode;
-	entry->inode = s.st_ino;
-	entry->mtime = s.st_mtime;
-	entry->atime = s.st_atime;
-	entry->ctime = s.st_ctime;
-	entry->nlinks = s.st_nlink;
+	entry->size = (uintmax_t)s->st_size;
+	entry->uid = s->st_uid;
+	entry->gid = s->st_gid;
+	entry->mode = s->st_mode;
+	entry->inode = s->st_ino;
+	entry->mtime = s->st_mtime;
+	entry->atime = s->st_atime;
+	entry->ctime = s->st_ctime;
+	entry->nlinks = s->st_nlink;
 
-	if(entry->type == FT_LINK)
+	return 0;
+}
+
+/* Queries information about files of the view in the current directory starting
+ * with the one at from index, which was postponed by add_file_entry_to_view()
+ * to process many entries at once on several threads.  Entries for which this
+ * fails are dropped. */
+static void
+load_entries_info(view_t *view, int from)
+{
+	load_info_t info = {
+		.entries = view->dir_entry + from,
+		.dir = view->curr_dir,
+		.dir_fd = open(view->curr_dir, O_RDONLY | O_DIRECTORY),
+	};
+
+	int i;
+	if(info.dir_fd != -1)
+	{
+		par_for(view->list_rows - from, LOAD_BATCH_SIZE, &load_entries_info_range,
+				&info);
+		close(info.dir_fd);
+	}
+	else
 	{
-		struct stat s;
+		/* Can't rely on current directory of the process, so load information
+		 * sequentially by full paths. */
+		LOG_SERROR_MSG(errno, "Can't open \"%s\"", view->curr_dir);
+		for(i = from; i < view->list_rows; ++i)
+		{
+			dir_entry_t *const entry = &view->dir_entry[i];
+			char *const full_path = format_str("%s/%s", view->curr_dir, entry->name);
+			if(full_path == NULL || fill_dir_entry(entry, full_path, NULL) != 0)
+			{
+				entry->type = FT_UNK;
+			}
+			free(full_path);
+		}
+	}
 
-		const SymLinkType symlink_type = get_symlink_type(path);
+	/* Drop entries that failed to load preserving order of the rest. */
+	int j = from;
+	for(i = from; i < view->list_rows; ++i)
+	{
+		dir_entry_t *const entry = &view->dir_entry[i];
+		if(entry->type == FT_UNK)
+		{
+			fentry_free(view, entry);
+			continue;
+		}
+
+		if(i != j)
+		{
+			view->dir_entry[j] = *entry;
+		}
+		++j;
+	}
+	view->list_rows = j;
+}
+
+/* par_for() callback that loads information about a range of entries.  Type
+ * of entries for which it fails is set to FT_UNK. */
+static void
+load_entries_info_range(size_t from, size_t to, void *arg)
+{
+	const load_info_t *const info = arg;
+
+	size_t i;
+	for(i = from; i < to; ++i)
+	{
+		dir_entry_t *const entry = &info->entries[i];
+		if(load_entry_info(entry, info->dir_fd, info->dir) != 0)
+		{
+			entry->type = FT_UNK;
+		}
+	}
+}
+
+/* Fills the entry of dir directory opened as dir_fd.  All paths are resolved
+ * relative to the descriptor, so current directory of the process doesn't
+ * matter.  Returns zero on success, otherwise non-zero is returned. */
+static int
+load_entry_info(dir_entry_t *entry, int dir_fd, const char dir[])
+{
+	struct stat s;
+	if(fstatat(dir_fd, entry->name, &s, AT_SYMLINK_NOFOLLOW) != 0)
+	{
+		LOG_SERROR_MSG(errno, "Can't lstat() \"%s\"", entry->name);
+		return 1;
+	}
+
+	/* Type reported by readdir() is only a fallback. */
+	const FileType type = get_type_from_mode(s.st_mode);
+	if(type != FT_UNK)
+	{
+		entry->type = type;
+	}
+
+	if(fill_dir_entry_from_stat(entry, entry->name, &s) != 0)
+	{
+		return 1;
+	}
+
+	if(entry->type == FT_LINK)
+	{
+		const SymLinkType symlink_type =
+			get_symlink_type_at(dir_fd, dir, entry->name);
 		entry->dir_link = (symlink_type != SLT_UNKNOWN);
 
 		/* Query mode of symbolic link target. */
-		if(symlink_type != SLT_SLOW && os_stat(entry->name, &s) == 0)
+		if(symlink_type != SLT_SLOW && fstatat(dir_fd, entry->name, &s, 0) == 0)
 		{
 			entry->mode = s.st_mode;
 		}
@@ -1077,10 +1359,10 @@ flist_custom_finish_internal(view_t *view, CVType type, int reload,
 				view->custom.entry_count);
 		if(dir_entry != NULL)
 		{
-			init_dir_entry(view, dir_entry, "..");
+			init_dir_entry(view, dir_entry, "..",
+					list_slab(view->custom.entries, view->custom.entry_count));
 			dir_entry->type = FT_DIR;
-			dir_entry->origin = strdup(dir);
-			dir_entry->owns_origin = 1;
+			(void)fentry_set_origin(dir_entry, dir);
 			++view->custom.entry_count;
 		}
 	}
@@ -1374,8 +1656,19 @@ flist_custom_clone(view_t *to, const view_t *from, int as_tree)
 		}
 
 		dst[j] = src[i];
-		dst[j].name = strdup(dst[j].name);
-		dst[j].origin = (dst[j].owns_origin ? strdup(dst[j].origin) : to->curr_dir);
+		/* Strings in arenas are shared with the source. */
+		if(dst[j].slab == NULL)
+		{
+			dst[j].name = strdup(dst[j].name);
+			if(dst[j].owns_origin)
+			{
+				dst[j].origin = strdup(dst[j].origin);
+			}
+		}
+		if(!dst[j].owns_origin)
+		{
+			dst[j].origin = to->curr_dir;
+		}
 
 		if(!as_tree)
 		{
@@ -1387,6 +1680,7 @@ flist_custom_clone(view_t *to, const view_t *from, int as_tree)
 
 		++j;
 	}
+	ref_entry_slabs(dst, j);
 
 	free_dir_entries(to, &to->custom.entries, &to->custom.entry_count);
 	free_dir_entries(to, &to->dir_entry, &to->list_rows);
@@ -1651,6 +1945,7 @@ static int
 populate_dir_list_internal(view_t *view, int reload)
 {
 	char *saved_cwd;
+	int pos_chosen = 0;
 
 	view->filtered = 0;
 
@@ -1715,7 +2010,7 @@ populate_dir_list_internal(view_t *view, int reload)
 					"Can't load list of shares of %s", view->curr_dir);
 
 			leave_invalid_dir(view);
-			if(update_dir_list(view, reload) != 0)
+			if(update_dir_list(view, reload, &pos_chosen) != 0)
 			{
 				/* We don't have read access, only execute, or there were other
 				 * problems. */
@@ -1725,7 +2020,7 @@ populate_dir_list_internal(view_t *view, int reload)
 		}
 #endif
 	}
-	else if(update_dir_list(view, reload) != 0)
+	else if(update_dir_list(view, reload, &pos_chosen) != 0)
 	{
 		/* We don't have read access, only execute, or there were other problems. */
 		free_view_entries(view);
@@ -1740,8 +2035,9 @@ populate_dir_list_internal(view_t *view, int reload)
 	fview_update_geometry(view);
 
 	/* If reloading the same directory don't jump to history position.  Stay at
-	 * the current line. */
-	if(!reload)
+	 * the current line.  Same if the user has already picked a file while the
+	 * list was loading. */
+	if(!reload && !pos_chosen)
 	{
 		/* XXX: why cursor is positioned in code that loads the list? */
 		flist_hist_lookup(view, view);
@@ -1915,7 +2211,7 @@ zap_compare_view(view_t *view, view_t *other, zap_filter filter, void *arg)
 				}
 				continue;
 			}
-			replace_string(&entry->name, "");
+			(void)fentry_set_name(entry, "");
 			entry->type = FT_UNK;
 			entry->id = other->dir_entry[i].id;
 		}
@@ -2138,10 +2434,10 @@ zap_entries(view_t *view, dir_entry_t *entries, int *count, zap_filter filter,
 
 			get_full_path_of(&entries[j - 1], sizeof(full_path), full_path);
 			path = format_str("%s/..", full_path);
-			init_parent_entry(view, &entries[j], path);
+			init_parent_entry(view, &entries[j], path, list_slab(entries, j));
 			remove_last_path_component(path);
-			entries[j].origin = path;
-			entries[j].owns_origin = 1;
+			(void)fentry_set_origin(&entries[j], path);
+			free(path);
 			entries[j].child_pos = 1;
 
 			/* Since we now adding back one entry, correct increase parent counts and
@@ -2203,23 +2499,51 @@ free_view_entries(view_t *view)
 	free_dir_entries(view, &view->dir_entry, &view->list_rows);
 }
 
-/* Updates file list with files from current directory.  Returns zero on
- * success, otherwise non-zero is returned. */
+/* Updates file list with files from current directory.  Sets *pos_chosen to
+ * non-zero if cursor was positioned by the user during loading.  Returns zero
+ * on success, otherwise non-zero is returned. */
 static int
-update_dir_list(view_t *view, int reload)
+update_dir_list(view_t *view, int reload, int *pos_chosen)
 {
 	dir_entry_t *prev_dir_entries;
 	int prev_list_rows;
 
 	start_dir_list_change(view, &prev_dir_entries, &prev_list_rows, reload);
 
-	if(enum_dir_content(view->curr_dir, &add_file_entry_to_view, view) != 0)
+	/* Reloading keeps displaying previous state of the list instead. */
+	dir_load_t load = {
+		.view = view,
+		.progressive = !reload && curr_stats.load_stage >= 2
+		            && ui_view_is_visible(view),
+		.next_paint = MAX(view->window_cells, 1),
+		.last_paint_time = time_in_ms(),
+	};
+	/* Keys can be handled only if they are meant for this view. */
+	load.handle_input = load.progressive && view == curr_view
+	                 && vle_mode_is(NORMAL_MODE);
+
+	const int enum_error =
+		(enum_dir_content(view->curr_dir, &add_file_entry_to_view, &load) != 0);
+	stop_load_input(&load);
+
+	if(enum_error)
 	{
 		LOG_SERROR_MSG(errno, "Can't opendir() \"%s\"", view->curr_dir);
 		free_dir_entries(view, &prev_dir_entries, &prev_list_rows);
 		return 1;
 	}
 
+	/* Names aren't reallocated, so the pointer identifies the file after the
+	 * list is sorted. */
+	const char *const picked_name = load.cursor_moved
+	                              ? view->dir_entry[view->list_pos].name
+	                              : NULL;
+	const int top_delta = view->list_pos - view->top_line;
+
+#ifndef _WIN32
+	load_entries_info(view, load.nloaded);
+#endif
+
 	if(cfg_parent_dir_is_visible(is_root_dir(view->curr_dir)) ||
 			view->list_rows == 0)
 	{
@@ -2232,6 +2556,13 @@ update_dir_list(view_t *view, int reload)
 	 * (sorting doesn't preserve it). */
 	finish_dir_list_change(view, prev_dir_entries, prev_list_rows);
 
+	if(picked_name != NULL)
+	{
+		/* Keep the file that was picked while the list was incomplete. */
+		goto_entry_by_name_ptr(view, picked_name, top_delta);
+		*pos_chosen = 1;
+	}
+
 	return 0;
 }
 
@@ -2279,7 +2610,8 @@ finish_dir_list_change(view_t *view, dir_entry_t *entries, int len)
 static int
 add_file_entry_to_view(const char name[], const void *data, void *param)
 {
-	view_t *const view = param;
+	dir_load_t *const load = param;
+	view_t *const view = load->view;
 	dir_entry_t *entry;
 
 	/* Always ignore the "." and ".." directories. */
@@ -2301,8 +2633,23 @@ add_file_entry_to_view(const char name[], const void *data, void *param)
 		return 1;
 	}
 
-	init_dir_entry(view, entry, name);
+	init_dir_entry(view, entry, name,
+			list_slab(view->dir_entry, view->list_rows));
+
+#ifndef _WIN32
+	/* Loading of the rest of information is postponed until all names are
+	 * known, see load_entries_info(). */
+#if defined(HAVE_STRUCT_DIRENT_D_TYPE) && HAVE_STRUCT_DIRENT_D_TYPE
+	entry->type = type_from_dir_entry(data, name);
+#endif
+	++view->list_rows;
 
+	if(view->list_rows - load->nloaded >= LOAD_PENDING_MAX)
+	{
+		load_entries_info(view, load->nloaded);
+		load->nloaded = view->list_rows;
+	}
+#else
 	if(fill_dir_entry(entry, entry->name, data) == 0)
 	{
 		++view->list_rows;
@@ -2311,10 +2658,210 @@ add_file_entry_to_view(const char name[], const void *data, void *param)
 	{
 		fentry_free(view, entry);
 	}
+#endif
+
+	if(load->progressive && view->list_rows >= load->next_paint &&
+			time_in_ms() - load->last_paint_time >= PARTIAL_PAINT_DELAY_MS)
+	{
+		show_partial_list(load);
+	}
+
+	if(load->handle_input && load->ndisplayed > 0 &&
+			view->list_rows%LOAD_INPUT_CHECK_PERIOD == 0)
+	{
+		handle_load_input(load);
+	}
+
+	return 0;
+}
+
+/* Displays list of a directory that is still being loaded so that the user
+ * doesn't stare at an empty screen while reading huge directory.  Entries
+ * loaded so far are sorted among themselves, final sorting happens after all of
+ * them are read.  Cursor stays on the file the user has moved it to. */
+static void
+show_partial_list(dir_load_t *load)
+{
+	view_t *const view = load->view;
+
+	const char *const cursor_name = load->cursor_moved
+	                              ? view->dir_entry[view->list_pos].name
+	                              : NULL;
+	const int top_delta = view->list_pos - view->top_line;
+
+#ifndef _WIN32
+	load_entries_info(view, load->nloaded);
+#endif
+	load->nloaded = view->list_rows;
+
+	sort_view(view);
+	load->ndisplayed = view->list_rows;
+
+	if(cursor_name != NULL)
+	{
+		goto_entry_by_name_ptr(view, cursor_name, top_delta);
+	}
+	else
+	{
+		/* Final position is chosen after loading is done. */
+		view->list_pos = 0;
+		view->curr_line = 0;
+		view->top_line = 0;
+	}
+
+	fview_update_geometry(view);
+	draw_dir_list(view);
+	if(view == curr_view)
+	{
+		ui_ruler_update(view, 1);
+	}
+	if(!vle_mode_is(CMDLINE_MODE))
+	{
+		ui_sb_quick_msgf("Reading directory... %d", view->list_rows);
+	}
+
+	/* Repaint less often as the list grows to not spend too much time on
+	 * sorting partial lists. */
+	load->next_paint = view->list_rows*2;
+	load->last_paint_time = time_in_ms();
+}
+
+/* Moves cursor over partially loaded list according to keys that were pressed
+ * by the user.  The first command that isn't a builtin movement is left to be
+ * processed after loading is done along with all keys that follow it. */
+static void
+handle_load_input(dir_load_t *load)
+{
+	wchar_t c;
+	while(get_pending_key(&c))
+	{
+		const size_t len = wcslen(load->keys);
+		load->keys[len] = c;
+		load->keys[len + 1] = L'\0';
+
+		const int result = exec_load_keys(load);
+		if(result == KEYS_WAIT && len + 2 < ARRAY_LEN(load->keys))
+		{
+			continue;
+		}
+
+		if(result != 0)
+		{
+			stop_load_input(load);
+			break;
+		}
+
+		load->keys[0] = L'\0';
+	}
+}
+
+/* Executes movement command accumulated in load->keys within displayed part of
+ * a list that is being loaded.  Keys that are mapped by the user aren't
+ * processed here.  Returns zero if the command was executed, KEYS_WAIT if it's
+ * incomplete and KEYS_UNKNOWN if it has to be handled by the event loop. */
+static int
+exec_load_keys(dir_load_t *load)
+{
+	if(vle_keys_user_starts_with(load->keys, NORMAL_MODE))
+	{
+		return KEYS_UNKNOWN;
+	}
+
+	const wchar_t *keys = load->keys;
+	int count = 0;
+	while(*keys >= L'0' && *keys <= L'9' && (count != 0 || *keys != L'0'))
+	{
+		count = MIN(count*10 + (*keys - L'0'), MAX_LOAD_COUNT);
+		++keys;
+	}
+
+	if(*keys == L'\0')
+	{
+		return KEYS_WAIT;
+	}
+	if(vle_keys_user_starts_with(keys, NORMAL_MODE))
+	{
+		return KEYS_UNKNOWN;
+	}
 
+	view_t *const view = load->view;
+	const int page = MAX(view->window_cells, 1);
+	const long long n = MAX(count, 1);
+	long long pos = view->list_pos;
+
+	switch(*keys)
+	{
+		case L'j':
+		case K(KEY_DOWN):
+			pos += n*fpos_get_ver_step(view);
+			break;
+		case L'k':
+		case K(KEY_UP):
+			pos -= n*fpos_get_ver_step(view);
+			break;
+		case WC_C_f:
+		case K(KEY_NPAGE):
+			pos += n*page;
+			break;
+		case WC_C_b:
+		case K(KEY_PPAGE):
+			pos -= n*page;
+			break;
+		case K(KEY_HOME):
+			pos = 0;
+			break;
+		case L'G':
+		case K(KEY_END):
+			pos = (count == 0 ? load->ndisplayed : count) - 1;
+			break;
+
+		default:
+			return KEYS_UNKNOWN;
+	}
+
+	/* Entries that were read after the list was displayed aren't sorted yet and
+	 * are hidden from the cursor. */
+	const int list_rows = view->list_rows;
+	view->list_rows = load->ndisplayed;
+	fpos_set_pos(view, (int)MAX(MIN(pos, load->ndisplayed), -1));
+	view->list_rows = list_rows;
+
+	load->cursor_moved = 1;
 	return 0;
 }
 
+/* Stops processing keys during loading giving keys of incomplete command back
+ * to the event loop. */
+static void
+stop_load_input(dir_load_t *load)
+{
+	size_t len = wcslen(load->keys);
+	while(len > 0)
+	{
+		unget_key(load->keys[--len]);
+	}
+	load->keys[0] = L'\0';
+	load->handle_input = 0;
+}
+
+/* Puts cursor on the entry whose name is stored at the specified address
+ * keeping distance from the top of the view if possible. */
+static void
+goto_entry_by_name_ptr(view_t *view, const char name[], int top_delta)
+{
+	int i;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		if(view->dir_entry[i].name == name)
+		{
+			view->list_pos = i;
+			view->top_line = MAX(i - top_delta, 0);
+			view->curr_line = i - view->top_line;
+			break;
+		}
+	}
+}
+
 void
 resort_dir_list(int msg, view_t *view)
 {
@@ -2359,39 +2906,39 @@ merge_lists(view_t *view, dir_entry_t *entries, int len)
 	int i;
 	int closest_dist;
 	const int prev_pos = view->list_pos;
-	trie_t *prev_names = trie_create();
+	nindex_t *const prev_names = nindex_alloc(len);
+	if(prev_names == NULL)
+	{
+		return;
+	}
 
 	for(i = 0; i < len; ++i)
 	{
-		add_to_trie(prev_names, view, &entries[i]);
-
-		/* We won't use the name later, so free some memory. */
-		update_string(&entries[i].name, NULL);
+		add_to_index(prev_names, view, &entries[i], i);
 	}
 
 	closest_dist = INT_MIN;
 	for(i = 0; i < view->list_rows; ++i)
 	{
-		int dist;
-		void *data;
 		dir_entry_t *const entry = &view->dir_entry[i];
-		if(!is_in_trie(prev_names, view, entry, &data))
+		const int prev = nindex_get(prev_names, get_index_dir(view, entry),
+				entry->name);
+		if(prev < 0)
 		{
 			continue;
 		}
 
 		/* Transfer information from previous entry to the new one. */
-		merge_entries(entry, data);
+		merge_entries(entry, &entries[prev]);
 
 		/* Update number of selected files (should have been zeroed beforehand). */
 		view->selected_files += (entry->selected != 0);
 
 		/* Update cursor position in a smart way. */
-		dist = (dir_entry_t *)data - entries - prev_pos;
-		closest_dist = correct_pos(view, i, dist, closest_dist);
+		closest_dist = correct_pos(view, i, prev - prev_pos, closest_dist);
 	}
 
-	trie_free(prev_names);
+	nindex_free(prev_names);
 }
 
 /* Checks that entries don't have the same name (for non-cv).  And if there are
@@ -2400,17 +2947,21 @@ merge_lists(view_t *view, dir_entry_t *entries, int len)
 TSTATIC void
 check_file_uniqueness(view_t *view)
 {
-	trie_t *file_names = trie_create();
+	nindex_t *const file_names = nindex_alloc(view->list_rows);
+	if(file_names == NULL)
+	{
+		return;
+	}
 
 	int had_dups = view->has_dups;
 
 	int i;
 	for(i = 0; i < view->list_rows; ++i)
 	{
-		add_to_trie(file_names, view, &view->dir_entry[i]);
+		add_to_index(file_names, view, &view->dir_entry[i], i);
 	}
 
-	trie_free(file_names);
+	nindex_free(file_names);
 
 	if(view->has_dups)
 	{
@@ -2423,23 +2974,22 @@ check_file_uniqueness(view_t *view)
 	}
 }
 
-/* Adds view entry into the trie mapping its name to entry structure.
- * Duplicated entries of a non-custom view are marked as temporary. */
+/* Adds view entry into the index mapping its name to its position.  Duplicated
+ * entries of a non-custom view are marked as temporary. */
 static void
-add_to_trie(trie_t *trie, view_t *view, dir_entry_t *entry)
+add_to_index(nindex_t *index, view_t *view, dir_entry_t *entry, int pos)
 {
+	const int result = nindex_put(index, get_index_dir(view, entry), entry->name,
+			pos);
+
 	if(flist_custom_active(view))
 	{
-		char full_path[PATH_MAX + 1];
-		get_full_path_of(entry, sizeof(full_path), full_path);
-
-		int error = trie_set(trie, full_path, entry);
-		assert(error == 0 && "Duplicated file names in the list?");
-		(void)error;
+		assert(result == 0 && "Duplicated file names in the list?");
+		(void)result;
 		return;
 	}
 
-	if(trie_set(trie, entry->name, entry) != 0)
+	if(result != 0)
 	{
 		LOG_INFO_MSG("Duplicated entry is `%s` in `%s`", entry->name,
 				entry->origin);
@@ -2448,27 +2998,14 @@ add_to_trie(trie_t *trie, view_t *view, dir_entry_t *entry)
 	}
 }
 
-/* Looks up entry in the trie by its name.  Retrieves directory entry stored by
- * add_to_trie() into *data (unchanged on lookup failure).  Returns non-zero if
- * item was successfully retrieved and zero otherwise. */
-static int
-is_in_trie(trie_t *trie, view_t *view, dir_entry_t *entry, void **data)
+/* Retrieves directory part of a key of the entry in an index of names, which
+ * is needed only in custom views where names alone aren't unique.  Returns the
+ * directory or NULL. */
+static const char *
+get_index_dir(const view_t *view, const dir_entry_t *entry)
 {
-	int error;
-
-	if(flist_custom_active(view))
-	{
-		char full_path[PATH_MAX + 1];
-		get_full_path_of(entry, sizeof(full_path), full_path);
-		error = trie_get(trie, full_path, data);
-	}
-	else
-	{
-		error = trie_get(trie, entry->name, data);
-	}
-
-	return (error == 0);
-}
+	return flist_custom_active(view) ? entry->origin : NULL;
+}
 
 /* Merges data from previous entry into the new one.  Both entries should
  * correspond to the same file (their names must match). */
@@ -2487,6 +3024,9 @@ merge_entries(dir_entry_t *new, const dir_entry_t *prev)
 		new->hi_num = prev->hi_num;
 		new->name_dec_num = prev->name_dec_num;
 	}
+
+	/* new->link_state is left as is, so that targets of links are checked anew
+	 * after every reload. */
 }
 
 /* Corrects selected item position in the list.  Returns updated value of the
@@ -2554,18 +3094,30 @@ add_parent_entry(view_t *view, dir_entry_t **entries, int *count)
 		return;
 	}
 
-	if(init_parent_entry(view, dir_entry, "..") == 0)
+	if(init_parent_entry(view, dir_entry, "..", list_slab(*entries, *count)) == 0)
 	{
 		++*count;
 	}
 }
 
 /* Initializes dir_entry_t with name and all other fields with default
- * values. */
+ * values.  Strings of the entry are put into the slab, which should be the one
+ * of the list the entry is added to, or into a new one if slab is NULL. */
 static void
-init_dir_entry(view_t *view, dir_entry_t *entry, const char name[])
+init_dir_entry(view_t *view, dir_entry_t *entry, const char name[],
+		slab_t *slab)
 {
-	entry->name = strdup(name);
+	if(slab == NULL)
+	{
+		slab = slab_create();
+	}
+	else
+	{
+		slab_ref(slab, 1);
+	}
+
+	entry->slab = slab;
+	entry->name = (slab == NULL ? strdup(name) : slab_strdup(slab, name));
 	entry->origin = &view->curr_dir[0];
 
 	entry->size = 0ULL;
@@ -2587,6 +3139,7 @@ init_dir_entry(view_t *view, dir_entry_t *entry, const char name[])
 	entry->dir_link = 0;
 	entry->hi_num = -1;
 	entry->name_dec_num = -1;
+	entry->link_state = LS_UNKNOWN;
 
 	entry->child_count = 0;
 	entry->child_pos = 0;
@@ -2611,27 +3164,38 @@ replace_dir_entries(view_t *view, dir_entry_t **entries, int *count,
 	int i;
 
 	new = dynarray_extend(NULL, with_count*sizeof(*new));
-	if(new == NULL)
+	slab_t *const slab = slab_create();
+	if(new == NULL || slab == NULL)
 	{
+		dynarray_free(new);
+		slab_release(slab, 1);
 		return;
 	}
 
 	memcpy(new, with_entries, sizeof(*new)*with_count);
 
+	/* The copy owns all of its strings, which are placed in an arena of its
+	 * own. */
+	slab_ref(slab, with_count);
+	int failed = 0;
 	for(i = 0; i < with_count; ++i)
 	{
 		dir_entry_t *const entry = &new[i];
 
-		entry->name = strdup(entry->name);
-		entry->origin = strdup(entry->origin);
+		entry->slab = slab;
+		entry->name = slab_strdup(slab, entry->name);
+		entry->origin = slab_intern(slab, entry->origin);
 		entry->owns_origin = 1;
 
-		if(entry->name == NULL || entry->origin == NULL)
-		{
-			int count_so_far = i + 1;
-			free_dir_entries(view, &new, &count_so_far);
-			return;
-		}
+		failed |= (entry->name == NULL || entry->origin == NULL);
+	}
+	slab_release(slab, 1);
+
+	if(failed)
+	{
+		int new_count = with_count;
+		free_dir_entries(view, &new, &new_count);
+		return;
 	}
 
 	free_dir_entries(view, entries, count);
@@ -2642,11 +3206,30 @@ replace_dir_entries(view_t *view, dir_entry_t **entries, int *count,
 void
 free_dir_entries(view_t *view, dir_entry_t **entries, int *count)
 {
+	/* Neighbouring entries usually share an arena, so references to it are
+	 * released at once. */
+	slab_t *slab = NULL;
+	int nrefs = 0;
+
 	int i;
 	for(i = 0; i < *count; ++i)
 	{
-		fentry_free(view, &(*entries)[i]);
+		dir_entry_t *const entry = &(*entries)[i];
+		if(entry->slab == NULL)
+		{
+			fentry_free(view, entry);
+			continue;
+		}
+
+		if(entry->slab != slab)
+		{
+			slab_release(slab, nrefs);
+			slab = entry->slab;
+			nrefs = 0;
+		}
+		++nrefs;
 	}
+	slab_release(slab, nrefs);
 
 	dynarray_free(*entries);
 	*entries = NULL;
@@ -2656,16 +3239,73 @@ free_dir_entries(view_t *view, dir_entry_t **entries, int *count)
 void
 fentry_free(const view_t *view, dir_entry_t *entry)
 {
-	free(entry->name);
-	entry->name = NULL;
+	if(entry->slab == NULL)
+	{
+		free(entry->name);
+		if(entry->owns_origin)
+		{
+			free(entry->origin);
+		}
+	}
+	else
+	{
+		slab_release(entry->slab, 1);
+		entry->slab = NULL;
+	}
 
+	entry->name = NULL;
 	if(entry->owns_origin)
 	{
-		free(entry->origin);
 		entry->origin = NULL;
 	}
 }
 
+int
+fentry_set_name(dir_entry_t *entry, const char name[])
+{
+	if(entry->slab != NULL)
+	{
+		/* Previous value stays in the arena until it's freed. */
+		char *const copy = slab_strdup(entry->slab, name);
+		if(copy == NULL)
+		{
+			return 1;
+		}
+		entry->name = copy;
+		return 0;
+	}
+
+	return (replace_string(&entry->name, name) != 0);
+}
+
+int
+fentry_set_origin(dir_entry_t *entry, const char origin[])
+{
+	char *copy;
+	if(entry->slab != NULL)
+	{
+		copy = slab_intern(entry->slab, origin);
+	}
+	else
+	{
+		copy = strdup(origin);
+	}
+
+	if(copy == NULL)
+	{
+		return 1;
+	}
+
+	if(entry->owns_origin && entry->slab == NULL)
+	{
+		free(entry->origin);
+	}
+
+	entry->origin = copy;
+	entry->owns_origin = 1;
+	return 0;
+}
+
 dir_entry_t *
 add_dir_entry(dir_entry_t **list, size_t *list_size, const dir_entry_t *entry)
 {
@@ -2690,11 +3330,13 @@ entry_list_add(view_t *view, dir_entry_t **list, int *list_size,
 		return NULL;
 	}
 
-	init_dir_entry(view, dir_entry, get_last_path_component(path));
+	init_dir_entry(view, dir_entry, get_last_path_component(path),
+			list_slab(*list, *list_size));
 
-	dir_entry->origin = strdup(path);
-	dir_entry->owns_origin = 1;
-	remove_last_path_component(dir_entry->origin);
+	char origin[PATH_MAX + 1];
+	copy_str(origin, sizeof(origin), path);
+	remove_last_path_component(origin);
+	(void)fentry_set_origin(dir_entry, origin);
 
 	if(fill_dir_entry_by_path(dir_entry, path) != 0)
 	{
@@ -2706,6 +3348,44 @@ entry_list_add(view_t *view, dir_entry_t **list, int *list_size,
 	return dir_entry;
 }
 
+/* Picks arena for strings of a new entry of the list.  Returns the arena or
+ * NULL if a new one should be created. */
+static slab_t *
+list_slab(const dir_entry_t list[], int list_size)
+{
+	return (list_size > 0 ? list[list_size - 1].slab : NULL);
+}
+
+/* Takes references to arenas on behalf of copies of the entries. */
+static void
+ref_entry_slabs(const dir_entry_t entries[], int count)
+{
+	/* Neighbouring entries usually share an arena, so references to it are
+	 * taken at once. */
+	slab_t *slab = NULL;
+	int nrefs = 0;
+
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		if(entries[i].slab != slab)
+		{
+			if(slab != NULL)
+			{
+				slab_ref(slab, nrefs);
+			}
+			slab = entries[i].slab;
+			nrefs = 0;
+		}
+		++nrefs;
+	}
+
+	if(slab != NULL)
+	{
+		slab_ref(slab, nrefs);
+	}
+}
+
 /* Allocates one more directory entry for the *list of size list_size by
  * extending it.  Returns pointer to new entry or NULL on failure. */
 static dir_entry_t *
@@ -2725,8 +3405,16 @@ void
 check_if_filelist_has_changed(view_t *view)
 {
 	int failed, changed;
+	FSWatchState state = FSWS_UNCHANGED;
 	const char *const curr_dir = flist_get_dir(view);
 
+	if(view->tree_watch_sum != 0U &&
+			!(flist_custom_active(view) && view->custom.type == CV_TREE))
+	{
+		/* Release resources after leaving a tree. */
+		reset_tree_watch(view);
+	}
+
 	if(view->on_slow_fs ||
 			(flist_custom_active(view) && !cv_tree(view->custom.type)) ||
 			is_unc_root(curr_dir))
@@ -2744,7 +3432,7 @@ check_if_filelist_has_changed(view_t *view)
 	}
 	else
 	{
-		FSWatchState state = poll_watcher(view->watch, curr_dir);
+		state = poll_watcher(view->watch, curr_dir);
 		changed = (state != FSWS_UNCHANGED);
 		failed = (state == FSWS_ERRORED);
 	}
@@ -2770,13 +3458,15 @@ check_if_filelist_has_changed(view_t *view)
 
 	if(changed)
 	{
-		ui_view_schedule_reload(view);
+		if(state != FSWS_UPDATED || apply_dir_changes(view) != 0)
+		{
+			ui_view_schedule_reload(view);
+		}
 	}
 	else if(flist_custom_active(view) && cv_tree(view->custom.type))
 	{
 		/* Custom trees don't track file-system changes. */
-		if(view->custom.type == CV_TREE &&
-				tree_has_changed(view->dir_entry, view->list_rows))
+		if(view->custom.type == CV_TREE && tree_needs_reload(view))
 		{
 			ui_view_schedule_reload(view);
 		}
@@ -2791,6 +3481,343 @@ check_if_filelist_has_changed(view_t *view)
 	}
 }
 
+/* Updates file list of the view according to changes of individual files
+ * reported by its watcher instead of re-reading the whole directory.  Returns
+ * zero on success and non-zero if the list needs to be reloaded instead. */
+static int
+apply_dir_changes(view_t *view)
+{
+	int count;
+	const fswatch_change_t *const changes = fswatch_get_changes(view->watch,
+			&count);
+	if(changes == NULL || flist_custom_active(view) ||
+			view->local_filter.in_progress)
+	{
+		return 1;
+	}
+
+	char full_path[PATH_MAX + 1];
+	const int top_delta = view->list_pos - view->top_line;
+	get_current_full_path(view, sizeof(full_path), full_path);
+
+	char *const saved_cwd = save_cwd();
+	/* This is needed for lstat() of files by their names. */
+	if(vifm_chdir(view->curr_dir) != 0)
+	{
+		restore_cwd(saved_cwd);
+		return 1;
+	}
+
+	const int result = patch_dir_list(view, changes, count);
+	restore_cwd(saved_cwd);
+
+	if(result != 0)
+	{
+		return 1;
+	}
+
+	flist_goto_by_path(view, full_path);
+	if(view->list_pos > view->list_rows - 1)
+	{
+		view->list_pos = view->list_rows - 1;
+	}
+	view->top_line = MAX(view->list_pos - top_delta, 0);
+
+	fview_list_updated(view);
+	ui_view_schedule_redraw(view);
+	return 0;
+}
+
+/* Removes entries of changed files from the list and inserts their updated
+ * versions at positions dictated by sorting.  Returns zero on success and
+ * non-zero if the list needs to be reloaded instead. */
+static int
+patch_dir_list(view_t *view, const fswatch_change_t changes[], int count)
+{
+	/* A list consisting of ".." only might have it because the directory was
+	 * empty. */
+	if(view->has_dups ||
+			(view->list_rows == 1 && is_parent_dir(view->dir_entry[0].name)))
+	{
+		return 1;
+	}
+
+	file_change_t *const files = reallocarray(NULL, count, sizeof(*files));
+	dir_entry_t *added = dynarray_extend(NULL, count*sizeof(*added));
+	if(files == NULL || added == NULL)
+	{
+		free(files);
+		dynarray_free(added);
+		return 1;
+	}
+
+	/* Reloading is cheaper when most of the list is affected. */
+	const int nfiles = summarize_changes(view, changes, count, files);
+	if(nfiles < 0 || nfiles*2 > view->list_rows)
+	{
+		free(files);
+		dynarray_free(added);
+		return 1;
+	}
+
+	int i;
+	int nadded = 0;
+	for(i = 0; i < nfiles; ++i)
+	{
+		patch_dir_entry(view, &files[i], added, &nadded);
+	}
+	free(files);
+
+	/* Drop entries freed by patch_dir_entry() preserving order of the rest. */
+	int j = 0;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		if(view->dir_entry[i].name != NULL)
+		{
+			view->dir_entry[j++] = view->dir_entry[i];
+		}
+	}
+	view->list_rows = j;
+
+	if(sort_insert_entries(view, added, nadded) != 0)
+	{
+		free_dir_entries(view, &added, &nadded);
+		return 1;
+	}
+	dynarray_free(added);
+
+	if(view->list_rows == 0)
+	{
+		add_parent_dir(view);
+	}
+
+	/* Same as on reload, which numbers search matches anew. */
+	view->matches = 0;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		view->dir_entry[i].search_match = 0;
+	}
+
+	return 0;
+}
+
+/* Collapses sequence of changes into a set of changed files.  Fills files array
+ * which should be at least count items long.  Returns number of filled items or
+ * -1 on error. */
+static int
+summarize_changes(view_t *view, const fswatch_change_t changes[], int count,
+		file_change_t files[])
+{
+	trie_t *const names = trie_create();
+	if(names == NULL)
+	{
+		return -1;
+	}
+
+	int i;
+	int nfiles = 0;
+	for(i = 0; i < count; ++i)
+	{
+		const fswatch_change_t *const change = &changes[i];
+
+		void *data;
+		if(trie_get(names, change->name, &data) == 0)
+		{
+			file_change_t *const file = data;
+			file->exists = (change->kind != FSWC_DELETED);
+			continue;
+		}
+
+		file_change_t *const file = &files[nfiles];
+		file->name = change->name;
+		file->existed = (change->kind != FSWC_CREATED);
+		file->exists = (change->kind != FSWC_DELETED);
+		file->pos = -1;
+		if(trie_set(names, file->name, file) < 0)
+		{
+			trie_free(names);
+			return -1;
+		}
+		++nfiles;
+	}
+
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		void *data;
+		if(trie_get(names, view->dir_entry[i].name, &data) == 0)
+		{
+			file_change_t *const file = data;
+			file->existed = 1;
+			file->pos = i;
+		}
+	}
+
+	trie_free(names);
+	return nfiles;
+}
+
+/* Frees list entry of a changed file (if there is one) and appends its new
+ * version to the added array if the file is still there and is visible. */
+static void
+patch_dir_entry(view_t *view, const file_change_t *file, dir_entry_t *added,
+		int *nadded)
+{
+	dir_entry_t *const prev = (file->pos >= 0 ? &view->dir_entry[file->pos]
+	                                          : NULL);
+	dir_entry_t *const entry = &added[*nadded];
+
+	/* Added entries end up in the list of the view. */
+	slab_t *const slab = (*nadded > 0)
+	                   ? added[*nadded - 1].slab
+	                   : list_slab(view->dir_entry, view->list_rows);
+
+	int exists = 0, visible = 0;
+	init_dir_entry(view, entry, file->name, slab);
+	if(file->exists && entry->name != NULL &&
+			fill_dir_entry_by_path(entry, entry->name) == 0)
+	{
+		exists = 1;
+		visible = file_is_visible(view, entry->name, fentry_is_dir(entry), NULL,
+				1);
+	}
+
+	if(visible)
+	{
+		if(prev != NULL)
+		{
+			merge_entries(entry, prev);
+		}
+		view->selected_files += (entry->selected != 0);
+		++*nadded;
+	}
+	else
+	{
+		fentry_free(view, entry);
+	}
+
+	/* Keep number of filtered out files up to date. */
+	const int was_filtered = (prev == NULL && file->existed);
+	const int is_filtered = (exists && !visible);
+	view->filtered = MAX(view->filtered + is_filtered - was_filtered, 0);
+
+	if(prev != NULL)
+	{
+		view->selected_files -= (prev->selected != 0);
+		fentry_free(view, prev);
+	}
+}
+
+/* Checks whether tree-view needs a reload (any of subdirectories were changed)
+ * watching its directories if possible and polling them otherwise.  Returns
+ * non-zero if so, otherwise zero is returned. */
+static int
+tree_needs_reload(view_t *view)
+{
+	int ndirs;
+	const uint64_t sum = get_tree_dirs_sum(view, &ndirs);
+
+	if(sum != view->tree_watch_sum)
+	{
+		/* Set of directories has changed (e.g., due to filtering), update the
+		 * watcher. */
+		reset_tree_watch(view);
+		view->tree_watch_sum = sum;
+		if(ndirs <= MAX_TREE_WATCHES)
+		{
+			view->tree_watch = create_tree_watch(view);
+		}
+
+		/* Something could have changed before the watcher was set up. */
+		return tree_has_changed(view->dir_entry, view->list_rows);
+	}
+
+	if(view->tree_watch == NULL)
+	{
+		return tree_has_changed(view->dir_entry, view->list_rows);
+	}
+
+	switch(fswatch_poll(view->tree_watch))
+	{
+		case FSWS_UNCHANGED:
+			return 0;
+		case FSWS_UPDATED:
+			return 1;
+
+		case FSWS_ERRORED:
+		case FSWS_REPLACED:
+			/* Fall back to polling until the tree is reloaded. */
+			fswatch_free(view->tree_watch);
+			view->tree_watch = NULL;
+			return tree_has_changed(view->dir_entry, view->list_rows);
+	}
+
+	return 0;
+}
+
+/* Computes checksum of the set of directories of a tree-view, which changes
+ * when the tree is reloaded or filtered.  *ndirs is set to the number of
+ * directories.  Returns the checksum, which is never zero. */
+static uint64_t
+get_tree_dirs_sum(const view_t *view, int *ndirs)
+{
+	/* FNV-1a hash of addresses of names of directories, names aren't reallocated
+	 * until the tree is reloaded. */
+	uint64_t sum = 14695981039346656037ULL;
+	*ndirs = 0;
+
+	int i;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		const dir_entry_t *const entry = &view->dir_entry[i];
+		if(entry->type == FT_DIR && !is_parent_dir(entry->name))
+		{
+			sum = (sum ^ (uintptr_t)entry->name)*1099511628211ULL;
+			++*ndirs;
+		}
+	}
+
+	return (sum == 0U ? 1U : sum);
+}
+
+/* Creates watcher for all directories of a tree-view.  Returns the watcher or
+ * NULL if watching isn't possible. */
+static fswatch_t *
+create_tree_watch(const view_t *view)
+{
+	fswatch_t *const watch = fswatch_create_set();
+	if(watch == NULL)
+	{
+		return NULL;
+	}
+
+	int i;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		const dir_entry_t *const entry = &view->dir_entry[i];
+		if(entry->type == FT_DIR && !is_parent_dir(entry->name))
+		{
+			char full_path[PATH_MAX + 1];
+			get_full_path_of(entry, sizeof(full_path), full_path);
+			if(fswatch_add(watch, full_path) != 0)
+			{
+				fswatch_free(watch);
+				return NULL;
+			}
+		}
+	}
+
+	return watch;
+}
+
+/* Frees watcher of tree directories and schedules its recreation. */
+static void
+reset_tree_watch(view_t *view)
+{
+	fswatch_free(view->tree_watch);
+	view->tree_watch = NULL;
+	view->tree_watch_sum = 0U;
+}
+
 /* Checks whether tree-view needs a reload (any of subdirectories were changed).
  * Returns non-zero if so, otherwise zero is returned. */
 static int
@@ -2822,6 +3849,48 @@ tree_has_changed(const dir_entry_t *entries, size_t nchildren)
 	return 0;
 }
 
+int
+flist_add_to_selector(const view_t *view, selector_t *selector)
+{
+	/* Logic here follows that of check_if_filelist_has_changed(). */
+
+	if(view->on_slow_fs ||
+			(flist_custom_active(view) && !cv_tree(view->custom.type)) ||
+			is_unc_root(flist_get_dir(view)))
+	{
+		return 0;
+	}
+
+	if(view->watch == NULL || fswatch_add_to_selector(view->watch, selector))
+	{
+		return 1;
+	}
+
+	if(flist_custom_active(view))
+	{
+		/* Tree without a watcher is being polled. */
+		return view->custom.type == CV_TREE
+		    && (view->tree_watch == NULL ||
+		        fswatch_add_to_selector(view->tree_watch, selector));
+	}
+
+	const cached_entries_t *const columns[] = {
+		&view->left_column, &view->right_column
+	};
+
+	int poll = 0;
+	size_t i;
+	for(i = 0U; i < ARRAY_LEN(columns); ++i)
+	{
+		if(columns[i]->dir != NULL)
+		{
+			poll |= (columns[i]->watch == NULL)
+			     || fswatch_add_to_selector(columns[i]->watch, selector);
+		}
+	}
+	return poll;
+}
+
 int
 flist_update_cache(view_t *view, cached_entries_t *cache, const char path[])
 {
@@ -3646,22 +4715,23 @@ flist_custom_end(view_t *view, int very)
 void
 fentry_rename(view_t *view, dir_entry_t *entry, const char to[])
 {
-	char *const old_name = entry->name;
+	char *const old_name = strdup(entry->name);
 
 	/* Rename file in internal structures for correct positioning of cursor
 	 * after reloading, as cursor will be positioned on the file with the same
 	 * name. */
-	entry->name = strdup(to);
-	if(entry->name == NULL)
+	if(old_name == NULL || fentry_set_name(entry, to) != 0)
 	{
-		entry->name = old_name;
+		free(old_name);
 		return;
 	}
 
 	/* Name change can affect name specific highlight and decorations, so reset
-	 * the caches. */
+	 * the caches.  Relative target of a link might also be resolved
+	 * differently. */
 	entry->hi_num = -1;
 	entry->name_dec_num = -1;
+	entry->link_state = LS_UNKNOWN;
 
 	/* Update origins of entries which include the one we're renaming. */
 	if(flist_custom_active(view) && fentry_is_dir(entry))
@@ -3680,12 +4750,8 @@ fentry_rename(view_t *view, dir_entry_t *entry, const char to[])
 				char *const new_origin = format_str("%s/%s%s", entry->origin, to,
 						e->origin + root_len);
 				chosp(new_origin);
-				if(e->owns_origin)
-				{
-					free(e->origin);
-				}
-				e->origin = new_origin;
-				e->owns_origin = 1;
+				(void)fentry_set_origin(e, new_origin);
+				free(new_origin);
 			}
 		}
 
@@ -3814,7 +4880,7 @@ make_tree(view_t *view, const char path[], int reload, trie_t *excluded_paths)
 	}
 	else
 	{
-		nfiltered = add_files_recursively(view, path, excluded_paths, -1, 0);
+		nfiltered = add_files_recursively(view, path, excluded_paths);
 		type = CV_TREE;
 	}
 	ui_cancellation_pop();
@@ -3843,6 +4909,9 @@ make_tree(view_t *view, const char path[], int reload, trie_t *excluded_paths)
 
 	replace_string(&view->custom.orig_dir, canonic_path);
 
+	/* Directories of the new tree should be watched instead. */
+	reset_tree_watch(view);
+
 	return 0;
 }
 
@@ -3905,6 +4974,7 @@ complete_tree(const char name[], int valid, const void *parent_data, void *data,
 	dir_entry_t **entries = (in_place ? &view->dir_entry : &view->custom.entries);
 	int *nentries = (in_place ? &view->list_rows : &view->custom.entry_count);
 
+	slab_t *const slab = list_slab(*entries, *nentries);
 	dir_entry_t *dir_entry = alloc_dir_entry(entries, *nentries);
 	if(dir_entry == NULL)
 	{
@@ -3919,6 +4989,7 @@ complete_tree(const char name[], int valid, const void *parent_data, void *data,
 		dir_entry->child_count = 0;
 		(*(dir_entry_t **)data)->name = NULL;
 		(*(dir_entry_t **)data)->origin = NULL;
+		(*(dir_entry_t **)data)->slab = NULL;
 	}
 	else
 	{
@@ -3932,26 +5003,24 @@ complete_tree(const char name[], int valid, const void *parent_data, void *data,
 				/* Entry for a root is added temporarily (this happens only on Windows)
 				 * as a storage of path prefix and is removed afterwards in
 				 * drop_tops(). */
-				init_dir_entry(view, dir_entry, "");
-				dir_entry->origin = strdup(name);
+				init_dir_entry(view, dir_entry, "", slab);
+				(void)fentry_set_origin(dir_entry, name);
 			}
 			else
 			{
-				init_dir_entry(view, dir_entry, name);
-				dir_entry->origin = strdup("/");
+				init_dir_entry(view, dir_entry, name, slab);
+				(void)fentry_set_origin(dir_entry, "/");
 			}
 			free(typed_path);
-			dir_entry->owns_origin = 1;
 		}
 		else
 		{
 			char parent_path[PATH_MAX + 1];
 			const intptr_t *parent_idx = parent_data;
-			init_dir_entry(view, dir_entry, name);
+			init_dir_entry(view, dir_entry, name, slab);
 			get_full_path_of(&(*entries)[*parent_idx], sizeof(parent_path),
 					parent_path);
-			dir_entry->origin = strdup(parent_path);
-			dir_entry->owns_origin = 1;
+			(void)fentry_set_origin(dir_entry, parent_path);
 		}
 
 		get_full_path_of(dir_entry, sizeof(full_path), full_path);
@@ -4008,75 +5077,275 @@ drop_tops(view_t *view, dir_entry_t *entries, int *nentries, int extra)
 	}
 }
 
-/* Adds custom view entries corresponding to file system tree.  parent_pos is
- * expected to be negative for the outermost invocation.  Returns number of
- * filtered out files on success or partial success and negative value on
- * serious error. */
+/* Adds custom view entries corresponding to file system tree.  Directories are
+ * scanned concurrently and then added in pre-order.  Returns number of filtered
+ * out files on success or partial success and negative value on serious
+ * error. */
 static int
-add_files_recursively(view_t *view, const char path[], trie_t *excluded_paths,
-		int parent_pos, int no_direct_parent)
+add_files_recursively(view_t *view, const char path[], trie_t *excluded_paths)
+{
+	tree_dir_t *const root = alloc_tree_dir(path);
+	if(root == NULL)
+	{
+		return -1;
+	}
+
+	tree_scan_t scan = {
+		.view = view,
+		.excluded_paths = excluded_paths,
+		.ui_thread = pthread_self(),
+	};
+	pthread_mutex_init(&scan.lock, NULL);
+	par_run_tasks(root, &scan_tree_dir, &scan);
+	pthread_mutex_destroy(&scan.lock);
+
+	const int nfiltered = add_tree_dir(view, root, -1, 0);
+	free_tree_dir(view, root);
+	return nfiltered;
+}
+
+/* Allocates an empty directory of a tree for the path.  Returns the directory
+ * or NULL on error. */
+static tree_dir_t *
+alloc_tree_dir(const char path[])
+{
+	tree_dir_t *const dir = calloc(1, sizeof(*dir));
+	if(dir == NULL)
+	{
+		return NULL;
+	}
+
+	dir->path = strdup(path);
+	if(dir->path == NULL)
+	{
+		free(dir);
+		return NULL;
+	}
+
+	return dir;
+}
+
+/* Frees a directory of a tree along with all of its contents that weren't
+ * moved to the view. */
+static void
+free_tree_dir(view_t *view, tree_dir_t *dir)
 {
+	if(dir == NULL)
+	{
+		return;
+	}
+
 	int i;
-	const int prev_count = view->custom.entry_count;
-	int nfiltered = 0;
+	for(i = 0; i < dir->nfiles; ++i)
+	{
+		fentry_free(view, &dir->files[i].entry);
+		free_tree_dir(view, dir->files[i].subdir);
+	}
+
+	slab_release(dir->slab, 1);
+	free(dir->files);
+	free(dir->path);
+	free(dir);
+}
+
+/* par_run_tasks() callback that lists a directory of a tree, queries
+ * information about its files and schedules scanning of its subdirectories. */
+static void
+scan_tree_dir(par_tasks_t *tasks, void *task, void *arg)
+{
+	tree_dir_t *const dir = task;
+	tree_scan_t *const scan = arg;
+
+	if(ui_cancellation_requested())
+	{
+		dir->nfiles = -1;
+		return;
+	}
 
 	int len;
-	char **lst = list_all_files(path, &len);
+	char **const names = list_all_files(dir->path, &len);
 	if(len < 0)
 	{
-		return -1;
+		dir->nfiles = -1;
+		return;
 	}
 
+	/* Each directory is scanned by a single thread and so has an arena of its
+	 * own. */
+	dir->slab = slab_create();
+	dir->files = reallocarray(NULL, len, sizeof(*dir->files));
+	if(dir->files == NULL && len != 0)
+	{
+		free_string_array(names, len);
+		dir->nfiles = -1;
+		return;
+	}
+
+	int i;
 	for(i = 0; i < len && !ui_cancellation_requested(); ++i)
 	{
-		int dir;
+		char full_path[PATH_MAX + 1];
 		void *dummy;
-		dir_entry_t *entry;
-		char *const full_path = format_str("%s/%s", path, lst[i]);
 
-		if(trie_get(excluded_paths, full_path, &dummy) == 0)
+		snprintf(full_path, sizeof(full_path), "%s/%s", dir->path, names[i]);
+		if(trie_get(scan->excluded_paths, full_path, &dummy) == 0)
 		{
-			free(full_path);
 			continue;
 		}
 
-		dir = is_dir(full_path);
-		if(!file_is_visible(view, lst[i], dir, NULL, 1))
+		tree_file_t *const file = &dir->files[dir->nfiles++];
+		scan_tree_file(scan, file, full_path, dir->slab);
+
+		if(file->subdir != NULL)
 		{
-			/* Traverse directory (but not symlink to it) even if we're skipping it,
-			 * because we might need files that are inside of it. */
-			if(dir && !is_symlink(full_path) &&
-					file_is_visible(view, lst[i], dir, NULL, 0))
+			par_tasks_add(tasks, file->subdir);
+		}
+	}
+
+	free_string_array(names, len);
+	report_tree_scan(scan, len);
+}
+
+/* Fills file of a tree located at the path putting its strings into the slab
+ * and allocates its subdirectory if contents of the directory can be added to
+ * the tree. */
+static void
+scan_tree_file(tree_scan_t *scan, tree_file_t *file, const char path[],
+		slab_t *slab)
+{
+	view_t *const view = scan->view;
+	dir_entry_t *const entry = &file->entry;
+
+	char canonic_path[PATH_MAX + 1];
+	to_canonic_path(path, flist_get_dir(view), canonic_path,
+			sizeof(canonic_path));
+
+	init_dir_entry(view, entry, get_last_path_component(canonic_path),
+			slab);
+	char origin[PATH_MAX + 1];
+	copy_str(origin, sizeof(origin), canonic_path);
+	remove_last_path_component(origin);
+	(void)fentry_set_origin(entry, origin);
+
+	if(entry->name == NULL || entry->origin == NULL ||
+			fill_dir_entry_by_path(entry, canonic_path) != 0)
+	{
+		entry->type = FT_UNK;
+	}
+
+	/* lstat() information is enough unless this is a symbolic link. */
+	file->is_dir = (entry->type == FT_DIR)
+	            || ((entry->type == FT_LINK || entry->type == FT_UNK) &&
+	                is_dir(path));
+	file->subdir = NULL;
+
+	/* Directory (but not symlink to it) is traversed even if it's filtered out,
+	 * because it might contain files that are visible.  Filters aren't meant to
+	 * be used concurrently. */
+	if(entry->type == FT_DIR)
+	{
+		pthread_mutex_lock(&scan->lock);
+		const int visible = file_is_visible(view, entry->name, 1, NULL, 0);
+		pthread_mutex_unlock(&scan->lock);
+
+		if(visible)
+		{
+			file->subdir = alloc_tree_dir(path);
+		}
+	}
+}
+
+/* Accounts for scanned files and displays progress if it's the right thread
+ * and time to do so. */
+static void
+report_tree_scan(tree_scan_t *scan, int nfiles)
+{
+	pthread_mutex_lock(&scan->lock);
+	scan->nscanned += nfiles;
+	const size_t nscanned = scan->nscanned;
+	const int report = pthread_equal(pthread_self(), scan->ui_thread)
+	                && nscanned - scan->nreported >= 1000U;
+	if(report)
+	{
+		scan->nreported = nscanned;
+	}
+	pthread_mutex_unlock(&scan->lock);
+
+	if(report)
+	{
+		char msg[64];
+		snprintf(msg, sizeof(msg), "Building tree... %zu", nscanned);
+		show_progress(msg, 1);
+	}
+}
+
+/* Adds scanned directory of a tree to the custom view in pre-order.
+ * parent_pos is expected to be negative for the outermost invocation.  Returns
+ * number of filtered out files on success or partial success and negative
+ * value on serious error. */
+static int
+add_tree_dir(view_t *view, tree_dir_t *dir, int parent_pos,
+		int no_direct_parent)
+{
+	int i;
+	const int prev_count = view->custom.entry_count;
+	int nfiltered = 0;
+
+	if(dir->nfiles < 0)
+	{
+		return -1;
+	}
+
+	for(i = 0; i < dir->nfiles && !ui_cancellation_requested(); ++i)
+	{
+		tree_file_t *const file = &dir->files[i];
+		dir_entry_t *entry;
+
+		if(file->entry.name == NULL)
+		{
+			return -1;
+		}
+
+		if(!file_is_visible(view, file->entry.name, file->is_dir, NULL, 1))
+		{
+			if(file->subdir != NULL)
 			{
-				nfiltered += add_files_recursively(view, full_path, excluded_paths,
-						parent_pos, 1);
+				nfiltered += add_tree_dir(view, file->subdir, parent_pos, 1);
 			}
 
-			free(full_path);
 			++nfiltered;
 			continue;
 		}
 
-		entry = flist_custom_add(view, full_path);
+		if(file->entry.type == FT_UNK)
+		{
+			return -1;
+		}
+
+		entry = flist_custom_put(view, &file->entry);
 		if(entry == NULL)
 		{
-			free(full_path);
-			free_string_array(lst, len);
 			return -1;
 		}
 
+		/* The view owns strings of the entry now. */
+		file->entry.name = NULL;
+		file->entry.owns_origin = 0;
+		file->entry.slab = NULL;
+
 		if(parent_pos >= 0)
 		{
 			entry->child_pos = (view->custom.entry_count - 1) - parent_pos;
 		}
 
-		/* Not using dir variable here, because it is set for symlinks to
+		/* Not using is_dir field here, because it is set for symlinks to
 		 * directories as well. */
 		if(entry->type == FT_DIR)
 		{
 			const int idx = view->custom.entry_count - 1;
-			const int filtered = add_files_recursively(view, full_path,
-					excluded_paths, idx, 0);
+			const int filtered = (file->subdir == NULL)
+			                   ? -1
+			                   : add_tree_dir(view, file->subdir, idx, 0);
 			/* Keep going in case of error and load partial list. */
 			if(filtered >= 0)
 			{
@@ -4087,14 +5356,8 @@ add_files_recursively(view_t *view, const char path[], trie_t *excluded_paths,
 				nfiltered += filtered;
 			}
 		}
-
-		free(full_path);
-
-		show_progress("Building tree...", 1000);
 	}
 
-	free_string_array(lst, len);
-
 	/* The prev_count != 0 check is to make sure that we won't create leaf instead
 	 * of the whole tree (this is handled in flist_custom_finish()). */
 	int show_empty_dir_leafs = (cfg.dot_dirs & DD_TREE_LEAFS_PARENT);
@@ -4103,7 +5366,7 @@ add_files_recursively(view_t *view, const char path[], trie_t *excluded_paths,
 	{
 		/* To be able to perform operations inside directory (e.g., create files),
 		 * we need at least one element there. */
-		if(add_directory_leaf(view, path, parent_pos) != 0)
+		if(add_directory_leaf(view, dir->path, parent_pos) != 0)
 		{
 			return -1;
 		}
@@ -4159,7 +5422,8 @@ add_directory_leaf(view_t *view, const char path[], int parent_pos)
 	}
 
 	full_path = format_str("%s/..", path);
-	if(init_parent_entry(view, entry, full_path) != 0)
+	if(init_parent_entry(view, entry, full_path,
+				list_slab(view->custom.entries, view->custom.entry_count)) != 0)
 	{
 		free(full_path);
 		/* Keep going in case of error and load partial list. */
@@ -4167,8 +5431,8 @@ add_directory_leaf(view_t *view, const char path[], int parent_pos)
 	}
 
 	remove_last_path_component(full_path);
-	entry->origin = full_path;
-	entry->owns_origin = 1;
+	(void)fentry_set_origin(entry, full_path);
+	free(full_path);
 
 	if(parent_pos >= 0)
 	{
@@ -4180,13 +5444,15 @@ add_directory_leaf(view_t *view, const char path[], int parent_pos)
 }
 
 /* Fills given entry of the view at specified path (can be relative, i.e. "..").
- * Returns zero on success, otherwise non-zero is returned. */
+ * See init_dir_entry() for the meaning of slab.  Returns zero on success,
+ * otherwise non-zero is returned. */
 static int
-init_parent_entry(view_t *view, dir_entry_t *entry, const char path[])
+init_parent_entry(view_t *view, dir_entry_t *entry, const char path[],
+		slab_t *slab)
 {
 	struct stat s;
 
-	init_dir_entry(view, entry, get_last_path_component(path));
+	init_dir_entry(view, entry, get_last_path_component(path), slab);
 	entry->type = FT_DIR;
 
 	/* Load the inode info or leave blank values in entry. */
@@ -28,6 +28,8 @@
 #include "ui/ui.h"
 #include "utils/test_helpers.h"
 
+struct selector_t;
+
 /* Type of filter function for zapping list of entries.  Should return non-zero
  * if entry is to be kept and zero otherwise. */
 typedef int (*zap_filter)(view_t *view, const dir_entry_t *entry, void *arg);
@@ -176,6 +178,10 @@ dir_entry_t * get_current_entry(const view_t *view);
 /* Checks whether content in the current directory of the view changed and
  * reloads the view if so. */
 void check_if_filelist_has_changed(view_t *view);
+/* Adds watchers used by check_if_filelist_has_changed() to the selector to be
+ * able to wait for changes instead of checking for them periodically.  Returns
+ * non-zero if the view still needs to be checked periodically. */
+int flist_add_to_selector(const view_t *view, struct selector_t *selector);
 /* Checks whether cd'ing into path is possible. Shows cd errors to a user.
  * Returns non-zero if it's possible, zero otherwise. */
 int cd_is_possible(const char path[]);
@@ -276,6 +282,12 @@ dir_entry_t * entry_list_add(view_t *view, dir_entry_t **list, int *list_size,
 void free_dir_entries(view_t *view, dir_entry_t **entries, int *count);
 /* Frees single directory entry. */
 void fentry_free(const view_t *view, dir_entry_t *entry);
+/* Replaces name of the entry with a copy of the name.  Returns zero on
+ * success, otherwise non-zero is returned and the entry isn't changed. */
+int fentry_set_name(dir_entry_t *entry, const char name[]);
+/* Makes the entry own a shared copy of the origin.  Returns zero on success,
+ * otherwise non-zero is returned and the entry isn't changed. */
+int fentry_set_origin(dir_entry_t *entry, const char origin[]);
 /* Adds parent directory entry (..) to filelist. */
 void add_parent_dir(view_t *view);
 /* Changes name of a file entry, performing additional required updates. */
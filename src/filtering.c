@@ -19,8 +19,13 @@
 
 #include "filtering.h"
 
+#include <regex.h> /* REG_ICASE */
+
 #include <assert.h> /* assert() */
-#include <string.h> /* strdup() */
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint32_t */
+#include <stdlib.h> /* calloc() free() */
+#include <string.h> /* strdup() strlen() strpbrk() */
 
 #include "cfg/config.h"
 #include "compat/reallocarray.h"
@@ -45,6 +50,8 @@ static int load_unfiltered_list(view_t *view);
 static int list_is_incomplete(view_t *view);
 static void store_local_filter_position(view_t *view, int pos);
 static int update_filtering_lists(view_t *view, int add, int clear);
+static int filter_is_narrowed(const view_t *view);
+static void remember_matches(view_t *view, uint32_t *matches);
 static void reparent_tree_node(dir_entry_t *original, dir_entry_t *filtered);
 static void ensure_filtered_list_not_empty(view_t *view,
 		dir_entry_t *parent_entry);
@@ -71,6 +78,8 @@ filters_view_reset(view_t *view)
 	view->local_filter.saved = NULL;
 	view->local_filter.poshist = NULL;
 	view->local_filter.poshist_len = 0U;
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_count = 0U;
 }
 
 /* Resets filter to empty state (either initializes or clears it). */
@@ -535,8 +544,32 @@ update_filtering_lists(view_t *view, int add, int clear)
 	dir_entry_t *parent_entry = NULL;
 	int parent_added = 0;
 
-	for(i = 0; i < view->local_filter.unfiltered_count; ++i)
+	/* Entries that didn't match previous value of a filter which got only
+	 * extended can't match now and have their tag already set to -1. */
+	const size_t count = view->local_filter.unfiltered_count;
+	const int narrowed = (add && !clear && filter_is_narrowed(view));
+	uint32_t *matches = NULL;
+	if(narrowed)
+	{
+		matches = view->local_filter.matches;
+	}
+	else if(add && !clear)
 	{
+		matches = calloc((count + 31U)/32U, sizeof(*matches));
+	}
+
+	for(i = 0; i < count; ++i)
+	{
+		if(narrowed && !(matches[i/32U] & (1U << i%32U)))
+		{
+			if((matches[i/32U] >> i%32U) == 0U)
+			{
+				/* Skip the rest of the empty word. */
+				i |= 31U;
+			}
+			continue;
+		}
+
 		/* FIXME: some very long file names won't be matched against some
 		 * regexps. */
 		char name_with_slash[NAME_MAX + 1 + 1];
@@ -546,6 +579,11 @@ update_filtering_lists(view_t *view, int add, int clear)
 
 		if(is_parent_dir(name))
 		{
+			if(matches != NULL)
+			{
+				matches[i/32U] |= 1U << i%32U;
+			}
+
 			if(entry->child_pos == 0)
 			{
 				parent_entry = entry;
@@ -578,6 +616,11 @@ update_filtering_lists(view_t *view, int add, int clear)
 		entry->tag = -1;
 		if(filter_matches(&view->local_filter.filter, name) != 0)
 		{
+			if(matches != NULL)
+			{
+				matches[i/32U] |= 1U << i%32U;
+			}
+
 			if(add)
 			{
 				dir_entry_t *e = add_dir_entry(&view->dir_entry, &list_size, entry);
@@ -592,6 +635,11 @@ update_filtering_lists(view_t *view, int add, int clear)
 		}
 		else
 		{
+			if(matches != NULL)
+			{
+				matches[i/32U] &= ~(1U << i%32U);
+			}
+
 			if(clear)
 			{
 				fentry_free(view, entry);
@@ -599,6 +647,11 @@ update_filtering_lists(view_t *view, int add, int clear)
 		}
 	}
 
+	if(add && !clear)
+	{
+		remember_matches(view, matches);
+	}
+
 	if(clear)
 	{
 		/* XXX: the check of name pointer is horrible, but is needed to prevent
@@ -622,6 +675,67 @@ update_filtering_lists(view_t *view, int add, int clear)
 	return 0;
 }
 
+/* Checks whether current value of the local filter can't match anything that
+ * wasn't matched by the value which produced the matches field.  Returns
+ * non-zero if so. */
+static int
+filter_is_narrowed(const view_t *view)
+{
+	const filter_t *const filter = &view->local_filter.filter;
+	const char *const prev = view->local_filter.matches_for;
+
+	if(view->local_filter.matches == NULL ||
+			view->local_filter.matches_count != view->local_filter.unfiltered_count)
+	{
+		return 0;
+	}
+
+	/* Empty or invalid filter matches everything. */
+	if(filter_is_empty(filter) || !filter->is_regex_valid)
+	{
+		return 0;
+	}
+
+	/* Becoming case insensitive adds matches. */
+	if((filter->cflags & REG_ICASE) &&
+			!(view->local_filter.matches_cflags & REG_ICASE))
+	{
+		return 0;
+	}
+
+	/* Appended part narrows matches only if it's a plain concatenation, which is
+	 * the case if it contains no special characters.  The previous value can't
+	 * end with an unfinished construct, because it was either valid or matched
+	 * everything. */
+	return starts_with(filter->raw, prev)
+	    && strpbrk(filter->raw + strlen(prev), "\\|*+?{}()[]^$") == NULL;
+}
+
+/* Stores bitset of matched entries of the unfiltered list along with the filter
+ * that produced it.  Takes ownership of the matches, which can be NULL. */
+static void
+remember_matches(view_t *view, uint32_t *matches)
+{
+	if(matches != view->local_filter.matches)
+	{
+		free(view->local_filter.matches);
+		view->local_filter.matches = matches;
+	}
+
+	if(matches == NULL ||
+			replace_string(&view->local_filter.matches_for,
+				view->local_filter.filter.raw) != 0)
+	{
+		free(view->local_filter.matches);
+		view->local_filter.matches = NULL;
+		view->local_filter.matches_count = 0U;
+		return;
+	}
+
+	view->local_filter.matches_count = view->local_filter.unfiltered_count;
+	view->local_filter.matches_cflags = view->local_filter.filter.cflags;
+}
+
 /* Reparents *filtered node by attaching it to the closes ancestor of *original
  * mapped onto the list of filtered nodes.  tag field of entries is used to
  * perform the mapping. */
@@ -836,6 +950,10 @@ local_filter_finish(view_t *view)
 	free(view->local_filter.poshist);
 	view->local_filter.poshist = NULL;
 	view->local_filter.poshist_len = 0U;
+
+	free(view->local_filter.matches);
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_count = 0U;
 }
 
 void
@@ -38,7 +38,6 @@
 #include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* calloc() free() malloc() realloc() strtol() */
 #include <string.h> /* memcmp() memset() strcat() strcmp() strdup() strlen() */
-#include <time.h> /* clock_gettime() */
 
 #include "cfg/config.h"
 #include "compat/dtype.h"
@@ -129,8 +128,8 @@ static void format_pretty_path(const char base_dir[], const char path[],
 		char pretty[], size_t pretty_size);
 static int is_file_name_changed(const char old[], const char new[]);
 static int ui_cancellation_hook(void *arg);
+static int dir_size_hook(const char path[], uint64_t *size);
 static progress_data_t * alloc_progress_data(int bg, void *info);
-static long long time_in_ms(void);
 
 line_prompt_func fops_line_prompt;
 options_prompt_func fops_options_prompt;
@@ -141,6 +140,7 @@ fops_init(line_prompt_func line_func, options_prompt_func options_func)
 	fops_line_prompt = line_func;
 	fops_options_prompt = options_func;
 	ionotif_register(&io_progress_changed);
+	ioeta_register_dir_size_hook(&dir_size_hook);
 }
 
 /* I/O operation update callback. */
@@ -731,6 +731,21 @@ ui_cancellation_hook(void *arg)
 	return ui_cancellation_requested();
 }
 
+/* Implementation of directory size hook for I/O unit, which reuses sizes
+ * calculated earlier.  Returns non-zero if size is known. */
+static int
+dir_size_hook(const char path[], uint64_t *size)
+{
+	struct stat st;
+	if(os_stat(path, &st) != 0)
+	{
+		return 0;
+	}
+
+	dcache_get_at(path, st.st_mtime, st.st_ino, size, NULL);
+	return (*size != DCACHE_UNKNOWN);
+}
+
 void
 fops_progress_msg(const char text[], int ready, int total)
 {
@@ -926,19 +941,6 @@ alloc_progress_data(int bg, void *info)
 	return pdata;
 }
 
-/* Retrieves current time in milliseconds. */
-static long long
-time_in_ms(void)
-{
-	struct timespec current_time;
-	if(clock_gettime(CLOCK_MONOTONIC, &current_time) != 0)
-	{
-		return 0;
-	}
-
-	return current_time.tv_sec*1000 + current_time.tv_nsec/1000000;
-}
-
 void
 fops_free_ops(ops_t *ops)
 {
@@ -19,13 +19,22 @@
 
 #include "fops_misc.h"
 
-#include <sys/stat.h> /* stat */
+#include <sys/stat.h> /* S_ISDIR stat fstatat() */
 #include <sys/types.h> /* gid_t uid_t */
+#ifndef _WIN32
+#include <dirent.h> /* DIR dirfd() fdopendir() */
+#include <fcntl.h> /* AT_SYMLINK_NOFOLLOW O_DIRECTORY O_RDONLY open() */
+#include <unistd.h> /* close() */
+#endif
 
+#include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* uint64_t */
+#include <stdlib.h> /* calloc() free() malloc() */
 #include <string.h> /* strdup() strlen() */
 
 #include "cfg/config.h"
 #include "compat/os.h"
+#include "compat/pthread.h"
 #include "modes/dialogs/msg_dialog.h"
 #include "ui/cancellation.h"
 #include "ui/fileview.h"
@@ -33,6 +42,7 @@
 #include "ui/ui.h"
 #include "utils/cancellation.h"
 #include "utils/fs.h"
+#include "utils/parallel.h"
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
@@ -55,6 +65,55 @@ typedef struct
 }
 dir_size_args_t;
 
+/* Directory which is being processed by fops_dir_size(). */
+typedef struct du_dir_t
+{
+	struct du_dir_t *parent; /* Directory that contains this one or NULL. */
+	struct du_dir_t *next;   /* Next finished directory. */
+	char *path;              /* Full path to the directory, freed once it's
+	                            finished. */
+	uint64_t inode;          /* Inode number of the directory. */
+	uint64_t size;           /* Sum of sizes of items that were processed. */
+	int depth;               /* Number of parents. */
+	int pending;             /* Unfinished subdirectories plus one for listing. */
+	int incomplete;          /* Whether some of the items weren't processed. */
+	int uncached;            /* Whether size of this directory alone differs
+	                            from the size calculated here, so it must not
+	                            be cached.  Unlike incomplete, this isn't
+	                            propagated to parents. */
+}
+du_dir_t;
+
+/* File with several hard links that was counted by fops_dir_size(). */
+typedef struct
+{
+	uint64_t dev;  /* Device of the file. */
+	uint64_t ino;  /* Inode of the file, zero for an empty slot. */
+	du_dir_t *dir; /* Directory in which the file was counted. */
+}
+du_link_t;
+
+/* State of a single fops_dir_size() invocation shared by its threads. */
+typedef struct
+{
+	int force;                          /* Whether cached sizes are ignored. */
+	const cancellation_t *cancellation; /* Cancellation of calculation. */
+
+	uint64_t size;  /* Size of the root once it's processed. */
+	int incomplete; /* Whether size of the root is incomplete. */
+
+	du_link_t *links; /* Set of hard links that were counted. */
+	size_t nlinks;    /* Number of elements in the set. */
+	size_t links_cap; /* Number of slots (zero or a power of two). */
+
+	/* Directories that were finished.  They are freed at the end, because
+	 * links refer to them. */
+	du_dir_t *finished;
+
+	pthread_mutex_t lock; /* Protects the directories and other fields. */
+}
+du_t;
+
 static int delete_file(dir_entry_t *entry, ops_t *ops, int reg, int use_trash,
 		int nested);
 static const char * get_top_dir(const view_t *view);
@@ -75,6 +134,17 @@ static void dir_size_bg(bg_op_t *bg_op, void *arg);
 static void dir_size(bg_op_t *bg_op, char path[], int force);
 static int bg_cancellation_hook(void *arg);
 static void redraw_after_path_change(view_t *view, const char path[]);
+static du_dir_t * du_alloc_dir(du_dir_t *parent, const char path[],
+		uint64_t inode);
+static void du_scan_dir(par_tasks_t *tasks, void *task, void *arg);
+static void du_add_subdir(par_tasks_t *tasks, du_t *du, du_dir_t *dir,
+		const char name[], time_t mtime, uint64_t inode, uint64_t *size);
+static void du_finish_dir(du_t *du, du_dir_t *dir, uint64_t size,
+		int incomplete);
+#ifndef _WIN32
+static int du_first_link(du_t *du, du_dir_t *dir, const struct stat *st);
+static void du_mark_uncached(du_dir_t *dir, const du_dir_t *other);
+#endif
 #ifndef _WIN32
 static void change_owner_cb(const char new_owner[]);
 static int complete_owner(const char str[], void *arg);
@@ -1168,68 +1238,353 @@ uint64_t
 fops_dir_size(const char path[], int force_update,
 		const cancellation_t *cancellation)
 {
-	struct dirent *dentry;
-	const char *slash;
-	uint64_t size;
-
-	time_t mtime = 0;
 	uint64_t inode = DCACHE_UNKNOWN;
 #ifndef _WIN32
 	struct stat s;
 	if(os_stat(path, &s) == 0)
 	{
-		mtime = s.st_mtime;
 		inode = s.st_ino;
 	}
 #endif
 
-	DIR *dir = os_opendir(path);
-	if(dir == NULL)
+	du_dir_t *const root = du_alloc_dir(NULL, path, inode);
+	if(root == NULL)
 	{
 		return 0U;
 	}
 
-	slash = (ends_with_slash(path) ? "" : "/");
-	size = 0U;
-	while((dentry = os_readdir(dir)) != NULL)
+	du_t du = { .force = force_update, .cancellation = cancellation };
+	pthread_mutex_init(&du.lock, NULL);
+	par_run_tasks(root, &du_scan_dir, &du);
+	pthread_mutex_destroy(&du.lock);
+	free(du.links);
+
+	while(du.finished != NULL)
 	{
-		char full_path[PATH_MAX + 1];
+		du_dir_t *const next = du.finished->next;
+		free(du.finished);
+		du.finished = next;
+	}
+
+	return (du.incomplete ? 0U : du.size);
+}
+
+/* Allocates a directory to be processed by fops_dir_size().  Returns the
+ * directory or NULL on error. */
+static du_dir_t *
+du_alloc_dir(du_dir_t *parent, const char path[], uint64_t inode)
+{
+	du_dir_t *const dir = calloc(1, sizeof(*dir));
+	if(dir == NULL)
+	{
+		return NULL;
+	}
+
+	dir->path = strdup(path);
+	if(dir->path == NULL)
+	{
+		free(dir);
+		return NULL;
+	}
+
+	dir->parent = parent;
+	dir->inode = inode;
+	dir->depth = (parent == NULL ? 0 : parent->depth + 1);
+	dir->pending = 1;
+	return dir;
+}
+
+/* par_run_tasks() callback that sums sizes of files of a directory and
+ * schedules processing of its subdirectories.  Files are queried relative to
+ * the directory to avoid resolving its path over and over again. */
+static void
+du_scan_dir(par_tasks_t *tasks, void *task, void *arg)
+{
+	du_dir_t *const dir = task;
+	du_t *const du = arg;
 
+	if(cancellation_requested(du->cancellation))
+	{
+		du_finish_dir(du, dir, 0U, 1);
+		return;
+	}
+
+#ifndef _WIN32
+	const int fd = open(dir->path, O_RDONLY | O_DIRECTORY);
+	DIR *const d = (fd == -1 ? NULL : fdopendir(fd));
+	if(d == NULL)
+	{
+		if(fd != -1)
+		{
+			close(fd);
+		}
+		/* Unreadable directory contributes nothing, but isn't cached. */
+		dir->uncached = 1;
+		du_finish_dir(du, dir, 0U, 0);
+		return;
+	}
+
+	uint64_t size = 0U;
+	int incomplete = 0;
+	struct dirent *dentry;
+	while((dentry = readdir(d)) != NULL)
+	{
 		if(is_builtin_dir(dentry->d_name))
 		{
 			continue;
 		}
 
-		snprintf(full_path, sizeof(full_path), "%s%s%s", path, slash,
+		struct stat st;
+		if(fstatat(dirfd(d), dentry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+		{
+			continue;
+		}
+
+		if(S_ISDIR(st.st_mode))
+		{
+			du_add_subdir(tasks, du, dir, dentry->d_name, st.st_mtime, st.st_ino,
+					&size);
+		}
+		else if(st.st_nlink < 2 || du_first_link(du, dir, &st))
+		{
+			size += st.st_size;
+		}
+
+		if(cancellation_requested(du->cancellation))
+		{
+			incomplete = 1;
+			break;
+		}
+	}
+	closedir(d);
+#else
+	DIR *const d = os_opendir(dir->path);
+	if(d == NULL)
+	{
+		dir->uncached = 1;
+		du_finish_dir(du, dir, 0U, 0);
+		return;
+	}
+
+	uint64_t size = 0U;
+	int incomplete = 0;
+	struct dirent *dentry;
+	while((dentry = os_readdir(d)) != NULL)
+	{
+		if(is_builtin_dir(dentry->d_name))
+		{
+			continue;
+		}
+
+		char full_path[PATH_MAX + 1];
+		snprintf(full_path, sizeof(full_path), "%s/%s", dir->path,
 				dentry->d_name);
 		if(fops_is_dir_entry(full_path, dentry))
 		{
-			uint64_t dir_size;
-			dcache_get_at(full_path, mtime, inode, &dir_size, NULL);
-			if(dir_size == DCACHE_UNKNOWN || force_update)
-			{
-				dir_size = fops_dir_size(full_path, force_update, cancellation);
-			}
-			size += dir_size;
+			du_add_subdir(tasks, du, dir, dentry->d_name, 0, DCACHE_UNKNOWN, &size);
 		}
 		else
 		{
 			size += get_file_size(full_path);
 		}
 
-		if(cancellation_requested(cancellation))
+		if(cancellation_requested(du->cancellation))
 		{
-			os_closedir(dir);
-			return 0U;
+			incomplete = 1;
+			break;
 		}
 	}
+	os_closedir(d);
+#endif
+
+	du_finish_dir(du, dir, size, incomplete);
+}
+
+/* Accounts for a subdirectory either by taking its size from the cache or by
+ * scheduling its processing. */
+static void
+du_add_subdir(par_tasks_t *tasks, du_t *du, du_dir_t *dir, const char name[],
+		time_t mtime, uint64_t inode, uint64_t *size)
+{
+	char path[PATH_MAX + 1];
+	snprintf(path, sizeof(path), "%s%s%s", dir->path,
+			(ends_with_slash(dir->path) ? "" : "/"), name);
+
+	if(!du->force)
+	{
+		uint64_t cached_size;
+		dcache_get_at(path, mtime, inode, &cached_size, NULL);
+		if(cached_size != DCACHE_UNKNOWN)
+		{
+			*size += cached_size;
+			return;
+		}
+	}
+
+	du_dir_t *const subdir = du_alloc_dir(dir, path, inode);
+	if(subdir == NULL)
+	{
+		pthread_mutex_lock(&du->lock);
+		dir->incomplete = 1;
+		pthread_mutex_unlock(&du->lock);
+		return;
+	}
+
+	pthread_mutex_lock(&du->lock);
+	++dir->pending;
+	pthread_mutex_unlock(&du->lock);
+
+	par_tasks_add(tasks, subdir);
+}
+
+/* Accounts for the end of processing of a part of the directory.  Once all of
+ * its parts are done, size of the directory is published to the cache and
+ * added to its parent, which might complete the parent as well. */
+static void
+du_finish_dir(du_t *du, du_dir_t *dir, uint64_t size, int incomplete)
+{
+	while(dir != NULL)
+	{
+		pthread_mutex_lock(&du->lock);
+		dir->size += size;
+		dir->incomplete |= incomplete;
+		const int done = (--dir->pending == 0);
+		pthread_mutex_unlock(&du->lock);
+
+		if(!done)
+		{
+			break;
+		}
+
+		size = dir->size;
+		incomplete = dir->incomplete;
+
+		if(!incomplete && !dir->uncached)
+		{
+			/* Make partial results visible while the rest is being calculated. */
+			(void)dcache_set_at(dir->path, dir->inode, size, DCACHE_UNKNOWN);
+			if(dir->parent != NULL)
+			{
+				redraw_after_path_change(&lwin, dir->parent->path);
+				redraw_after_path_change(&rwin, dir->parent->path);
+			}
+		}
+
+		du_dir_t *const parent = dir->parent;
+		if(parent == NULL)
+		{
+			du->size = size;
+			du->incomplete = incomplete;
+		}
+
+		free(dir->path);
+		dir->path = NULL;
+
+		pthread_mutex_lock(&du->lock);
+		dir->next = du->finished;
+		du->finished = dir;
+		pthread_mutex_unlock(&du->lock);
+
+		dir = parent;
+	}
+}
+
+#ifndef _WIN32
+
+/* Checks whether file with several hard links is encountered for the first
+ * time, so that its size is counted only once.  If it was counted in another
+ * directory, sizes of directories that don't contain that one become too
+ * small to be cached.  Returns non-zero if so. */
+static int
+du_first_link(du_t *du, du_dir_t *dir, const struct stat *st)
+{
+	const uint64_t dev = st->st_dev, ino = st->st_ino;
 
-	os_closedir(dir);
+	pthread_mutex_lock(&du->lock);
 
-	(void)dcache_set_at(path, inode, size, DCACHE_UNKNOWN);
-	return size;
+	/* Keep load factor of the table under one half. */
+	if((du->nlinks + 1U)*2U > du->links_cap)
+	{
+		const size_t cap = (du->links_cap == 0U) ? 64U : du->links_cap*2U;
+		du_link_t *const links = calloc(cap, sizeof(*links));
+		if(links == NULL)
+		{
+			pthread_mutex_unlock(&du->lock);
+			/* Counting a file twice is better than not counting it. */
+			return 1;
+		}
+
+		size_t i;
+		for(i = 0U; i < du->links_cap; ++i)
+		{
+			if(du->links[i].ino == 0U)
+			{
+				continue;
+			}
+
+			size_t slot = (du->links[i].dev*31U + du->links[i].ino) & (cap - 1U);
+			while(links[slot].ino != 0U)
+			{
+				slot = (slot + 1U) & (cap - 1U);
+			}
+			links[slot] = du->links[i];
+		}
+
+		free(du->links);
+		du->links = links;
+		du->links_cap = cap;
+	}
+
+	/* Inode numbers are never zero, so zero marks empty slots. */
+	int first = 1;
+	size_t slot = (dev*31U + ino) & (du->links_cap - 1U);
+	while(du->links[slot].ino != 0U)
+	{
+		if(du->links[slot].dev == dev && du->links[slot].ino == ino)
+		{
+			first = 0;
+			du_mark_uncached(dir, du->links[slot].dir);
+			break;
+		}
+		slot = (slot + 1U) & (du->links_cap - 1U);
+	}
+
+	if(first)
+	{
+		du->links[slot].dev = dev;
+		du->links[slot].ino = ino;
+		du->links[slot].dir = dir;
+		++du->nlinks;
+	}
+
+	pthread_mutex_unlock(&du->lock);
+	return first;
+}
+
+/* Marks the directory and its parents up to the closest common parent with the
+ * other directory as the ones whose size must not be cached. */
+static void
+du_mark_uncached(du_dir_t *dir, const du_dir_t *other)
+{
+	while(other->depth > dir->depth)
+	{
+		other = other->parent;
+	}
+	while(dir->depth > other->depth)
+	{
+		dir->uncached = 1;
+		dir = dir->parent;
+	}
+	while(dir != other)
+	{
+		dir->uncached = 1;
+		dir = dir->parent;
+		other = other->parent;
+	}
 }
 
+#endif
+
 #ifndef _WIN32
 
 int
@@ -74,8 +74,10 @@ void fops_size_bg(struct view_t *view, int force);
 struct cancellation_t;
 
 /* Calculates size of a directory specified by path possibly using cache of
- * known sizes.  Forcing disables using previously cached values.  Returns size
- * of a directory or zero on error. */
+ * known sizes.  Forcing disables using previously cached values.  Directories
+ * are processed in parallel and sizes of subdirectories are cached as soon as
+ * they are known.  Files with several hard links are counted once.  Returns
+ * size of a directory or zero on error. */
 uint64_t fops_dir_size(const char path[], int force,
 		const struct cancellation_t *cancellation);
 
@@ -107,13 +107,27 @@ struct io_args_t
 	}
 	arg3;
 
-	union
+	struct
 	{
 		/* Whether try to use O(1) file cloning feature of btrfs. */
 		int fast_file_cloning;
+		/* Whether holes of sparse files should be filled with zeroes. */
+		int dense_copy;
 	}
 	arg4;
 
+	/* Concurrency settings of operations on subtrees. */
+	struct
+	{
+		/* Maximum number of files processed at the same time.  Values less than
+		 * two mean sequential processing. */
+		int nworkers;
+		/* Maximum number of files waiting to be processed, non-positive value
+		 * picks default (a couple of files per worker). */
+		int queue_depth;
+	}
+	par;
+
 	/* Provides means for cancellation checking. */
 	io_cancellation_t cancellation;
 
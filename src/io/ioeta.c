@@ -22,13 +22,65 @@
 #include <stddef.h> /* NULL size_t */
 #include <stdint.h> /* uint64_t */
 #include <stdlib.h> /* calloc() free() */
+#include <string.h> /* strdup() */
 
+#include "../compat/pthread.h"
+#include "../utils/fs.h"
+#include "../utils/utils.h"
 #include "private/ioc.h"
 #include "private/ioeta.h"
 #include "private/traverser.h"
 
+/* Number of items after which calculation on a separate thread publishes what
+ * it has found so far. */
+#define PUBLISH_PERIOD 256
+
+/* Subtree waiting to be calculated. */
+typedef struct calc_root_t
+{
+	char *path;               /* Root of the subtree. */
+	int shallow;              /* Whether to recur into directories. */
+	struct calc_root_t *next; /* Next root in the queue. */
+}
+calc_root_t;
+
+/* State of calculation on a separate thread. */
+typedef struct ioeta_calc_t
+{
+	pthread_t thread;     /* Thread that does the calculation. */
+	pthread_mutex_t lock; /* Protects fields below. */
+	pthread_cond_t cond;  /* Signaled on changes of fields below. */
+	calc_root_t *roots;   /* Queue of roots to calculate. */
+	calc_root_t **tail;   /* Pointer to next field of the last root. */
+	int busy;             /* Whether a root is being calculated. */
+	int stop;             /* Whether the thread should quit. */
+}
+ioeta_calc_t;
+
+/* State of a walk over a subtree. */
+typedef struct
+{
+	ioeta_estim_t *estim; /* Estimation to fill. */
+	ioeta_calc_t *calc;   /* State of separate thread or NULL. */
+	int known_depth;      /* Depth inside a directory of known size or zero. */
+	size_t items;         /* Number of items found but not yet published. */
+	uint64_t bytes;       /* Number of bytes found but not yet published. */
+}
+walk_t;
+
+static void walk(ioeta_estim_t *estim, ioeta_calc_t *calc, const char path[],
+		int shallow);
 static VisitResult eta_visitor(const char full_path[], VisitAction action,
 		void *param);
+static void add_file(walk_t *walk, const char path[]);
+static void publish(walk_t *walk);
+static int calc_start(ioeta_estim_t *estim);
+static void calc_stop(ioeta_estim_t *estim);
+static void * calc_thread(void *arg);
+static int calc_stopped(ioeta_calc_t *calc);
+
+/* Hook that looks up sizes of directories. */
+static ioeta_dir_size_hook dir_size_hook;
 
 ioeta_estim_t *
 ioeta_alloc(void *param, io_cancellation_t cancellation)
@@ -36,6 +88,7 @@ ioeta_alloc(void *param, io_cancellation_t cancellation)
 	ioeta_estim_t *const estim = calloc(1U, sizeof(*estim));
 	estim->param = param;
 	estim->cancellation = cancellation;
+	pthread_mutex_init(&estim->lock, NULL);
 	return estim;
 }
 
@@ -44,7 +97,9 @@ ioeta_free(ioeta_estim_t *estim)
 {
 	if(estim != NULL)
 	{
+		calc_stop(estim);
 		ioeta_release(estim);
+		pthread_mutex_destroy(&estim->lock);
 		free(estim);
 	}
 }
@@ -52,14 +107,86 @@ ioeta_free(ioeta_estim_t *estim)
 void
 ioeta_calculate(ioeta_estim_t *estim, const char path[], int shallow)
 {
+	walk(estim, NULL, path, shallow);
+}
+
+void
+ioeta_calculate_bg(ioeta_estim_t *estim, const char path[], int shallow)
+{
+	calc_root_t *const root = malloc(sizeof(*root));
+	if(root == NULL || (root->path = strdup(path)) == NULL ||
+			calc_start(estim) != 0)
+	{
+		if(root != NULL)
+		{
+			free(root->path);
+			free(root);
+		}
+		/* Estimations are better late than never. */
+		ioeta_calculate(estim, path, shallow);
+		return;
+	}
+
+	root->shallow = shallow;
+	root->next = NULL;
+
+	ioeta_calc_begin(estim);
+
+	ioeta_calc_t *const calc = estim->calc;
+	pthread_mutex_lock(&calc->lock);
+	*calc->tail = root;
+	calc->tail = &root->next;
+	pthread_cond_broadcast(&calc->cond);
+	pthread_mutex_unlock(&calc->lock);
+}
+
+void
+ioeta_wait(ioeta_estim_t *estim)
+{
+	ioeta_calc_t *const calc = estim->calc;
+	if(calc == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&calc->lock);
+	while((calc->roots != NULL || calc->busy) && !calc->stop)
+	{
+		pthread_cond_wait(&calc->cond, &calc->lock);
+	}
+	pthread_mutex_unlock(&calc->lock);
+}
+
+void
+ioeta_register_dir_size_hook(ioeta_dir_size_hook hook)
+{
+	dir_size_hook = hook;
+}
+
+/* Calculates estimates for a subtree either on this or on a separate thread
+ * depending on whether calc is NULL. */
+static void
+walk(ioeta_estim_t *estim, ioeta_calc_t *calc, const char path[], int shallow)
+{
+	walk_t walk = { .estim = estim, .calc = calc };
+
 	if(shallow)
 	{
-		ioeta_add_item(estim, path);
+		if(calc == NULL)
+		{
+			ioeta_add_item(estim, path);
+		}
+		else
+		{
+			++walk.items;
+		}
 	}
 	else
 	{
-		(void)traverse(path, &eta_visitor, estim);
+		(void)traverse(path, &eta_visitor, &walk);
 	}
+
+	publish(&walk);
 }
 
 /* Implementation of traverse() visitor for subtree copying.  Returns 0 on
@@ -67,9 +194,11 @@ ioeta_calculate(ioeta_estim_t *estim, const char path[], int shallow)
 static VisitResult
 eta_visitor(const char full_path[], VisitAction action, void *param)
 {
-	ioeta_estim_t *const estim = param;
+	walk_t *const walk = param;
+	ioeta_estim_t *const estim = walk->estim;
+	uint64_t size;
 
-	if(cancelled(&estim->cancellation))
+	if(cancelled(&estim->cancellation) || calc_stopped(walk->calc))
 	{
 		return VR_CANCELLED;
 	}
@@ -77,18 +206,206 @@ eta_visitor(const char full_path[], VisitAction action, void *param)
 	switch(action)
 	{
 		case VA_DIR_ENTER:
-			ioeta_add_dir(estim, full_path);
+			if(walk->known_depth > 0)
+			{
+				++walk->known_depth;
+				return VR_OK;
+			}
+
+			if(dir_size_hook != NULL && dir_size_hook(full_path, &size))
+			{
+				/* Files are still counted, but their sizes aren't queried. */
+				walk->known_depth = 1;
+				walk->bytes += size;
+				if(walk->calc == NULL)
+				{
+					publish(walk);
+					ioeta_add_dir(estim, full_path);
+				}
+				return VR_OK;
+			}
+
+			if(walk->calc == NULL)
+			{
+				ioeta_add_dir(estim, full_path);
+			}
 			return VR_SKIP_DIR_LEAVE;
 		case VA_FILE:
-			ioeta_add_file(estim, full_path);
+			add_file(walk, full_path);
 			return VR_OK;
 		case VA_DIR_LEAVE:
-			assert(0 && "Can't get here because of VR_SKIP_DIR_LEAVE.");
+			assert(walk->known_depth > 0 && "Unexpected leaving of a directory.");
+			--walk->known_depth;
 			return VR_OK;
 	}
 
 	return VR_OK;
 }
 
+/* Accounts a file found by the walk. */
+static void
+add_file(walk_t *walk, const char path[])
+{
+	if(walk->calc == NULL)
+	{
+		if(walk->known_depth > 0)
+		{
+			ioeta_add_item(walk->estim, path);
+		}
+		else
+		{
+			ioeta_add_file(walk->estim, path);
+		}
+		return;
+	}
+
+	++walk->items;
+	if(walk->known_depth == 0 && !is_symlink(path))
+	{
+		/* Holes of sparse files aren't copied, so they don't count. */
+		walk->bytes += get_file_data_size(path);
+	}
+
+	if(walk->items%PUBLISH_PERIOD == 0)
+	{
+		publish(walk);
+	}
+}
+
+/* Adds what was found by the walk so far to the estimation. */
+static void
+publish(walk_t *walk)
+{
+	if(walk->items != 0U || walk->bytes != 0U)
+	{
+		ioeta_add_found(walk->estim, walk->items, walk->bytes);
+		walk->items = 0U;
+		walk->bytes = 0U;
+	}
+}
+
+/* Starts calculation thread for the estimation if it's not running yet.
+ * Returns zero on success. */
+static int
+calc_start(ioeta_estim_t *estim)
+{
+	if(estim->calc != NULL)
+	{
+		return 0;
+	}
+
+	ioeta_calc_t *const calc = calloc(1, sizeof(*calc));
+	if(calc == NULL)
+	{
+		return 1;
+	}
+
+	calc->tail = &calc->roots;
+	pthread_mutex_init(&calc->lock, NULL);
+	pthread_cond_init(&calc->cond, NULL);
+
+	estim->calc = calc;
+	if(pthread_create(&calc->thread, NULL, &calc_thread, estim) != 0)
+	{
+		estim->calc = NULL;
+		pthread_cond_destroy(&calc->cond);
+		pthread_mutex_destroy(&calc->lock);
+		free(calc);
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Stops calculation thread of the estimation if it's running.  Calculations
+ * that are in progress are abandoned. */
+static void
+calc_stop(ioeta_estim_t *estim)
+{
+	ioeta_calc_t *const calc = estim->calc;
+	if(calc == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&calc->lock);
+	calc->stop = 1;
+	pthread_cond_broadcast(&calc->cond);
+	pthread_mutex_unlock(&calc->lock);
+
+	(void)pthread_join(calc->thread, NULL);
+
+	while(calc->roots != NULL)
+	{
+		calc_root_t *const next = calc->roots->next;
+		free(calc->roots->path);
+		free(calc->roots);
+		calc->roots = next;
+	}
+
+	pthread_cond_destroy(&calc->cond);
+	pthread_mutex_destroy(&calc->lock);
+	free(calc);
+	estim->calc = NULL;
+}
+
+/* Entry point of calculation thread.  Processes roots one by one until told
+ * to stop.  Returns NULL. */
+static void *
+calc_thread(void *arg)
+{
+	ioeta_estim_t *const estim = arg;
+	ioeta_calc_t *const calc = estim->calc;
+
+	block_all_thread_signals();
+
+	pthread_mutex_lock(&calc->lock);
+	while(!calc->stop)
+	{
+		calc_root_t *const root = calc->roots;
+		if(root == NULL)
+		{
+			pthread_cond_wait(&calc->cond, &calc->lock);
+			continue;
+		}
+
+		calc->roots = root->next;
+		if(calc->roots == NULL)
+		{
+			calc->tail = &calc->roots;
+		}
+		calc->busy = 1;
+		pthread_mutex_unlock(&calc->lock);
+
+		walk(estim, calc, root->path, root->shallow);
+		ioeta_calc_end(estim);
+		free(root->path);
+		free(root);
+
+		pthread_mutex_lock(&calc->lock);
+		calc->busy = 0;
+		pthread_cond_broadcast(&calc->cond);
+	}
+	pthread_mutex_unlock(&calc->lock);
+
+	return NULL;
+}
+
+/* Checks whether calculation should be abandoned.  calc can be NULL.  Returns
+ * non-zero if so. */
+static int
+calc_stopped(ioeta_calc_t *calc)
+{
+	if(calc == NULL)
+	{
+		return 0;
+	}
+
+	pthread_mutex_lock(&calc->lock);
+	const int stop = calc->stop;
+	pthread_mutex_unlock(&calc->lock);
+	return stop;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
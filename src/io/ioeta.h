@@ -22,6 +22,7 @@
 #include <stddef.h> /* size_t */
 #include <stdint.h> /* uint64_t */
 
+#include "../compat/pthread.h"
 #include "ioc.h"
 
 /* ioeta - Input/Output estimation */
@@ -68,9 +69,29 @@ typedef struct ioeta_estim_t
 
 	/* Provides means for cancellation checking. */
 	io_cancellation_t cancellation;
+
+	/* Protects fields of the structure from concurrent updates and serializes
+	 * progress notifications. */
+	pthread_mutex_t lock;
+
+	/* Number of subtrees that are being calculated on a separate thread. */
+	int calculating;
+
+	/* Parts of totals that were added while calculating to keep up with progress
+	 * that got ahead of the calculation.  Found items and bytes fill these parts
+	 * first. */
+	size_t excess_items;
+	uint64_t excess_bytes;
+
+	/* State of calculation on a separate thread or NULL. */
+	struct ioeta_calc_t *calc;
 }
 ioeta_estim_t;
 
+/* Type of hook that provides size of a directory known in advance (e.g., from
+ * a cache).  Should return non-zero and set *size if the size is known. */
+typedef int (*ioeta_dir_size_hook)(const char path[], uint64_t *size);
+
 /* Allocates and initializes new ioeta_estim_t. */
 ioeta_estim_t * ioeta_alloc(void *param, io_cancellation_t cancellation);
 
@@ -82,6 +103,15 @@ void ioeta_free(ioeta_estim_t *estim);
  * directories. */
 void ioeta_calculate(ioeta_estim_t *estim, const char path[], int shallow);
 
+/* Same as ioeta_calculate(), but the work is done on a separate thread (one per
+ * estimation), so that operation can proceed while totals are being filled in.
+ * No notifications are emitted for what's found. */
+void ioeta_calculate_bg(ioeta_estim_t *estim, const char path[], int shallow);
+
+/* Registers hook used to skip querying sizes of files of directories whose size
+ * is already known.  NULL disables the hook. */
+void ioeta_register_dir_size_hook(ioeta_dir_size_hook hook);
+
 #endif /* VIFM__IO__IOETA_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -25,6 +25,10 @@
 #ifndef _WIN32
 #include <sys/ioctl.h> /* ioctl() */
 #endif
+#ifdef __linux__
+#include <sys/sendfile.h> /* sendfile() */
+#include <sys/syscall.h> /* SYS_copy_file_range */
+#endif
 #include <sys/stat.h> /* stat */
 #include <sys/types.h> /* mode_t */
 #include <unistd.h> /* symlink() unlink() */
@@ -32,9 +36,10 @@
 #include <assert.h> /* assert() */
 #include <errno.h> /* EEXIST ENOENT EISDIR errno */
 #include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* UINT64_MAX uint64_t */
 #include <stdio.h> /* FILE fpos_t fclose() fgetpos() fflush() fread() fseek()
                       fsetpos() fwrite() snprintf() */
-#include <stdlib.h> /* free() */
+#include <stdlib.h> /* free() malloc() */
 #include <string.h> /* strchr() */
 
 #include "../compat/fs_limits.h"
@@ -51,18 +56,48 @@
 #include "private/ioeta.h"
 #include "ioc.h"
 
-/* Amount of data to transfer at once. */
+/* Amount of data to transfer at once when a larger buffer isn't available. */
 #define BLOCK_SIZE 32*1024
 
+/* Amount of data to transfer at once through user space. */
+#define BUFFER_SIZE (1024*1024)
+
+/* Amount of data to transfer at once inside of the kernel.  Limits time between
+ * progress updates and checks for cancellation. */
+#define KERNEL_CHUNK_SIZE (16*1024*1024)
+
 /* Type of io function used by retry_wrapper(). */
 typedef int (*iop_func)(io_args_t *args);
 
+/* Ways of copying data between file descriptors inside of the kernel in the
+ * order of preference. */
+typedef enum
+{
+	KC_COPY_FILE_RANGE, /* copy_file_range(), works within a file system. */
+	KC_SENDFILE,        /* sendfile(), works for any regular files. */
+	KC_COUNT            /* Number of methods. */
+}
+KernelCopy;
+
 static int iop_mkfile_internal(io_args_t *args);
 static int iop_mkdir_internal(io_args_t *args);
 static int iop_rmfile_internal(io_args_t *args);
 static int iop_rmdir_internal(io_args_t *args);
 static int iop_cp_internal(io_args_t *args);
 static int clone_file(int dst_fd, int src_fd);
+static int copy_file_data(io_args_t *args, int in_fd, int out_fd, int sparse);
+static int copy_range(io_args_t *args, int in_fd, int out_fd, uint64_t len,
+		int report);
+static int copy_in_kernel(io_args_t *args, int in_fd, int out_fd,
+		uint64_t *len, int report);
+#ifdef __linux__
+static ssize_t copy_chunk_in_kernel(KernelCopy method, int dst_fd, int src_fd,
+		size_t len);
+static int kernel_copy_unsupported(int error);
+#endif
+static int copy_in_user_space(io_args_t *args, int in_fd, int out_fd,
+		uint64_t len, int report);
+static int write_fully(int fd, const char data[], size_t len);
 #ifdef _WIN32
 static DWORD CALLBACK win_progress_cb(LARGE_INTEGER total,
 		LARGE_INTEGER transferred, LARGE_INTEGER stream_size,
@@ -288,7 +323,6 @@ iop_cp_internal(io_args_t *args)
 	const io_confirm confirm = args->confirm;
 	struct stat st;
 
-	char block[BLOCK_SIZE];
 	FILE *in, *out;
 	int error;
 	int cloned;
@@ -537,45 +571,15 @@ iop_cp_internal(io_args_t *args)
 		}
 	}
 
-	/* TODO: use sendfile() if platform supports it. */
-
 	if(!error && !cloned)
 	{
-		/* Suppress possible false-positive compiler warning. */
-		size_t nread = (size_t)-1;
-		while((nread = fread(&block, 1, sizeof(block), in)) != 0U)
-		{
-			if(io_cancelled(args))
-			{
-				error = 1;
-				break;
-			}
-
-			if(fwrite(&block, 1, nread, out) != nread)
-			{
-				(void)ioe_errlst_append(&args->result.errors, dst, errno,
-						"Write to destination file failed");
-				error = 1;
-				break;
-			}
-
-			ioeta_update(args->estim, NULL, NULL, 0, nread);
-		}
+		/* Holes can't be skipped when all writes go to the end of the file. */
+		const int sparse = !args->arg4.dense_copy
+		                && crs != IO_CRS_APPEND_TO_FILES;
 
-		if(nread == 0U && !feof(in) && ferror(in))
-		{
-			(void)ioe_errlst_append(&args->result.errors, src, errno,
-					"Read from destination file failed");
-		}
-
-		/* fwrite() does caching, so we need to force flush to catch output errors
-		 * before fclose() (which also does fflush() internally). */
-		if(fflush(out) != 0)
-		{
-			(void)ioe_errlst_append(&args->result.errors, dst, errno,
-					"Write to destination file failed");
-			error = 1;
-		}
+		/* Neither of the streams has buffered any data yet, so the rest can be
+		 * copied from/to current positions of their descriptors. */
+		error = copy_file_data(args, fileno(in), fileno(out), sparse);
 	}
 
 	/* Note that we truncate output file even if operation was cancelled by the
@@ -645,6 +649,308 @@ clone_file(int dst_fd, int src_fd)
 #endif
 }
 
+/* Copies data from current position of input to current position of output.
+ * With non-zero sparse, holes of input are reproduced in output instead of
+ * being filled with zeroes.  Progress is reported for data regions only.
+ * Returns zero on success, otherwise non-zero is returned. */
+static int
+copy_file_data(io_args_t *args, int in_fd, int out_fd, int sparse)
+{
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	struct stat st;
+	off_t pos = lseek(in_fd, 0, SEEK_CUR);
+	if(pos != (off_t)-1 && fstat(in_fd, &st) == 0 && S_ISREG(st.st_mode))
+	{
+		const off_t end = st.st_size;
+		while(pos < end)
+		{
+			off_t data = lseek(in_fd, pos, SEEK_DATA);
+			if(data == (off_t)-1)
+			{
+				if(errno != ENXIO)
+				{
+					/* Holes can't be detected, copy the rest as is. */
+					break;
+				}
+				/* The rest of the file is a hole. */
+				data = end;
+			}
+
+			off_t hole = (data < end) ? lseek(in_fd, data, SEEK_HOLE) : end;
+			if(hole == (off_t)-1 || hole > end)
+			{
+				hole = end;
+			}
+
+			if(data > pos)
+			{
+				int error;
+				if(sparse)
+				{
+					/* Seeking past the end of output leaves a hole there. */
+					error = (lseek(out_fd, data - pos, SEEK_CUR) == (off_t)-1);
+				}
+				else
+				{
+					error = (lseek(in_fd, pos, SEEK_SET) == (off_t)-1)
+					     || copy_range(args, in_fd, out_fd, data - pos, 0) != 0;
+				}
+
+				if(error)
+				{
+					(void)ioe_errlst_append(&args->result.errors, args->arg2.dst, errno,
+							"Failed to reproduce a hole of sparse file");
+					return 1;
+				}
+			}
+
+			if(data == end)
+			{
+				pos = end;
+				break;
+			}
+
+			if(lseek(in_fd, data, SEEK_SET) == (off_t)-1 ||
+					copy_range(args, in_fd, out_fd, hole - data, 1) != 0)
+			{
+				return 1;
+			}
+			pos = hole;
+		}
+
+		if(pos >= end)
+		{
+			/* Trailing hole doesn't change size of output by itself. */
+			if(sparse && ftruncate(out_fd, end) != 0)
+			{
+				(void)ioe_errlst_append(&args->result.errors, args->arg2.dst, errno,
+						"Failed to reproduce a hole of sparse file");
+				return 1;
+			}
+			return 0;
+		}
+
+		if(lseek(in_fd, pos, SEEK_SET) == (off_t)-1)
+		{
+			(void)ioe_errlst_append(&args->result.errors, args->arg1.src, errno,
+					"Failed to seek in source file");
+			return 1;
+		}
+	}
+#else
+	(void)sparse;
+#endif
+
+	return copy_range(args, in_fd, out_fd, UINT64_MAX, 1);
+}
+
+/* Copies len bytes (less if input ends earlier) between current positions of
+ * descriptors.  Progress is reported only if report is non-zero.  Returns zero
+ * on success, otherwise non-zero is returned. */
+static int
+copy_range(io_args_t *args, int in_fd, int out_fd, uint64_t len, int report)
+{
+	const int result = copy_in_kernel(args, in_fd, out_fd, &len, report);
+	if(result > 0)
+	{
+		return copy_in_user_space(args, in_fd, out_fd, len, report);
+	}
+	return (result != 0);
+}
+
+/* Copies up to *len bytes between current positions of descriptors without
+ * passing them through user space.  *len is decreased by the amount of copied
+ * data.  Returns zero on success, positive number if the rest of the data
+ * should be copied in some other way and negative number on error or
+ * cancellation. */
+static int
+copy_in_kernel(io_args_t *args, int in_fd, int out_fd, uint64_t *len,
+		int report)
+{
+#ifdef __linux__
+	KernelCopy method;
+	for(method = 0; method < KC_COUNT; ++method)
+	{
+		uint64_t copied = 0U;
+		while(*len != 0U)
+		{
+			if(io_cancelled(args))
+			{
+				return -1;
+			}
+
+			const ssize_t n = copy_chunk_in_kernel(method, out_fd, in_fd,
+					MIN(*len, KERNEL_CHUNK_SIZE));
+			if(n > 0)
+			{
+				copied += n;
+				*len -= n;
+				if(report)
+				{
+					ioeta_update(args->estim, NULL, NULL, 0, n);
+				}
+				continue;
+			}
+
+			if(n == 0)
+			{
+				/* Some pseudo files look empty to the kernel, so try harder if nothing
+				 * was copied. */
+				if(copied != 0U)
+				{
+					return 0;
+				}
+				break;
+			}
+
+			if(kernel_copy_unsupported(errno))
+			{
+				/* Positions of descriptors account for data copied so far. */
+				break;
+			}
+
+			(void)ioe_errlst_append(&args->result.errors, args->arg2.dst, errno,
+					"Failed to copy file data");
+			return -1;
+		}
+
+		if(*len == 0U)
+		{
+			return 0;
+		}
+	}
+#else
+	(void)args;
+	(void)in_fd;
+	(void)out_fd;
+	(void)report;
+#endif
+	return (*len == 0U) ? 0 : 1;
+}
+
+#ifdef __linux__
+
+/* Copies up to len bytes between current positions of descriptors with the
+ * specified method.  Returns number of copied bytes, 0 at the end of input or
+ * -1 on error with errno set. */
+static ssize_t
+copy_chunk_in_kernel(KernelCopy method, int dst_fd, int src_fd, size_t len)
+{
+	switch(method)
+	{
+		case KC_COPY_FILE_RANGE:
+#ifdef SYS_copy_file_range
+			/* Using system call directly doesn't depend on version of libc. */
+			return syscall(SYS_copy_file_range, src_fd, NULL, dst_fd, NULL, len, 0U);
+#else
+			break;
+#endif
+		case KC_SENDFILE:
+			return sendfile(dst_fd, src_fd, NULL, len);
+		case KC_COUNT:
+			assert(0 && "Unexpected copy method.");
+			break;
+	}
+
+	errno = ENOSYS;
+	return -1;
+}
+
+/* Checks whether the error means that copying method isn't applicable to the
+ * files rather than a failure of reading or writing.  Returns non-zero if
+ * so. */
+static int
+kernel_copy_unsupported(int error)
+{
+	/* EBADF is reported for output files opened for appending. */
+	return error == ENOSYS || error == EXDEV || error == EINVAL
+	    || error == EOPNOTSUPP || error == ENOTSUP || error == EBADF;
+}
+
+#endif
+
+/* Copies up to len bytes between current positions of descriptors by reading
+ * data into a buffer and writing it out.  Progress is reported only if report
+ * is non-zero.  Returns zero on success, otherwise non-zero is returned. */
+static int
+copy_in_user_space(io_args_t *args, int in_fd, int out_fd, uint64_t len,
+		int report)
+{
+	char fallback[BLOCK_SIZE];
+	char *const buffer = malloc(BUFFER_SIZE);
+	char *const block = (buffer == NULL) ? fallback : buffer;
+	const size_t block_size = (buffer == NULL) ? sizeof(fallback) : BUFFER_SIZE;
+
+	int error = 0;
+	while(len != 0U)
+	{
+		const ssize_t nread = read(in_fd, block, MIN(len, block_size));
+		if(nread == 0)
+		{
+			break;
+		}
+
+		if(nread < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			(void)ioe_errlst_append(&args->result.errors, args->arg1.src, errno,
+					"Read from source file failed");
+			error = 1;
+			break;
+		}
+
+		if(io_cancelled(args))
+		{
+			error = 1;
+			break;
+		}
+
+		if(write_fully(out_fd, block, nread) != 0)
+		{
+			(void)ioe_errlst_append(&args->result.errors, args->arg2.dst, errno,
+					"Write to destination file failed");
+			error = 1;
+			break;
+		}
+
+		len -= nread;
+		if(report)
+		{
+			ioeta_update(args->estim, NULL, NULL, 0, nread);
+		}
+	}
+
+	free(buffer);
+	return error;
+}
+
+/* Writes all of the data to a descriptor.  Returns zero on success, otherwise
+ * non-zero is returned and errno is set. */
+static int
+write_fully(int fd, const char data[], size_t len)
+{
+	while(len != 0U)
+	{
+		const ssize_t n = write(fd, data, len);
+		if(n < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			return 1;
+		}
+
+		data += n;
+		len -= n;
+	}
+	return 0;
+}
+
 #ifdef _WIN32
 
 static DWORD CALLBACK win_progress_cb(LARGE_INTEGER total,
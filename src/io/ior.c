@@ -25,7 +25,7 @@
 #include <stddef.h> /* NULL */
 #include <stdio.h> /* remove() snprintf() */
 #include <stdlib.h> /* free() */
-#include <string.h> /* strlen() */
+#include <string.h> /* strdup() strlen() */
 
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
@@ -33,15 +33,28 @@
 #include "../utils/log.h"
 #include "../utils/path.h"
 #include "../utils/str.h"
+#include "../utils/string_array.h"
 #include "../utils/utils.h"
 #include "../background.h"
 #include "private/ioc.h"
 #include "private/ioe.h"
 #include "private/ioeta.h"
+#include "private/iosched.h"
 #include "private/traverser.h"
 #include "ioc.h"
 #include "iop.h"
 
+/* State of copying or moving a subtree. */
+typedef struct
+{
+	io_args_t *args;      /* Arguments of the operation. */
+	iosched_t *sched;     /* Scheduler of files or NULL if they are processed
+	                         sequentially. */
+	strlist_t left_dirs;  /* Directories to finish after all files are
+	                         processed (in the order of leaving them). */
+}
+cp_mv_state_t;
+
 static VisitResult rm_visitor(const char full_path[], VisitAction action,
 		void *param);
 static VisitResult cp_visitor(const char full_path[], VisitAction action,
@@ -52,8 +65,11 @@ static int mv_replacing_files(io_args_t *args);
 static int is_file(const char path[]);
 static VisitResult mv_visitor(const char full_path[], VisitAction action,
 		void *param);
+static int cp_mv_subtree(io_args_t *args, int cp);
 static VisitResult cp_mv_visitor(const char full_path[], VisitAction action,
 		void *param, int cp);
+static VisitResult leave_dir(io_args_t *args, const char src[],
+		const char dst[], int cp);
 
 int
 ior_rm(io_args_t *args)
@@ -153,7 +169,7 @@ ior_cp(io_args_t *args)
 		}
 	}
 
-	return traverse(src, &cp_visitor, args);
+	return cp_mv_subtree(args, 1);
 }
 
 /* Implementation of traverse() visitor for subtree copying.  Returns 0 on
@@ -335,7 +351,6 @@ mv_replacing_all(io_args_t *args)
 static int
 mv_replacing_files(io_args_t *args)
 {
-	const char *const src = args->arg1.src;
 	const char *const dst = args->arg2.dst;
 
 	if(!has_atomic_file_replace() && is_file(dst))
@@ -362,7 +377,7 @@ mv_replacing_files(io_args_t *args)
 		}
 	}
 
-	return traverse(src, &mv_visitor, args);
+	return cp_mv_subtree(args, 0);
 }
 
 /* Checks that path points to a file or symbolic link.  Returns non-zero if so,
@@ -382,12 +397,50 @@ mv_visitor(const char full_path[], VisitAction action, void *param)
 	return cp_mv_visitor(full_path, action, param, 0);
 }
 
+/* Copies or moves subtree processing files concurrently if that's requested.
+ * Returns zero on success and non-zero on error. */
+static int
+cp_mv_subtree(io_args_t *args, int cp)
+{
+	cp_mv_state_t state = {
+		.args = args,
+		.sched = iosched_start(args),
+	};
+
+	int result = traverse(args->arg1.src, cp ? &cp_visitor : &mv_visitor,
+			&state);
+	if(state.sched == NULL)
+	{
+		return result;
+	}
+
+	result |= iosched_finish(state.sched);
+
+	/* Directories weren't completed on failure of sequential processing either,
+	 * leave them as is. */
+	int i;
+	for(i = 0; i < state.left_dirs.nitems && result == 0; ++i)
+	{
+		const char *const full_path = state.left_dirs.items[i];
+		const char *const rel_part = full_path + strlen(args->arg1.src);
+		char *const dst = (rel_part[0] == '\0')
+		                ? strdup(args->arg2.dst)
+		                : join_paths(args->arg2.dst, rel_part);
+		result = (dst == NULL || leave_dir(args, full_path, dst, cp) != VR_OK);
+		free(dst);
+	}
+
+	free_string_array(state.left_dirs.items, state.left_dirs.nitems);
+	return result;
+}
+
 /* Generic implementation of traverse() visitor for subtree copying/moving.
  * Returns 0 on success, otherwise non-zero is returned. */
 static VisitResult
 cp_mv_visitor(const char full_path[], VisitAction action, void *param, int cp)
 {
-	io_args_t *const cp_args = param;
+	cp_mv_state_t *const state = param;
+	io_args_t *const cp_args = state->args;
 	const char *dst_full_path;
 	char *free_me = NULL;
 	VisitResult result = VR_OK;
@@ -433,6 +486,7 @@ cp_mv_visitor(const char full_path[], VisitAction action, void *param, int cp)
 					.arg3.crs = cp_args->arg3.crs,
 					/* It's safe to always use fast file cloning on moving files. */
 					.arg4.fast_file_cloning = cp ? cp_args->arg4.fast_file_cloning : 1,
+					.arg4.dense_copy = cp ? cp_args->arg4.dense_copy : 0,
 
 					.cancellation = cp_args->cancellation,
 					.confirm = cp_args->confirm,
@@ -441,50 +495,76 @@ cp_mv_visitor(const char full_path[], VisitAction action, void *param, int cp)
 					.result = cp_args->result,
 				};
 
-				result = ((cp ? iop_cp(&args) : ior_mv(&args)) == 0) ? VR_OK : VR_ERROR;
+				const iosched_func func = (cp ? &iop_cp : &ior_mv);
+				if(state->sched != NULL)
+				{
+					result = (iosched_add(state->sched, func, &args) == 0)
+					       ? VR_OK
+					       : VR_ERROR;
+					break;
+				}
+
+				result = (func(&args) == 0) ? VR_OK : VR_ERROR;
 				cp_args->result = args.result;
 				break;
 			}
 		case VA_DIR_LEAVE:
+			if(state->sched == NULL)
+			{
+				result = leave_dir(cp_args, full_path, dst_full_path, cp);
+			}
+			else
 			{
-				struct stat st;
+				/* Files of the directory might still be in progress. */
+				state->left_dirs.nitems = add_to_string_array(&state->left_dirs.items,
+						state->left_dirs.nitems, full_path);
+			}
+			break;
+	}
 
-				if(cp_args->arg3.crs == IO_CRS_REPLACE_FILES && !cp)
-				{
-					io_args_t rm_args = {
-						.arg1.path = full_path,
+	free(free_me);
+
+	return result;
+}
 
-						.cancellation = cp_args->cancellation,
-						.estim = cp_args->estim,
+/* Finishes processing of a directory after all of its files have been
+ * processed.  Returns VR_OK on success and VR_ERROR on error. */
+static VisitResult
+leave_dir(io_args_t *args, const char src[], const char dst[], int cp)
+{
+	struct stat st;
+	VisitResult result;
 
-						.result = cp_args->result,
-					};
+	if(args->arg3.crs == IO_CRS_REPLACE_FILES && !cp)
+	{
+		io_args_t rm_args = {
+			.arg1.path = src,
 
-					result = (iop_rmdir(&rm_args) == 0) ? VR_OK : VR_ERROR;
-				}
-				else if(os_stat(full_path, &st) == 0)
-				{
-					result = (os_chmod(dst_full_path, st.st_mode & 07777) == 0)
-									? VR_OK
-									: VR_ERROR;
-					if(result == VR_ERROR)
-					{
-						(void)ioe_errlst_append(&cp_args->result.errors, dst_full_path,
-								errno, "Failed to setup directory permissions");
-					}
-					clone_attribs(dst_full_path, full_path, &st);
-				}
-				else
-				{
-					(void)ioe_errlst_append(&cp_args->result.errors, full_path, errno,
-							"Failed to stat() source directory");
-					result = VR_ERROR;
-				}
-				break;
-			}
-	}
+			.cancellation = args->cancellation,
+			.estim = args->estim,
 
-	free(free_me);
+			.result = args->result,
+		};
+
+		result = (iop_rmdir(&rm_args) == 0) ? VR_OK : VR_ERROR;
+		args->result = rm_args.result;
+	}
+	else if(os_stat(src, &st) == 0)
+	{
+		result = (os_chmod(dst, st.st_mode & 07777) == 0) ? VR_OK : VR_ERROR;
+		if(result == VR_ERROR)
+		{
+			(void)ioe_errlst_append(&args->result.errors, dst, errno,
+					"Failed to setup directory permissions");
+		}
+		clone_attribs(dst, src, &st);
+	}
+	else
+	{
+		(void)ioe_errlst_append(&args->result.errors, src, errno,
+				"Failed to stat() source directory");
+		result = VR_ERROR;
+	}
 
 	return result;
 }
@@ -24,10 +24,14 @@
 #include <string.h> /* strdup() */
 
 #include "../../utils/fs.h"
+#include "../../utils/macros.h"
 #include "../../utils/str.h"
 #include "../ioeta.h"
 #include "ionotif.h"
 
+static void add_item(ioeta_estim_t *estim, const char path[]);
+static void sync_totals(ioeta_estim_t *estim);
+
 void
 ioeta_release(ioeta_estim_t *estim)
 {
@@ -37,6 +41,28 @@ ioeta_release(ioeta_estim_t *estim)
 
 void
 ioeta_add_item(ioeta_estim_t *estim, const char path[])
+{
+	pthread_mutex_lock(&estim->lock);
+	add_item(estim, path);
+	pthread_mutex_unlock(&estim->lock);
+}
+
+void
+ioeta_add_file(ioeta_estim_t *estim, const char path[])
+{
+	/* Holes of sparse files aren't copied, so they don't count. */
+	const uint64_t size = is_symlink(path) ? 0U : get_file_data_size(path);
+
+	pthread_mutex_lock(&estim->lock);
+	estim->total_bytes += size;
+	add_item(estim, path);
+	pthread_mutex_unlock(&estim->lock);
+}
+
+/* Adds zero-size item to the estimation.  Must be called with the lock
+ * held. */
+static void
+add_item(ioeta_estim_t *estim, const char path[])
 {
 	++estim->total_items;
 
@@ -46,14 +72,40 @@ ioeta_add_item(ioeta_estim_t *estim, const char path[])
 }
 
 void
-ioeta_add_file(ioeta_estim_t *estim, const char path[])
+ioeta_add_found(ioeta_estim_t *estim, size_t items, uint64_t bytes)
+{
+	pthread_mutex_lock(&estim->lock);
+
+	const size_t taken_items = MIN(items, estim->excess_items);
+	estim->excess_items -= taken_items;
+	estim->total_items += items - taken_items;
+
+	const uint64_t taken_bytes = MIN(bytes, estim->excess_bytes);
+	estim->excess_bytes -= taken_bytes;
+	estim->total_bytes += bytes - taken_bytes;
+
+	pthread_mutex_unlock(&estim->lock);
+}
+
+void
+ioeta_calc_begin(ioeta_estim_t *estim)
+{
+	pthread_mutex_lock(&estim->lock);
+	++estim->calculating;
+	pthread_mutex_unlock(&estim->lock);
+}
+
+void
+ioeta_calc_end(ioeta_estim_t *estim)
 {
-	if(!is_symlink(path))
+	pthread_mutex_lock(&estim->lock);
+	if(--estim->calculating == 0)
 	{
-		estim->total_bytes += get_file_size(path);
+		/* Whatever wasn't found is a correction of the estimates now. */
+		estim->excess_items = 0U;
+		estim->excess_bytes = 0U;
 	}
-
-	ioeta_add_item(estim, path);
+	pthread_mutex_unlock(&estim->lock);
 }
 
 void
@@ -64,43 +116,45 @@ ioeta_add_dir(ioeta_estim_t *estim, const char path[])
 	 *       progress reports and it even might be the reason of getting more than
 	 *       100% progress. */
 
+	pthread_mutex_lock(&estim->lock);
+
 	replace_string(&estim->item, path);
 
 	ionotif_notify(IO_PS_ESTIMATING, estim);
+
+	pthread_mutex_unlock(&estim->lock);
 }
 
 void
 ioeta_update(ioeta_estim_t *estim, const char path[], const char target[],
 		int finished, uint64_t bytes)
 {
-	if(estim == NULL || estim->silent)
+	if(estim == NULL)
 	{
 		return;
 	}
 
-	estim->current_byte += bytes;
-	estim->current_file_byte += bytes;
-	if(estim->current_byte > estim->total_bytes)
+	pthread_mutex_lock(&estim->lock);
+
+	if(estim->silent)
 	{
-		/* Estimations are out of date, update them. */
-		estim->total_bytes = estim->current_byte;
+		pthread_mutex_unlock(&estim->lock);
+		return;
 	}
 
+	estim->current_byte += bytes;
+	estim->current_file_byte += bytes;
+
 	if(finished)
 	{
 		++estim->current_item;
-		if(estim->current_item > estim->total_items)
-		{
-			/* Estimations are out of date, update them. */
-			estim->total_items = estim->current_item;
-		}
 		estim->current_file_byte = 0U;
 		estim->total_file_bytes = 0U;
 	}
 	else if(estim->inspected_items != estim->current_item + 1)
 	{
 		estim->inspected_items = estim->current_item + 1;
-		estim->total_file_bytes = get_file_size(path);
+		estim->total_file_bytes = get_file_data_size(path);
 	}
 
 	if(path != NULL)
@@ -113,7 +167,36 @@ ioeta_update(ioeta_estim_t *estim, const char path[], const char target[],
 		replace_string(&estim->target, target);
 	}
 
+	sync_totals(estim);
+
 	ionotif_notify(IO_PS_IN_PROGRESS, estim);
+
+	pthread_mutex_unlock(&estim->lock);
+}
+
+/* Updates out of date estimations to match progress.  Must be called with the
+ * lock held. */
+static void
+sync_totals(ioeta_estim_t *estim)
+{
+	const int calculating = (estim->calculating != 0);
+
+	if(estim->current_byte > estim->total_bytes)
+	{
+		if(calculating)
+		{
+			estim->excess_bytes += estim->current_byte - estim->total_bytes;
+		}
+		estim->total_bytes = estim->current_byte;
+	}
+	if(estim->current_item > estim->total_items)
+	{
+		if(calculating)
+		{
+			estim->excess_items += estim->current_item - estim->total_items;
+		}
+		estim->total_items = estim->current_item;
+	}
 }
 
 int
@@ -126,8 +209,10 @@ ioeta_silent_on(ioeta_estim_t *estim)
 		return 0;
 	}
 
+	pthread_mutex_lock(&estim->lock);
 	silent = estim->silent;
 	estim->silent = 1;
+	pthread_mutex_unlock(&estim->lock);
 	return silent;
 }
 
@@ -136,16 +221,38 @@ ioeta_silent_set(ioeta_estim_t *estim, int silent)
 {
 	if(estim != NULL)
 	{
+		pthread_mutex_lock(&estim->lock);
 		estim->silent = silent;
+		pthread_mutex_unlock(&estim->lock);
+	}
+}
+
+void
+ioeta_lock(ioeta_estim_t *estim)
+{
+	if(estim != NULL)
+	{
+		pthread_mutex_lock(&estim->lock);
+	}
+}
+
+void
+ioeta_unlock(ioeta_estim_t *estim)
+{
+	if(estim != NULL)
+	{
+		pthread_mutex_unlock(&estim->lock);
 	}
 }
 
 ioeta_estim_t
-ioeta_save(const ioeta_estim_t *estim)
+ioeta_save(ioeta_estim_t *estim)
 {
+	pthread_mutex_lock(&estim->lock);
 	ioeta_estim_t copy = *estim;
 	copy.item = (copy.item == NULL ? NULL : strdup(copy.item));
 	copy.target = (copy.target == NULL ? NULL : strdup(copy.target));
+	pthread_mutex_unlock(&estim->lock);
 
 	return copy;
 }
@@ -153,20 +260,32 @@ ioeta_save(const ioeta_estim_t *estim)
 void
 ioeta_restore(ioeta_estim_t *estim, const ioeta_estim_t *save)
 {
-	char *item = estim->item;
-	char *target = estim->target;
+	pthread_mutex_lock(&estim->lock);
 
-	if(estim->silent)
+	if(!estim->silent)
 	{
-		return;
-	}
+		update_string(&estim->item, save->item);
+		update_string(&estim->target, save->target);
 
-	update_string(&item, save->item);
-	update_string(&target, save->target);
+		/* The structure isn't copied as a whole to leave the lock intact. */
+		if(estim->calculating == 0 && save->calculating == 0)
+		{
+			/* Otherwise totals could have been extended by the calculation. */
+			estim->total_items = save->total_items;
+			estim->total_bytes = save->total_bytes;
+		}
+
+		estim->current_item = save->current_item;
+		estim->current_byte = save->current_byte;
+		estim->total_file_bytes = save->total_file_bytes;
+		estim->current_file_byte = save->current_file_byte;
+		estim->inspected_items = save->inspected_items;
+		estim->silent = save->silent;
+		estim->param = save->param;
+		estim->cancellation = save->cancellation;
+	}
 
-	*estim = *save;
-	estim->item = item;
-	estim->target = target;
+	pthread_mutex_unlock(&estim->lock);
 }
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
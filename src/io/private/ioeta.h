@@ -19,12 +19,17 @@
 #ifndef VIFM__IO__PRIVATE__IOETA_H__
 #define VIFM__IO__PRIVATE__IOETA_H__
 
+#include <stddef.h> /* size_t */
 #include <stdint.h> /* uint64_t */
 
 #include "../ioeta.h"
 
 /* ioeta - private functions of Input/Output estimation */
 
+/* All functions that modify estimation (including notifications they emit) are
+ * serialized via lock of the estimation, so they can be called from several
+ * threads. */
+
 /* Frees resources of estimation, but not the structure itself.  estim can't be
  * NULL. */
 void ioeta_release(ioeta_estim_t *estim);
@@ -38,6 +43,20 @@ void ioeta_add_file(ioeta_estim_t *estim, const char path[]);
 /* Adds directory to the estimation. */
 void ioeta_add_dir(ioeta_estim_t *estim, const char path[]);
 
+/* Extends totals of the estimation without emitting a notification. */
+void ioeta_add_found(ioeta_estim_t *estim, size_t items, uint64_t bytes);
+
+/* Marks start of calculation of a subtree on a separate thread. */
+void ioeta_calc_begin(ioeta_estim_t *estim);
+
+/* Marks end of calculation of a subtree on a separate thread.  Once there are
+ * no calculations left, totals are made consistent with progress. */
+void ioeta_calc_end(ioeta_estim_t *estim);
+
+/* Waits for all calculations started by ioeta_calculate_bg() to finish.  Only
+ * needed to check final totals, as nothing in the I/O unit depends on them. */
+void ioeta_wait(ioeta_estim_t *estim);
+
 /* ioeta_update_estim(e, "p", "t", 0, 100); -- 100 bytes of current item
  * processed.
  * ioeta_update_estim(e, "", "", 1, 50); -- Last 50 bytes of current item
@@ -55,10 +74,20 @@ int ioeta_silent_on(ioeta_estim_t *estim);
 /* Sets silence flag for the estimation.  Does nothing if estim is NULL. */
 void ioeta_silent_set(ioeta_estim_t *estim, int silent);
 
+/* Blocks updates of the estimation (and thus progress notifications) by other
+ * threads until ioeta_unlock() is called.  No ioeta_* function can be called
+ * on the estimation by the same thread in between.  Does nothing if estim is
+ * NULL. */
+void ioeta_lock(ioeta_estim_t *estim);
+
+/* Unblocks updates of the estimation.  Does nothing if estim is NULL. */
+void ioeta_unlock(ioeta_estim_t *estim);
+
 /* Makes restoration point for state of the estimation.  Returns the restoration
  * point to be passed to ioeta_restore.  It can be used to restore state
- * multiple times and needs to be freed with ioeta_release() after last use. */
-ioeta_estim_t ioeta_save(const ioeta_estim_t *estim);
+ * multiple times and needs to be freed with ioeta_release() after last use.
+ * The lock of the copy isn't initialized and must not be used. */
+ioeta_estim_t ioeta_save(ioeta_estim_t *estim);
 
 /* Restores estimation to its previous state. */
 void ioeta_restore(ioeta_estim_t *estim, const ioeta_estim_t *save);
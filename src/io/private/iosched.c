@@ -0,0 +1,424 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "iosched.h"
+
+#include <assert.h> /* assert() */
+#include <stddef.h> /* NULL */
+#include <stdlib.h> /* calloc() free() */
+#include <string.h> /* strdup() */
+
+#include "../../compat/pthread.h"
+#include "../../utils/fs.h"
+#include "../../utils/utils.h"
+#include "../ioc.h"
+#include "../ioe.h"
+#include "ioc.h"
+#include "ioe.h"
+#include "ioeta.h"
+
+/* A file waiting to be processed or already processed. */
+typedef struct job_t
+{
+	iosched_func func; /* Operation to perform. */
+	io_args_t args;    /* Arguments of the operation. */
+	char *src;         /* Copy of source path. */
+	char *dst;         /* Copy of destination path. */
+	int result;        /* Result of running func. */
+	struct job_t *next; /* Next job in a list. */
+}
+job_t;
+
+struct iosched_t
+{
+	io_args_t *args; /* Arguments of the whole operation. */
+	int queue_depth; /* Maximum number of jobs in the queue. */
+	int failed;      /* Whether operation has failed.  Used only by scheduling
+	                    thread. */
+
+	pthread_mutex_t lock;      /* Protects fields below. */
+	pthread_cond_t queued;     /* Signaled on new job or when stopping. */
+	pthread_cond_t finished;   /* Signaled on finished job. */
+	job_t *queue;              /* Jobs waiting for a worker in FIFO order. */
+	job_t **queue_tail;        /* Pointer to next field of last queued job. */
+	int nqueued;               /* Number of jobs in the queue. */
+	int nrunning;              /* Number of jobs processed by workers. */
+	job_t *done;               /* Finished jobs in reverse order. */
+	int stop;                  /* Whether workers should quit. */
+
+	int nworkers;         /* Number of started workers. */
+	pthread_t workers[];  /* Handles of worker threads. */
+};
+
+static job_t * make_job(iosched_t *sched, iosched_func func,
+		const io_args_t *proto);
+static void free_job(job_t *job);
+static void enqueue(iosched_t *sched, job_t *job);
+static void drop_queue(iosched_t *sched);
+static void collect(iosched_t *sched, int drain);
+static void handle_finished(iosched_t *sched, job_t *job);
+static void * worker_thread(void *arg);
+
+iosched_t *
+iosched_start(io_args_t *args)
+{
+	const int nworkers = args->par.nworkers;
+	if(nworkers < 2)
+	{
+		return NULL;
+	}
+
+	iosched_t *const sched = calloc(1, sizeof(*sched) +
+			sizeof(sched->workers[0])*nworkers);
+	if(sched == NULL)
+	{
+		return NULL;
+	}
+
+	sched->args = args;
+	sched->queue_depth = (args->par.queue_depth > 0)
+	                   ? args->par.queue_depth
+	                   : 2*nworkers;
+	sched->queue_tail = &sched->queue;
+	pthread_mutex_init(&sched->lock, NULL);
+	pthread_cond_init(&sched->queued, NULL);
+	pthread_cond_init(&sched->finished, NULL);
+
+	while(sched->nworkers < nworkers)
+	{
+		if(pthread_create(&sched->workers[sched->nworkers], NULL, &worker_thread,
+					sched) != 0)
+		{
+			break;
+		}
+		++sched->nworkers;
+	}
+
+	if(sched->nworkers == 0)
+	{
+		/* Fall back to sequential processing. */
+		(void)iosched_finish(sched);
+		return NULL;
+	}
+
+	return sched;
+}
+
+int
+iosched_add(iosched_t *sched, iosched_func func, const io_args_t *job)
+{
+	io_args_t *const args = sched->args;
+
+	if(sched->failed || io_cancelled(args))
+	{
+		return 1;
+	}
+
+	job_t *const new_job = make_job(sched, func, job);
+	if(new_job == NULL)
+	{
+		(void)ioe_errlst_append(&args->result.errors, job->arg1.src,
+				IO_ERR_UNKNOWN, "Not enough memory");
+		sched->failed = 1;
+		return 1;
+	}
+
+	/* Workers can't interact with the user, so do it here beforehand. */
+	const IoCrs crs = job->arg3.crs;
+	if(args->confirm != NULL &&
+			(crs == IO_CRS_REPLACE_FILES || crs == IO_CRS_REPLACE_ALL) &&
+			path_exists(new_job->dst, NODEREF))
+	{
+		/* Keep workers from drawing progress while user is being asked. */
+		ioeta_lock(args->estim);
+		const int confirmed = args->confirm(&new_job->args, new_job->src,
+				new_job->dst);
+		ioeta_unlock(args->estim);
+
+		if(!confirmed)
+		{
+			free_job(new_job);
+			return 0;
+		}
+	}
+
+	collect(sched, 0);
+	if(sched->failed)
+	{
+		free_job(new_job);
+		return 1;
+	}
+
+	enqueue(sched, new_job);
+	return 0;
+}
+
+int
+iosched_finish(iosched_t *sched)
+{
+	collect(sched, 1);
+
+	pthread_mutex_lock(&sched->lock);
+	sched->stop = 1;
+	pthread_cond_broadcast(&sched->queued);
+	pthread_mutex_unlock(&sched->lock);
+
+	int i;
+	for(i = 0; i < sched->nworkers; ++i)
+	{
+		(void)pthread_join(sched->workers[i], NULL);
+	}
+
+	assert(sched->queue == NULL && sched->done == NULL && "Jobs were lost.");
+
+	const int result = (sched->failed || io_cancelled(sched->args));
+
+	pthread_cond_destroy(&sched->finished);
+	pthread_cond_destroy(&sched->queued);
+	pthread_mutex_destroy(&sched->lock);
+	free(sched);
+
+	return result;
+}
+
+/* Makes a job that inherits most of the arguments from the operation.  Returns
+ * the job or NULL on error. */
+static job_t *
+make_job(iosched_t *sched, iosched_func func, const io_args_t *proto)
+{
+	const io_args_t *const args = sched->args;
+
+	job_t *const job = calloc(1, sizeof(*job));
+	if(job == NULL)
+	{
+		return NULL;
+	}
+
+	job->src = strdup(proto->arg1.src);
+	job->dst = strdup(proto->arg2.dst);
+	if(job->src == NULL || job->dst == NULL)
+	{
+		free_job(job);
+		return NULL;
+	}
+
+	job->func = func;
+	job->args = (io_args_t){
+		.arg1.src = job->src,
+		.arg2.dst = job->dst,
+		.arg3 = proto->arg3,
+		.arg4 = proto->arg4,
+
+		.cancellation = args->cancellation,
+		/* Confirmation is handled by the scheduler. */
+		.confirm = NULL,
+		.estim = args->estim,
+
+		/* Errors are handled by the scheduler. */
+		.result.errors_cb = NULL,
+		.result.errors.active = args->result.errors.active,
+	};
+	return job;
+}
+
+/* Frees the job along with its errors. */
+static void
+free_job(job_t *job)
+{
+	ioe_errlst_free(&job->args.result.errors);
+	free(job->src);
+	free(job->dst);
+	free(job);
+}
+
+/* Puts job at the end of the queue regardless of its length. */
+static void
+enqueue(iosched_t *sched, job_t *job)
+{
+	job->next = NULL;
+
+	pthread_mutex_lock(&sched->lock);
+	*sched->queue_tail = job;
+	sched->queue_tail = &job->next;
+	++sched->nqueued;
+	pthread_cond_signal(&sched->queued);
+	pthread_mutex_unlock(&sched->lock);
+}
+
+/* Discards jobs that weren't picked up by workers yet. */
+static void
+drop_queue(iosched_t *sched)
+{
+	pthread_mutex_lock(&sched->lock);
+	job_t *job = sched->queue;
+	sched->queue = NULL;
+	sched->queue_tail = &sched->queue;
+	sched->nqueued = 0;
+	pthread_mutex_unlock(&sched->lock);
+
+	while(job != NULL)
+	{
+		job_t *const next = job->next;
+		free_job(job);
+		job = next;
+	}
+}
+
+/* Handles finished jobs until there is room in the queue or, if drain is set,
+ * until all jobs are finished. */
+static void
+collect(iosched_t *sched, int drain)
+{
+	while(1)
+	{
+		pthread_mutex_lock(&sched->lock);
+		while(sched->done == NULL)
+		{
+			const int idle = drain
+			               ? (sched->nqueued == 0 && sched->nrunning == 0)
+			               : (sched->nqueued < sched->queue_depth);
+			if(idle)
+			{
+				break;
+			}
+			pthread_cond_wait(&sched->finished, &sched->lock);
+		}
+
+		/* Reverse the list to handle jobs in the order of their completion. */
+		job_t *done = NULL;
+		while(sched->done != NULL)
+		{
+			job_t *const job = sched->done;
+			sched->done = job->next;
+			job->next = done;
+			done = job;
+		}
+		pthread_mutex_unlock(&sched->lock);
+
+		if(done == NULL)
+		{
+			break;
+		}
+
+		while(done != NULL)
+		{
+			job_t *const next = done->next;
+			handle_finished(sched, done);
+			done = next;
+		}
+	}
+}
+
+/* Accounts result of a finished job by either freeing or rescheduling it. */
+static void
+handle_finished(iosched_t *sched, job_t *job)
+{
+	io_args_t *const args = sched->args;
+	ioe_errlst_t *const errors = &job->args.result.errors;
+
+	if(job->result == 0 || sched->failed)
+	{
+		ioe_errlst_splice(&args->result.errors, errors);
+		free_job(job);
+		return;
+	}
+
+	IoErrCbResult response = IO_ECR_BREAK;
+	if(args->result.errors_cb != NULL && errors->error_count != 0U)
+	{
+		/* Keep workers from drawing progress while user is being asked. */
+		ioeta_lock(args->estim);
+		response = args->result.errors_cb(&job->args, &errors->errors[0]);
+		ioeta_unlock(args->estim);
+	}
+
+	switch(response)
+	{
+		case IO_ECR_RETRY:
+			ioe_errlst_free(errors);
+			ioe_errlst_init(errors);
+			errors->active = args->result.errors.active;
+			enqueue(sched, job);
+			return;
+
+		case IO_ECR_IGNORE:
+			/* Pretend that the file was processed to keep progress consistent. */
+			ioeta_update(args->estim, job->src, job->dst, 1, 0);
+			break;
+
+		case IO_ECR_BREAK:
+			sched->failed = 1;
+			drop_queue(sched);
+			break;
+
+		default:
+			assert(0 && "Unknown error handling result.");
+			break;
+	}
+
+	ioe_errlst_splice(&args->result.errors, errors);
+	free_job(job);
+}
+
+/* Entry point of a worker thread.  Processes jobs until told to stop.  Returns
+ * NULL. */
+static void *
+worker_thread(void *arg)
+{
+	iosched_t *const sched = arg;
+
+	block_all_thread_signals();
+
+	pthread_mutex_lock(&sched->lock);
+	while(1)
+	{
+		while(sched->queue == NULL && !sched->stop)
+		{
+			pthread_cond_wait(&sched->queued, &sched->lock);
+		}
+
+		job_t *const job = sched->queue;
+		if(job == NULL)
+		{
+			break;
+		}
+
+		sched->queue = job->next;
+		if(sched->queue == NULL)
+		{
+			sched->queue_tail = &sched->queue;
+		}
+		--sched->nqueued;
+		++sched->nrunning;
+		pthread_mutex_unlock(&sched->lock);
+
+		job->result = io_cancelled(&job->args) ? 1 : job->func(&job->args);
+
+		pthread_mutex_lock(&sched->lock);
+		--sched->nrunning;
+		job->next = sched->done;
+		sched->done = job;
+		pthread_cond_signal(&sched->finished);
+	}
+	pthread_mutex_unlock(&sched->lock);
+
+	return NULL;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
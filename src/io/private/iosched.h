@@ -0,0 +1,56 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__IO__PRIVATE__IOSCHED_H__
+#define VIFM__IO__PRIVATE__IOSCHED_H__
+
+#include "../ioc.h"
+
+/* iosched - Input/Output scheduler of concurrent operations on files */
+
+/* Files are processed by a pool of worker threads while the thread that
+ * schedules them keeps doing everything that needs ordering or user
+ * interaction: it asks for overwrite confirmations before queueing a file and
+ * handles errors of finished files via errors_cb of the operation. */
+
+/* Opaque scheduler type. */
+typedef struct iosched_t iosched_t;
+
+/* Operation on a single file. */
+typedef int (*iosched_func)(io_args_t *args);
+
+/* Starts workers for an operation on a subtree if its concurrency settings
+ * (args->par) ask for it.  Returns the scheduler or NULL if files should be
+ * processed sequentially. */
+iosched_t * iosched_start(io_args_t *args);
+
+/* Schedules processing of src -> dst by func.  The job inherits everything
+ * except for paths, arg3 and arg4 from arguments of the operation.  Blocks
+ * while the queue is full.  Returns zero on success and non-zero if the
+ * operation should be stopped because of an error or cancellation. */
+int iosched_add(iosched_t *sched, iosched_func func, const io_args_t *job);
+
+/* Waits for all scheduled files to be processed, stops workers and frees the
+ * scheduler.  Errors of all files end up in the error list of the operation.
+ * Returns zero if all files were processed successfully. */
+int iosched_finish(iosched_t *sched);
+
+#endif /* VIFM__IO__PRIVATE__IOSCHED_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -47,7 +47,7 @@
 
 #include <errno.h> /* EACCES EEXIST EDQUOT ENOSPC ENXIO errno */
 #include <stddef.h> /* NULL size_t ssize_t */
-#include <stdio.h> /* FILE fclose() fdopen() fread() fwrite() */
+#include <stdio.h> /* FILE fclose() fdopen() fread() fwrite() setvbuf() */
 #include <stdlib.h> /* free() malloc() snprintf() */
 #include <string.h> /* strcmp() strcpy() strlen() */
 
@@ -56,6 +56,7 @@
 #include "utils/log.h"
 #include "utils/macros.h"
 #include "utils/path.h"
+#include "utils/selector.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
 #include "utils/utils.h"
@@ -128,6 +129,12 @@ struct ipc_t
 	char pipe_path[PATH_MAX + 1];
 	/* Opened file of the pipe. */
 	read_pipe_t pipe_file;
+#ifndef WIN32_PIPE_READ
+	/* Write end of our own pipe, which prevents it from signaling end-of-file
+	 * (and thus always being ready for reading) after a writer is gone.  Can
+	 * be -1. */
+	int write_fd;
+#endif
 	/* Holds result of expression evaluation or NULL on evaluation error. */
 	char *eval_result;
 };
@@ -193,6 +200,12 @@ ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb)
 		return NULL;
 	}
 
+#ifndef WIN32_PIPE_READ
+	/* Buffering would hide available data from ipc_add_to_selector(). */
+	(void)setvbuf(ipc->pipe_file, NULL, _IONBF, 0);
+	ipc->write_fd = open(ipc->pipe_path, O_WRONLY | O_NONBLOCK);
+#endif
+
 	return ipc;
 }
 
@@ -205,6 +218,10 @@ ipc_free(ipc_t *ipc)
 	}
 
 #ifndef WIN32_PIPE_READ
+	if(ipc->write_fd != -1)
+	{
+		close(ipc->write_fd);
+	}
 	fclose(ipc->pipe_file);
 	unlink(ipc->pipe_path);
 #else
@@ -240,6 +257,24 @@ ipc_check(ipc_t *ipc)
 	return 0;
 }
 
+int
+ipc_add_to_selector(ipc_t *ipc, selector_t *selector)
+{
+	/* Locked instance doesn't read messages, so there is nothing to wait for. */
+	if(ipc->locked)
+	{
+		return 0;
+	}
+
+#ifndef WIN32_PIPE_READ
+	selector_add(selector, fileno(ipc->pipe_file));
+	return 0;
+#else
+	/* Non-overlapped named pipes can't be waited on. */
+	return 1;
+#endif
+}
+
 /* Receives message addressed to this instance.  Returns NULL if there was no
  * message or on failure to read it, otherwise newly allocated string is
  * returned. */
@@ -938,6 +973,12 @@ ipc_check(ipc_t *ipc)
 	return 0;
 }
 
+int
+ipc_add_to_selector(ipc_t *ipc, struct selector_t *selector)
+{
+	return 0;
+}
+
 int
 ipc_send(ipc_t *ipc, const char whom[], char *data[])
 {
@@ -19,6 +19,8 @@
 #ifndef VIFM__IPC_H__
 #define VIFM__IPC_H__
 
+struct selector_t;
+
 /* Opaque handle type for this unit that represents an IPC instance. */
 typedef struct ipc_t ipc_t;
 
@@ -55,6 +57,11 @@ const char * ipc_get_name(const ipc_t *ipc);
  * non-zero if something was received, otherwise zero is returned. */
 int ipc_check(ipc_t *ipc);
 
+/* Adds pipe of the instance to the selector to be able to wait for incoming
+ * messages instead of calling ipc_check() periodically.  Returns non-zero if
+ * the instance still needs to be polled. */
+int ipc_add_to_selector(ipc_t *ipc, struct selector_t *selector);
+
 /* Sends data to server.  If whom argument is NULL, target instance is
  * automatically determined.  The data array should end with NULL.  Returns zero
  * on successful send and non-zero otherwise. */
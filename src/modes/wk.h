@@ -148,6 +148,8 @@
 
 /* Character form for use in aggregate initializers of wide strings or direct
  * comparisons. */
+#define WC_C_b L'\x02'
+#define WC_C_f L'\x06'
 #define WC_C_m L'\x0d'
 #define WC_C_w L'\x17'
 #define WC_C_z L'\x1a'
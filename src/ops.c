@@ -173,6 +173,8 @@ ops_alloc(OPS main_op, int bg, const char descr[], const char base_dir[],
 	update_string(&ops->delete_prg, cfg.delete_prg);
 	ops->use_system_calls = cfg.use_system_calls;
 	ops->fast_file_cloning = cfg.fast_file_cloning;
+	ops->dense_copy = cfg.dense_copy;
+	ops->io_jobs = cfg.io_jobs;
 	ops->base_dir = strdup(base_dir);
 	ops->target_dir = strdup(target_dir);
 	ops->bg = bg;
@@ -196,7 +198,7 @@ ops_enqueue(ops_t *ops, const char src[], const char dst[])
 	}
 
 	/* Check once and cache result, it should be the same for each invocation. */
-	if(ops->estim->total_items == 0)
+	if(ops->total == 1)
 	{
 		switch(ops->main_op)
 		{
@@ -232,7 +234,9 @@ ops_enqueue(ops_t *ops, const char src[], const char dst[])
 		}
 	}
 
-	ioeta_calculate(ops->estim, src, ops->shallow_eta);
+	/* Operation doesn't wait for estimation, totals are filled in as files are
+	 * discovered. */
+	ioeta_calculate_bg(ops->estim, src, ops->shallow_eta);
 }
 
 void
@@ -448,6 +452,8 @@ op_cp(ops_t *ops, void *data, const char src[], const char dst[],
 	const int fast_file_cloning = (ops == NULL)
 	                             ? cfg.fast_file_cloning
 	                             : ops->fast_file_cloning;
+	const int dense_copy = (ops == NULL) ? cfg.dense_copy : ops->dense_copy;
+	const int io_jobs = (ops == NULL) ? cfg.io_jobs : ops->io_jobs;
 
 	if(!ops_uses_syscalls(ops))
 	{
@@ -518,6 +524,8 @@ op_cp(ops_t *ops, void *data, const char src[], const char dst[],
 		.arg2.dst = dst,
 		.arg3.crs = ca_to_crs(conflict_action),
 		.arg4.fast_file_cloning = fast_file_cloning,
+		.arg4.dense_copy = dense_copy,
+		.par.nworkers = io_jobs,
 	};
 	return exec_io_op(ops, &ior_cp, &args, data == NULL);
 }
@@ -619,6 +627,7 @@ op_mv(ops_t *ops, void *data, const char src[], const char dst[],
 			.arg3.crs = ca_to_crs(conflict_action),
 			/* It's safe to always use fast file cloning on moving files. */
 			.arg4.fast_file_cloning = 1,
+			.par.nworkers = (ops == NULL) ? cfg.io_jobs : ops->io_jobs,
 		};
 		result = exec_io_op(ops, &ior_mv, &args, data == NULL);
 	}
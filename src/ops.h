@@ -95,6 +95,8 @@ typedef struct
 	char *delete_prg;      /* Copy of 'deleteprg' option value. */
 	int use_system_calls;  /* Copy of 'syscalls' option value. */
 	int fast_file_cloning; /* Copy of part of 'iooptions' option value. */
+	int dense_copy;        /* Copy of part of 'iooptions' option value. */
+	int io_jobs;           /* Copy of 'iojobs' option value. */
 
 	char *base_dir;   /* Base directory in which operation is taking place. */
 	char *target_dir; /* Target directory of the operation (same as base_dir if
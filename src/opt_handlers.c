@@ -139,6 +139,7 @@ static void hlsearch_handler(OPT_OP op, optval_t val);
 static void iec_handler(OPT_OP op, optval_t val);
 static void ignorecase_handler(OPT_OP op, optval_t val);
 static void incsearch_handler(OPT_OP op, optval_t val);
+static void iojobs_handler(OPT_OP op, optval_t val);
 static void iooptions_handler(OPT_OP op, optval_t val);
 static void laststatus_handler(OPT_OP op, optval_t val);
 static void lines_handler(OPT_OP op, optval_t val);
@@ -359,6 +360,7 @@ ARRAY_GUARD(suggestoptions_vals, NUM_SUGGESTION_FLAGS);
 /* Possible flags of 'iooptions'. */
 static const char *iooptions_vals[][2] = {
 	{ "fastfilecloning", "use COW if FS supports it" },
+	{ "densecopy",       "fill holes of sparse files on copying" },
 };
 
 /* Possible flags of 'shortmess' and their count. */
@@ -682,6 +684,10 @@ options[] = {
 	  OPT_BOOL, 0, NULL, &incsearch_handler , NULL,
 	  { .ref.bool_val = &cfg.inc_search },
 	},
+	{ "iojobs", "", "number of files copied at once",
+	  OPT_INT, 0, NULL, &iojobs_handler, NULL,
+	  { .ref.int_val = &cfg.io_jobs },
+	},
 	{ "iooptions", "", "file I/O settings",
 	  OPT_SET, ARRAY_LEN(iooptions_vals), iooptions_vals, &iooptions_handler,
 		NULL,
@@ -1224,7 +1230,8 @@ init_sizefmt(optval_t *val)
 static void
 init_iooptions(optval_t *val)
 {
-	val->set_items = (cfg.fast_file_cloning != 0) << 0;
+	val->set_items = ((cfg.fast_file_cloning != 0) << 0)
+	               | ((cfg.dense_copy != 0) << 1);
 }
 
 /* Default-initializes whether to display file numbers. */
@@ -2170,11 +2177,27 @@ incsearch_handler(OPT_OP op, optval_t val)
 	cfg.inc_search = val.bool_val;
 }
 
+/* Handles changes of 'iojobs'.  Rejects non-positive values. */
+static void
+iojobs_handler(OPT_OP op, optval_t val)
+{
+	if(val.int_val <= 0)
+	{
+		vle_tb_append_linef(vle_err, "Argument must be positive: %d", val.int_val);
+		error = 1;
+		vle_opts_restore_default("iojobs", OPT_GLOBAL);
+		return;
+	}
+
+	cfg.io_jobs = val.int_val;
+}
+
 /* Handles changes of 'iooptions'.  Updates related configuration values. */
 static void
 iooptions_handler(OPT_OP op, optval_t val)
 {
 	cfg.fast_file_cloning = ((val.set_items & 1) != 0);
+	cfg.dense_copy = ((val.set_items & 2) != 0);
 }
 
 static void
@@ -2528,6 +2551,15 @@ static void
 slowfs_handler(OPT_OP op, optval_t val)
 {
 	(void)replace_string(&cfg.slow_fs_list, val.str_val);
+
+	/* Whether targets of links are checked depends on the value. */
+	int i;
+	tab_info_t tab_info;
+	for(i = 0; tabs_enum_all(i, &tab_info); ++i)
+	{
+		ui_view_reset_link_cache(tab_info.view);
+		ui_view_schedule_redraw(tab_info.view);
+	}
 }
 #endif
 
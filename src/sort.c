@@ -23,15 +23,20 @@
 
 #include <assert.h> /* assert() */
 #include <ctype.h>
-#include <stdlib.h> /* abs() */
-#include <string.h> /* strcmp() strrchr() */
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* int64_t uint64_t */
+#include <stdlib.h> /* abs() free() realloc() */
+#include <string.h> /* memcpy() strcmp() strlen() strrchr() */
 
 #include "cfg/config.h"
 #include "compat/fs_limits.h"
+#include "compat/reallocarray.h"
 #include "ui/ui.h"
 #include "utils/dynarray.h"
 #include "utils/fs.h"
 #include "utils/fsdata.h"
+#include "utils/macros.h"
+#include "utils/parallel.h"
 #include "utils/path.h"
 #include "utils/regexp.h"
 #include "utils/str.h"
@@ -43,14 +48,87 @@
 #include "status.h"
 #include "types.h"
 
+/* Marker of absent string in sort_rec_t. */
+#define NO_STR ((size_t)-1)
+
+/* Minimal number of records with string keys to sort them on several threads.
+ * Smaller lists are sorted faster than threads can be started. */
+#define PAR_SORT_MIN 32768U
+
+/* Precomputed sorting key of an entry for a single sorting round. */
+typedef struct
+{
+	uint64_t num;    /* Numeric key or the most significant part of the key. */
+	uint64_t prefix; /* First bytes of str for comparing it faster or zero. */
+	size_t str;      /* Offset of string part of the key in pool or NO_STR. */
+	size_t orig;     /* Offset of a string that breaks ties of str or NO_STR. */
+	size_t index;    /* Position of the entry before sorting. */
+}
+sort_rec_t;
+
+/* State of sorting a sequence of entries in several rounds.  Rounds reorder
+ * indexes of entries, which are moved only once in the end. */
+typedef struct
+{
+	dir_entry_t *entries; /* Entries being sorted. */
+	size_t nentries;      /* Number of entries. */
+	size_t *order;        /* Current order of entries or NULL if not used. */
+	size_t *new_order;    /* Scratch space for the next order. */
+	sort_rec_t *recs;     /* Keys of entries. */
+	sort_rec_t *buf;      /* Scratch space for sorting keys. */
+}
+sort_seq_t;
+
+/* Storage of strings of sorting keys. */
+typedef struct
+{
+	char *data;  /* Strings one after another. */
+	size_t len;  /* Number of used bytes. */
+	size_t cap;  /* Number of allocated bytes. */
+	int error;   /* Whether allocation has failed. */
+}
+key_pool_t;
+
+/* Single pass of merging pairs of adjacent sorted runs of records. */
+typedef struct
+{
+	const sort_rec_t *from; /* Source runs. */
+	sort_rec_t *to;         /* Destination of merged runs. */
+	size_t nrecs;           /* Total number of records. */
+	size_t width;           /* Length of a run (the last one can be shorter). */
+}
+merge_pass_t;
+
 static void sort_tree_slice(dir_entry_t *entries, const dir_entry_t *children,
 		size_t nchildren, int root);
 static void sort_sequence(dir_entry_t *entries, size_t nentries);
-static void sort_by_groups(dir_entry_t *entries, signed char key,
+static void sort_by_groups(sort_seq_t *seq, signed char key);
+static void sort_by_key(sort_seq_t *seq, signed char key, void *data);
+static int init_sort_seq(sort_seq_t *seq, dir_entry_t *entries,
 		size_t nentries);
-static void sort_by_key(dir_entry_t *entries, size_t nentries, signed char key,
-		void *data);
+static void finish_sort_seq(sort_seq_t *seq);
+static int sort_order_by_key(sort_seq_t *seq);
+static void extract_key(const dir_entry_t *entry, sort_rec_t *rec,
+		key_pool_t *pool, const int type_ranks[]);
+static void set_name_key(sort_rec_t *rec, key_pool_t *pool, const char name[],
+		int ignore_case);
+static void set_str_key(sort_rec_t *rec, key_pool_t *pool, const char str[]);
+static size_t add_key_str(key_pool_t *pool, const char str[]);
+static uint64_t time_key(time_t t);
+static void radix_sort(sort_rec_t recs[], sort_rec_t buf[], size_t nrecs);
+static void sort_recs(sort_rec_t recs[], sort_rec_t buf[], size_t nrecs);
+static void sort_chunk(size_t from, size_t to, void *arg);
+static void merge_range(size_t from, size_t to, void *arg);
+static size_t co_rank(size_t k, const sort_rec_t a[], size_t na,
+		const sort_rec_t b[], size_t nb);
+static int compare_recs(const void *one, const void *two);
 static int sort_dir_list(const void *one, const void *two);
+static int compare_entries(const dir_entry_t *first,
+		const dir_entry_t *second);
+static int compare_by_all_keys(const dir_entry_t *first,
+		const dir_entry_t *second);
+static int compare_by_key(const dir_entry_t *first, const dir_entry_t *second,
+		signed char key);
 TSTATIC int strnumcmp(const char s[], const char t[]);
 #if !defined(HAVE_STRVERSCMP_FUNC) || !HAVE_STRVERSCMP_FUNC
 static int vercmp(const char s[], const char t[]);
@@ -82,6 +160,10 @@ static int sort_descending;
 static SortingKey sort_type;
 /* Sorting key specific data. */
 static void *sort_data;
+/* Strings of keys of current sorting round for compare_recs(). */
+static const char *key_strs;
+/* Comparer of string parts of keys of current sorting round. */
+static int (*key_strcmp)(const char s[], const char t[]);
 
 void
 sort_view(view_t *v)
@@ -175,6 +257,114 @@ sort_tree_slice(dir_entry_t *entries, const dir_entry_t *children,
 	}
 }
 
+int
+sort_insert_entries(view_t *v, dir_entry_t entries[], int count)
+{
+	if(count == 0)
+	{
+		return 0;
+	}
+
+	dir_entry_t *const merged = dynarray_extend(NULL,
+			(v->list_rows + count)*sizeof(*merged));
+	if(merged == NULL)
+	{
+		return 1;
+	}
+
+	view = v;
+	view_sort = v->sort;
+	view_sort_groups = v->sort_groups;
+	custom_view = flist_custom_active(v);
+
+	/* Sorting by groups takes several rounds per key and trees have structure,
+	 * so just sort everything from scratch in these cases. */
+	const int full_sort = v->sort[0] > SK_LAST
+	                   || ui_view_sort_list_contains(v->sort, SK_BY_GROUPS)
+	                   || (custom_view && cv_tree(v->custom.type));
+
+	if(!full_sort)
+	{
+		sort_sequence(entries, count);
+	}
+
+	/* New entries go after existing ones that compare equal to them. */
+	int i = 0, j = 0, k = 0;
+	while(j < count)
+	{
+		if(i < v->list_rows && (full_sort ||
+					compare_by_all_keys(&v->dir_entry[i], &entries[j]) <= 0))
+		{
+			merged[k++] = v->dir_entry[i++];
+		}
+		else
+		{
+			merged[k++] = entries[j++];
+		}
+	}
+	while(i < v->list_rows)
+	{
+		merged[k++] = v->dir_entry[i++];
+	}
+
+	dynarray_free(v->dir_entry);
+	v->dir_entry = merged;
+	v->list_rows += count;
+
+	if(full_sort)
+	{
+		sort_view(v);
+	}
+	return 0;
+}
+
+/* Compares two entries by all sorting keys in order of their significance.
+ * Returns standard -1, 0, 1 for comparisons. */
+static int
+compare_by_all_keys(const dir_entry_t *first, const dir_entry_t *second)
+{
+	int retval;
+
+	if(!ui_view_sort_list_contains(view_sort, SK_BY_DIR))
+	{
+		retval = compare_by_key(first, second, SK_BY_DIR);
+		if(retval != 0)
+		{
+			return retval;
+		}
+	}
+
+	int i;
+	for(i = 0; i < SK_COUNT; ++i)
+	{
+		if(abs(view_sort[i]) > SK_LAST)
+		{
+			continue;
+		}
+
+		retval = compare_by_key(first, second, view_sort[i]);
+		if(retval != 0)
+		{
+			return retval;
+		}
+	}
+
+	return 0;
+}
+
+/* Compares two entries by a single sorting key.  Returns standard -1, 0, 1 for
+ * comparisons. */
+static int
+compare_by_key(const dir_entry_t *first, const dir_entry_t *second,
+		signed char key)
+{
+	sort_descending = (key < 0);
+	sort_type = (SortingKey)abs(key);
+	sort_data = NULL;
+
+	return compare_entries(first, second);
+}
+
 void
 sort_entries(view_t *v, entries_t entries)
 {
@@ -196,6 +386,9 @@ sort_entries(view_t *v, entries_t entries)
 static void
 sort_sequence(dir_entry_t *entries, size_t nentries)
 {
+	sort_seq_t seq;
+	(void)init_sort_seq(&seq, entries, nentries);
+
 	int i = SK_COUNT;
 	while(--i >= 0)
 	{
@@ -209,22 +402,24 @@ sort_sequence(dir_entry_t *entries, size_t nentries)
 
 		if(sorting_type == SK_BY_GROUPS)
 		{
-			sort_by_groups(entries, sorting_key, nentries);
+			sort_by_groups(&seq, sorting_key);
 			continue;
 		}
 
-		sort_by_key(entries, nentries, sorting_key, NULL);
+		sort_by_key(&seq, sorting_key, NULL);
 	}
 
 	if(!ui_view_sort_list_contains(view_sort, SK_BY_DIR))
 	{
-		sort_by_key(entries, nentries, SK_BY_DIR, NULL);
+		sort_by_key(&seq, SK_BY_DIR, NULL);
 	}
+
+	finish_sort_seq(&seq);
 }
 
 /* Sorts specified range of entries according to sorting groups option. */
 static void
-sort_by_groups(dir_entry_t *entries, signed char key, size_t nentries)
+sort_by_groups(sort_seq_t *seq, signed char key)
 {
 	char **groups = NULL;
 	int ngroups = 0;
@@ -243,32 +438,583 @@ sort_by_groups(dir_entry_t *entries, signed char key, size_t nentries)
 	{
 		regex_t regex;
 		(void)regcomp(&regex, groups[i], REG_EXTENDED | REG_ICASE);
-		sort_by_key(entries, nentries, key, &regex);
+		sort_by_key(seq, key, &regex);
 		regfree(&regex);
 	}
 	if(optimize && ngroups != 0)
 	{
-		sort_by_key(entries, nentries, key, &view->primary_group);
+		sort_by_key(seq, key, &view->primary_group);
 	}
 
 	free_string_array(groups, ngroups);
 }
 
-/* Sorts specified range of entries by the key in a stable way. */
+/* Sorts entries of the sequence by the key in a stable way. */
 static void
-sort_by_key(dir_entry_t *entries, size_t nentries, signed char key, void *data)
+sort_by_key(sort_seq_t *seq, signed char key, void *data)
 {
 	sort_descending = (key < 0);
 	sort_type = (SortingKey)abs(key);
 	sort_data = data;
 
+	if(seq->order != NULL && sort_order_by_key(seq) == 0)
+	{
+		return;
+	}
+
+	/* Comparing entries directly is slower, but needs no extra memory. */
+	finish_sort_seq(seq);
+
 	unsigned int i;
+	for(i = 0U; i < seq->nentries; ++i)
+	{
+		seq->entries[i].tag = i;
+	}
+
+	safe_qsort(seq->entries, seq->nentries, sizeof(*seq->entries),
+			&sort_dir_list);
+}
+
+/* Prepares for sorting of entries by precomputed keys.  On failure, entries
+ * will be sorted directly.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+init_sort_seq(sort_seq_t *seq, dir_entry_t *entries, size_t nentries)
+{
+	seq->entries = entries;
+	seq->nentries = nentries;
+	seq->order = reallocarray(NULL, nentries, sizeof(*seq->order));
+	seq->new_order = reallocarray(NULL, nentries, sizeof(*seq->new_order));
+	seq->recs = reallocarray(NULL, nentries, sizeof(*seq->recs));
+	seq->buf = reallocarray(NULL, nentries, sizeof(*seq->buf));
+
+	if(seq->order == NULL || seq->new_order == NULL || seq->recs == NULL ||
+			seq->buf == NULL)
+	{
+		finish_sort_seq(seq);
+		return 1;
+	}
+
+	size_t i;
 	for(i = 0U; i < nentries; ++i)
 	{
-		entries[i].tag = i;
+		seq->order[i] = i;
+	}
+	return 0;
+}
+
+/* Moves entries according to the order computed so far and frees resources
+ * used for sorting by precomputed keys. */
+static void
+finish_sort_seq(sort_seq_t *seq)
+{
+	if(seq->order != NULL)
+	{
+		/* Permute entries in place by following cycles of the permutation. */
+		size_t i;
+		for(i = 0U; i < seq->nentries; ++i)
+		{
+			if(seq->order[i] == i)
+			{
+				continue;
+			}
+
+			const dir_entry_t tmp = seq->entries[i];
+			size_t j = i;
+			while(seq->order[j] != i)
+			{
+				const size_t next = seq->order[j];
+				seq->entries[j] = seq->entries[next];
+				seq->order[j] = j;
+				j = next;
+			}
+			seq->entries[j] = tmp;
+			seq->order[j] = j;
+		}
 	}
 
-	safe_qsort(entries, nentries, sizeof(*entries), &sort_dir_list);
+	free(seq->order);
+	free(seq->new_order);
+	free(seq->recs);
+	free(seq->buf);
+	seq->order = NULL;
+	seq->new_order = NULL;
+	seq->recs = NULL;
+	seq->buf = NULL;
+}
+
+/* Reorders entries of the sequence by the key of the current sorting round in a
+ * stable way by computing keys once per entry and sorting them instead of
+ * entries.  Returns zero on success and non-zero on memory error, in which
+ * case order of entries is left unchanged. */
+static int
+sort_order_by_key(sort_seq_t *seq)
+{
+	/* Ranks of type names, which are compared as strings. */
+	int type_ranks[FT_COUNT];
+	int i, j;
+	for(i = 0; i < FT_COUNT; ++i)
+	{
+		type_ranks[i] = 0;
+		for(j = 0; j < FT_COUNT; ++j)
+		{
+			type_ranks[i] += (strcmp(get_type_str(j), get_type_str(i)) < 0);
+		}
+	}
+
+	/* Parent directory always comes first and isn't subject to sorting.  Index
+	 * of a record is position of its entry in the current order. */
+	key_pool_t pool = { };
+	size_t nparents = 0U, nrecs = 0U;
+	size_t k;
+	for(k = 0U; k < seq->nentries; ++k)
+	{
+		const dir_entry_t *const entry = &seq->entries[seq->order[k]];
+		if(fentry_is_dir(entry) && is_parent_dir(entry->name))
+		{
+			seq->new_order[nparents++] = seq->order[k];
+			continue;
+		}
+
+		seq->recs[nrecs].index = k;
+		extract_key(entry, &seq->recs[nrecs], &pool, type_ranks);
+		++nrecs;
+	}
+
+	if(pool.error)
+	{
+		free(pool.data);
+		return 1;
+	}
+
+	if(pool.data != NULL)
+	{
+		key_strs = pool.data;
+		sort_recs(seq->recs, seq->buf, nrecs);
+		key_strs = NULL;
+		free(pool.data);
+	}
+	else
+	{
+		if(sort_descending)
+		{
+			for(k = 0U; k < nrecs; ++k)
+			{
+				seq->recs[k].num = ~seq->recs[k].num;
+			}
+		}
+		radix_sort(seq->recs, seq->buf, nrecs);
+	}
+
+	for(k = 0U; k < nrecs; ++k)
+	{
+		seq->new_order[nparents + k] = seq->order[seq->recs[k].index];
+	}
+
+	size_t *const tmp = seq->order;
+	seq->order = seq->new_order;
+	seq->new_order = tmp;
+	return 0;
+}
+
+/* Computes key of the entry for the current sorting round.  Errors are
+ * reported via the pool. */
+static void
+extract_key(const dir_entry_t *entry, sort_rec_t *rec, key_pool_t *pool,
+		const int type_ranks[])
+{
+	const int is_dir = fentry_is_dir(entry);
+
+	rec->num = 0U;
+	rec->prefix = 0U;
+	rec->str = NO_STR;
+	rec->orig = NO_STR;
+
+	switch(sort_type)
+	{
+		const char *dot;
+		char buf[PATH_MAX + 1];
+
+		case SK_BY_NAME:
+		case SK_BY_INAME:
+			{
+				const char *name = entry->name;
+				if(custom_view)
+				{
+					get_short_path_of(view, entry, NF_NONE, 0, sizeof(buf), buf);
+					name = buf;
+				}
+				/* Dot files go first. */
+				rec->num = (name[0] != '.');
+				set_name_key(rec, pool, name, sort_type == SK_BY_INAME);
+			}
+			break;
+
+		case SK_BY_DIR:
+			rec->num = !is_dir;
+			break;
+
+		case SK_BY_TYPE:
+			rec->num = type_ranks[entry->type];
+			break;
+
+		case SK_BY_FILEEXT:
+		case SK_BY_EXTENSION:
+			dot = strrchr(entry->name, '.');
+			if(is_dir && sort_type == SK_BY_FILEEXT)
+			{
+				/* Directories go first and are sorted by name. */
+				set_name_key(rec, pool, entry->name, 0);
+			}
+			else if(dot == NULL)
+			{
+				rec->num = 3;
+				set_name_key(rec, pool, entry->name, 0);
+			}
+			else
+			{
+				/* Dot files without extension precede files with extension. */
+				rec->num = (dot == entry->name) ? 1 : 2;
+				set_name_key(rec, pool, dot + 1, 0);
+			}
+			break;
+
+		case SK_BY_SIZE:
+			rec->num = fentry_get_size(view, entry);
+			break;
+
+		case SK_BY_NITEMS:
+			/* Not calling fentry_get_nitems() for files on purpose as it's not
+			 * cheap. */
+			rec->num = is_dir ? fentry_get_nitems(view, entry) : 0U;
+			break;
+
+		case SK_BY_GROUPS:
+			{
+				const regmatch_t match = get_group_match(sort_data, entry->name);
+				copy_str(buf, MIN(NAME_MAX + 1U, (size_t)match.rm_eo - match.rm_so + 1U),
+						entry->name + match.rm_so);
+				key_strcmp = &strcmp;
+				set_str_key(rec, pool, buf);
+			}
+			break;
+
+		case SK_BY_TARGET:
+			/* Symbolic links go after other files, which are equal. */
+			rec->num = (entry->type == FT_LINK);
+			if(entry->type == FT_LINK)
+			{
+				char full_path[PATH_MAX + 1];
+				get_full_path_of(entry, sizeof(full_path), full_path);
+				if(get_link_target(full_path, buf, sizeof(buf)) != 0)
+				{
+					buf[0] = '\0';
+				}
+				key_strcmp = &stroscmp;
+				set_str_key(rec, pool, buf);
+			}
+			break;
+
+		case SK_BY_TIME_MODIFIED:
+			rec->num = time_key(entry->mtime);
+			break;
+
+		case SK_BY_TIME_ACCESSED:
+			rec->num = time_key(entry->atime);
+			break;
+
+		case SK_BY_TIME_CHANGED:
+			rec->num = time_key(entry->ctime);
+			break;
+
+#ifndef _WIN32
+		case SK_BY_MODE:
+			rec->num = entry->mode;
+			break;
+
+		case SK_BY_INODE:
+			rec->num = entry->inode;
+			break;
+
+		case SK_BY_OWNER_NAME: /* FIXME */
+		case SK_BY_OWNER_ID:
+			rec->num = entry->uid;
+			break;
+
+		case SK_BY_GROUP_NAME: /* FIXME */
+		case SK_BY_GROUP_ID:
+			rec->num = entry->gid;
+			break;
+
+		case SK_BY_PERMISSIONS:
+			get_perm_string(buf, sizeof(buf), entry->mode);
+			key_strcmp = &strcmp;
+			set_str_key(rec, pool, buf);
+			break;
+
+		case SK_BY_NLINKS:
+			rec->num = entry->nlinks;
+			break;
+#endif
+	}
+}
+
+/* Sets string part of a key that is a file name or its part to be compared
+ * like compare_file_names() does it. */
+static void
+set_name_key(sort_rec_t *rec, key_pool_t *pool, const char name[],
+		int ignore_case)
+{
+	key_strcmp = cfg.sort_numbers ? &strnumcmp : &strcmp;
+
+	if(ignore_case)
+	{
+		/* Ignore too small buffer errors by not caring about part that didn't
+		 * fit. */
+		char lower[NAME_MAX + 1];
+		(void)str_to_lower(name, lower, sizeof(lower));
+		set_str_key(rec, pool, lower);
+		rec->orig = add_key_str(pool, name);
+	}
+	else
+	{
+		set_str_key(rec, pool, name);
+	}
+}
+
+/* Sets string part of a key.  key_strcmp should be set beforehand. */
+static void
+set_str_key(sort_rec_t *rec, key_pool_t *pool, const char str[])
+{
+	rec->str = add_key_str(pool, str);
+
+	/* Prefix compares in the same way as strcmp() does, other comparers aren't
+	 * that simple. */
+	if(key_strcmp == &strcmp)
+	{
+		int i;
+		for(i = 0; i < 8; ++i)
+		{
+			rec->prefix <<= 8;
+			if(*str != '\0')
+			{
+				rec->prefix |= (unsigned char)*str++;
+			}
+		}
+	}
+}
+
+/* Appends the string to the pool.  Returns offset of the string in the pool or
+ * NO_STR on error. */
+static size_t
+add_key_str(key_pool_t *pool, const char str[])
+{
+	const size_t len = strlen(str) + 1U;
+	if(pool->len + len > pool->cap)
+	{
+		const size_t cap = MAX(pool->cap*2U, pool->len + len + 4096U);
+		char *const data = realloc(pool->data, cap);
+		if(data == NULL)
+		{
+			pool->error = 1;
+			return NO_STR;
+		}
+		pool->data = data;
+		pool->cap = cap;
+	}
+
+	const size_t offset = pool->len;
+	memcpy(pool->data + offset, str, len);
+	pool->len += len;
+	return offset;
+}
+
+/* Maps time to an unsigned number that preserves order.  Returns the number. */
+static uint64_t
+time_key(time_t t)
+{
+	return (uint64_t)(int64_t)t ^ ((uint64_t)1 << 63);
+}
+
+/* Sorts records by their numeric keys in a stable way via LSD radix sort using
+ * a buffer of the same size. */
+static void
+radix_sort(sort_rec_t recs[], sort_rec_t buf[], size_t nrecs)
+{
+	if(nrecs < 2U)
+	{
+		return;
+	}
+
+	sort_rec_t *from = recs, *to = buf;
+	int shift;
+	for(shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = { };
+		size_t i;
+		for(i = 0U; i < nrecs; ++i)
+		{
+			++counts[(from[i].num >> shift) & 0xff];
+		}
+
+		/* Skip the pass if all keys have the same digit. */
+		if(counts[(from[0].num >> shift) & 0xff] == nrecs)
+		{
+			continue;
+		}
+
+		size_t pos = 0U;
+		for(i = 0U; i < 256U; ++i)
+		{
+			const size_t count = counts[i];
+			counts[i] = pos;
+			pos += count;
+		}
+
+		for(i = 0U; i < nrecs; ++i)
+		{
+			to[counts[(from[i].num >> shift) & 0xff]++] = from[i];
+		}
+
+		sort_rec_t *const tmp = from;
+		from = to;
+		to = tmp;
+	}
+
+	if(from != recs)
+	{
+		memcpy(recs, from, sizeof(*recs)*nrecs);
+	}
+}
+
+/* Sorts records with string keys.  Long lists are split into chunks that are
+ * sorted on separate threads and then merged pairwise with every merge being
+ * split among threads as well.  Records never compare equal, so the result is
+ * the same as that of sorting on a single thread. */
+static void
+sort_recs(sort_rec_t recs[], sort_rec_t buf[], size_t nrecs)
+{
+	const size_t nworkers = par_get_nworkers();
+	if(nrecs < PAR_SORT_MIN || nworkers < 2U)
+	{
+		safe_qsort(recs, nrecs, sizeof(*recs), &compare_recs);
+		return;
+	}
+
+	const size_t chunk = DIV_ROUND_UP(nrecs, nworkers);
+	par_for(nrecs, chunk, &sort_chunk, recs);
+
+	merge_pass_t pass = { .from = recs, .to = buf, .nrecs = nrecs };
+	for(pass.width = chunk; pass.width < nrecs; pass.width *= 2U)
+	{
+		par_for(nrecs, chunk, &merge_range, &pass);
+
+		sort_rec_t *const tmp = (sort_rec_t *)pass.from;
+		pass.from = pass.to;
+		pass.to = tmp;
+	}
+
+	if(pass.from != recs)
+	{
+		memcpy(recs, pass.from, sizeof(*recs)*nrecs);
+	}
+}
+
+/* par_for() callback that sorts a chunk of records. */
+static void
+sort_chunk(size_t from, size_t to, void *arg)
+{
+	sort_rec_t *const recs = arg;
+	safe_qsort(recs + from, to - from, sizeof(*recs), &compare_recs);
+}
+
+/* par_for() callback that produces [from; to) part of the output of a merge
+ * pass.  The range can span several pairs of runs. */
+static void
+merge_range(size_t from, size_t to, void *arg)
+{
+	const merge_pass_t *const pass = arg;
+
+	while(from < to)
+	{
+		const size_t start = from - from%(pass->width*2U);
+		const size_t mid = MIN(start + pass->width, pass->nrecs);
+		const size_t end = MIN(mid + pass->width, pass->nrecs);
+		const size_t stop = MIN(to, end);
+
+		const sort_rec_t *const a = pass->from + start;
+		const sort_rec_t *const b = pass->from + mid;
+		const size_t na = mid - start, nb = end - mid;
+
+		size_t i = co_rank(from - start, a, na, b, nb);
+		size_t j = (from - start) - i;
+		for(; from < stop; ++from)
+		{
+			if(j >= nb || (i < na && compare_recs(&a[i], &b[j]) < 0))
+			{
+				pass->to[from] = a[i++];
+			}
+			else
+			{
+				pass->to[from] = b[j++];
+			}
+		}
+	}
+}
+
+/* Finds how many of the first k records of the merge of two sorted runs come
+ * from the first one.  Returns the number. */
+static size_t
+co_rank(size_t k, const sort_rec_t a[], size_t na, const sort_rec_t b[],
+		size_t nb)
+{
+	size_t lo = (k > nb) ? k - nb : 0U;
+	size_t hi = MIN(k, na);
+	while(lo < hi)
+	{
+		const size_t i = lo + (hi - lo)/2U;
+		if(compare_recs(&a[i], &b[k - i - 1U]) < 0)
+		{
+			lo = i + 1U;
+		}
+		else
+		{
+			hi = i;
+		}
+	}
+	return lo;
+}
+
+/* qsort() comparer of records with string keys.  Returns standard -1, 0, 1 for
+ * comparisons. */
+static int
+compare_recs(const void *one, const void *two)
+{
+	const sort_rec_t *const a = one;
+	const sort_rec_t *const b = two;
+
+	int retval = (a->num > b->num) - (a->num < b->num);
+	if(retval == 0 && a->prefix != b->prefix)
+	{
+		retval = (a->prefix > b->prefix) ? 1 : -1;
+	}
+	else if(retval == 0 && a->str != NO_STR && b->str != NO_STR)
+	{
+		retval = key_strcmp(key_strs + a->str, key_strs + b->str);
+		if(retval == 0 && a->orig != NO_STR && b->orig != NO_STR)
+		{
+			/* Resort to comparing original names when their normalized versions
+			 * match to always solve ties in deterministic way. */
+			retval = strcmp(key_strs + a->orig, key_strs + b->orig);
+		}
+	}
+
+	if(sort_descending)
+	{
+		retval = -retval;
+	}
+
+	return (retval != 0) ? retval : (a->index > b->index) - (a->index < b->index);
 }
 
 /* Compares file names containing numbers correctly. */
@@ -335,12 +1081,26 @@ skip_leading_zeros(const char str[])
 static int
 sort_dir_list(const void *one, const void *two)
 {
-	/* TODO: refactor this function sort_dir_list(). */
-
-	int retval;
 	const dir_entry_t *const first = one;
 	const dir_entry_t *const second = two;
 
+	int retval = compare_entries(first, second);
+	if(retval == 0)
+	{
+		retval = first->tag - second->tag;
+	}
+	return retval;
+}
+
+/* Compares two entries by the key and data of the current sorting round.
+ * Returns standard -1, 0, 1 for comparisons. */
+static int
+compare_entries(const dir_entry_t *first, const dir_entry_t *second)
+{
+	/* TODO: refactor this function compare_entries(). */
+
+	int retval;
+
 	const int first_is_dir = fentry_is_dir(first);
 	const int second_is_dir = fentry_is_dir(second);
 
@@ -433,34 +1193,34 @@ sort_dir_list(const void *one, const void *two)
 			break;
 
 		case SK_BY_TIME_MODIFIED:
-			retval = first->mtime - second->mtime;
+			retval = (first->mtime > second->mtime) - (first->mtime < second->mtime);
 			break;
 
 		case SK_BY_TIME_ACCESSED:
-			retval = first->atime - second->atime;
+			retval = (first->atime > second->atime) - (first->atime < second->atime);
 			break;
 
 		case SK_BY_TIME_CHANGED:
-			retval = first->ctime - second->ctime;
+			retval = (first->ctime > second->ctime) - (first->ctime < second->ctime);
 			break;
 
 #ifndef _WIN32
 		case SK_BY_MODE:
-			retval = first->mode - second->mode;
+			retval = (first->mode > second->mode) - (first->mode < second->mode);
 			break;
 
 		case SK_BY_INODE:
-			retval = first->inode - second->inode;
+			retval = (first->inode > second->inode) - (first->inode < second->inode);
 			break;
 
 		case SK_BY_OWNER_NAME: /* FIXME */
 		case SK_BY_OWNER_ID:
-			retval = first->uid - second->uid;
+			retval = (first->uid > second->uid) - (first->uid < second->uid);
 			break;
 
 		case SK_BY_GROUP_NAME: /* FIXME */
 		case SK_BY_GROUP_ID:
-			retval = first->gid - second->gid;
+			retval = (first->gid > second->gid) - (first->gid < second->gid);
 			break;
 
 		case SK_BY_PERMISSIONS:
@@ -473,21 +1233,12 @@ sort_dir_list(const void *one, const void *two)
 			break;
 
 		case SK_BY_NLINKS:
-			retval = first->nlinks - second->nlinks;
+			retval = (first->nlinks > second->nlinks) - (first->nlinks < second->nlinks);
 			break;
 #endif
 	}
 
-	if(retval == 0)
-	{
-		retval = first->tag - second->tag;
-	}
-	else if(sort_descending)
-	{
-		retval = -retval;
-	}
-
-	return retval;
+	return (sort_descending ? -retval : retval);
 }
 
 /* Compares two file sizes.  Returns standard -1, 0, 1 for comparisons. */
@@ -551,15 +1302,16 @@ compare_targets(const dir_entry_t *f, const dir_entry_t *s)
 
 	/* Both entries are symbolic links. */
 
+	/* Unreadable targets are treated as empty to keep the order total. */
 	get_full_path_of(f, sizeof(full_path), full_path);
 	if(get_link_target(full_path, nlink, sizeof(nlink)) != 0)
 	{
-		return 0;
+		nlink[0] = '\0';
 	}
 	get_full_path_of(s, sizeof(full_path), full_path);
 	if(get_link_target(full_path, plink, sizeof(plink)) != 0)
 	{
-		return 0;
+		plink[0] = '\0';
 	}
 
 	return stroscmp(nlink, plink);
@@ -26,6 +26,11 @@
 /* Sorts entries of the view according to its sorting configuration. */
 void sort_view(view_t *view);
 
+/* Inserts entries into sorted list of the view at positions that keep it
+ * sorted.  Entries are moved to the list.  Returns zero on success, otherwise
+ * non-zero is returned and the view is left unchanged. */
+int sort_insert_entries(view_t *view, dir_entry_t entries[], int count);
+
 /* Sorts specified entries using global settings of the view. */
 void sort_entries(view_t *view, entries_t entries);
 
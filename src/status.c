@@ -30,23 +30,29 @@
 
 #include <assert.h> /* assert() */
 #include <limits.h> /* INT_MIN */
-#include <stddef.h> /* NULL */
+#include <stddef.h> /* NULL size_t */
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() */
 #include <string.h>
 #include <time.h> /* time_t time() */
 
 #include "cfg/config.h"
 #include "compat/fs_limits.h"
+#include "compat/os.h"
 #include "compat/pthread.h"
 #include "compat/reallocarray.h"
 #include "modes/modes.h"
 #include "ui/colors.h"
 #include "ui/ui.h"
+#include "utils/darray.h"
+#include "utils/dcfile.h"
 #include "utils/env.h"
 #include "utils/fsdata.h"
 #include "utils/log.h"
 #include "utils/macros.h"
 #include "utils/path.h"
 #include "utils/str.h"
+#include "utils/trie.h"
 #include "utils/utils.h"
 #include "cmd_completion.h"
 #include "cmd_core.h"
@@ -77,7 +83,15 @@ static int reset_dircache(void);
 static void set_last_cmdline_command(const char cmd[]);
 static void dcache_get(const char path[], time_t mtime, uint64_t inode,
 		dcache_result_t *size, dcache_result_t *nitems);
+static int dcache_lookup(fsdata_t **cache, pthread_mutex_t *mutex, int size,
+		const char path[], dcache_data_t *data);
+static int dcache_file_get(const char path[], dcfile_record_t *rec);
+static void import_parents(const char path[]);
 static void size_updater(void *data, void *arg);
+static void collect_sizes(const char path[], const void *data, void *arg);
+static void collect_nitems(const char path[], const void *data, void *arg);
+static void collect_record(const char path[], const dcache_data_t *data,
+		int size);
 
 status_t curr_stats;
 
@@ -97,6 +111,21 @@ static pthread_mutex_t dcache_nitems_mutex = PTHREAD_MUTEX_INITIALIZER;
 static fsdata_t *dcache_size;
 /* Cache for directory item count. */
 static fsdata_t *dcache_nitems;
+/* Whether any of the caches was updated since the start. */
+static int dcache_changed;
+
+/* Thread-safety guard for variables of persistent dcache. */
+static pthread_mutex_t dcache_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Persistent dcache, which is loaded on first use.  Can be NULL. */
+static dcfile_t *dcache_file;
+/* Whether loading of persistent dcache was attempted. */
+static int dcache_file_loaded;
+/* Paths which are known to be missing from persistent dcache.  Can be NULL. */
+static trie_t *dcache_file_misses;
+
+/* Records collected by dcache_save(). */
+static dcfile_record_t *collected;
+static DA_INSTANCE(collected);
 
 /* Whether UI updates should be "paused" (a counter, not a flag). */
 static int silent_ui;
@@ -260,6 +289,15 @@ reset_dircache(void)
 	fsdata_free(dcache_nitems);
 	dcache_nitems = fsdata_create(0, 1);
 
+	/* Persistent dcache will be loaded anew on the next use. */
+	pthread_mutex_lock(&dcache_file_mutex);
+	dcfile_free(dcache_file);
+	dcache_file = NULL;
+	dcache_file_loaded = 0;
+	trie_free(dcache_file_misses);
+	dcache_file_misses = NULL;
+	pthread_mutex_unlock(&dcache_file_mutex);
+
 	return (dcache_size == NULL || dcache_nitems == NULL);
 }
 
@@ -590,9 +628,9 @@ dcache_get(const char path[], time_t mtime, uint64_t inode,
 		size->value = DCACHE_UNKNOWN;
 		size->is_valid = 0;
 
-		pthread_mutex_lock(&dcache_size_mutex);
 		dcache_data_t size_data;
-		if(fsdata_get(dcache_size, path, &size_data, sizeof(size_data)) == 0)
+		if(dcache_lookup(&dcache_size, &dcache_size_mutex, 1, path,
+					&size_data) == 0)
 		{
 			size->value = size_data.value;
 			/* We check strictly for less than to handle scenario when multiple
@@ -602,7 +640,6 @@ dcache_get(const char path[], time_t mtime, uint64_t inode,
 			size->is_valid &= (inode == size_data.inode);
 #endif
 		}
-		pthread_mutex_unlock(&dcache_size_mutex);
 	}
 
 	if(nitems != NULL)
@@ -610,9 +647,9 @@ dcache_get(const char path[], time_t mtime, uint64_t inode,
 		nitems->value = DCACHE_UNKNOWN;
 		nitems->is_valid = 0;
 
-		pthread_mutex_lock(&dcache_nitems_mutex);
 		dcache_data_t nitems_data;
-		if(fsdata_get(dcache_nitems, path, &nitems_data, sizeof(nitems_data)) == 0)
+		if(dcache_lookup(&dcache_nitems, &dcache_nitems_mutex, 0, path,
+					&nitems_data) == 0)
 		{
 			nitems->value = nitems_data.value;
 			/* We check strictly for less than to handle scenario when multiple
@@ -622,18 +659,154 @@ dcache_get(const char path[], time_t mtime, uint64_t inode,
 			nitems->is_valid &= (inode == nitems_data.inode);
 #endif
 		}
-		pthread_mutex_unlock(&dcache_nitems_mutex);
 	}
 }
 
+/* Retrieves cached data of the path falling back to persistent dcache.  Data
+ * found in the latter is copied to the cache.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+dcache_lookup(fsdata_t **cache, pthread_mutex_t *mutex, int size,
+		const char path[], dcache_data_t *data)
+{
+	pthread_mutex_lock(mutex);
+	const int found = (*cache != NULL &&
+			fsdata_get(*cache, path, data, sizeof(*data)) == 0);
+	pthread_mutex_unlock(mutex);
+	if(found)
+	{
+		return 0;
+	}
+
+	dcfile_record_t rec;
+	if(!dcache_file_get(path, &rec))
+	{
+		return 1;
+	}
+
+	const dcfile_value_t *const value = (size ? &rec.size : &rec.nitems);
+	if(value->timestamp == 0)
+	{
+		return 1;
+	}
+
+	data->value = value->value;
+	data->timestamp = value->timestamp;
+#ifndef _WIN32
+	data->inode = (ino_t)value->inode;
+#endif
+
+	pthread_mutex_lock(mutex);
+	/* Don't overwrite data that could have been set in the meantime. */
+	dcache_data_t current;
+	if(*cache != NULL &&
+			fsdata_get(*cache, path, &current, sizeof(current)) != 0)
+	{
+		(void)fsdata_set(*cache, path, data, sizeof(*data));
+		/* Saving refreshes time of use of the record. */
+		dcache_changed = 1;
+	}
+	pthread_mutex_unlock(mutex);
+	return 0;
+}
+
+/* Looks up the path in persistent dcache loading it if necessary.  Paths that
+ * weren't found are remembered to not resolve them again.  Returns non-zero if
+ * record was found, otherwise zero is returned. */
+static int
+dcache_file_get(const char path[], dcfile_record_t *rec)
+{
+	pthread_mutex_lock(&dcache_file_mutex);
+
+	if(!dcache_file_loaded && cfg.config_dir[0] != '\0')
+	{
+		char file_path[PATH_MAX + 32];
+		snprintf(file_path, sizeof(file_path), "%s/dir-cache", cfg.config_dir);
+		dcache_file = dcfile_open(file_path);
+		dcache_file_loaded = 1;
+	}
+
+	void *data;
+	const int can_be_found = (dcache_file != NULL
+	                       && !dcfile_is_empty(dcache_file)
+	                       && trie_get(dcache_file_misses, path, &data) != 0);
+
+	pthread_mutex_unlock(&dcache_file_mutex);
+
+	/* Resolving the path is expensive, so do it only when it can help. */
+	if(!can_be_found)
+	{
+		return 0;
+	}
+
+	char real_path[PATH_MAX + 1];
+	const int resolved = (os_realpath(path, real_path) == real_path);
+
+	pthread_mutex_lock(&dcache_file_mutex);
+
+	const int found = (resolved && dcache_file != NULL &&
+			dcfile_get(dcache_file, real_path, rec));
+
+	if(!found && dcache_file != NULL)
+	{
+		if(dcache_file_misses == NULL)
+		{
+			dcache_file_misses = trie_create();
+		}
+		if(dcache_file_misses != NULL)
+		{
+			(void)trie_put(dcache_file_misses, path);
+		}
+	}
+
+	pthread_mutex_unlock(&dcache_file_mutex);
+
+	/* Path points into the file, which could be unloaded after unlocking. */
+	rec->path = NULL;
+	return found;
+}
+
 void
 dcache_update_parent_sizes(const char path[], uint64_t by)
 {
+	import_parents(path);
+
 	pthread_mutex_lock(&dcache_size_mutex);
-	(void)fsdata_map_parents(dcache_size, path, &size_updater, &by);
+	if(fsdata_map_parents(dcache_size, path, &size_updater, &by) == 0)
+	{
+		dcache_changed = 1;
+	}
 	pthread_mutex_unlock(&dcache_size_mutex);
 }
 
+/* Makes sure that sizes of the path and its parents that are stored in
+ * persistent dcache are in the cache, so that they can be updated. */
+static void
+import_parents(const char path[])
+{
+	char real_path[PATH_MAX + 1];
+	if(os_realpath(path, real_path) != real_path)
+	{
+		return;
+	}
+
+	dcache_data_t data;
+	(void)dcache_lookup(&dcache_size, &dcache_size_mutex, 1, "/", &data);
+
+	size_t i;
+	for(i = 1U; real_path[i - 1U] != '\0'; ++i)
+	{
+		const char c = real_path[i];
+		if(c == '/' || c == '\0')
+		{
+			real_path[i] = '\0';
+			(void)dcache_lookup(&dcache_size, &dcache_size_mutex, 1, real_path,
+					&data);
+			real_path[i] = c;
+		}
+	}
+}
+
 /* Updates cached value by a fixed amount. */
 static void
 size_updater(void *data, void *arg)
@@ -659,6 +832,7 @@ dcache_set_at(const char path[], uint64_t inode, uint64_t size, uint64_t nitems)
 
 		pthread_mutex_lock(&dcache_size_mutex);
 		ret |= fsdata_set(dcache_size, path, &data, sizeof(data));
+		dcache_changed = 1;
 		pthread_mutex_unlock(&dcache_size_mutex);
 	}
 
@@ -671,11 +845,88 @@ dcache_set_at(const char path[], uint64_t inode, uint64_t size, uint64_t nitems)
 
 		pthread_mutex_lock(&dcache_nitems_mutex);
 		ret |= fsdata_set(dcache_nitems, path, &data, sizeof(data));
+		dcache_changed = 1;
 		pthread_mutex_unlock(&dcache_nitems_mutex);
 	}
 
 	return ret;
 }
 
+int
+dcache_save(void)
+{
+	if(cfg.config_dir[0] == '\0')
+	{
+		return 0;
+	}
+
+	pthread_mutex_lock(&dcache_size_mutex);
+	pthread_mutex_lock(&dcache_nitems_mutex);
+
+	int error = 0;
+	if(dcache_changed)
+	{
+		fsdata_traverse_paths(dcache_size, &collect_sizes, NULL);
+		fsdata_traverse_paths(dcache_nitems, &collect_nitems, NULL);
+
+		char file_path[PATH_MAX + 32];
+		snprintf(file_path, sizeof(file_path), "%s/dir-cache", cfg.config_dir);
+		error = dcfile_save(file_path, collected, DA_SIZE(collected), time(NULL));
+		dcache_changed = (error != 0);
+
+		size_t i;
+		for(i = 0U; i < DA_SIZE(collected); ++i)
+		{
+			free((char *)collected[i].path);
+		}
+		DA_REMOVE_ALL(collected);
+	}
+
+	pthread_mutex_unlock(&dcache_nitems_mutex);
+	pthread_mutex_unlock(&dcache_size_mutex);
+	return error;
+}
+
+/* fsdata_traverse_paths() callback that collects sizes. */
+static void
+collect_sizes(const char path[], const void *data, void *arg)
+{
+	collect_record(path, data, 1);
+}
+
+/* fsdata_traverse_paths() callback that collects item counts. */
+static void
+collect_nitems(const char path[], const void *data, void *arg)
+{
+	collect_record(path, data, 0);
+}
+
+/* Appends a record with one of the values set to the list of collected
+ * records.  Errors are ignored, as the cache can do without some of them. */
+static void
+collect_record(const char path[], const dcache_data_t *data, int size)
+{
+	dcfile_record_t *const rec = DA_EXTEND(collected);
+	if(rec == NULL)
+	{
+		return;
+	}
+
+	/* Everything that's in memory was used during this session. */
+	*rec = (dcfile_record_t){ .path = strdup(path), .seen = time(NULL) };
+	if(rec->path == NULL)
+	{
+		return;
+	}
+
+	dcfile_value_t *const value = (size ? &rec->size : &rec->nitems);
+	value->value = data->value;
+	value->timestamp = data->timestamp;
+#ifndef _WIN32
+	value->inode = data->inode;
+#endif
+	DA_COMMIT(collected);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
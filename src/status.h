@@ -351,6 +351,10 @@ void dcache_update_parent_sizes(const char path[], uint64_t by);
 int dcache_set_at(const char path[], uint64_t inode, uint64_t size,
 		uint64_t nitems);
 
+/* Merges information about directories into persistent dcache if there were
+ * any changes.  Returns zero on success, otherwise non-zero is returned. */
+int dcache_save(void);
+
 #endif /* VIFM__STATUS_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -69,6 +69,7 @@ const char *tags[] = {
 	"vifm-'iec'",
 	"vifm-'ignorecase'",
 	"vifm-'incsearch'",
+	"vifm-'iojobs'",
 	"vifm-'iooptions'",
 	"vifm-'is'",
 	"vifm-'laststatus'",
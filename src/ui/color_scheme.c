@@ -40,6 +40,7 @@
 #include "../utils/fsddata.h"
 #include "../utils/macros.h"
 #include "../utils/matchers.h"
+#include "../utils/matchers_index.h"
 #include "../utils/str.h"
 #include "../utils/string_array.h"
 #include "../utils/utils.h"
@@ -448,6 +449,7 @@ static void restore_primary_cs(const col_scheme_t *cs);
 static void reset_to_default_cs(col_scheme_t *cs);
 static void free_cs_highlights(col_scheme_t *cs);
 static file_hi_t * clone_cs_highlights(const col_scheme_t *from);
+static void index_cs_highlights(col_scheme_t *cs);
 static void reset_cs_colors(col_scheme_t *cs);
 static int source_cs(const char name[]);
 static void get_cs_path(const char name[], char buf[], size_t buf_size);
@@ -831,6 +833,8 @@ cs_assign(col_scheme_t *to, const col_scheme_t *from)
 	free_cs_highlights(to);
 	*to = *from;
 	to->file_hi = clone_cs_highlights(from);
+	to->file_hi_index = NULL;
+	index_cs_highlights(to);
 }
 
 /* Resets color scheme to default builtin values. */
@@ -857,9 +861,11 @@ free_cs_highlights(col_scheme_t *cs)
 	}
 
 	free(cs->file_hi);
+	mindex_free(cs->file_hi_index);
 
 	cs->file_hi = NULL;
 	cs->file_hi_count = 0;
+	cs->file_hi_index = NULL;
 }
 
 /* Clones filename specific highlight array of the *from color scheme and
@@ -881,6 +887,25 @@ clone_cs_highlights(const col_scheme_t *from)
 	return file_hi;
 }
 
+/* (Re)builds index of filename specific highlights of the color scheme.  On
+ * failure the index is left unset and highlights are matched one by one. */
+static void
+index_cs_highlights(col_scheme_t *cs)
+{
+	mindex_free(cs->file_hi_index);
+	cs->file_hi_index = mindex_alloc();
+
+	int i;
+	for(i = 0; i < cs->file_hi_count && cs->file_hi_index != NULL; ++i)
+	{
+		if(mindex_add(cs->file_hi_index, cs->file_hi[i].matchers) != 0)
+		{
+			mindex_free(cs->file_hi_index);
+			cs->file_hi_index = NULL;
+		}
+	}
+}
+
 int
 cs_load_local(int left, const char dir[])
 {
@@ -1151,6 +1176,13 @@ cs_add_file_hi(struct matchers_t *matchers, const col_attr_t *hi)
 	file_hi->hi = *hi;
 
 	++cs->file_hi_count;
+
+	/* Appending to the index is enough, because matchers are appended. */
+	if(cs->file_hi_index == NULL ||
+			mindex_add(cs->file_hi_index, matchers) != 0)
+	{
+		index_cs_highlights(cs);
+	}
 }
 
 const col_attr_t *
@@ -1168,18 +1200,29 @@ cs_get_file_hi(const col_scheme_t *cs, const char fname[], int *hi_hint)
 	}
 
 	int i;
-	for(i = 0; i < cs->file_hi_count; ++i)
+	if(cs->file_hi_index != NULL)
+	{
+		i = mindex_find(cs->file_hi_index, fname);
+	}
+	else
 	{
-		const file_hi_t *const file_hi = &cs->file_hi[i];
-		if(matchers_match(file_hi->matchers, fname))
+		for(i = 0; i < cs->file_hi_count; ++i)
 		{
-			*hi_hint = i;
-			return &file_hi->hi;
+			if(matchers_match(cs->file_hi[i].matchers, fname))
+			{
+				break;
+			}
 		}
 	}
 
-	*hi_hint = INT_MAX;
-	return NULL;
+	if(i < 0 || i >= cs->file_hi_count)
+	{
+		*hi_hint = INT_MAX;
+		return NULL;
+	}
+
+	*hi_hint = i;
+	return &cs->file_hi[i].hi;
 }
 
 int
@@ -1196,6 +1239,7 @@ cs_del_file_hi(const char matchers_expr[])
 			memmove(&cs->file_hi[i], &cs->file_hi[i + 1],
 					sizeof(*cs->file_hi)*((cs->file_hi_count - 1) - i));
 			--cs->file_hi_count;
+			index_cs_highlights(cs);
 			return 1;
 		}
 	}
@@ -41,6 +41,7 @@ typedef enum
 ColorSchemeState;
 
 struct matchers_t;
+struct mindex_t;
 
 /* Single file highlight description. */
 typedef struct
@@ -60,6 +61,8 @@ typedef struct
 
 	file_hi_t *file_hi; /* List of file highlight preferences. */
 	int file_hi_count;  /* Number of file highlight definitions. */
+	/* Index of file_hi for finding matching highlight quickly or NULL. */
+	struct mindex_t *file_hi_index;
 }
 col_scheme_t;
 
@@ -90,7 +90,7 @@ static int calculate_number_width(const view_t *view, int list_length,
 		int width);
 static int count_digits(int num);
 static int calculate_top_position(view_t *view, int top);
-static int get_line_color(const view_t *view, const dir_entry_t *entry);
+static int get_line_color(const view_t *view, dir_entry_t *entry);
 static size_t calculate_print_width(const view_t *view, int i,
 		size_t max_width);
 static void draw_cell(columns_t *columns, const column_data_t *cdt,
@@ -605,9 +605,10 @@ calculate_top_position(view_t *view, int top)
 	return result;
 }
 
-/* Calculates highlight group for the entry.  Returns highlight group number. */
+/* Calculates highlight group for the entry, which can cache state of a link in
+ * it.  Returns highlight group number. */
 static int
-get_line_color(const view_t *view, const dir_entry_t *entry)
+get_line_color(const view_t *view, dir_entry_t *entry)
 {
 	switch(entry->type)
 	{
@@ -620,24 +621,8 @@ get_line_color(const view_t *view, const dir_entry_t *entry)
 			{
 				return LINK_COLOR;
 			}
-			else
-			{
-				char full[PATH_MAX + 1];
-				get_full_path_of(entry, sizeof(full), full);
-				if(get_link_target_abs(full, entry->origin, full, sizeof(full)) != 0)
-				{
-					return BROKEN_LINK_COLOR;
-				}
-
-				/* Assume that targets on slow file system are not broken as actual
-				 * check might take long time. */
-				if(is_on_slow_fs(full, cfg.slow_fs_list))
-				{
-					return LINK_COLOR;
-				}
-
-				return path_exists(full, DEREF) ? LINK_COLOR : BROKEN_LINK_COLOR;
-			}
+			return (ui_get_link_state(entry) == LS_BROKEN) ? BROKEN_LINK_COLOR
+			                                               : LINK_COLOR;
 #ifndef _WIN32
 		case FT_SOCK:
 			return SOCKET_COLOR;
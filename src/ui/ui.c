@@ -1725,6 +1725,53 @@ ui_view_reset_decor_cache(const view_t *view)
 	}
 }
 
+LinkState
+ui_get_link_state(dir_entry_t *entry)
+{
+	if(entry->link_state != LS_UNKNOWN)
+	{
+		return entry->link_state;
+	}
+
+	LinkState state = LS_BROKEN;
+
+	char full[PATH_MAX + 1];
+	get_full_path_of(entry, sizeof(full), full);
+	if(get_link_target_abs(full, entry->origin, full, sizeof(full)) == 0)
+	{
+		/* Assume that targets on slow file system are not broken as actual check
+		 * might take long time. */
+		if(is_on_slow_fs(full, cfg.slow_fs_list) || path_exists(full, DEREF))
+		{
+			state = LS_VALID;
+		}
+	}
+
+	entry->link_state = state;
+	return state;
+}
+
+void
+ui_view_reset_link_cache(const view_t *view)
+{
+	int i;
+
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		view->dir_entry[i].link_state = LS_UNKNOWN;
+	}
+
+	for(i = 0; i < view->left_column.entries.nentries; ++i)
+	{
+		view->left_column.entries.entries[i].link_state = LS_UNKNOWN;
+	}
+
+	for(i = 0; i < view->right_column.entries.nentries; ++i)
+	{
+		view->right_column.entries.entries[i].link_state = LS_UNKNOWN;
+	}
+}
+
 /* Gets real type of file view entry.  Returns type of entry, resolving symbolic
  * link if needed. */
 static FileType
@@ -183,6 +183,15 @@ typedef enum
 }
 NameFormat;
 
+/* State of target of a symbolic link as cached in dir_entry_t. */
+typedef enum
+{
+	LS_UNKNOWN, /* Not resolved yet (must be zero for zeroed entries). */
+	LS_VALID,   /* Target exists or is assumed to exist. */
+	LS_BROKEN   /* Link is broken. */
+}
+LinkState;
+
 /* Single entry of directory history. */
 typedef struct
 {
@@ -198,43 +207,26 @@ typedef struct dir_entry_t dir_entry_t;
 /* Description of a single directory entry. */
 struct dir_entry_t
 {
-	char *name;       /* File name. */
-	char *origin;     /* Location where this file comes from.  Either points to
-	                     view_t::curr_dir for non-cv views or is allocated on
-	                     a heap depending on owns_origin field. */
-	uint64_t size;    /* File size in bytes. */
-#ifndef _WIN32
-	uid_t uid;        /* Owning user id. */
-	gid_t gid;        /* Owning group id. */
-	mode_t mode;      /* Mode of the file. */
-	ino_t inode;      /* Inode number. */
-#else
-	uint32_t attrs;   /* Attributes of the file. */
-#endif
-	time_t mtime;     /* Modification time. */
-	time_t atime;     /* Access time. */
-	time_t ctime;     /* Creation time. */
-	int nlinks;       /* Number of hard links to the entry. */
+	/* Fields that are used on drawing, filtering, searching and selecting go
+	 * first to occupy as few cache lines as possible. */
 
-	int id;           /* File uniqueness identifier on comparison. */
-
-	int tag;          /* Used to hold temporary data associated with the item,
-	                     e.g. by sorting comparer to perform stable sort or item
-	                     mapping during tree filtering. */
+	char *name;       /* File name.  Allocated in the slab or on a heap if slab
+	                     field is NULL. */
+	char *origin;     /* Location where this file comes from.  Either points to
+	                     view_t::curr_dir for non-cv views or is owned by the
+	                     entry (like name) depending on owns_origin field. */
 
 	int hi_num;       /* File highlighting parameters cache.  Initially -1.
 	                     INT_MAX signifies absence of a match. */
 	int name_dec_num; /* File decoration parameters cache (initially -1).  The
 	                     value is shifted by one, 0 means no type decoration. */
 
-	int child_count; /* Number of child entries (all, not just direct). */
-	int child_pos;   /* Position of this entry in among children of its parent.
-	                    Zero for top-level entries. */
+	int search_match; /* Non-zero if the item matches last search.  Equals to
+	                     search match number (top to bottom order). */
 
-	int search_match;      /* Non-zero if the item matches last search.  Equals to
-	                          search match number (top to bottom order). */
-	short int match_left;  /* Starting position of search match. */
-	short int match_right; /* Ending position of search match. */
+	int id;           /* File uniqueness identifier on comparison. */
+
+	int child_count;  /* Number of child entries (all, not just direct). */
 
 	FileType type : 4;             /* File type. */
 	unsigned int selected : 1;     /* Whether file is selected. */
@@ -243,6 +235,40 @@ struct dir_entry_t
 	unsigned int temporary : 1;    /* Whether this is temporary node. */
 	unsigned int dir_link : 1;     /* Whether this is symlink to a directory. */
 	unsigned int owns_origin : 1;  /* Whether this entry is custom one. */
+	LinkState link_state : 2;      /* State of symbolic link's target cache.
+	                                  Reset on reloading of the list. */
+
+	uint64_t size;    /* File size in bytes. */
+	time_t mtime;     /* Modification time. */
+
+	/* The rest is metadata that is mostly needed by sorting, columns and file
+	 * operations. */
+
+	struct slab_t *slab; /* Arena that holds owned strings of the entry and to
+	                        which the entry holds a reference or NULL. */
+
+	int child_pos;    /* Position of this entry in among children of its
+	                     parent.  Zero for top-level entries. */
+
+	int tag;          /* Used to hold temporary data associated with the item,
+	                     e.g. by sorting comparer to perform stable sort or item
+	                     mapping during tree filtering. */
+
+	int nlinks;       /* Number of hard links to the entry. */
+
+	short int match_left;  /* Starting position of search match. */
+	short int match_right; /* Ending position of search match. */
+
+#ifndef _WIN32
+	uid_t uid;        /* Owning user id. */
+	gid_t gid;        /* Owning group id. */
+	mode_t mode;      /* Mode of the file. */
+	ino_t inode;      /* Inode number. */
+#else
+	uint32_t attrs;   /* Attributes of the file. */
+#endif
+	time_t atime;     /* Access time. */
+	time_t ctime;     /* Creation time. */
 };
 
 /* List of entries bundled with its size. */
@@ -312,6 +338,17 @@ struct local_filter_t
 	/* Number of entries filtered in other ways. */
 	size_t prefiltered_count;
 
+	/* Bitset over unfiltered list that marks entries which passed the filter the
+	 * last time (parent directory entries are always marked).  When the filter
+	 * is only extended, just the marked entries need to be checked. */
+	uint32_t *matches;
+	/* Number of unfiltered entries described by the matches field. */
+	size_t matches_count;
+	/* Value of the filter that produced the matches field. */
+	char *matches_for;
+	/* Compilation flags of the filter that produced the matches field. */
+	int matches_cflags;
+
 	/* List of previous cursor positions in the unfiltered array. */
 	int *poshist;
 	/* Number of elements in the poshist field. */
@@ -359,6 +396,13 @@ struct view_t
 	fswatch_t *watch;  /* Monitor that checks for directory changes. */
 	char *watched_dir; /* Path for which the monitor was created. */
 
+	/* Monitor of directories of a tree view or NULL if it couldn't be created,
+	 * in which case directories are polled. */
+	fswatch_t *tree_watch;
+	/* Checksum of directories for which tree_watch was created, zero if creation
+	 * wasn't attempted. */
+	uint64_t tree_watch_sum;
+
 	char *last_dir; /* Location visited by the view before the current one. */
 
 	/* Number of files that match current search pattern. */
@@ -625,6 +669,13 @@ void ui_get_decors(const dir_entry_t *entry, const char **prefix,
 /* Resets cached indexes for name-dependent type_decs. */
 void ui_view_reset_decor_cache(const view_t *view);
 
+/* Retrieves state of target of a symbolic link entry.  The state is resolved
+ * on the first call and cached in the entry.  Returns the state. */
+LinkState ui_get_link_state(dir_entry_t *entry);
+
+/* Resets cached states of targets of symbolic links. */
+void ui_view_reset_link_cache(const view_t *view);
+
 /* Moves cursor to position specified by coordinates checking result of the
  * movement. */
 void checked_wmove(WINDOW *win, int y, int x);
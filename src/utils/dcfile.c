@@ -0,0 +1,524 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+
+#include "dcfile.h"
+
+#ifndef _WIN32
+#include <sys/mman.h> /* MAP_FAILED MAP_PRIVATE PROT_READ mmap() munmap() */
+#include <sys/stat.h> /* stat fstat() */
+#include <fcntl.h> /* O_RDONLY open() */
+#include <unistd.h> /* close() */
+#endif
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* SIZE_MAX int64_t uint32_t uint64_t */
+#include <stdio.h> /* FILE fclose() fread() fwrite() remove() snprintf() */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* memcmp() memcpy() strcmp() strdup() strlen() */
+
+#include "../compat/fs_limits.h"
+#include "../compat/os.h"
+#include "../compat/reallocarray.h"
+#include "fs.h"
+#include "utils.h"
+
+/* Signature of a file. */
+#define MAGIC "vifmdc1"
+
+/* Maximum number of records written to a file.  Records that were seen least
+ * recently are dropped first to fit into the limit. */
+#define MAX_RECORDS (256U*1024U)
+
+/* Records that weren't seen for this long (in seconds) are dropped. */
+#define MAX_AGE (90*24*60*60)
+
+/* Time when a record was seen isn't updated more often than this (in seconds),
+ * so that just using records doesn't cause rewriting of the file. */
+#define SEEN_PRECISION (24*60*60)
+
+/* Header of a file. */
+typedef struct
+{
+	char magic[8];     /* MAGIC. */
+	uint32_t rec_size; /* Size of a record to detect changes in the format. */
+	uint32_t padding;  /* Always zero. */
+	uint64_t nrecs;    /* Number of records that follow the header. */
+}
+header_t;
+
+/* Record of a file. */
+typedef struct
+{
+	uint64_t path_off;     /* Offset of the path in the block of paths. */
+	uint64_t path_len;     /* Length of the path (it's also null-terminated). */
+	dcfile_value_t size;   /* Size of the directory. */
+	dcfile_value_t nitems; /* Number of items in the directory. */
+	int64_t seen;          /* When the record was last used. */
+}
+record_t;
+
+struct dcfile_t
+{
+	void *data;           /* Contents of the file or NULL. */
+	size_t data_size;     /* Size of the data. */
+	const record_t *recs; /* Sorted records (points into data). */
+	size_t nrecs;         /* Number of elements in recs. */
+	const char *paths;    /* Block of paths (points into data). */
+	size_t paths_size;    /* Size of the block of paths. */
+};
+
+static void load_file(dcfile_t *file, const char path[]);
+static void unload_file(dcfile_t *file);
+static const char * get_path(const dcfile_t *file, size_t i);
+static void fill_record(const dcfile_t *file, size_t i, dcfile_record_t *rec);
+static size_t merge(const dcfile_t *file, const dcfile_record_t recs[],
+		size_t nrecs, dcfile_record_t out[]);
+static void merge_value(dcfile_value_t *to, const dcfile_value_t *from);
+static size_t drop_unused(dcfile_record_t recs[], size_t nrecs, int64_t now);
+static int int64_cmp(const void *a, const void *b);
+static int is_unchanged(const dcfile_t *file, const dcfile_record_t recs[],
+		size_t nrecs);
+static int values_equal(const dcfile_value_t *a, const dcfile_value_t *b);
+static int record_cmp(const void *a, const void *b);
+static int write_records(const char path[], const dcfile_record_t recs[],
+		size_t nrecs);
+
+dcfile_t *
+dcfile_open(const char path[])
+{
+	dcfile_t *const file = calloc(1, sizeof(*file));
+	if(file != NULL)
+	{
+		load_file(file, path);
+	}
+	return file;
+}
+
+/* Makes records of the file available for lookups if the file exists and is
+ * valid. */
+static void
+load_file(dcfile_t *file, const char path[])
+{
+#ifndef _WIN32
+	const int fd = open(path, O_RDONLY);
+	if(fd == -1)
+	{
+		return;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header_t))
+	{
+		close(fd);
+		return;
+	}
+
+	void *const data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED)
+	{
+		return;
+	}
+	file->data = data;
+	file->data_size = st.st_size;
+#else
+	const uint64_t size = get_file_size(path);
+	if(size < sizeof(header_t) || size > SIZE_MAX)
+	{
+		return;
+	}
+
+	FILE *const fp = os_fopen(path, "rb");
+	if(fp == NULL)
+	{
+		return;
+	}
+
+	file->data = malloc(size);
+	file->data_size = size;
+	if(file->data == NULL || fread(file->data, size, 1, fp) != 1)
+	{
+		fclose(fp);
+		unload_file(file);
+		return;
+	}
+	fclose(fp);
+#endif
+
+	header_t header;
+	memcpy(&header, file->data, sizeof(header));
+	const size_t payload = file->data_size - sizeof(header);
+	if(memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 ||
+			header.rec_size != sizeof(record_t) ||
+			header.nrecs > payload/sizeof(record_t))
+	{
+		unload_file(file);
+		return;
+	}
+
+	file->recs = (const record_t *)((const char *)file->data + sizeof(header));
+	file->nrecs = header.nrecs;
+	file->paths = (const char *)(file->recs + file->nrecs);
+	file->paths_size = payload - file->nrecs*sizeof(record_t);
+}
+
+/* Releases contents of the file. */
+static void
+unload_file(dcfile_t *file)
+{
+	if(file->data != NULL)
+	{
+#ifndef _WIN32
+		munmap(file->data, file->data_size);
+#else
+		free(file->data);
+#endif
+	}
+
+	file->data = NULL;
+	file->data_size = 0U;
+	file->recs = NULL;
+	file->nrecs = 0U;
+	file->paths = NULL;
+	file->paths_size = 0U;
+}
+
+void
+dcfile_free(dcfile_t *file)
+{
+	if(file != NULL)
+	{
+		unload_file(file);
+		free(file);
+	}
+}
+
+int
+dcfile_is_empty(const dcfile_t *file)
+{
+	return (file->nrecs == 0U);
+}
+
+int
+dcfile_get(const dcfile_t *file, const char path[], dcfile_record_t *rec)
+{
+	size_t l = 0U, r = file->nrecs;
+	while(l < r)
+	{
+		const size_t m = l + (r - l)/2U;
+		const char *const rec_path = get_path(file, m);
+		if(rec_path == NULL)
+		{
+			/* The file is damaged, order of records can't be trusted. */
+			return 0;
+		}
+
+		const int cmp = strcmp(rec_path, path);
+		if(cmp == 0)
+		{
+			fill_record(file, m, rec);
+			return 1;
+		}
+
+		if(cmp < 0)
+		{
+			l = m + 1U;
+		}
+		else
+		{
+			r = m;
+		}
+	}
+	return 0;
+}
+
+/* Retrieves path of i-th record of the file.  Returns the path or NULL if the
+ * record is broken. */
+static const char *
+get_path(const dcfile_t *file, size_t i)
+{
+	const record_t *const rec = &file->recs[i];
+	if(rec->path_off >= file->paths_size ||
+			rec->path_len >= file->paths_size - rec->path_off ||
+			file->paths[rec->path_off + rec->path_len] != '\0')
+	{
+		return NULL;
+	}
+	return &file->paths[rec->path_off];
+}
+
+/* Converts i-th record of the file into external representation. */
+static void
+fill_record(const dcfile_t *file, size_t i, dcfile_record_t *rec)
+{
+	rec->path = get_path(file, i);
+	rec->size = file->recs[i].size;
+	rec->nitems = file->recs[i].nitems;
+	rec->seen = file->recs[i].seen;
+}
+
+int
+dcfile_save(const char path[], dcfile_record_t recs[], size_t nrecs,
+		int64_t now)
+{
+	/* Reread the file to not lose what other instances have stored since it was
+	 * opened. */
+	dcfile_t *const file = dcfile_open(path);
+	if(file == NULL)
+	{
+		return 1;
+	}
+
+	dcfile_record_t *const merged = reallocarray(NULL, file->nrecs + nrecs,
+			sizeof(*merged));
+	if(merged == NULL)
+	{
+		dcfile_free(file);
+		return 1;
+	}
+
+	safe_qsort(recs, nrecs, sizeof(*recs), &record_cmp);
+	size_t nmerged = merge(file, recs, nrecs, merged);
+	nmerged = drop_unused(merged, nmerged, now);
+
+	const int error = is_unchanged(file, merged, nmerged)
+	                ? 0
+	                : write_records(path, merged, nmerged);
+
+	free(merged);
+	dcfile_free(file);
+	return error;
+}
+
+/* Merges sorted records of the file with sorted records folding those with
+ * equal paths.  out should have enough space for all records.  Returns number
+ * of elements in out. */
+static size_t
+merge(const dcfile_t *file, const dcfile_record_t recs[], size_t nrecs,
+		dcfile_record_t out[])
+{
+	size_t i = 0U, j = 0U, n = 0U;
+	while(i < file->nrecs || j < nrecs)
+	{
+		dcfile_record_t rec;
+		if(i < file->nrecs)
+		{
+			if(get_path(file, i) == NULL)
+			{
+				/* Drop the rest of the broken file. */
+				i = file->nrecs;
+				continue;
+			}
+			fill_record(file, i, &rec);
+		}
+
+		if(i == file->nrecs || (j < nrecs && strcmp(recs[j].path, rec.path) < 0))
+		{
+			rec = recs[j++];
+		}
+		else
+		{
+			++i;
+		}
+
+		if(n != 0U && strcmp(out[n - 1U].path, rec.path) == 0)
+		{
+			merge_value(&out[n - 1U].size, &rec.size);
+			merge_value(&out[n - 1U].nitems, &rec.nitems);
+			if(rec.seen - out[n - 1U].seen > SEEN_PRECISION)
+			{
+				out[n - 1U].seen = rec.seen;
+			}
+		}
+		else
+		{
+			out[n++] = rec;
+		}
+	}
+	return n;
+}
+
+/* Replaces value with another one unless it's older.  Values of the same age
+ * are replaced to let the caller update them without changing timestamps. */
+static void
+merge_value(dcfile_value_t *to, const dcfile_value_t *from)
+{
+	if(from->timestamp >= to->timestamp)
+	{
+		*to = *from;
+	}
+}
+
+/* Removes records that weren't seen for too long and then the least recently
+ * seen ones if there are too many records left.  Preserves order of records.
+ * Returns new number of records. */
+static size_t
+drop_unused(dcfile_record_t recs[], size_t nrecs, int64_t now)
+{
+	size_t i, n = 0U;
+	for(i = 0U; i < nrecs; ++i)
+	{
+		if(now - recs[i].seen <= MAX_AGE)
+		{
+			recs[n++] = recs[i];
+		}
+	}
+
+	if(n <= MAX_RECORDS)
+	{
+		return n;
+	}
+
+	/* Find time of seeing the oldest record that will be kept. */
+	int64_t *const seen = reallocarray(NULL, n, sizeof(*seen));
+	if(seen == NULL)
+	{
+		return MAX_RECORDS;
+	}
+	for(i = 0U; i < n; ++i)
+	{
+		seen[i] = recs[i].seen;
+	}
+	safe_qsort(seen, n, sizeof(*seen), &int64_cmp);
+	const int64_t cutoff = seen[n - MAX_RECORDS];
+	free(seen);
+
+	/* Records seen exactly at the cutoff are kept while there is room. */
+	size_t budget = 0U;
+	for(i = 0U; i < n; ++i)
+	{
+		budget += (recs[i].seen > cutoff);
+	}
+	budget = MAX_RECORDS - budget;
+
+	size_t m = 0U;
+	for(i = 0U; i < n; ++i)
+	{
+		if(recs[i].seen > cutoff || (recs[i].seen == cutoff && budget-- != 0U))
+		{
+			recs[m++] = recs[i];
+		}
+	}
+	return m;
+}
+
+/* qsort() comparer of 64-bit integers.  Returns standard -1, 0, 1 for
+ * comparisons. */
+static int
+int64_cmp(const void *a, const void *b)
+{
+	const int64_t x = *(const int64_t *)a;
+	const int64_t y = *(const int64_t *)b;
+	return (x > y) - (x < y);
+}
+
+/* Checks whether records are exactly the same as those of the file.  Returns
+ * non-zero if so, otherwise zero is returned. */
+static int
+is_unchanged(const dcfile_t *file, const dcfile_record_t recs[], size_t nrecs)
+{
+	if(file->nrecs != nrecs)
+	{
+		return 0;
+	}
+
+	size_t i;
+	for(i = 0U; i < nrecs; ++i)
+	{
+		dcfile_record_t rec;
+		fill_record(file, i, &rec);
+		if(rec.path == NULL || strcmp(rec.path, recs[i].path) != 0 ||
+				!values_equal(&rec.size, &recs[i].size) ||
+				!values_equal(&rec.nitems, &recs[i].nitems) || rec.seen != recs[i].seen)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Compares two values.  Returns non-zero if they are equal, otherwise zero is
+ * returned. */
+static int
+values_equal(const dcfile_value_t *a, const dcfile_value_t *b)
+{
+	return a->value == b->value
+	    && a->inode == b->inode
+	    && a->timestamp == b->timestamp;
+}
+
+/* qsort() comparer of records by their paths.  Returns standard -1, 0, 1 for
+ * comparisons. */
+static int
+record_cmp(const void *a, const void *b)
+{
+	const dcfile_record_t *const rec_a = a;
+	const dcfile_record_t *const rec_b = b;
+	return strcmp(rec_a->path, rec_b->path);
+}
+
+/* Writes records to the file replacing it atomically.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+write_records(const char path[], const dcfile_record_t recs[], size_t nrecs)
+{
+	char tmp_path[PATH_MAX + 32];
+	snprintf(tmp_path, sizeof(tmp_path), "%s_%u", path, get_pid());
+
+	FILE *const fp = os_fopen(tmp_path, "wb");
+	if(fp == NULL)
+	{
+		return 1;
+	}
+
+	header_t header = { .rec_size = sizeof(record_t), .nrecs = nrecs };
+	memcpy(header.magic, MAGIC, sizeof(header.magic));
+	int error = (fwrite(&header, sizeof(header), 1, fp) != 1);
+
+	uint64_t path_off = 0U;
+	size_t i;
+	for(i = 0U; i < nrecs && !error; ++i)
+	{
+		const record_t rec = {
+			.path_off = path_off,
+			.path_len = strlen(recs[i].path),
+			.size = recs[i].size,
+			.nitems = recs[i].nitems,
+			.seen = recs[i].seen,
+		};
+		error = (fwrite(&rec, sizeof(rec), 1, fp) != 1);
+		path_off += rec.path_len + 1U;
+	}
+
+	for(i = 0U; i < nrecs && !error; ++i)
+	{
+		error = (fwrite(recs[i].path, strlen(recs[i].path) + 1U, 1, fp) != 1);
+	}
+
+	error |= (fclose(fp) != 0);
+	if(error || rename_file(tmp_path, path) != 0)
+	{
+		(void)remove(tmp_path);
+		return 1;
+	}
+	return 0;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,82 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+
+#ifndef VIFM__UTILS__DCFILE_H__
+#define VIFM__UTILS__DCFILE_H__
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* int64_t uint64_t */
+
+/* Persistent storage of information about directories (their sizes and number
+ * of items).  The file is a table of fixed-size records sorted by path followed
+ * by a block of paths, it's mapped into memory and searched in place.  Values
+ * aren't checked for being outdated here, they carry data for doing that.
+ * Records that weren't used for a long time are dropped on saving and so are
+ * the least recently used ones when there are too many of them. */
+
+/* Single value stored for a directory. */
+typedef struct
+{
+	uint64_t value;    /* The value. */
+	uint64_t inode;    /* Inode number of the directory. */
+	int64_t timestamp; /* When the value was computed, zero means it's unset. */
+}
+dcfile_value_t;
+
+/* Information about a directory. */
+typedef struct
+{
+	const char *path;      /* Absolute canonical path to the directory. */
+	dcfile_value_t size;   /* Size of the directory. */
+	dcfile_value_t nitems; /* Number of items in the directory. */
+	int64_t seen;          /* When the record was last used. */
+}
+dcfile_record_t;
+
+/* Opaque type of an opened file. */
+typedef struct dcfile_t dcfile_t;
+
+/* Opens file at the path.  Missing or broken file is treated as an empty one.
+ * Returns the file or NULL on error. */
+dcfile_t * dcfile_open(const char path[]);
+
+/* Frees resources of the file.  file can be NULL. */
+void dcfile_free(dcfile_t *file);
+
+/* Checks whether the file has no records.  Returns non-zero if so, otherwise
+ * zero is returned. */
+int dcfile_is_empty(const dcfile_t *file);
+
+/* Looks up record of the path.  Returns non-zero if it was found and *rec was
+ * filled (rec->path points into the file), otherwise zero is returned. */
+int dcfile_get(const dcfile_t *file, const char path[], dcfile_record_t *rec);
+
+/* Merges records with current contents of the file at the path and replaces it
+ * atomically unless that changes nothing.  Values with larger timestamps win,
+ * on ties values from recs win.  recs can contain several records of the same
+ * path and are reordered.  now is the current time used to find records that
+ * weren't seen for too long.  Returns zero on success, otherwise non-zero is
+ * returned. */
+int dcfile_save(const char path[], dcfile_record_t recs[], size_t nrecs,
+		int64_t now);
+
+#endif /* VIFM__UTILS__DCFILE_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
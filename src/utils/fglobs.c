@@ -0,0 +1,243 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "fglobs.h"
+
+#include <ctype.h> /* tolower() */
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* intptr_t */
+#include <stdlib.h> /* calloc() free() */
+#include <string.h> /* strcspn() strdup() strlen() */
+
+#include "../compat/reallocarray.h"
+#include "str.h"
+#include "trie.h"
+
+/* Set of parsed globs. */
+struct fglobs_t
+{
+	trie_t *names;       /* Lowercased exact names mapped to ids. */
+	trie_t *suffixes;    /* Lowercased suffixes of "*suffix" globs. */
+	size_t *suffix_lens; /* Distinct lengths of the suffixes. */
+	int nsuffix_lens;    /* Number of elements in suffix_lens. */
+	int any;             /* Id of "*" glob or -1. */
+};
+
+static int is_fglob(const char glob[]);
+static int put_min(trie_t *trie, const char key[], int id);
+static int add_suffix_len(fglobs_t *fglobs, size_t len);
+static int min_id(int a, int b);
+
+int
+fglobs_supported(const char globs[])
+{
+	char *const copy = strdup(globs);
+	if(copy == NULL)
+	{
+		return 0;
+	}
+
+	char *glob = copy, *state = NULL;
+	while((glob = split_and_get_dc(glob, &state)) != NULL)
+	{
+		if(!is_fglob(glob))
+		{
+			break;
+		}
+	}
+
+	free(copy);
+	return (glob == NULL);
+}
+
+/* Checks whether glob is an exact name or "*suffix".  Returns non-zero if so,
+ * otherwise zero is returned. */
+static int
+is_fglob(const char glob[])
+{
+	if(glob[0] == '*')
+	{
+		++glob;
+	}
+	return (glob[strcspn(glob, "[?*")] == '\0');
+}
+
+fglobs_t *
+fglobs_alloc(void)
+{
+	fglobs_t *const fglobs = calloc(1U, sizeof(*fglobs));
+	if(fglobs == NULL)
+	{
+		return NULL;
+	}
+
+	fglobs->any = -1;
+	fglobs->names = trie_create();
+	fglobs->suffixes = trie_create();
+	if(fglobs->names == NULL || fglobs->suffixes == NULL)
+	{
+		fglobs_free(fglobs);
+		return NULL;
+	}
+
+	return fglobs;
+}
+
+void
+fglobs_free(fglobs_t *fglobs)
+{
+	if(fglobs != NULL)
+	{
+		trie_free(fglobs->names);
+		trie_free(fglobs->suffixes);
+		free(fglobs->suffix_lens);
+		free(fglobs);
+	}
+}
+
+int
+fglobs_add(fglobs_t *fglobs, const char globs[], int id)
+{
+	char *const copy = strdup(globs);
+	if(copy == NULL)
+	{
+		return 1;
+	}
+
+	int error = 0;
+	char *glob = copy, *state = NULL;
+	while(!error && (glob = split_and_get_dc(glob, &state)) != NULL)
+	{
+		char *p;
+		for(p = glob; *p != '\0'; ++p)
+		{
+			*p = tolower((unsigned char)*p);
+		}
+
+		if(glob[0] == '\0')
+		{
+			/* Empty glob matches only empty name, which doesn't happen. */
+			continue;
+		}
+
+		if(glob[0] != '*')
+		{
+			error = put_min(fglobs->names, glob, id);
+		}
+		else if(glob[1] == '\0')
+		{
+			fglobs->any = min_id(fglobs->any, id);
+		}
+		else
+		{
+			error = put_min(fglobs->suffixes, glob + 1, id)
+			     || add_suffix_len(fglobs, strlen(glob + 1));
+		}
+	}
+
+	free(copy);
+	return error;
+}
+
+/* Associates key with the id unless it's already associated with a smaller
+ * one.  Returns zero on success, otherwise non-zero is returned. */
+static int
+put_min(trie_t *trie, const char key[], int id)
+{
+	void *data;
+	if(trie_get(trie, key, &data) == 0 && (intptr_t)data <= id)
+	{
+		return 0;
+	}
+	return (trie_set(trie, key, (void *)(intptr_t)id) < 0);
+}
+
+/* Remembers length of a suffix if it's new.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+add_suffix_len(fglobs_t *fglobs, size_t len)
+{
+	int i;
+	for(i = 0; i < fglobs->nsuffix_lens; ++i)
+	{
+		if(fglobs->suffix_lens[i] == len)
+		{
+			return 0;
+		}
+	}
+
+	size_t *const lens = reallocarray(fglobs->suffix_lens,
+			fglobs->nsuffix_lens + 1, sizeof(*lens));
+	if(lens == NULL)
+	{
+		return 1;
+	}
+
+	fglobs->suffix_lens = lens;
+	fglobs->suffix_lens[fglobs->nsuffix_lens++] = len;
+	return 0;
+}
+
+int
+fglobs_find(const fglobs_t *fglobs, const char name[])
+{
+	int id = -1;
+
+	void *data;
+	if(trie_get_lower(fglobs->names, name, &data) == 0)
+	{
+		id = (int)(intptr_t)data;
+	}
+
+	/* Stars don't match leading dot and empty string. */
+	if(name[0] == '.' || name[0] == '\0')
+	{
+		return id;
+	}
+
+	id = min_id(id, fglobs->any);
+
+	const size_t len = strlen(name);
+	int i;
+	for(i = 0; i < fglobs->nsuffix_lens; ++i)
+	{
+		const size_t suffix_len = fglobs->suffix_lens[i];
+		if(suffix_len < len &&
+				trie_get_lower(fglobs->suffixes, name + len - suffix_len, &data) == 0)
+		{
+			id = min_id(id, (int)(intptr_t)data);
+		}
+	}
+
+	return id;
+}
+
+/* Picks smaller of two ids where -1 stands for a missing one.  Returns the
+ * id. */
+static int
+min_id(int a, int b)
+{
+	if(a < 0)
+	{
+		return b;
+	}
+	return (b < 0 || a < b) ? a : b;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,54 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__FGLOBS_H__
+#define VIFM__UTILS__FGLOBS_H__
+
+/* "Faster globs" are globs that are either exact names or "*suffix" patterns
+ * (no other wildcards).  They are matched case-insensitively by looking up
+ * names and their suffixes in tries without converting globs into regular
+ * expressions and without allocating memory.  Like with other globs, leading
+ * star doesn't match leading dot or empty string. */
+
+/* Opaque set of parsed globs. */
+typedef struct fglobs_t fglobs_t;
+
+/* Checks whether all globs of a comma-separated list are faster globs.
+ * Returns non-zero if so, otherwise zero is returned. */
+int fglobs_supported(const char globs[]);
+
+/* Creates an empty set.  Returns the set or NULL on error. */
+fglobs_t * fglobs_alloc(void);
+
+/* Frees the set.  fglobs can be NULL. */
+void fglobs_free(fglobs_t *fglobs);
+
+/* Adds comma-separated list of faster globs to the set associating each of them
+ * with the id unless the same glob is already there.  Returns zero on success,
+ * otherwise non-zero is returned and only some of globs might have been
+ * added. */
+int fglobs_add(fglobs_t *fglobs, const char globs[], int id);
+
+/* Matches the name against globs of the set.  Returns the smallest id among
+ * matched globs or -1 if nothing matches. */
+int fglobs_find(const fglobs_t *fglobs, const char name[]);
+
+#endif /* VIFM__UTILS__FGLOBS_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -27,9 +27,10 @@
 #include "utf8.h"
 #endif
 
-#include <sys/stat.h> /* S_* statbuf */
-#include <sys/types.h> /* size_t mode_t */
-#include <unistd.h> /* pathconf() readlink() */
+#include <sys/stat.h> /* S_* statbuf fstatat() */
+#include <sys/types.h> /* off_t size_t mode_t */
+#include <fcntl.h> /* O_RDONLY open() */
+#include <unistd.h> /* close() lseek() pathconf() readlink() readlinkat() */
 
 #include <ctype.h> /* isalpha() */
 #include <errno.h> /* errno */
@@ -270,6 +271,48 @@ get_symlink_type(const char path[])
 	return SLT_UNKNOWN;
 }
 
+#ifndef _WIN32
+
+SymLinkType
+get_symlink_type_at(int dir_fd, const char dir[], const char name[])
+{
+	char link_target[PATH_MAX + 1];
+	const ssize_t len = readlinkat(dir_fd, name, link_target,
+			sizeof(link_target) - 1);
+	if(len == -1)
+	{
+		LOG_SERROR_MSG(errno, "Can't readlink \"%s\" in \"%s\"", name, dir);
+		return SLT_UNKNOWN;
+	}
+	link_target[len] = '\0';
+
+	char path[PATH_MAX + NAME_MAX];
+	char linkto[PATH_MAX + NAME_MAX];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if(is_path_absolute(link_target))
+	{
+		copy_str(linkto, sizeof(linkto), link_target);
+	}
+	else
+	{
+		snprintf(linkto, sizeof(linkto), "%s/%s", dir, link_target);
+	}
+
+	if(refers_to_slower_fs(path, linkto))
+	{
+		return SLT_SLOW;
+	}
+
+	struct stat s;
+	if(fstatat(dir_fd, name, &s, 0) != 0)
+	{
+		return SLT_UNKNOWN;
+	}
+	return S_ISDIR(s.st_mode) ? SLT_DIR : SLT_UNKNOWN;
+}
+
+#endif
+
 int
 get_link_target_abs(const char link[], const char cwd[], char buf[],
 		size_t buf_len)
@@ -435,6 +478,62 @@ get_file_size(const char path[])
 #endif
 }
 
+uint64_t
+get_file_data_size(const char path[])
+{
+#if !defined(_WIN32) && defined(SEEK_DATA) && defined(SEEK_HOLE)
+	struct stat st;
+	if(os_lstat(path, &st) != 0)
+	{
+		return 0;
+	}
+
+	/* Files without holes occupy enough blocks to hold all of their data, so
+	 * there is no need to look for holes. */
+	if(!S_ISREG(st.st_mode) ||
+			(uint64_t)st.st_blocks*512U >= (uint64_t)st.st_size)
+	{
+		return st.st_size;
+	}
+
+	const int fd = open(path, O_RDONLY);
+	if(fd == -1)
+	{
+		return st.st_size;
+	}
+
+	uint64_t size = 0U;
+	off_t pos = 0;
+	while(pos < st.st_size)
+	{
+		const off_t data = lseek(fd, pos, SEEK_DATA);
+		if(data == (off_t)-1)
+		{
+			/* ENXIO means that the rest of the file is a hole. */
+			if(errno != ENXIO)
+			{
+				size = st.st_size;
+			}
+			break;
+		}
+
+		off_t hole = lseek(fd, data, SEEK_HOLE);
+		if(hole == (off_t)-1 || hole > st.st_size)
+		{
+			hole = st.st_size;
+		}
+
+		size += hole - data;
+		pos = hole;
+	}
+
+	close(fd);
+	return size;
+#else
+	return get_file_size(path);
+#endif
+}
+
 char **
 list_regular_files(const char path[], char *list[], int *len)
 {
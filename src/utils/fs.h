@@ -84,6 +84,14 @@ int is_shortcut(const char path[]);
  * Returns one of SymLinkType values. */
 SymLinkType get_symlink_type(const char path[]);
 
+#ifndef _WIN32
+/* Same as get_symlink_type(), but for a link named name inside of dir
+ * directory, which is opened as dir_fd.  Doesn't depend on current working
+ * directory.  Returns one of SymLinkType values. */
+SymLinkType get_symlink_type_at(int dir_fd, const char dir[],
+		const char name[]);
+#endif
+
 /* Fills the buf of size buf_len with the absolute path to a file pointed to by
  * the link symbolic link.  Uses the cwd parameter to make absolute path from
  * relative symbolic links.  The link and buf can point to the same piece of
@@ -125,6 +133,11 @@ int is_dir_writable(const char path[]);
  * empty files and on error. */
 uint64_t get_file_size(const char path[]);
 
+/* Gets number of bytes in data regions of a file, which is less than its size
+ * if the file has holes (is sparse).  Returns zero for both empty files and on
+ * error. */
+uint64_t get_file_data_size(const char path[]);
+
 /* Appends all regular files inside the path directory.  Reallocates array of
  * strings if necessary to fit all elements.  Returns pointer to reallocated
  * array or source list (on error). */
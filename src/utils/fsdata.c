@@ -25,7 +25,7 @@
 
 #include <stddef.h> /* NULL size_t */
 #include <stdlib.h> /* free() malloc() */
-#include <string.h> /* memcpy() */
+#include <string.h> /* memcpy() strlen() */
 
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
@@ -67,6 +67,8 @@ static int resolve_path(const fsdata_t *fsd, const char path[],
 		char real_path[]);
 static int traverse_node(node_t *node, const node_t *parent,
 		fsdata_traverser_func traverser, void *arg);
+static void traverse_paths(const node_t *node, char path[], size_t len,
+		fsdata_path_visit_func visitor, void *arg);
 
 fsdata_t *
 fsdata_create(int prefix, int resolve_paths)
@@ -414,5 +416,59 @@ traverse_node(node_t *node, const node_t *parent,
 	return 0;
 }
 
+void
+fsdata_traverse_paths(fsdata_t *fsd, fsdata_path_visit_func visitor, void *arg)
+{
+	if(fsd->root == NULL)
+	{
+		return;
+	}
+
+	if(fsd->root->valid)
+	{
+		visitor("/", &fsd->root->data, arg);
+	}
+
+	/* Paths on Windows start with a drive letter, which is a child of the
+	 * root. */
+#ifndef _WIN32
+	char path[PATH_MAX + 1] = "/";
+#else
+	char path[PATH_MAX + 1] = "";
+#endif
+	traverse_paths(fsd->root, path, strlen(path), visitor, arg);
+}
+
+/* fsdata_traverse_paths() helper which visits children of the node.  path
+ * holds path of the node and has len characters. */
+static void
+traverse_paths(const node_t *node, char path[], size_t len,
+		fsdata_path_visit_func visitor, void *arg)
+{
+	for(node = node->child; node != NULL; node = node->next)
+	{
+		const int need_slash = (len != 0U && path[len - 1U] != '/');
+		const size_t new_len = len + need_slash + node->name_len;
+		if(new_len > PATH_MAX)
+		{
+			continue;
+		}
+
+		if(need_slash)
+		{
+			path[len] = '/';
+		}
+		memcpy(&path[len + need_slash], node->name, node->name_len + 1U);
+
+		if(node->valid)
+		{
+			visitor(path, &node->data, arg);
+		}
+		traverse_paths(node, path, new_len, visitor, arg);
+	}
+
+	path[len] = '\0';
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
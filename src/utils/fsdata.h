@@ -37,6 +37,10 @@ typedef int (*fsdata_traverser_func)(const char name[], int valid,
 /* Type of callback for fsdata_map_parents(). */
 typedef void (*fsdata_visit_func)(void *data, void *arg);
 
+/* Type of callback for fsdata_traverse_paths(). */
+typedef void (*fsdata_path_visit_func)(const char path[], const void *data,
+		void *arg);
+
 /* prefix mode causes queries to return nearest match when exact match is not
  * available.  Non-zero resolve_paths enables path resolution, which also
  * forbids use of nonexistent files.  Returns NULL on error. */
@@ -63,6 +67,11 @@ int fsdata_map_parents(fsdata_t *fsd, const char path[],
  * prematurely, otherwise zero is returned. */
 int fsdata_traverse(fsdata_t *fsd, fsdata_traverser_func traverser, void *arg);
 
+/* Calls the visitor for each valid node passing it absolute path of the
+ * node. */
+void fsdata_traverse_paths(fsdata_t *fsd, fsdata_path_visit_func visitor,
+		void *arg);
+
 #endif /* VIFM__UTILS__FSDATA_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -31,6 +31,26 @@ typedef enum
 }
 FSWatchState;
 
+/* Kinds of changes of individual files. */
+typedef enum
+{
+	FSWC_CREATED, /* File has appeared (created or moved in). */
+	FSWC_DELETED, /* File has disappeared (deleted or moved out). */
+	FSWC_CHANGED  /* Contents or meta-data of a file has changed. */
+}
+FSWatchChange;
+
+/* Single change of a file within watched directory. */
+typedef struct
+{
+	char *name;         /* Name of the file (full path for a watcher of several
+	                       directories). */
+	FSWatchChange kind; /* What has happened to it. */
+}
+fswatch_change_t;
+
+struct selector_t;
+
 /* Opaque type of a watcher. */
 typedef struct fswatch_t fswatch_t;
 
@@ -38,6 +58,17 @@ typedef struct fswatch_t fswatch_t;
  * error. */
 fswatch_t * fswatch_create(const char path[]);
 
+/* Creates new watcher for lists of files of several directories, which are
+ * added via fswatch_add().  Only creation, removal and renaming of files are
+ * tracked and there is no detection of replacement of directories.  Returns the
+ * watcher or NULL on error or if this kind of watching isn't supported. */
+fswatch_t * fswatch_create_set(void);
+
+/* Adds directory to a watcher created by fswatch_create_set().  Returns zero on
+ * success, otherwise non-zero is returned (e.g., when system limit on number of
+ * watches is reached). */
+int fswatch_add(fswatch_t *w, const char path[]);
+
 /* Frees a watcher.  w can be NULL. */
 void fswatch_free(fswatch_t *w);
 
@@ -45,6 +76,19 @@ void fswatch_free(fswatch_t *w);
  * query.  Returns latest state. */
 FSWatchState fswatch_poll(fswatch_t *w);
 
+/* Retrieves changes of individual files discovered by the last
+ * fswatch_poll() in the order in which they happened.  *count is set to the
+ * number of elements.  The list is valid until the next call to fswatch_poll()
+ * or fswatch_free().  Returns the list or NULL if changes can't be described on
+ * per-file basis (e.g., some events were lost or the platform doesn't provide
+ * such information), in which case everything should be considered changed. */
+const fswatch_change_t * fswatch_get_changes(const fswatch_t *w, int *count);
+
+/* Adds object that becomes ready on changes to the selector to be able to wait
+ * for them instead of calling fswatch_poll() periodically.  Returns non-zero if
+ * the watcher still needs to be polled. */
+int fswatch_add_to_selector(const fswatch_t *w, struct selector_t *selector);
+
 #endif /* VIFM__UTILS__FSWATCH_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
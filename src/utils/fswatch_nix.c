@@ -20,6 +20,8 @@
 
 #include <stdlib.h> /* free() malloc() */
 
+#include "selector.h"
+
 #ifdef HAVE_INOTIFY
 
 #include <sys/inotify.h> /* IN_* inotify_* */
@@ -35,25 +37,44 @@
 
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
+#include "../compat/reallocarray.h"
+#include "str.h"
 #include "trie.h"
 
 /* TODO: consider implementation that could reuse already available descriptor
  *       by just removing old watch and then adding a new one. */
 
+/* Directory of a watcher of several directories. */
+typedef struct
+{
+	int wd;     /* Watch descriptor. */
+	char *path; /* Path to the directory. */
+}
+watched_dir_t;
+
 /* Watcher data. */
 struct fswatch_t
 {
-	/* Path that's being watched. */
+	/* Path that's being watched or NULL for a watcher of several directories. */
 	char *path;
 	/* File descriptor for inotify. */
 	int fd;
-	/* Watch descriptor. */
+	/* Watch descriptor or -1 for a watcher of several directories. */
 	int wd;
 	/* Trie to keep track of per file frequency of notifications. */
 	trie_t *stats;
 	/* To monitor mount events, which aren't reported by inotify. */
 	dev_t dev;
 	ino_t inode;
+	/* Changes of files discovered by the last poll. */
+	fswatch_change_t *changes;
+	int nchanges;
+	/* Whether some changes weren't recorded in the list above. */
+	int changes_lost;
+	/* Directories of a watcher of several directories sorted by their watch
+	 * descriptors. */
+	watched_dir_t *dirs;
+	int ndirs;
 };
 
 /* Per file statistics information. */
@@ -67,15 +88,24 @@ typedef struct
 }
 notif_stat_t;
 
+static fswatch_t * alloc_watcher(void);
 static FSWatchState poll_for_replacement(fswatch_t *w);
 static int update_file_stats(fswatch_t *w, const struct inotify_event *e,
 		time_t now);
+static void record_change(fswatch_t *w, const struct inotify_event *e);
+static char * get_event_path(const fswatch_t *w, const struct inotify_event *e);
+static const watched_dir_t * find_dir(const fswatch_t *w, int wd);
+static void reset_changes(fswatch_t *w);
 
 /* Events we're interested in. */
 static const uint32_t EVENTS_MASK = IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE
                                   | IN_CREATE | IN_DELETE | IN_EXCL_UNLINK
                                   | IN_MOVED_FROM | IN_MOVED_TO;
 
+/* Events that change list of files of a directory. */
+static const uint32_t LIST_EVENTS_MASK = IN_CREATE | IN_DELETE | IN_EXCL_UNLINK
+                                       | IN_MOVED_FROM | IN_MOVED_TO;
+
 fswatch_t *
 fswatch_create(const char path[])
 {
@@ -85,7 +115,7 @@ fswatch_create(const char path[])
 		return NULL;
 	}
 
-	fswatch_t *const w = malloc(sizeof(*w));
+	fswatch_t *const w = alloc_watcher();
 	if(w == NULL)
 	{
 		return NULL;
@@ -94,11 +124,55 @@ fswatch_create(const char path[])
 	w->dev = st.st_dev;
 	w->inode = st.st_ino;
 
+	/* Add directory to watch. */
+	w->wd = inotify_add_watch(w->fd, path, EVENTS_MASK);
+	if(w->wd == -1)
+	{
+		fswatch_free(w);
+		return NULL;
+	}
+
+	w->path = strdup(path);
+	if(w->path == NULL)
+	{
+		fswatch_free(w);
+		return NULL;
+	}
+
+	return w;
+}
+
+fswatch_t *
+fswatch_create_set(void)
+{
+	return alloc_watcher();
+}
+
+/* Allocates and initializes watcher that doesn't watch anything yet.  Returns
+ * the watcher or NULL on error. */
+static fswatch_t *
+alloc_watcher(void)
+{
+	fswatch_t *const w = malloc(sizeof(*w));
+	if(w == NULL)
+	{
+		return NULL;
+	}
+
+	w->path = NULL;
+	w->wd = -1;
+	w->dev = 0;
+	w->inode = 0;
+	w->changes = NULL;
+	w->nchanges = 0;
+	w->changes_lost = 0;
+	w->dirs = NULL;
+	w->ndirs = 0;
+
 	/* Create tree to collect update frequency statistics. */
 	w->stats = trie_create();
 	if(w->stats == NULL)
 	{
-		trie_free_with_data(w->stats, &free);
 		free(w);
 		return NULL;
 	}
@@ -112,24 +186,57 @@ fswatch_create(const char path[])
 		return NULL;
 	}
 
-	/* Add directory to watch. */
-	w->wd = inotify_add_watch(w->fd, path, EVENTS_MASK);
-	if(w->wd == -1)
+	return w;
+}
+
+int
+fswatch_add(fswatch_t *w, const char path[])
+{
+	if(w->path != NULL)
 	{
-		close(w->fd);
-		trie_free_with_data(w->stats, &free);
-		free(w);
-		return NULL;
+		return 1;
 	}
 
-	w->path = strdup(path);
-	if(w->path == NULL)
+	watched_dir_t *const dirs = reallocarray(w->dirs, w->ndirs + 1,
+			sizeof(*dirs));
+	if(dirs == NULL)
 	{
-		fswatch_free(w);
-		return NULL;
+		return 1;
 	}
+	w->dirs = dirs;
 
-	return w;
+	char *const path_copy = strdup(path);
+	if(path_copy == NULL)
+	{
+		return 1;
+	}
+
+	const int wd = inotify_add_watch(w->fd, path, LIST_EVENTS_MASK);
+	if(wd == -1)
+	{
+		free(path_copy);
+		return 1;
+	}
+
+	/* Watch descriptor is the same for paths that point to the same directory. */
+	if(find_dir(w, wd) != NULL)
+	{
+		free(path_copy);
+		return 0;
+	}
+
+	/* Descriptors are usually allocated in increasing order, so this loop
+	 * shouldn't do many iterations. */
+	int pos = w->ndirs;
+	while(pos > 0 && dirs[pos - 1].wd > wd)
+	{
+		dirs[pos] = dirs[pos - 1];
+		--pos;
+	}
+	dirs[pos].wd = wd;
+	dirs[pos].path = path_copy;
+	++w->ndirs;
+	return 0;
 }
 
 void
@@ -137,6 +244,14 @@ fswatch_free(fswatch_t *w)
 {
 	if(w != NULL)
 	{
+		int i;
+		for(i = 0; i < w->ndirs; ++i)
+		{
+			free(w->dirs[i].path);
+		}
+		free(w->dirs);
+
+		reset_changes(w);
 		free(w->path);
 		trie_free_with_data(w->stats, &free);
 		close(w->fd);
@@ -156,6 +271,8 @@ fswatch_poll(fswatch_t *w)
 	int nreads = 0;
 	const time_t now = time(NULL);
 
+	reset_changes(w);
+
 	do
 	{
 		char *p;
@@ -167,6 +284,7 @@ fswatch_poll(fswatch_t *w)
 		{
 			if(errno != EAGAIN)
 			{
+				w->changes_lost = 1;
 				return FSWS_ERRORED;
 			}
 			break;
@@ -178,11 +296,22 @@ fswatch_poll(fswatch_t *w)
 			e = (struct inotify_event *)p;
 			if((e->mask & IN_IGNORED) != 0 && e->wd == w->wd)
 			{
+				w->changes_lost = 1;
 				return poll_for_replacement(w);
 			}
 
+			if((e->mask & IN_Q_OVERFLOW) != 0)
+			{
+				/* Some events were dropped by the kernel, so the list of changes is
+				 * incomplete. */
+				w->changes_lost = 1;
+				changed = 1;
+				continue;
+			}
+
 			if((e->mask & EVENTS_MASK) != 0 && update_file_stats(w, e, now))
 			{
+				record_change(w, e);
 				changed = 1;
 			}
 		}
@@ -196,7 +325,47 @@ fswatch_poll(fswatch_t *w)
 	}
 	while(nread != 0);
 
-	return (changed ? FSWS_UPDATED : poll_for_replacement(w));
+	if(changed)
+	{
+		return FSWS_UPDATED;
+	}
+
+	if(w->path == NULL)
+	{
+		/* Replacement isn't tracked for several directories. */
+		return FSWS_UNCHANGED;
+	}
+
+	const FSWatchState state = poll_for_replacement(w);
+	if(state != FSWS_UNCHANGED)
+	{
+		w->changes_lost = 1;
+	}
+	return state;
+}
+
+const fswatch_change_t *
+fswatch_get_changes(const fswatch_t *w, int *count)
+{
+	if(w->changes_lost)
+	{
+		*count = 0;
+		return NULL;
+	}
+
+	/* Make sure that empty list is distinguishable from NULL. */
+	static const fswatch_change_t no_changes;
+	*count = w->nchanges;
+	return (w->nchanges == 0 ? &no_changes : w->changes);
+}
+
+int
+fswatch_add_to_selector(const fswatch_t *w, selector_t *selector)
+{
+	/* Replacement of the target is detected by fswatch_poll(), but it's a rare
+	 * event and is checked whenever the watcher is polled for other reasons. */
+	selector_add(selector, w->fd);
+	return 0;
 }
 
 /* Detects replacement of path's target.  Returns watcher's state. */
@@ -243,7 +412,9 @@ update_file_stats(fswatch_t *w, const struct inotify_event *e, time_t now)
 	const uint32_t IMPORTANT_EVENTS = IN_CREATE | IN_DELETE | IN_MOVED_FROM
 	                                | IN_MOVED_TO | IN_Q_OVERFLOW;
 
-	const char *const fname = (e->len == 0U) ? "." : e->name;
+	char *const path = get_event_path(w, e);
+	const char *const fname = (path != NULL) ? path
+	                        : (e->len == 0U) ? "." : e->name;
 	void *data;
 	notif_stat_t *stats;
 
@@ -263,9 +434,11 @@ update_file_stats(fswatch_t *w, const struct inotify_event *e, time_t now)
 			}
 		}
 
+		free(path);
 		return 1;
 	}
 
+	free(path);
 	stats = data;
 
 	/* Unban entry on any of the "important" events. */
@@ -298,6 +471,118 @@ update_file_stats(fswatch_t *w, const struct inotify_event *e, time_t now)
 	return 1;
 }
 
+/* Appends file change described by the event to the list of changes. */
+static void
+record_change(fswatch_t *w, const struct inotify_event *e)
+{
+	if(w->changes_lost)
+	{
+		return;
+	}
+
+	if(e->len == 0U)
+	{
+		/* Change of the directory itself might affect all of its files. */
+		w->changes_lost = 1;
+		return;
+	}
+
+	fswatch_change_t *const changes =
+		reallocarray(w->changes, w->nchanges + 1, sizeof(*changes));
+	if(changes == NULL)
+	{
+		w->changes_lost = 1;
+		return;
+	}
+	w->changes = changes;
+
+	fswatch_change_t *const change = &changes[w->nchanges];
+	change->name = (w->path == NULL) ? get_event_path(w, e) : strdup(e->name);
+	if(change->name == NULL)
+	{
+		w->changes_lost = 1;
+		return;
+	}
+
+	if(e->mask & (IN_CREATE | IN_MOVED_TO))
+	{
+		change->kind = FSWC_CREATED;
+	}
+	else if(e->mask & (IN_DELETE | IN_MOVED_FROM))
+	{
+		change->kind = FSWC_DELETED;
+	}
+	else
+	{
+		change->kind = FSWC_CHANGED;
+	}
+
+	++w->nchanges;
+}
+
+/* Builds full path to the file an event is about for a watcher of several
+ * directories.  Returns newly allocated string or NULL for a watcher of a
+ * single directory or on error. */
+static char *
+get_event_path(const fswatch_t *w, const struct inotify_event *e)
+{
+	if(w->path != NULL)
+	{
+		return NULL;
+	}
+
+	const watched_dir_t *const dir = find_dir(w, e->wd);
+	if(dir == NULL)
+	{
+		return NULL;
+	}
+
+	return (e->len == 0U) ? strdup(dir->path)
+	                      : format_str("%s/%s", dir->path, e->name);
+}
+
+/* Looks up directory of a watcher of several directories by its watch
+ * descriptor.  Returns the directory or NULL if it's not found. */
+static const watched_dir_t *
+find_dir(const fswatch_t *w, int wd)
+{
+	int l = 0, u = w->ndirs - 1;
+	while(l <= u)
+	{
+		const int i = l + (u - l)/2;
+		if(w->dirs[i].wd == wd)
+		{
+			return &w->dirs[i];
+		}
+
+		if(w->dirs[i].wd < wd)
+		{
+			l = i + 1;
+		}
+		else
+		{
+			u = i - 1;
+		}
+	}
+	return NULL;
+}
+
+/* Empties list of changes of the watcher. */
+static void
+reset_changes(fswatch_t *w)
+{
+	int i;
+	for(i = 0; i < w->nchanges; ++i)
+	{
+		free(w->changes[i].name);
+	}
+	free(w->changes);
+
+	w->changes = NULL;
+	w->nchanges = 0;
+	w->changes_lost = 0;
+}
+
 #else
 
 #include "filemon.h"
@@ -362,6 +647,34 @@ fswatch_poll(fswatch_t *w)
 	return (changed ? FSWS_UPDATED : FSWS_UNCHANGED);
 }
 
+fswatch_t *
+fswatch_create_set(void)
+{
+	/* Several directories can't be checked without polling all of them. */
+	return NULL;
+}
+
+int
+fswatch_add(fswatch_t *w, const char path[])
+{
+	return 1;
+}
+
+const fswatch_change_t *
+fswatch_get_changes(const fswatch_t *w, int *count)
+{
+	/* Only modification of the directory is known. */
+	*count = 0;
+	return NULL;
+}
+
+int
+fswatch_add_to_selector(const fswatch_t *w, selector_t *selector)
+{
+	/* Timestamps can only be polled. */
+	return 1;
+}
+
 #endif
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
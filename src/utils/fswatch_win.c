@@ -25,6 +25,7 @@
 
 #include "../compat/fs_limits.h"
 #include "macros.h"
+#include "selector.h"
 #include "str.h"
 #include "utf8.h"
 
@@ -75,6 +76,19 @@ fswatch_create(const char path[])
 	return w;
 }
 
+fswatch_t *
+fswatch_create_set(void)
+{
+	/* Several directories can't be checked without polling all of them. */
+	return NULL;
+}
+
+int
+fswatch_add(fswatch_t *w, const char path[])
+{
+	return 1;
+}
+
 void
 fswatch_free(fswatch_t *w)
 {
@@ -107,6 +121,21 @@ fswatch_poll(fswatch_t *w)
 	return (changed ? FSWS_UPDATED : FSWS_UNCHANGED);
 }
 
+const fswatch_change_t *
+fswatch_get_changes(const fswatch_t *w, int *count)
+{
+	/* Only the fact of a change is known. */
+	*count = 0;
+	return NULL;
+}
+
+int
+fswatch_add_to_selector(const fswatch_t *w, selector_t *selector)
+{
+	selector_add(selector, w->dir_watcher);
+	return 0;
+}
+
 /* Gets last directory modification time.  Returns non-zero on error, otherwise
  * zero is returned. */
 static int
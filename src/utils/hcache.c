@@ -0,0 +1,667 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "hcache.h"
+
+#ifndef _WIN32
+#include <sys/mman.h> /* MAP_FAILED MAP_PRIVATE PROT_READ mmap() munmap() */
+#include <fcntl.h> /* O_RDONLY open() */
+#include <unistd.h> /* close() */
+#endif
+
+#include <sys/stat.h> /* S_ISREG stat fstat() */
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* int64_t uint32_t uint64_t */
+#include <stdio.h> /* FILE fclose() fread() fwrite() remove() snprintf() */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* memcmp() memcpy() memset() strdup() */
+
+#include "../compat/fs_limits.h"
+#include "../compat/os.h"
+#include "../compat/reallocarray.h"
+#include "fs.h"
+#include "macros.h"
+#include "utils.h"
+
+/* Signature of a cache file. */
+#define MAGIC "vifmhc1"
+
+/* Maximum number of records written to a file.  Records that weren't used
+ * since the cache was opened are dropped first to fit into the limit. */
+#define MAX_RECORDS (2U*1024U*1024U)
+
+/* Flags of a record. */
+enum
+{
+	HAS_PREFIX = 1 << 0, /* Hash of a prefix is set. */
+	HAS_DIGEST = 1 << 1, /* Digest of the whole contents is set. */
+};
+
+/* Header of a cache file. */
+typedef struct
+{
+	char magic[8];     /* MAGIC. */
+	uint32_t kind;     /* Kind of hashes as passed to hcache_open(). */
+	uint32_t rec_size; /* Size of a record to detect changes in the format. */
+}
+header_t;
+
+/* Information about a single file. */
+typedef struct
+{
+	hcache_key_t key;   /* State of the file. */
+	uint64_t prefix;    /* Hash of a prefix of the file. */
+	uint64_t digest[2]; /* Digest of the whole file. */
+	uint32_t flags;     /* Which fields are set. */
+	uint32_t padding;   /* Always zero. */
+}
+record_t;
+
+struct hcache_t
+{
+	char *path;    /* Location of the file. */
+	uint32_t kind; /* Kind of hashes. */
+	int changed;   /* Whether any record was added or updated. */
+
+	void *data;           /* Contents of the file or NULL. */
+	size_t data_size;     /* Size of the data. */
+	const record_t *recs; /* Sorted records of the file (points into data). */
+	size_t nrecs;         /* Number of elements in recs. */
+	unsigned char *used;  /* Bit per element of recs that was looked up. */
+
+	record_t *added;  /* New records and updated copies of elements of recs. */
+	size_t nadded;    /* Number of used elements in added. */
+	size_t added_cap; /* Number of allocated elements in added. */
+	size_t *slots;    /* Hash table of indexes of added (plus one). */
+	size_t nslots;    /* Number of slots (a power of two). */
+};
+
+static void load_file(hcache_t *cache);
+static void unload_file(hcache_t *cache);
+static const record_t * find(hcache_t *cache, const hcache_key_t *key);
+static const record_t * find_added(const hcache_t *cache,
+		const hcache_key_t *key);
+static const record_t * find_stored(hcache_t *cache, const hcache_key_t *key);
+static record_t * get_added(hcache_t *cache, const hcache_key_t *key);
+static int index_added(hcache_t *cache, size_t nslots);
+static size_t hash_key(const hcache_key_t *key);
+static int key_cmp(const hcache_key_t *a, const hcache_key_t *b);
+static int record_cmp(const void *a, const void *b);
+static int is_live(const hcache_t *cache, const record_t *rec);
+static int write_records(const hcache_t *cache, const record_t *recs[],
+		size_t nrecs);
+
+int
+hcache_key_of(const char path[], hcache_key_t *key)
+{
+#ifndef _WIN32
+	struct stat st;
+	if(os_stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		return 1;
+	}
+
+	key->dev = st.st_dev;
+	key->inode = st.st_ino;
+	key->size = st.st_size;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+	key->mtime = (int64_t)st.st_mtim.tv_sec*1000000000 + st.st_mtim.tv_nsec;
+	key->ctime = (int64_t)st.st_ctim.tv_sec*1000000000 + st.st_ctim.tv_nsec;
+#else
+	key->mtime = (int64_t)st.st_mtime*1000000000;
+	key->ctime = (int64_t)st.st_ctime*1000000000;
+#endif
+	return 0;
+#else
+	/* Inode numbers aren't available, so files can't be told apart. */
+	(void)path;
+	(void)key;
+	return 1;
+#endif
+}
+
+hcache_t *
+hcache_open(const char path[], uint32_t kind)
+{
+	hcache_t *const cache = calloc(1, sizeof(*cache));
+	if(cache == NULL)
+	{
+		return NULL;
+	}
+
+	cache->path = strdup(path);
+	if(cache->path == NULL)
+	{
+		free(cache);
+		return NULL;
+	}
+
+	cache->kind = kind;
+	load_file(cache);
+	return cache;
+}
+
+/* Makes records of the file available for lookups if the file exists and is
+ * valid. */
+static void
+load_file(hcache_t *cache)
+{
+#ifndef _WIN32
+	const int fd = open(cache->path, O_RDONLY);
+	if(fd == -1)
+	{
+		return;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header_t))
+	{
+		close(fd);
+		return;
+	}
+
+	void *const data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED)
+	{
+		return;
+	}
+	cache->data = data;
+	cache->data_size = st.st_size;
+#else
+	const uint64_t size = get_file_size(cache->path);
+	if(size < sizeof(header_t) || size > SIZE_MAX)
+	{
+		return;
+	}
+
+	FILE *const fp = os_fopen(cache->path, "rb");
+	if(fp == NULL)
+	{
+		return;
+	}
+
+	cache->data = malloc(size);
+	cache->data_size = size;
+	if(cache->data == NULL || fread(cache->data, size, 1, fp) != 1)
+	{
+		fclose(fp);
+		unload_file(cache);
+		return;
+	}
+	fclose(fp);
+#endif
+
+	header_t header;
+	memcpy(&header, cache->data, sizeof(header));
+	const size_t payload = cache->data_size - sizeof(header);
+	if(memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 ||
+			header.kind != cache->kind || header.rec_size != sizeof(record_t) ||
+			payload%sizeof(record_t) != 0U)
+	{
+		unload_file(cache);
+		return;
+	}
+
+	cache->recs = (const record_t *)((const char *)cache->data + sizeof(header));
+	cache->nrecs = payload/sizeof(record_t);
+	cache->used = calloc(DIV_ROUND_UP(cache->nrecs, 8U) + 1U, 1);
+	if(cache->used == NULL)
+	{
+		unload_file(cache);
+	}
+}
+
+/* Releases resources associated with the file. */
+static void
+unload_file(hcache_t *cache)
+{
+	if(cache->data != NULL)
+	{
+#ifndef _WIN32
+		munmap(cache->data, cache->data_size);
+#else
+		free(cache->data);
+#endif
+	}
+
+	free(cache->used);
+
+	cache->data = NULL;
+	cache->data_size = 0U;
+	cache->recs = NULL;
+	cache->nrecs = 0U;
+	cache->used = NULL;
+}
+
+int
+hcache_save(hcache_t *cache)
+{
+	if(!cache->changed)
+	{
+		return 0;
+	}
+
+	/* Sorting reorders records, so the index has to be rebuilt afterwards. */
+	safe_qsort(cache->added, cache->nadded, sizeof(*cache->added), &record_cmp);
+	if(index_added(cache, cache->nslots) != 0)
+	{
+		return 1;
+	}
+
+	const record_t **const recs = reallocarray(NULL,
+			cache->nrecs + cache->nadded, sizeof(*recs));
+	if(recs == NULL)
+	{
+		return 1;
+	}
+
+	/* Merge two sorted sequences of records preferring added ones as they are
+	 * more recent. */
+	size_t i = 0U, j = 0U, n = 0U;
+	while(i < cache->nrecs || j < cache->nadded)
+	{
+		const int cmp = (i == cache->nrecs) ? 1
+		              : (j == cache->nadded) ? -1
+		              : key_cmp(&cache->recs[i].key, &cache->added[j].key);
+		if(cmp < 0)
+		{
+			recs[n++] = &cache->recs[i++];
+			continue;
+		}
+
+		if(cmp == 0)
+		{
+			++i;
+		}
+		recs[n++] = &cache->added[j++];
+	}
+
+	/* Drop old states of files which were seen in their current state. */
+	size_t nlive = 0U, m = 0U;
+	for(i = 0U; i < n; i = j)
+	{
+		int has_live = 0;
+		for(j = i; j < n && recs[j]->key.dev == recs[i]->key.dev &&
+				recs[j]->key.inode == recs[i]->key.inode; ++j)
+		{
+			has_live |= is_live(cache, recs[j]);
+		}
+
+		size_t k;
+		for(k = i; k < j; ++k)
+		{
+			const int live = is_live(cache, recs[k]);
+			if(live || !has_live)
+			{
+				recs[m++] = recs[k];
+				nlive += live;
+			}
+		}
+	}
+	n = m;
+
+	/* Enforce size limit by dropping records which weren't used first. */
+	if(n > MAX_RECORDS)
+	{
+		size_t budget = (nlive < MAX_RECORDS) ? MAX_RECORDS - nlive : 0U;
+		size_t kept_live = 0U;
+		m = 0U;
+		for(i = 0U; i < n; ++i)
+		{
+			if(is_live(cache, recs[i]))
+			{
+				if(kept_live < MAX_RECORDS)
+				{
+					recs[m++] = recs[i];
+					++kept_live;
+				}
+			}
+			else if(budget != 0U)
+			{
+				recs[m++] = recs[i];
+				--budget;
+			}
+		}
+		n = m;
+	}
+
+	const int error = write_records(cache, recs, n);
+	free(recs);
+
+	if(error == 0)
+	{
+		cache->changed = 0;
+	}
+	return error;
+}
+
+/* Writes records to the file replacing it atomically.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+write_records(const hcache_t *cache, const record_t *recs[], size_t nrecs)
+{
+	char tmp_path[PATH_MAX + 32];
+	snprintf(tmp_path, sizeof(tmp_path), "%s_%u", cache->path, get_pid());
+
+	FILE *const fp = os_fopen(tmp_path, "wb");
+	if(fp == NULL)
+	{
+		return 1;
+	}
+
+	header_t header = { .kind = cache->kind, .rec_size = sizeof(record_t) };
+	memcpy(header.magic, MAGIC, sizeof(header.magic));
+	int error = (fwrite(&header, sizeof(header), 1, fp) != 1);
+
+	size_t i;
+	for(i = 0U; i < nrecs && !error; ++i)
+	{
+		error = (fwrite(recs[i], sizeof(*recs[i]), 1, fp) != 1);
+	}
+
+	error |= (fclose(fp) != 0);
+	if(error || rename_file(tmp_path, cache->path) != 0)
+	{
+		(void)remove(tmp_path);
+		return 1;
+	}
+	return 0;
+}
+
+void
+hcache_free(hcache_t *cache)
+{
+	if(cache != NULL)
+	{
+		unload_file(cache);
+		free(cache->added);
+		free(cache->slots);
+		free(cache->path);
+		free(cache);
+	}
+}
+
+int
+hcache_get_prefix(hcache_t *cache, const hcache_key_t *key, uint64_t *hash)
+{
+	const record_t *const rec = find(cache, key);
+	if(rec == NULL || !(rec->flags & HAS_PREFIX))
+	{
+		return 0;
+	}
+
+	*hash = rec->prefix;
+	return 1;
+}
+
+void
+hcache_set_prefix(hcache_t *cache, const hcache_key_t *key, uint64_t hash)
+{
+	record_t *const rec = get_added(cache, key);
+	if(rec != NULL)
+	{
+		rec->prefix = hash;
+		rec->flags |= HAS_PREFIX;
+	}
+}
+
+int
+hcache_get_digest(hcache_t *cache, const hcache_key_t *key, uint64_t digest[2])
+{
+	const record_t *const rec = find(cache, key);
+	if(rec == NULL || !(rec->flags & HAS_DIGEST))
+	{
+		return 0;
+	}
+
+	digest[0] = rec->digest[0];
+	digest[1] = rec->digest[1];
+	return 1;
+}
+
+void
+hcache_set_digest(hcache_t *cache, const hcache_key_t *key,
+		const uint64_t digest[2])
+{
+	record_t *const rec = get_added(cache, key);
+	if(rec != NULL)
+	{
+		rec->digest[0] = digest[0];
+		rec->digest[1] = digest[1];
+		rec->flags |= HAS_DIGEST;
+	}
+}
+
+/* Looks up the most recent record for the key.  Returns the record or NULL. */
+static const record_t *
+find(hcache_t *cache, const hcache_key_t *key)
+{
+	const record_t *const rec = find_added(cache, key);
+	return (rec != NULL) ? rec : find_stored(cache, key);
+}
+
+/* Looks up a record among added ones.  Returns the record or NULL. */
+static const record_t *
+find_added(const hcache_t *cache, const hcache_key_t *key)
+{
+	if(cache->nslots == 0U)
+	{
+		return NULL;
+	}
+
+	size_t slot = hash_key(key) & (cache->nslots - 1U);
+	while(cache->slots[slot] != 0U)
+	{
+		const record_t *const rec = &cache->added[cache->slots[slot] - 1U];
+		if(key_cmp(&rec->key, key) == 0)
+		{
+			return rec;
+		}
+		slot = (slot + 1U) & (cache->nslots - 1U);
+	}
+	return NULL;
+}
+
+/* Looks up a record among those of the file and marks it as used.  Returns the
+ * record or NULL. */
+static const record_t *
+find_stored(hcache_t *cache, const hcache_key_t *key)
+{
+	size_t l = 0U, r = cache->nrecs;
+	while(l < r)
+	{
+		const size_t m = l + (r - l)/2U;
+		const int cmp = key_cmp(&cache->recs[m].key, key);
+		if(cmp == 0)
+		{
+			cache->used[m/8U] |= 1U << (m%8U);
+			return &cache->recs[m];
+		}
+
+		if(cmp < 0)
+		{
+			l = m + 1U;
+		}
+		else
+		{
+			r = m;
+		}
+	}
+	return NULL;
+}
+
+/* Retrieves modifiable record for the key creating it if necessary.  The
+ * pointer is valid until the next addition.  Returns the record or NULL on
+ * error. */
+static record_t *
+get_added(hcache_t *cache, const hcache_key_t *key)
+{
+	cache->changed = 1;
+
+	const record_t *const added = find_added(cache, key);
+	if(added != NULL)
+	{
+		return (record_t *)added;
+	}
+
+	if(cache->nadded == cache->added_cap)
+	{
+		const size_t cap = (cache->added_cap == 0U) ? 64U : cache->added_cap*2U;
+		record_t *const resized = reallocarray(cache->added, cap,
+				sizeof(*resized));
+		if(resized == NULL)
+		{
+			return NULL;
+		}
+		cache->added = resized;
+		cache->added_cap = cap;
+	}
+
+	/* Keep load factor of the table under one half. */
+	if((cache->nadded + 1U)*2U > cache->nslots)
+	{
+		const size_t nslots = (cache->nslots == 0U) ? 128U : cache->nslots*2U;
+		if(index_added(cache, nslots) != 0)
+		{
+			return NULL;
+		}
+	}
+
+	record_t *const rec = &cache->added[cache->nadded];
+	const record_t *const stored = find_stored(cache, key);
+	if(stored != NULL)
+	{
+		*rec = *stored;
+	}
+	else
+	{
+		memset(rec, 0, sizeof(*rec));
+		rec->key = *key;
+	}
+
+	size_t slot = hash_key(key) & (cache->nslots - 1U);
+	while(cache->slots[slot] != 0U)
+	{
+		slot = (slot + 1U) & (cache->nslots - 1U);
+	}
+	cache->slots[slot] = ++cache->nadded;
+
+	return rec;
+}
+
+/* Rebuilds hash table of added records with the specified number of slots.
+ * Returns zero on success, otherwise non-zero is returned. */
+static int
+index_added(hcache_t *cache, size_t nslots)
+{
+	if(nslots == 0U)
+	{
+		return 0;
+	}
+
+	size_t *const slots = calloc(nslots, sizeof(*slots));
+	if(slots == NULL)
+	{
+		return 1;
+	}
+
+	size_t i;
+	for(i = 0U; i < cache->nadded; ++i)
+	{
+		size_t slot = hash_key(&cache->added[i].key) & (nslots - 1U);
+		while(slots[slot] != 0U)
+		{
+			slot = (slot + 1U) & (nslots - 1U);
+		}
+		slots[slot] = i + 1U;
+	}
+
+	free(cache->slots);
+	cache->slots = slots;
+	cache->nslots = nslots;
+	return 0;
+}
+
+/* Mixes fields of the key.  Returns the hash. */
+static size_t
+hash_key(const hcache_key_t *key)
+{
+	uint64_t h = key->dev*0x9e3779b97f4a7c15ULL ^ key->inode;
+	h = (h ^ (h >> 31))*0xbf58476d1ce4e5b9ULL ^ key->size;
+	h = (h ^ (h >> 29))*0x94d049bb133111ebULL ^ (uint64_t)key->mtime;
+	h = (h ^ (h >> 32))*0xbf58476d1ce4e5b9ULL ^ (uint64_t)key->ctime;
+	h = (h ^ (h >> 31))*0x94d049bb133111ebULL;
+	return h ^ (h >> 32);
+}
+
+/* Orders keys by their fields.  Returns negative number, zero or positive
+ * number like strcmp(). */
+static int
+key_cmp(const hcache_key_t *a, const hcache_key_t *b)
+{
+	if(a->dev != b->dev)
+	{
+		return (a->dev < b->dev) ? -1 : 1;
+	}
+	if(a->inode != b->inode)
+	{
+		return (a->inode < b->inode) ? -1 : 1;
+	}
+	if(a->size != b->size)
+	{
+		return (a->size < b->size) ? -1 : 1;
+	}
+	if(a->mtime != b->mtime)
+	{
+		return (a->mtime < b->mtime) ? -1 : 1;
+	}
+	if(a->ctime != b->ctime)
+	{
+		return (a->ctime < b->ctime) ? -1 : 1;
+	}
+	return 0;
+}
+
+/* qsort() comparer of records by their keys.  Returns standard -1, 0, 1 for
+ * comparisons. */
+static int
+record_cmp(const void *a, const void *b)
+{
+	const record_t *const rec_a = a;
+	const record_t *const rec_b = b;
+	return key_cmp(&rec_a->key, &rec_b->key);
+}
+
+/* Checks whether record was added or used since the cache was opened.  Returns
+ * non-zero if so, otherwise zero is returned. */
+static int
+is_live(const hcache_t *cache, const record_t *rec)
+{
+	if(rec >= cache->added && rec < cache->added + cache->nadded)
+	{
+		return 1;
+	}
+
+	const size_t i = rec - cache->recs;
+	return (cache->used[i/8U] >> (i%8U)) & 1U;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,81 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__HCACHE_H__
+#define VIFM__UTILS__HCACHE_H__
+
+#include <stdint.h> /* int64_t uint32_t uint64_t */
+
+/* Persistent cache of hashes of file contents.  Files are identified by their
+ * device, inode, size and timestamps, so any change of a file makes its old
+ * record unreachable.  The file of the cache is a sorted array of fixed-size
+ * records, which is mapped into memory and searched in place, while new records
+ * are kept aside until the cache is saved. */
+
+/* State of a file which identifies its contents. */
+typedef struct
+{
+	uint64_t dev;   /* Device number. */
+	uint64_t inode; /* Inode number. */
+	uint64_t size;  /* Size in bytes. */
+	int64_t mtime;  /* Modification time in nanoseconds. */
+	int64_t ctime;  /* Change time in nanoseconds. */
+}
+hcache_key_t;
+
+/* Opaque cache type. */
+typedef struct hcache_t hcache_t;
+
+/* Fills in the key for the file at path (symbolic links are followed).  Returns
+ * zero on success, otherwise non-zero is returned, which includes the case of
+ * systems where files can't be identified reliably. */
+int hcache_key_of(const char path[], hcache_key_t *key);
+
+/* Opens cache stored at path.  The kind identifies the way hashes are computed,
+ * contents of a file of a different kind is discarded.  Missing or broken file
+ * results in an empty cache.  Returns the cache or NULL on error. */
+hcache_t * hcache_open(const char path[], uint32_t kind);
+
+/* Writes out the cache if it was changed.  Returns zero on success, otherwise
+ * non-zero is returned. */
+int hcache_save(hcache_t *cache);
+
+/* Frees the cache without saving it.  cache can be NULL. */
+void hcache_free(hcache_t *cache);
+
+/* Retrieves hash of a prefix of the file.  Returns non-zero if it was found and
+ * *hash was set, otherwise zero is returned. */
+int hcache_get_prefix(hcache_t *cache, const hcache_key_t *key,
+		uint64_t *hash);
+
+/* Stores hash of a prefix of the file. */
+void hcache_set_prefix(hcache_t *cache, const hcache_key_t *key, uint64_t hash);
+
+/* Retrieves digest of the whole contents of the file.  Returns non-zero if it
+ * was found and digest was set, otherwise zero is returned. */
+int hcache_get_digest(hcache_t *cache, const hcache_key_t *key,
+		uint64_t digest[2]);
+
+/* Stores digest of the whole contents of the file. */
+void hcache_set_digest(hcache_t *cache, const hcache_key_t *key,
+		const uint64_t digest[2]);
+
+#endif /* VIFM__UTILS__HCACHE_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -22,9 +22,10 @@
 
 #include <stddef.h> /* NULL */
 #include <stdlib.h> /* free() malloc() */
-#include <string.h> /* strcspn() strdup() strlen() strrchr() */
+#include <string.h> /* strdup() strlen() strrchr() */
 
 #include "../int/file_magic.h"
+#include "fglobs.h"
 #include "globs.h"
 #include "path.h"
 #include "regexp.h"
@@ -49,8 +50,8 @@ struct matcher_t
 	MType type : 2;             /* Type of the matcher's pattern. */
 	unsigned int full_path : 1; /* Matches full path instead of just file name. */
 	unsigned int negated : 1;   /* Whether match is inverted. */
-	unsigned int fglobs : 1;    /* Whether this matcher is a special case of
-	                               globs ("faster" globs) that is optimized. */
+	fglobs_t *fglobs; /* Parsed globs if this matcher is a special case of globs
+	                     ("faster" globs) that is optimized, otherwise NULL. */
 	regex_t regex; /* The expression in compiled form, unless matcher is empty. */
 };
 
@@ -60,7 +61,7 @@ static MType determine_type(const char expr[], int re, int glob,
 static int compile_expr(matcher_t *m, int strip, int cs_by_def,
 		const char on_empty_re[], char **error);
 static int parse_glob(matcher_t *m, int strip, char **error);
-static int is_fglobs(char expr[]);
+static int is_fglobs(const char expr[]);
 static int parse_re(matcher_t *m, int strip, int cs_by_def,
 		const char on_empty_re[], char **error);
 static void free_matcher_items(matcher_t *matcher);
@@ -110,6 +111,7 @@ matcher_alloc(const char expr[], int cs_by_def, int glob_by_def,
 		free(m.raw);
 		free(m.expr);
 		free(m.undec);
+		fglobs_free(m.fglobs);
 		return NULL;
 	}
 
@@ -198,7 +200,7 @@ compile_expr(matcher_t *m, int strip, int cs_by_def, const char on_empty_re[],
 			break;
 	}
 
-	if(m->fglobs || m->raw[0] == '\0')
+	if(m->fglobs != NULL || m->raw[0] == '\0')
 	{
 		/* This is a faster glob or an empty matcher and we don't compile "". */
 		return 0;
@@ -235,7 +237,12 @@ parse_glob(matcher_t *m, int strip, char **error)
 
 	if(is_fglobs(m->raw))
 	{
-		m->fglobs = 1;
+		m->fglobs = fglobs_alloc();
+		if(m->fglobs == NULL || fglobs_add(m->fglobs, m->raw, 0) != 0)
+		{
+			replace_string(error, "Failed to parse globs.");
+			return 1;
+		}
 		return 0;
 	}
 
@@ -257,31 +264,9 @@ parse_glob(matcher_t *m, int strip, char **error)
  * implemented without regular expressions.  Returns non-zero if so, otherwise
  * zero is returned. */
 static int
-is_fglobs(char expr[])
+is_fglobs(const char expr[])
 {
-	if(expr[0] == '\0')
-	{
-		return 0;
-	}
-
-	expr = strdup(expr);
-
-	char *glob = expr, *state = NULL;
-	while((glob = split_and_get_dc(glob, &state)) != NULL)
-	{
-		if(glob[strcspn(glob, "[?*")] == '\0')
-		{
-			continue;
-		}
-		if(glob[0] == '*' && glob[1 + strcspn(glob + 1, "[?*")] == '\0')
-		{
-			continue;
-		}
-		break;
-	}
-
-	free(expr);
-	return (glob == NULL);
+	return (expr[0] != '\0' && fglobs_supported(expr));
 }
 
 /* Parses regexp flags.  Returns zero on success or non-zero on error with
@@ -338,6 +323,7 @@ matcher_clone(const matcher_t *matcher)
 	clone->expr = strdup(matcher->expr);
 	clone->raw = strdup(matcher->raw);
 	clone->undec = strdup(matcher->undec);
+	clone->fglobs = NULL;
 
 	if(clone->expr == NULL || clone->raw == NULL || clone->undec == NULL)
 	{
@@ -345,8 +331,17 @@ matcher_clone(const matcher_t *matcher)
 		return NULL;
 	}
 
+	if(matcher->fglobs != NULL)
+	{
+		clone->fglobs = fglobs_alloc();
+		if(clone->fglobs == NULL || fglobs_add(clone->fglobs, clone->raw, 0) != 0)
+		{
+			matcher_free(clone);
+			return NULL;
+		}
+	}
 	/* Don't compile regex for faster globs or empty matcher. */
-	if(!clone->fglobs && clone->raw[0] != '\0')
+	else if(clone->raw[0] != '\0')
 	{
 		if(regcomp(&clone->regex, matcher->raw, matcher->cflags) != 0)
 		{
@@ -373,11 +368,13 @@ matcher_free(matcher_t *matcher)
 static void
 free_matcher_items(matcher_t *matcher)
 {
-	if(!matcher->fglobs && matcher->raw != NULL && !matcher_is_empty(matcher))
+	if(matcher->fglobs == NULL && matcher->raw != NULL &&
+			!matcher_is_empty(matcher))
 	{
 		/* Regex is compiled only for non-empty matchers of unoptimized patterns. */
 		regfree(&matcher->regex);
 	}
+	fglobs_free(matcher->fglobs);
 	free(matcher->expr);
 	free(matcher->raw);
 	free(matcher->undec);
@@ -405,7 +402,7 @@ matcher_matches(const matcher_t *matcher, const char path[])
 		path = get_last_path_component(path);
 	}
 
-	if(matcher->fglobs)
+	if(matcher->fglobs != NULL)
 	{
 		return fglobs_matches(matcher, path);
 	}
@@ -418,27 +415,7 @@ matcher_matches(const matcher_t *matcher, const char path[])
 static int
 fglobs_matches(const matcher_t *matcher, const char path[])
 {
-	char *globs = strdup(matcher->raw);
-	char *glob = globs, *state = NULL;
-	while((glob = split_and_get_dc(glob, &state)) != NULL)
-	{
-		if(glob[strcspn(glob, "[?*")] == '\0')
-		{
-			if(strcasecmp(path, glob) == 0)
-			{
-				break;
-			}
-		}
-		if(glob[0] == '*' && glob[1 + strcspn(glob + 1, "[?*")] == '\0')
-		{
-			if(path[0] != '.' && ends_with_case(path + 1, glob + 1))
-			{
-				break;
-			}
-		}
-	}
-	free(globs);
-	return (glob != NULL)^matcher->negated;
+	return (fglobs_find(matcher->fglobs, path) >= 0)^matcher->negated;
 }
 
 int
@@ -462,13 +439,14 @@ matcher_get_undec(const matcher_t *matcher)
 int
 matcher_includes(const matcher_t *matcher, const matcher_t *like)
 {
-	if(matcher->type != like->type || matcher->fglobs != like->fglobs ||
+	if(matcher->type != like->type ||
+			(matcher->fglobs == NULL) != (like->fglobs == NULL) ||
 			matcher->cflags != like->cflags || matcher->full_path != like->full_path)
 	{
 		return 0;
 	}
 
-	if(matcher->fglobs)
+	if(matcher->fglobs != NULL)
 	{
 		return fglobs_includes(matcher, like);
 	}
@@ -554,6 +532,16 @@ is_mime_expr(const char expr[])
 	return surrounded_with(expr, '<', '>') && expr[2] != '\0';
 }
 
+const char *
+matcher_get_name_globs(const matcher_t *matcher)
+{
+	if(matcher->type != MT_GLOBS || matcher->negated || matcher->full_path)
+	{
+		return NULL;
+	}
+	return matcher->undec;
+}
+
 int
 matcher_is_full_path(const matcher_t *matcher)
 {
@@ -60,6 +60,10 @@ const char * matcher_get_undec(const matcher_t *matcher);
  * Returns non-zero if so, otherwise zero is returned. */
 int matcher_includes(const matcher_t *matcher, const matcher_t *like);
 
+/* Retrieves globs of a non-negated matcher of file names by globs.  Returns
+ * comma-separated list of globs or NULL for other kinds of matchers. */
+const char * matcher_get_name_globs(const matcher_t *matcher);
+
 /* Checks whether given matcher is a full path matcher.  Returns non-zero if so,
  * otherwise zero is returned. */
 int matcher_is_full_path(const matcher_t *matcher);
@@ -46,6 +46,10 @@ int matchers_match_dir(const matchers_t *matchers, const char path[]);
 /* Retrieves original matcher expression.  Returns the expression. */
 const char * matchers_get_expr(const matchers_t *matchers);
 
+/* Retrieves globs of the list if it consists of a single non-negated matcher
+ * of file names by globs.  Returns comma-separated list of globs or NULL. */
+const char * matchers_get_name_globs(const matchers_t *matchers);
+
 /* Checks whether matchers matches at least superset of what like is matching.
  * Returns non-zero if so, otherwise zero is returned. */
 int matchers_includes(const matchers_t *matchers, const matchers_t *like);
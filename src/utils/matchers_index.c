@@ -0,0 +1,545 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "matchers_index.h"
+
+#include <ctype.h> /* tolower() */
+#include <limits.h> /* INT_MAX */
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+#include <stdlib.h> /* free() malloc() */
+#include <string.h> /* memcpy() memset() strdup() */
+
+#include "../compat/fs_limits.h"
+#include "../compat/reallocarray.h"
+#include "macros.h"
+#include "matchers.h"
+#include "path.h"
+#include "fglobs.h"
+#include "str.h"
+
+/* Number of words of state sets of the automaton that are kept on stack during
+ * matching. */
+#define NFA_STACK_WORDS 64U
+
+/* How matchers are handled by the index. */
+typedef enum
+{
+	MK_DIRECT, /* Matchers are invoked directly. */
+	MK_FGLOBS, /* Globs are in the set of faster globs. */
+	MK_NFA,    /* Globs are in the automaton. */
+}
+MKind;
+
+/* Automaton that matches a name against many globs at once.  Every glob
+ * occupies a run of states (one per element of the glob plus the final one)
+ * and active states are tracked as a bit set. */
+typedef struct
+{
+	uint64_t *moves;  /* For every word of states 256 masks of states that pass
+	                     activity to the next state on corresponding byte. */
+	uint64_t *loops;  /* States that stay active on any byte and pass activity
+	                     to the next state without consuming input (stars). */
+	uint64_t *starts; /* Initial states. */
+	uint64_t *finals; /* Final states. */
+	int *owners;      /* Position of matchers that own the state. */
+	size_t nstates;   /* Number of states. */
+	size_t nwords;    /* Number of words in bit sets of states. */
+}
+nfa_t;
+
+struct mindex_t
+{
+	const matchers_t **lists; /* Indexed matchers. */
+	MKind *kinds;             /* How each of the matchers is handled. */
+	int count;                /* Number of matchers. */
+	int capacity;             /* Number of allocated elements. */
+
+	fglobs_t *fglobs; /* Exact names and "*suffix" globs. */
+	nfa_t nfa;        /* Automaton for the rest of simple globs. */
+};
+
+static int all_globs(const char globs[], int (*pred)(const char glob[]));
+static int is_nfa_glob(const char glob[]);
+static int to_lower_ascii(const char name[], char buf[], size_t buf_size);
+static int find_directly(const mindex_t *index, const char path[], int limit,
+		int nfa_used);
+static void nfa_free(nfa_t *nfa);
+static int nfa_add_globs(nfa_t *nfa, const char globs[], int pos);
+static int nfa_add_glob(nfa_t *nfa, const char glob[], int pos);
+static size_t nfa_count_states(const char glob[]);
+static int nfa_resize(nfa_t *nfa, size_t nstates);
+static void nfa_set_moves(nfa_t *nfa, size_t state, int except);
+static void set_bit(uint64_t set[], size_t bit);
+static int nfa_find(const nfa_t *nfa, const char name[], int *pos);
+
+mindex_t *
+mindex_alloc(void)
+{
+	mindex_t *const index = calloc(1U, sizeof(*index));
+	if(index == NULL)
+	{
+		return NULL;
+	}
+
+	index->fglobs = fglobs_alloc();
+	if(index->fglobs == NULL)
+	{
+		mindex_free(index);
+		return NULL;
+	}
+
+	return index;
+}
+
+void
+mindex_free(mindex_t *index)
+{
+	if(index == NULL)
+	{
+		return;
+	}
+
+	free(index->lists);
+	free(index->kinds);
+	fglobs_free(index->fglobs);
+	nfa_free(&index->nfa);
+	free(index);
+}
+
+int
+mindex_add(mindex_t *index, const matchers_t *matchers)
+{
+	if(index->count == index->capacity)
+	{
+		const int capacity = (index->capacity == 0) ? 16 : index->capacity*2;
+
+		const matchers_t **const lists = reallocarray(index->lists, capacity,
+				sizeof(*lists));
+		if(lists == NULL)
+		{
+			return 1;
+		}
+		index->lists = lists;
+
+		MKind *const kinds = reallocarray(index->kinds, capacity, sizeof(*kinds));
+		if(kinds == NULL)
+		{
+			return 1;
+		}
+		index->kinds = kinds;
+
+		index->capacity = capacity;
+	}
+
+	const int pos = index->count++;
+	index->lists[pos] = matchers;
+	index->kinds[pos] = MK_DIRECT;
+
+	/* Failing to add globs to a set or automaton is not an error, matchers are
+	 * just invoked directly.  Globs that were added still produce correct
+	 * results, because matching any of them means that matchers match. */
+	const char *const globs = matchers_get_name_globs(matchers);
+	if(globs == NULL)
+	{
+		return 0;
+	}
+
+	if(fglobs_supported(globs))
+	{
+		if(fglobs_add(index->fglobs, globs, pos) == 0)
+		{
+			index->kinds[pos] = MK_FGLOBS;
+		}
+	}
+	else if(all_globs(globs, &is_nfa_glob))
+	{
+		if(nfa_add_globs(&index->nfa, globs, pos) == 0)
+		{
+			index->kinds[pos] = MK_NFA;
+		}
+	}
+
+	return 0;
+}
+
+/* Checks whether all globs of a comma-separated list satisfy the predicate.
+ * Returns non-zero if so, otherwise zero is returned. */
+static int
+all_globs(const char globs[], int (*pred)(const char glob[]))
+{
+	char *const copy = strdup(globs);
+	if(copy == NULL)
+	{
+		return 0;
+	}
+
+	char *glob = copy, *state = NULL;
+	while((glob = split_and_get_dc(glob, &state)) != NULL)
+	{
+		if(!pred(glob))
+		{
+			break;
+		}
+	}
+
+	free(copy);
+	return (glob == NULL);
+}
+
+/* Checks whether glob consists only of ASCII characters, stars and question
+ * marks.  Returns non-zero if so, otherwise zero is returned. */
+static int
+is_nfa_glob(const char glob[])
+{
+	for(; *glob != '\0'; ++glob)
+	{
+		if((unsigned char)*glob >= 0x80 || *glob == '[' || *glob == '\\')
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int
+mindex_find(const mindex_t *index, const char path[])
+{
+	const char *const name = get_last_path_component(path);
+
+	int first = fglobs_find(index->fglobs, name);
+	if(first < 0)
+	{
+		first = INT_MAX;
+	}
+
+	/* Case of non-ASCII characters is left for regular expressions to figure
+	 * out. */
+	int nfa_used = 0;
+	char lower[NAME_MAX + 2];
+	if(index->nfa.nstates != 0U &&
+			to_lower_ascii(name, lower, sizeof(lower)) == 0)
+	{
+		int nfa_first;
+		if(nfa_find(&index->nfa, lower, &nfa_first) == 0)
+		{
+			nfa_used = 1;
+			first = MIN(first, nfa_first);
+		}
+	}
+
+	return find_directly(index, path, first, nfa_used);
+}
+
+/* Converts ASCII name to lower case.  Returns zero on success and non-zero if
+ * the name is too long or contains non-ASCII characters. */
+static int
+to_lower_ascii(const char name[], char buf[], size_t buf_size)
+{
+	size_t i;
+	for(i = 0U; i < buf_size; ++i)
+	{
+		if((unsigned char)name[i] >= 0x80)
+		{
+			return 1;
+		}
+
+		buf[i] = tolower((unsigned char)name[i]);
+		if(name[i] == '\0')
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Invokes matchers that precede limit and weren't checked by other means.
+ * Returns position of the first matching matchers, limit if it's less than
+ * count or -1. */
+static int
+find_directly(const mindex_t *index, const char path[], int limit,
+		int nfa_used)
+{
+	int i;
+	for(i = 0; i < index->count && i < limit; ++i)
+	{
+		const MKind kind = index->kinds[i];
+		if(kind == MK_DIRECT || (kind == MK_NFA && !nfa_used))
+		{
+			if(matchers_match(index->lists[i], path))
+			{
+				return i;
+			}
+		}
+	}
+
+	return (limit < index->count ? limit : -1);
+}
+
+/* Frees resources of the automaton. */
+static void
+nfa_free(nfa_t *nfa)
+{
+	free(nfa->moves);
+	free(nfa->loops);
+	free(nfa->starts);
+	free(nfa->finals);
+	free(nfa->owners);
+}
+
+/* Adds comma-separated list of globs to the automaton.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+nfa_add_globs(nfa_t *nfa, const char globs[], int pos)
+{
+	char *const copy = strdup(globs);
+	if(copy == NULL)
+	{
+		return 1;
+	}
+
+	int error = 0;
+	char *glob = copy, *state = NULL;
+	while(!error && (glob = split_and_get_dc(glob, &state)) != NULL)
+	{
+		error = nfa_add_glob(nfa, glob, pos);
+	}
+
+	free(copy);
+	return error;
+}
+
+/* Adds states that match the glob like its regular expression produced by
+ * glob_to_regex() does for ASCII names.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+nfa_add_glob(nfa_t *nfa, const char glob[], int pos)
+{
+	const size_t first = nfa->nstates;
+	if(nfa_resize(nfa, first + nfa_count_states(glob)) != 0)
+	{
+		return 1;
+	}
+
+	size_t state = first;
+	const char *p;
+	for(p = glob; *p != '\0'; ++p)
+	{
+		if(*p == '*')
+		{
+			if(p == glob)
+			{
+				/* Leading star requires a character which isn't a dot. */
+				nfa_set_moves(nfa, state++, '.');
+			}
+			else if(p[-1] == '*')
+			{
+				/* Consecutive stars are the same as one star. */
+				continue;
+			}
+			set_bit(nfa->loops, state++);
+		}
+		else if(*p == '?')
+		{
+			nfa_set_moves(nfa, state++, '\0');
+		}
+		else
+		{
+			const int c = tolower((unsigned char)*p);
+			nfa->moves[(state/64U)*256U + c] |= (uint64_t)1 << state%64U;
+			++state;
+		}
+	}
+
+	set_bit(nfa->starts, first);
+	set_bit(nfa->finals, state);
+	nfa->owners[state] = pos;
+	nfa->nstates = state + 1U;
+	return 0;
+}
+
+/* Computes number of states needed for the glob.  Returns the number. */
+static size_t
+nfa_count_states(const char glob[])
+{
+	size_t count = 1U;
+	const char *p;
+	for(p = glob; *p != '\0'; ++p)
+	{
+		if(*p == '*')
+		{
+			count += (p == glob) ? 2U : (p[-1] != '*');
+		}
+		else
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+/* Makes room for the specified number of states.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+nfa_resize(nfa_t *nfa, size_t nstates)
+{
+	int *const owners = reallocarray(nfa->owners, nstates, sizeof(*owners));
+	if(owners == NULL)
+	{
+		return 1;
+	}
+	nfa->owners = owners;
+
+	const size_t nwords = DIV_ROUND_UP(nstates, 64U);
+	if(nwords <= nfa->nwords)
+	{
+		return 0;
+	}
+
+	uint64_t *const moves = reallocarray(nfa->moves, nwords*256U,
+			sizeof(*moves));
+	if(moves == NULL)
+	{
+		return 1;
+	}
+	nfa->moves = moves;
+	memset(moves + nfa->nwords*256U, 0,
+			sizeof(*moves)*(nwords - nfa->nwords)*256U);
+
+	uint64_t **const sets[] = { &nfa->loops, &nfa->starts, &nfa->finals };
+	size_t i;
+	for(i = 0U; i < ARRAY_LEN(sets); ++i)
+	{
+		uint64_t *const set = reallocarray(*sets[i], nwords, sizeof(*set));
+		if(set == NULL)
+		{
+			return 1;
+		}
+		*sets[i] = set;
+		memset(set + nfa->nwords, 0, sizeof(*set)*(nwords - nfa->nwords));
+	}
+
+	nfa->nwords = nwords;
+	return 0;
+}
+
+/* Makes the state pass activity to the next one on every byte except for the
+ * specified one. */
+static void
+nfa_set_moves(nfa_t *nfa, size_t state, int except)
+{
+	uint64_t *const moves = &nfa->moves[(state/64U)*256U];
+	int c;
+	for(c = 1; c < 256; ++c)
+	{
+		if(c != except)
+		{
+			moves[c] |= (uint64_t)1 << state%64U;
+		}
+	}
+}
+
+/* Sets a bit in a bit set. */
+static void
+set_bit(uint64_t set[], size_t bit)
+{
+	set[bit/64U] |= (uint64_t)1 << bit%64U;
+}
+
+/* Runs the automaton on a lowercased name.  Sets *pos to position of the first
+ * matchers that match or to INT_MAX.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+nfa_find(const nfa_t *nfa, const char name[], int *pos)
+{
+	*pos = INT_MAX;
+	if(nfa->nstates == 0U)
+	{
+		return 0;
+	}
+
+	const size_t nwords = nfa->nwords;
+	uint64_t stack_sets[2U*NFA_STACK_WORDS];
+	uint64_t *const sets = (nwords <= NFA_STACK_WORDS)
+	                     ? stack_sets
+	                     : reallocarray(NULL, 2U*nwords, sizeof(*sets));
+	if(sets == NULL)
+	{
+		return 1;
+	}
+
+	uint64_t *curr = sets, *next = sets + nwords;
+	memcpy(curr, nfa->starts, sizeof(*curr)*nwords);
+
+	int alive = 1;
+	for(; *name != '\0' && alive; ++name)
+	{
+		const uint64_t *const moves = &nfa->moves[(unsigned char)*name];
+
+		uint64_t carry = 0U;
+		size_t w;
+		for(w = 0U; w < nwords; ++w)
+		{
+			const uint64_t moved = curr[w] & moves[w*256U];
+			next[w] = (moved << 1) | carry | (curr[w] & nfa->loops[w]);
+			carry = moved >> 63;
+		}
+
+		/* Stars can match empty string, so they activate next state right away.
+		 * Consecutive stars are merged, so a single step is enough. */
+		alive = 0;
+		carry = 0U;
+		for(w = 0U; w < nwords; ++w)
+		{
+			const uint64_t looped = next[w] & nfa->loops[w];
+			next[w] |= (looped << 1) | carry;
+			carry = looped >> 63;
+			alive |= (next[w] != 0U);
+		}
+
+		uint64_t *const tmp = curr;
+		curr = next;
+		next = tmp;
+	}
+
+	size_t w;
+	for(w = 0U; w < nwords && alive; ++w)
+	{
+		const uint64_t matched = curr[w] & nfa->finals[w];
+		if(matched != 0U)
+		{
+			/* States are ordered by positions of matchers. */
+			size_t bit = 0U;
+			while(!(matched & ((uint64_t)1 << bit)))
+			{
+				++bit;
+			}
+			*pos = nfa->owners[w*64U + bit];
+			break;
+		}
+	}
+
+	if(sets != stack_sets)
+	{
+		free(sets);
+	}
+	return 0;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
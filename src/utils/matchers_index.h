@@ -0,0 +1,51 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__MATCHERS_INDEX_H__
+#define VIFM__UTILS__MATCHERS_INDEX_H__
+
+/* Index of a sequence of matchers for finding the first one that matches a
+ * path without trying all of them one by one.  Exact names and "*suffix" globs
+ * are looked up in tries, other simple globs are combined into a single
+ * automaton and the rest of matchers is invoked as is. */
+
+struct matchers_t;
+
+/* Opaque index type. */
+typedef struct mindex_t mindex_t;
+
+/* Creates an empty index.  Returns the index or NULL on error. */
+mindex_t * mindex_alloc(void);
+
+/* Frees the index.  index can be NULL. */
+void mindex_free(mindex_t *index);
+
+/* Appends matchers to the end of the sequence.  The index stores the pointer,
+ * so matchers must outlive the index or its use.  Returns zero on success,
+ * otherwise non-zero is returned and the index shouldn't be used anymore. */
+int mindex_add(mindex_t *index, const struct matchers_t *matchers);
+
+/* Finds the first matchers of the sequence that match the path.  The result is
+ * the same as of calling matchers_match() for all of them in order.  Returns
+ * position of the matchers or -1 if none matches. */
+int mindex_find(const mindex_t *index, const char path[]);
+
+#endif /* VIFM__UTILS__MATCHERS_INDEX_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,326 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "name_index.h"
+
+#include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* uint32_t */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memcpy() strcmp() strlen() */
+
+#include "../compat/reallocarray.h"
+#include "path.h"
+
+/* Minimal number of slots in the table. */
+#define MIN_SLOTS 16U
+
+/* Expected average length of a key, used to preallocate buffer of keys. */
+#define AVG_KEY_LEN 16U
+
+/* Single cell of the hash table. */
+typedef struct
+{
+	uint32_t hash; /* Hash of the key. */
+	int value;     /* Value associated with the key or -1 for an empty slot. */
+	size_t key;    /* Offset of the key in the buffer of keys. */
+}
+slot_t;
+
+/* Key split into parts that are concatenated to form it. */
+typedef struct
+{
+	const char *dir;  /* Directory part, possibly empty. */
+	const char *sep;  /* Separator between the dir and the name. */
+	const char *name; /* Name part. */
+}
+parts_t;
+
+struct nindex_t
+{
+	slot_t *slots; /* Open-addressing table of 2^n slots. */
+	size_t mask;   /* Number of slots minus one. */
+	size_t count;  /* Number of used slots. */
+
+	char *keys;      /* Keys stored one after another. */
+	size_t keys_len; /* Used size of the buffer. */
+	size_t keys_cap; /* Allocated size of the buffer. */
+};
+
+static parts_t make_key(const char dir[], const char name[]);
+static uint32_t hash_key(const parts_t *key);
+static uint32_t hash_str(uint32_t hash, const char str[]);
+static size_t find_slot(const nindex_t *index, const parts_t *key,
+		uint32_t hash);
+static int key_equals(const char stored[], const parts_t *key);
+static const char * skip_part(const char str[], const char part[]);
+static int grow_table(nindex_t *index);
+static int store_key(nindex_t *index, const parts_t *key, size_t *offset);
+
+nindex_t *
+nindex_alloc(int size_hint)
+{
+	nindex_t *const index = malloc(sizeof(*index));
+	if(index == NULL)
+	{
+		return NULL;
+	}
+
+	/* Keep load factor under 0.5 without growing for expected number of keys. */
+	size_t nslots = MIN_SLOTS;
+	while(size_hint > 0 && nslots < (size_t)size_hint*2U)
+	{
+		nslots *= 2U;
+	}
+
+	index->slots = reallocarray(NULL, nslots, sizeof(*index->slots));
+	index->mask = nslots - 1U;
+	index->count = 0U;
+
+	index->keys_cap = (size_hint > 0 ? (size_t)size_hint : 1U)*AVG_KEY_LEN;
+	index->keys = malloc(index->keys_cap);
+	index->keys_len = 0U;
+
+	if(index->slots == NULL || index->keys == NULL)
+	{
+		nindex_free(index);
+		return NULL;
+	}
+
+	size_t i;
+	for(i = 0U; i < nslots; ++i)
+	{
+		index->slots[i].value = -1;
+	}
+
+	return index;
+}
+
+void
+nindex_free(nindex_t *index)
+{
+	if(index != NULL)
+	{
+		free(index->slots);
+		free(index->keys);
+		free(index);
+	}
+}
+
+int
+nindex_put(nindex_t *index, const char dir[], const char name[], int value)
+{
+	const parts_t key = make_key(dir, name);
+	const uint32_t hash = hash_key(&key);
+
+	size_t pos = find_slot(index, &key, hash);
+	if(index->slots[pos].value >= 0)
+	{
+		return 1;
+	}
+
+	if((index->count + 1U)*2U > index->mask + 1U)
+	{
+		if(grow_table(index) != 0)
+		{
+			return -1;
+		}
+		pos = find_slot(index, &key, hash);
+	}
+
+	size_t offset;
+	if(store_key(index, &key, &offset) != 0)
+	{
+		return -1;
+	}
+
+	index->slots[pos].hash = hash;
+	index->slots[pos].value = value;
+	index->slots[pos].key = offset;
+	++index->count;
+	return 0;
+}
+
+int
+nindex_get(const nindex_t *index, const char dir[], const char name[])
+{
+	const parts_t key = make_key(dir, name);
+	return index->slots[find_slot(index, &key, hash_key(&key))].value;
+}
+
+/* Splits key into parts in the same way build_path() joins them.  Returns the
+ * key. */
+static parts_t
+make_key(const char dir[], const char name[])
+{
+	parts_t key = { .dir = "", .sep = "", .name = name };
+	if(dir != NULL)
+	{
+		key.dir = dir;
+		key.sep = (ends_with_slash(dir) ? "" : "/");
+	}
+	return key;
+}
+
+/* Computes FNV-1a hash of the key as if its parts were concatenated.  Returns
+ * the hash. */
+static uint32_t
+hash_key(const parts_t *key)
+{
+	uint32_t hash = 2166136261U;
+	hash = hash_str(hash, key->dir);
+	hash = hash_str(hash, key->sep);
+	return hash_str(hash, key->name);
+}
+
+/* Continues FNV-1a hashing with a string.  Returns updated hash. */
+static uint32_t
+hash_str(uint32_t hash, const char str[])
+{
+	while(*str != '\0')
+	{
+		hash = (hash ^ (unsigned char)*str++)*16777619U;
+	}
+	return hash;
+}
+
+/* Finds slot that holds the key or an empty slot where it should be put.
+ * Returns position of the slot. */
+static size_t
+find_slot(const nindex_t *index, const parts_t *key, uint32_t hash)
+{
+	size_t pos = hash & index->mask;
+	while(1)
+	{
+		const slot_t *const slot = &index->slots[pos];
+		if(slot->value < 0)
+		{
+			return pos;
+		}
+		if(slot->hash == hash && key_equals(&index->keys[slot->key], key))
+		{
+			return pos;
+		}
+		pos = (pos + 1U) & index->mask;
+	}
+}
+
+/* Compares stored key with a key that's split into parts.  Returns non-zero if
+ * they are equal. */
+static int
+key_equals(const char stored[], const parts_t *key)
+{
+	stored = skip_part(stored, key->dir);
+	if(stored != NULL)
+	{
+		stored = skip_part(stored, key->sep);
+	}
+	return (stored != NULL && strcmp(stored, key->name) == 0);
+}
+
+/* Skips prefix of the string if it's equal to the part.  Returns pointer past
+ * the part or NULL on mismatch. */
+static const char *
+skip_part(const char str[], const char part[])
+{
+	while(*part != '\0')
+	{
+		if(*str++ != *part++)
+		{
+			return NULL;
+		}
+	}
+	return str;
+}
+
+/* Doubles size of the table.  Returns zero on success. */
+static int
+grow_table(nindex_t *index)
+{
+	const size_t nslots = (index->mask + 1U)*2U;
+	slot_t *const slots = reallocarray(NULL, nslots, sizeof(*slots));
+	if(slots == NULL)
+	{
+		return 1;
+	}
+
+	size_t i;
+	for(i = 0U; i < nslots; ++i)
+	{
+		slots[i].value = -1;
+	}
+
+	/* Hashes are stored, so keys don't need to be looked at. */
+	for(i = 0U; i <= index->mask; ++i)
+	{
+		const slot_t *const slot = &index->slots[i];
+		if(slot->value >= 0)
+		{
+			size_t pos = slot->hash & (nslots - 1U);
+			while(slots[pos].value >= 0)
+			{
+				pos = (pos + 1U) & (nslots - 1U);
+			}
+			slots[pos] = *slot;
+		}
+	}
+
+	free(index->slots);
+	index->slots = slots;
+	index->mask = nslots - 1U;
+	return 0;
+}
+
+/* Appends concatenated parts of the key to the buffer of keys.  Sets *offset to
+ * position of the stored key.  Returns zero on success. */
+static int
+store_key(nindex_t *index, const parts_t *key, size_t *offset)
+{
+	const size_t dir_len = strlen(key->dir);
+	const size_t sep_len = strlen(key->sep);
+	const size_t name_len = strlen(key->name);
+	const size_t len = dir_len + sep_len + name_len + 1U;
+
+	if(index->keys_len + len > index->keys_cap)
+	{
+		size_t cap = index->keys_cap*2U;
+		while(index->keys_len + len > cap)
+		{
+			cap *= 2U;
+		}
+
+		char *const keys = realloc(index->keys, cap);
+		if(keys == NULL)
+		{
+			return 1;
+		}
+		index->keys = keys;
+		index->keys_cap = cap;
+	}
+
+	char *const dst = &index->keys[index->keys_len];
+	memcpy(dst, key->dir, dir_len);
+	memcpy(dst + dir_len, key->sep, sep_len);
+	memcpy(dst + dir_len + sep_len, key->name, name_len + 1U);
+
+	*offset = index->keys_len;
+	index->keys_len += len;
+	return 0;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,52 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__NAME_INDEX_H__
+#define VIFM__UTILS__NAME_INDEX_H__
+
+/* Hash index that maps names of files to non-negative integers (usually
+ * positions in a list of entries).  A name can be qualified with a directory,
+ * in which case the key is the path that build_path() would make out of them,
+ * but the path isn't composed in memory.  Keys are copied into a single buffer
+ * owned by the index, so the number of allocations doesn't depend on the
+ * number of keys. */
+
+/* Opaque index type. */
+typedef struct nindex_t nindex_t;
+
+/* Creates an empty index that is expected to hold about size_hint keys.
+ * Returns the index or NULL on error. */
+nindex_t * nindex_alloc(int size_hint);
+
+/* Frees the index.  index can be NULL. */
+void nindex_free(nindex_t *index);
+
+/* Adds a key that consists of the name optionally prefixed with the dir (which
+ * can be NULL).  The value must be non-negative.  Existing keys are left
+ * unchanged.  Returns negative value on error, zero on successful insertion and
+ * positive number if the key was already in the index. */
+int nindex_put(nindex_t *index, const char dir[], const char name[], int value);
+
+/* Looks up value of the key made of the dir (can be NULL) and the name.
+ * Returns the value or -1 if there is no such key. */
+int nindex_get(const nindex_t *index, const char dir[], const char name[]);
+
+#endif /* VIFM__UTILS__NAME_INDEX_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
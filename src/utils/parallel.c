@@ -0,0 +1,441 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "parallel.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h> /* sysconf() */
+#endif
+
+#include <stddef.h> /* size_t */
+#include <stdlib.h> /* free() malloc() */
+
+#include "../compat/pthread.h"
+#include "../compat/reallocarray.h"
+#include "macros.h"
+#include "utils.h"
+
+/* Upper limit on the default number of workers. */
+#define MAX_DEFAULT_WORKERS 16
+
+/* State of a single par_for() invocation shared among its threads. */
+typedef struct
+{
+	par_range_func func;  /* Processor of ranges. */
+	void *arg;            /* Argument of the processor. */
+	size_t count;         /* Total number of items. */
+	size_t batch_size;    /* Maximum number of items in a batch. */
+	size_t next;          /* Start of the first batch that wasn't taken yet. */
+	pthread_mutex_t lock; /* Protects next field. */
+}
+par_job_t;
+
+/* State of a single par_run_tasks() invocation shared among its threads. */
+typedef struct
+{
+	par_task_func func;   /* Processor of tasks. */
+	void *arg;            /* Argument of the processor. */
+	par_tasks_t *threads; /* Per-thread queues of tasks. */
+	size_t nthreads;      /* Number of elements in threads array. */
+	size_t pending;       /* Number of added tasks that weren't processed yet. */
+	size_t generation;    /* Incremented on every addition of a task. */
+	pthread_mutex_t lock; /* Protects pending and generation fields. */
+	pthread_cond_t cond;  /* Signaled on new tasks and on completion. */
+}
+par_pool_t;
+
+/* Queue of tasks of a single thread of par_run_tasks().  The owner takes the
+ * newest tasks from its end, while other threads steal the oldest ones. */
+struct par_tasks_t
+{
+	par_pool_t *pool;     /* Pool to which the thread belongs. */
+	void **tasks;         /* Tasks in the order of their addition. */
+	size_t first;         /* Index of the first task that wasn't taken yet. */
+	size_t count;         /* Number of used elements of tasks array. */
+	size_t capacity;      /* Number of allocated elements of tasks array. */
+	pthread_mutex_t lock; /* Protects fields of the structure. */
+};
+
+static int get_default_nworkers(void);
+static void * worker_thread(void *arg);
+static void process_batches(par_job_t *job);
+static void * tasks_thread(void *arg);
+static void process_tasks(par_tasks_t *self);
+static int reserve_task(par_tasks_t *tasks);
+static int take_own_task(par_tasks_t *self, void **task);
+static int steal_task(par_tasks_t *self, void **task);
+
+/* Number of workers explicitly requested by the user or zero. */
+static int requested_nworkers;
+
+int
+par_get_nworkers(void)
+{
+	return (requested_nworkers > 0 ? requested_nworkers : get_default_nworkers());
+}
+
+/* Computes default number of workers.  Returns the number. */
+static int
+get_default_nworkers(void)
+{
+	static int nworkers;
+
+	if(nworkers == 0)
+	{
+#ifndef _WIN32
+		const long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		const long ncpus = info.dwNumberOfProcessors;
+#endif
+		nworkers = (ncpus < 1) ? 1 : MIN(ncpus, MAX_DEFAULT_WORKERS);
+	}
+
+	return nworkers;
+}
+
+void
+par_set_nworkers(int n)
+{
+	requested_nworkers = MAX(n, 0);
+}
+
+void
+par_for(size_t count, size_t batch_size, par_range_func func, void *arg)
+{
+	if(batch_size == 0U)
+	{
+		batch_size = 1U;
+	}
+
+	const size_t nbatches = DIV_ROUND_UP(count, batch_size);
+	const size_t nworkers = MIN((size_t)par_get_nworkers(), nbatches);
+	if(nworkers <= 1U)
+	{
+		if(count != 0U)
+		{
+			func(0U, count, arg);
+		}
+		return;
+	}
+
+	par_job_t job = {
+		.func = func,
+		.arg = arg,
+		.count = count,
+		.batch_size = batch_size,
+		.next = 0U,
+	};
+	pthread_mutex_init(&job.lock, NULL);
+
+	pthread_t *const threads = malloc(sizeof(*threads)*(nworkers - 1U));
+	size_t nthreads = 0U;
+	if(threads != NULL)
+	{
+		while(nthreads < nworkers - 1U)
+		{
+			if(pthread_create(&threads[nthreads], NULL, &worker_thread, &job) != 0)
+			{
+				/* Do with what we've got, calling thread will do the rest. */
+				break;
+			}
+			++nthreads;
+		}
+	}
+
+	process_batches(&job);
+
+	size_t i;
+	for(i = 0U; i < nthreads; ++i)
+	{
+		(void)pthread_join(threads[i], NULL);
+	}
+
+	free(threads);
+	pthread_mutex_destroy(&job.lock);
+}
+
+/* Entry point of a worker thread.  Returns NULL. */
+static void *
+worker_thread(void *arg)
+{
+	block_all_thread_signals();
+	process_batches(arg);
+	return NULL;
+}
+
+/* Takes batches of the job one by one and processes them until there is
+ * nothing left. */
+static void
+process_batches(par_job_t *job)
+{
+	while(1)
+	{
+		pthread_mutex_lock(&job->lock);
+		const size_t from = job->next;
+		if(from < job->count)
+		{
+			job->next += MIN(job->batch_size, job->count - from);
+		}
+		pthread_mutex_unlock(&job->lock);
+
+		if(from >= job->count)
+		{
+			break;
+		}
+
+		job->func(from, MIN(from + job->batch_size, job->count), job->arg);
+	}
+}
+
+void
+par_run_tasks(void *task, par_task_func func, void *arg)
+{
+	par_tasks_t single = { };
+	par_pool_t pool = {
+		.func = func,
+		.arg = arg,
+		.nthreads = par_get_nworkers(),
+	};
+
+	pool.threads = calloc(pool.nthreads, sizeof(*pool.threads));
+	if(pool.threads == NULL)
+	{
+		pool.threads = &single;
+		pool.nthreads = 1U;
+	}
+
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.cond, NULL);
+
+	size_t i;
+	for(i = 0U; i < pool.nthreads; ++i)
+	{
+		pool.threads[i].pool = &pool;
+		pthread_mutex_init(&pool.threads[i].lock, NULL);
+	}
+
+	par_tasks_add(&pool.threads[0], task);
+
+	/* Threads that failed to start just leave their queues empty. */
+	pthread_t *const threads = (pool.nthreads > 1U)
+	                         ? malloc(sizeof(*threads)*(pool.nthreads - 1U))
+	                         : NULL;
+	size_t nthreads = 0U;
+	if(threads != NULL)
+	{
+		for(i = 1U; i < pool.nthreads; ++i)
+		{
+			if(pthread_create(&threads[nthreads], NULL, &tasks_thread,
+						&pool.threads[i]) == 0)
+			{
+				++nthreads;
+			}
+		}
+	}
+
+	process_tasks(&pool.threads[0]);
+
+	for(i = 0U; i < nthreads; ++i)
+	{
+		(void)pthread_join(threads[i], NULL);
+	}
+	free(threads);
+
+	for(i = 0U; i < pool.nthreads; ++i)
+	{
+		free(pool.threads[i].tasks);
+		pthread_mutex_destroy(&pool.threads[i].lock);
+	}
+	if(pool.threads != &single)
+	{
+		free(pool.threads);
+	}
+
+	pthread_cond_destroy(&pool.cond);
+	pthread_mutex_destroy(&pool.lock);
+}
+
+void
+par_tasks_add(par_tasks_t *tasks, void *task)
+{
+	par_pool_t *const pool = tasks->pool;
+
+	if(reserve_task(tasks) != 0)
+	{
+		/* Not enough memory to postpone the task, so process it right away. */
+		pool->func(tasks, task, pool->arg);
+		return;
+	}
+
+	/* The task is accounted for before it becomes visible to other threads so
+	 * that they won't consider all work to be done prematurely. */
+	pthread_mutex_lock(&pool->lock);
+	++pool->pending;
+	++pool->generation;
+
+	pthread_mutex_lock(&tasks->lock);
+	tasks->tasks[tasks->count++] = task;
+	pthread_mutex_unlock(&tasks->lock);
+
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/* Entry point of a thread of par_run_tasks().  Returns NULL. */
+static void *
+tasks_thread(void *arg)
+{
+	block_all_thread_signals();
+	process_tasks(arg);
+	return NULL;
+}
+
+/* Processes own and stolen tasks until there are no more of them. */
+static void
+process_tasks(par_tasks_t *self)
+{
+	par_pool_t *const pool = self->pool;
+
+	while(1)
+	{
+		pthread_mutex_lock(&pool->lock);
+		const size_t generation = pool->generation;
+		const int done = (pool->pending == 0U);
+		pthread_mutex_unlock(&pool->lock);
+
+		if(done)
+		{
+			break;
+		}
+
+		void *task;
+		if(take_own_task(self, &task) || steal_task(self, &task))
+		{
+			pool->func(self, task, pool->arg);
+
+			pthread_mutex_lock(&pool->lock);
+			if(--pool->pending == 0U)
+			{
+				pthread_cond_broadcast(&pool->cond);
+			}
+			pthread_mutex_unlock(&pool->lock);
+			continue;
+		}
+
+		/* All pending tasks are being processed, wait for them to spawn more
+		 * tasks or to finish. */
+		pthread_mutex_lock(&pool->lock);
+		while(pool->pending != 0U && pool->generation == generation)
+		{
+			pthread_cond_wait(&pool->cond, &pool->lock);
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+/* Makes sure that there is room for one more task in the queue.  Returns zero
+ * on success, otherwise non-zero is returned. */
+static int
+reserve_task(par_tasks_t *tasks)
+{
+	int error = 0;
+
+	pthread_mutex_lock(&tasks->lock);
+	if(tasks->count == tasks->capacity)
+	{
+		const size_t capacity = (tasks->capacity == 0U) ? 64U : tasks->capacity*2U;
+		void **const resized = reallocarray(tasks->tasks, capacity,
+				sizeof(*resized));
+		if(resized == NULL)
+		{
+			error = 1;
+		}
+		else
+		{
+			tasks->tasks = resized;
+			tasks->capacity = capacity;
+		}
+	}
+	pthread_mutex_unlock(&tasks->lock);
+
+	return error;
+}
+
+/* Takes the newest task of the thread.  Returns non-zero if *task was set,
+ * otherwise zero is returned. */
+static int
+take_own_task(par_tasks_t *self, void **task)
+{
+	int taken = 0;
+
+	pthread_mutex_lock(&self->lock);
+	if(self->count > self->first)
+	{
+		*task = self->tasks[--self->count];
+		taken = 1;
+		if(self->count == self->first)
+		{
+			self->first = self->count = 0U;
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+	return taken;
+}
+
+/* Takes the oldest task of some other thread.  Returns non-zero if *task was
+ * set, otherwise zero is returned. */
+static int
+steal_task(par_tasks_t *self, void **task)
+{
+	par_pool_t *const pool = self->pool;
+	const size_t me = self - pool->threads;
+
+	size_t i;
+	for(i = 1U; i < pool->nthreads; ++i)
+	{
+		par_tasks_t *const victim = &pool->threads[(me + i)%pool->nthreads];
+
+		int taken = 0;
+		pthread_mutex_lock(&victim->lock);
+		if(victim->count > victim->first)
+		{
+			*task = victim->tasks[victim->first++];
+			taken = 1;
+			if(victim->count == victim->first)
+			{
+				victim->first = victim->count = 0U;
+			}
+		}
+		pthread_mutex_unlock(&victim->lock);
+
+		if(taken)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
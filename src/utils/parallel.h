@@ -0,0 +1,65 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__PARALLEL_H__
+#define VIFM__UTILS__PARALLEL_H__
+
+#include <stddef.h> /* size_t */
+
+/* Helpers for splitting work among several short-lived threads. */
+
+/* Type of function that processes items in the [from; to) range. */
+typedef void (*par_range_func)(size_t from, size_t to, void *arg);
+
+/* Handle of a thread that processes tasks of par_run_tasks(). */
+typedef struct par_tasks_t par_tasks_t;
+
+/* Type of function that processes a single task.  It can add more tasks to
+ * be processed via par_tasks_add() on the tasks handle. */
+typedef void (*par_task_func)(par_tasks_t *tasks, void *task, void *arg);
+
+/* Retrieves maximum number of threads (including the calling one) that are
+ * used to process a piece of work.  Returns a positive number. */
+int par_get_nworkers(void);
+
+/* Sets maximum number of threads (including the calling one) used to process
+ * a piece of work.  Non-positive value restores the default, which depends on
+ * the number of processors. */
+void par_set_nworkers(int n);
+
+/* Splits count items into batches of at most batch_size items and calls func
+ * on each of them from up to par_get_nworkers() threads including the calling
+ * one.  Batches are processed in no particular order and func should be safe to
+ * call concurrently for different ranges.  Returns after all items were
+ * processed. */
+void par_for(size_t count, size_t batch_size, par_range_func func, void *arg);
+
+/* Calls func on the task and on all tasks it (recursively) spawns from up to
+ * par_get_nworkers() threads including the calling one.  Each thread processes
+ * tasks it spawned in LIFO order and steals the oldest tasks of other threads
+ * when it runs out of its own.  Returns after all tasks were processed. */
+void par_run_tasks(void *task, par_task_func func, void *arg);
+
+/* Schedules one more task for processing.  Should be called only by a
+ * par_task_func on the handle it was passed. */
+void par_tasks_add(par_tasks_t *tasks, void *task);
+
+#endif /* VIFM__UTILS__PARALLEL_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -18,6 +18,332 @@
 
 #include "selector.h"
 
+#ifdef __linux__
+
+#include <sys/epoll.h> /* EPOLLIN EPOLL_CLOEXEC EPOLL_CTL_* epoll_event
+                          epoll_create1() epoll_ctl() epoll_wait() */
+#include <unistd.h> /* close() */
+
+#include <errno.h> /* ENOENT EPERM errno */
+#include <stdlib.h> /* free() malloc() realloc() */
+
+/* Maximum number of ready descriptors reported by a single wait. */
+#define MAX_READY 16
+
+/* Descriptor registered in epoll instance. */
+typedef struct
+{
+	int fd;    /* The descriptor. */
+	int added; /* Whether it was added since the last reset. */
+}
+watched_t;
+
+/* Selector object.  Registrations in epoll instance persist across resets,
+ * descriptors that weren't added again after a reset are unregistered right
+ * before waiting. */
+struct selector_t
+{
+	int epfd;              /* Descriptor of epoll instance. */
+	watched_t *watched;    /* Descriptors registered in the instance. */
+	int nwatched;          /* Number of elements in watched array. */
+	int ready[MAX_READY];  /* Descriptors that are ready after successful
+	                          check. */
+	int nready;            /* Number of elements in ready array. */
+	int *files;            /* Descriptors that can't be polled (e.g., regular
+	                          files), which are always ready like for
+	                          select(). */
+	int nfiles;            /* Number of elements in files array. */
+};
+
+static int register_fd(selector_t *selector, int fd);
+static watched_t * find_watched(selector_t *selector, int fd);
+static void add_watched(selector_t *selector, int fd);
+static void remove_watched(selector_t *selector, int fd);
+static void drop_not_added(selector_t *selector);
+static void recreate_instance(selector_t *selector);
+static void add_file(selector_t *selector, int fd);
+static void remove_item(int items[], int *count, int item);
+
+selector_t *
+selector_alloc(void)
+{
+	selector_t *selector = malloc(sizeof(*selector));
+	if(selector == NULL)
+	{
+		return NULL;
+	}
+
+	selector->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if(selector->epfd == -1)
+	{
+		free(selector);
+		return NULL;
+	}
+
+	selector->watched = NULL;
+	selector->nwatched = 0;
+	selector->nready = 0;
+	selector->files = NULL;
+	selector->nfiles = 0;
+	return selector;
+}
+
+void
+selector_free(selector_t *selector)
+{
+	if(selector != NULL)
+	{
+		close(selector->epfd);
+		free(selector->watched);
+		free(selector->files);
+		free(selector);
+	}
+}
+
+void
+selector_reset(selector_t *selector)
+{
+	int i;
+	for(i = 0; i < selector->nwatched; ++i)
+	{
+		selector->watched[i].added = 0;
+	}
+
+	selector->nready = 0;
+	selector->nfiles = 0;
+}
+
+void
+selector_add(selector_t *selector, selector_item_t item)
+{
+	watched_t *const watched = find_watched(selector, item);
+	if(watched != NULL)
+	{
+		/* Registration is dropped by the kernel when descriptor is closed and its
+		 * number can be reused for another file, so make sure it's still there.
+		 * Modifying registration is much cheaper than recreating it. */
+		struct epoll_event event = { .events = EPOLLIN, .data.fd = item };
+		if(epoll_ctl(selector->epfd, EPOLL_CTL_MOD, item, &event) == 0)
+		{
+			watched->added = 1;
+			return;
+		}
+		remove_watched(selector, item);
+	}
+
+	switch(register_fd(selector, item))
+	{
+		case 0:
+			add_watched(selector, item);
+			break;
+		case EPERM:
+			add_file(selector, item);
+			break;
+	}
+}
+
+/* Adds descriptor to epoll instance.  Returns zero on success, otherwise errno
+ * value is returned. */
+static int
+register_fd(selector_t *selector, int fd)
+{
+	struct epoll_event event = { .events = EPOLLIN, .data.fd = fd };
+	const int result = epoll_ctl(selector->epfd, EPOLL_CTL_ADD, fd, &event);
+	return (result == 0 ? 0 : errno);
+}
+
+/* Looks up registered descriptor.  Returns pointer to its entry or NULL. */
+static watched_t *
+find_watched(selector_t *selector, int fd)
+{
+	int i;
+	for(i = 0; i < selector->nwatched; ++i)
+	{
+		if(selector->watched[i].fd == fd)
+		{
+			return &selector->watched[i];
+		}
+	}
+	return NULL;
+}
+
+/* Remembers descriptor that was registered in epoll instance.  On error the
+ * descriptor is unregistered. */
+static void
+add_watched(selector_t *selector, int fd)
+{
+	watched_t *const watched = realloc(selector->watched,
+			sizeof(*watched)*(selector->nwatched + 1));
+	if(watched == NULL)
+	{
+		(void)epoll_ctl(selector->epfd, EPOLL_CTL_DEL, fd, NULL);
+		return;
+	}
+
+	selector->watched = watched;
+	watched[selector->nwatched++] = (watched_t){ .fd = fd, .added = 1 };
+}
+
+/* Forgets about registered descriptor. */
+static void
+remove_watched(selector_t *selector, int fd)
+{
+	int i, j = 0;
+	for(i = 0; i < selector->nwatched; ++i)
+	{
+		if(selector->watched[i].fd != fd)
+		{
+			selector->watched[j++] = selector->watched[i];
+		}
+	}
+	selector->nwatched = j;
+}
+
+/* Remembers descriptor of a file that doesn't support polling. */
+static void
+add_file(selector_t *selector, int fd)
+{
+	int *const files = realloc(selector->files,
+			sizeof(*files)*(selector->nfiles + 1));
+	if(files != NULL)
+	{
+		selector->files = files;
+		files[selector->nfiles++] = fd;
+	}
+}
+
+void
+selector_remove(selector_t *selector, selector_item_t item)
+{
+	if(find_watched(selector, item) != NULL)
+	{
+		(void)epoll_ctl(selector->epfd, EPOLL_CTL_DEL, item, NULL);
+		remove_watched(selector, item);
+	}
+	remove_item(selector->files, &selector->nfiles, item);
+	remove_item(selector->ready, &selector->nready, item);
+}
+
+/* Removes all occurrences of the item from the array. */
+static void
+remove_item(int items[], int *count, int item)
+{
+	int i, j = 0;
+	for(i = 0; i < *count; ++i)
+	{
+		if(items[i] != item)
+		{
+			items[j++] = items[i];
+		}
+	}
+	*count = j;
+}
+
+int
+selector_wait(selector_t *selector, int delay)
+{
+	if(delay < 0 || selector->nfiles != 0)
+	{
+		delay = 0;
+	}
+
+	drop_not_added(selector);
+
+	struct epoll_event events[MAX_READY];
+	int n = epoll_wait(selector->epfd, events, MAX_READY, delay);
+	if(n < 0)
+	{
+		n = 0;
+	}
+
+	int i;
+	int unknown = 0;
+	selector->nready = 0;
+	/* Errors and hang ups are reported as readiness like select() does. */
+	for(i = 0; i < n; ++i)
+	{
+		if(find_watched(selector, events[i].data.fd) == NULL)
+		{
+			unknown = 1;
+			continue;
+		}
+		selector->ready[selector->nready++] = events[i].data.fd;
+	}
+	for(i = 0; i < selector->nfiles && selector->nready < MAX_READY; ++i)
+	{
+		selector->ready[selector->nready++] = selector->files[i];
+	}
+
+	if(unknown)
+	{
+		recreate_instance(selector);
+	}
+
+	return (selector->nready != 0);
+}
+
+/* Unregisters descriptors that weren't added since the last reset. */
+static void
+drop_not_added(selector_t *selector)
+{
+	int i, j = 0;
+	for(i = 0; i < selector->nwatched; ++i)
+	{
+		if(selector->watched[i].added)
+		{
+			selector->watched[j++] = selector->watched[i];
+		}
+		else
+		{
+			(void)epoll_ctl(selector->epfd, EPOLL_CTL_DEL, selector->watched[i].fd,
+					NULL);
+		}
+	}
+	selector->nwatched = j;
+}
+
+/* Replaces epoll instance with a new one that has the same descriptors
+ * registered.  This gets rid of registrations of files that were closed while
+ * being referenced elsewhere, which can't be removed by descriptor. */
+static void
+recreate_instance(selector_t *selector)
+{
+	const int epfd = epoll_create1(EPOLL_CLOEXEC);
+	if(epfd == -1)
+	{
+		return;
+	}
+
+	close(selector->epfd);
+	selector->epfd = epfd;
+
+	int i, j = 0;
+	for(i = 0; i < selector->nwatched; ++i)
+	{
+		if(register_fd(selector, selector->watched[i].fd) == 0)
+		{
+			selector->watched[j++] = selector->watched[i];
+		}
+	}
+	selector->nwatched = j;
+}
+
+int
+selector_is_ready(selector_t *selector, selector_item_t item)
+{
+	int i;
+	for(i = 0; i < selector->nready; ++i)
+	{
+		if(selector->ready[i] == item)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+#else
+
 #include <sys/select.h> /* FD_* fd_set select() */
 
 #include <stdlib.h> /* free() malloc() */
@@ -102,5 +428,7 @@ selector_is_ready(selector_t *selector, selector_item_t item)
 	return FD_ISSET(item, &selector->ready);
 }
 
+#endif
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
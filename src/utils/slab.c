@@ -0,0 +1,285 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "slab.h"
+
+#include <stddef.h> /* NULL offsetof() size_t */
+#include <stdint.h> /* uint32_t */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* memcpy() strcmp() strlen() */
+
+/* Size of the first chunk of an arena.  Sizes of the following ones grow up to
+ * MAX_CHUNK_SIZE, so that small lists don't waste memory while large ones
+ * don't allocate too often. */
+#define MIN_CHUNK_SIZE 1024U
+
+/* Maximal size of a regular chunk.  Larger strings get chunks of their own. */
+#define MAX_CHUNK_SIZE 65536U
+
+/* Initial number of buckets of a table of interned strings. */
+#define INITIAL_BUCKETS 64U
+
+/* Header of a chunk, which is followed by strings. */
+typedef struct chunk_t
+{
+	struct chunk_t *next; /* Next chunk of the arena. */
+	size_t used;          /* Number of used bytes including the header. */
+	size_t size;          /* Size of the chunk including the header. */
+}
+chunk_t;
+
+/* Interned string along with its bookkeeping, allocated within a chunk. */
+typedef struct node_t
+{
+	struct node_t *next; /* Next node of the same bucket. */
+	uint32_t hash;       /* Hash of the string. */
+	char str[];          /* The string. */
+}
+node_t;
+
+struct slab_t
+{
+	chunk_t *chunks;   /* Chunks of the arena, the first one is being filled. */
+	size_t next_size;  /* Size of the next regular chunk. */
+
+	node_t **buckets;  /* Hash table of interned strings with chaining. */
+	size_t nbuckets;   /* Number of buckets (zero or a power of two). */
+	size_t count;      /* Number of interned strings. */
+
+	int refs;          /* Number of references to the arena. */
+};
+
+static void * alloc_bytes(slab_t *slab, size_t size, size_t align);
+static chunk_t * alloc_chunk(size_t size);
+static uint32_t hash_str(const char str[]);
+static void grow_table(slab_t *slab);
+
+slab_t *
+slab_create(void)
+{
+	slab_t *const slab = calloc(1, sizeof(*slab));
+	if(slab != NULL)
+	{
+		slab->next_size = MIN_CHUNK_SIZE;
+		slab->refs = 1;
+	}
+	return slab;
+}
+
+void
+slab_ref(slab_t *slab, int n)
+{
+	(void)__sync_add_and_fetch(&slab->refs, n);
+}
+
+void
+slab_release(slab_t *slab, int n)
+{
+	if(slab == NULL || __sync_sub_and_fetch(&slab->refs, n) != 0)
+	{
+		return;
+	}
+
+	chunk_t *chunk = slab->chunks;
+	while(chunk != NULL)
+	{
+		chunk_t *const next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	free(slab->buckets);
+	free(slab);
+}
+
+char *
+slab_strdup(slab_t *slab, const char str[])
+{
+	const size_t len = strlen(str);
+	char *const copy = alloc_bytes(slab, len + 1U, 1U);
+	if(copy != NULL)
+	{
+		memcpy(copy, str, len + 1U);
+	}
+	return copy;
+}
+
+char *
+slab_intern(slab_t *slab, const char str[])
+{
+	const uint32_t hash = hash_str(str);
+
+	if(slab->count >= slab->nbuckets)
+	{
+		grow_table(slab);
+	}
+
+	if(slab->nbuckets == 0U)
+	{
+		return NULL;
+	}
+
+	node_t **const bucket = &slab->buckets[hash & (slab->nbuckets - 1U)];
+	node_t *node;
+	for(node = *bucket; node != NULL; node = node->next)
+	{
+		if(node->hash == hash && strcmp(node->str, str) == 0)
+		{
+			return node->str;
+		}
+	}
+
+	const size_t len = strlen(str);
+	node = alloc_bytes(slab, offsetof(node_t, str) + len + 1U, sizeof(node_t *));
+	if(node == NULL)
+	{
+		return NULL;
+	}
+
+	node->hash = hash;
+	memcpy(node->str, str, len + 1U);
+	node->next = *bucket;
+	*bucket = node;
+	++slab->count;
+
+	return node->str;
+}
+
+/* Allocates memory within the slab at specified alignment.  Returns pointer to
+ * the memory or NULL on error. */
+static void *
+alloc_bytes(slab_t *slab, size_t size, size_t align)
+{
+	chunk_t *chunk = slab->chunks;
+	if(chunk != NULL)
+	{
+		const size_t offset = (chunk->used + align - 1U)/align*align;
+		if(offset + size <= chunk->size)
+		{
+			chunk->used = offset + size;
+			return (char *)chunk + offset;
+		}
+	}
+
+	if(sizeof(chunk_t) + size > MAX_CHUNK_SIZE)
+	{
+		/* Large data gets a chunk of its own, which is put after the current one
+		 * to keep filling it. */
+		chunk = alloc_chunk(sizeof(chunk_t) + size);
+		if(chunk == NULL)
+		{
+			return NULL;
+		}
+
+		if(slab->chunks == NULL)
+		{
+			slab->chunks = chunk;
+		}
+		else
+		{
+			chunk->next = slab->chunks->next;
+			slab->chunks->next = chunk;
+		}
+	}
+	else
+	{
+		size_t chunk_size = slab->next_size;
+		while(chunk_size < sizeof(chunk_t) + size)
+		{
+			chunk_size *= 2U;
+		}
+
+		chunk = alloc_chunk(chunk_size);
+		if(chunk == NULL)
+		{
+			return NULL;
+		}
+
+		chunk->next = slab->chunks;
+		slab->chunks = chunk;
+		if(chunk_size < MAX_CHUNK_SIZE)
+		{
+			slab->next_size = chunk_size*2U;
+		}
+	}
+
+	/* Header is aligned for any of the types stored in a chunk. */
+	chunk->used += size;
+	return (char *)chunk + sizeof(chunk_t);
+}
+
+/* Allocates an empty chunk.  Returns the chunk or NULL on error. */
+static chunk_t *
+alloc_chunk(size_t size)
+{
+	chunk_t *const chunk = malloc(size);
+	if(chunk != NULL)
+	{
+		chunk->next = NULL;
+		chunk->used = sizeof(chunk_t);
+		chunk->size = size;
+	}
+	return chunk;
+}
+
+/* Computes FNV-1a hash of the string.  Returns the hash. */
+static uint32_t
+hash_str(const char str[])
+{
+	uint32_t hash = 2166136261U;
+	while(*str != '\0')
+	{
+		hash = (hash ^ (unsigned char)*str++)*16777619U;
+	}
+	return hash;
+}
+
+/* Doubles number of buckets of the slab redistributing nodes among them.
+ * Leaves the table as is on error. */
+static void
+grow_table(slab_t *slab)
+{
+	const size_t new_nbuckets = (slab->nbuckets == 0U ? INITIAL_BUCKETS
+	                                                  : slab->nbuckets*2U);
+	node_t **const new_buckets = calloc(new_nbuckets, sizeof(*new_buckets));
+	if(new_buckets == NULL)
+	{
+		return;
+	}
+
+	size_t i;
+	for(i = 0U; i < slab->nbuckets; ++i)
+	{
+		node_t *node = slab->buckets[i];
+		while(node != NULL)
+		{
+			node_t *const next = node->next;
+			node_t **const bucket = &new_buckets[node->hash & (new_nbuckets - 1U)];
+			node->next = *bucket;
+			*bucket = node;
+			node = next;
+		}
+	}
+
+	free(slab->buckets);
+	slab->buckets = new_buckets;
+	slab->nbuckets = new_nbuckets;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
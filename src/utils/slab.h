@@ -0,0 +1,55 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__SLAB_H__
+#define VIFM__UTILS__SLAB_H__
+
+/* Arena of many small strings (like names of files) that packs them one after
+ * another into chunks instead of allocating every one of them separately.
+ * Strings aren't freed individually, all of them are freed along with the
+ * arena when its last reference is released.  Strings of an arena can be
+ * added by one thread at a time, while references can be taken and released
+ * from any thread. */
+
+/* Opaque declaration of the arena type. */
+typedef struct slab_t slab_t;
+
+/* Creates an empty arena with one reference to it.  Returns the arena or NULL
+ * on error. */
+slab_t * slab_create(void);
+
+/* Takes n more references to the slab. */
+void slab_ref(slab_t *slab, int n);
+
+/* Releases n references to the slab freeing it along with all of its strings
+ * once none are left.  slab can be NULL. */
+void slab_release(slab_t *slab, int n);
+
+/* Copies the string into the slab.  Returns the copy or NULL on error. */
+char * slab_strdup(slab_t *slab, const char str[]);
+
+/* Same as slab_strdup(), but equal strings share a single copy, which is
+ * useful for values that repeat a lot (like paths to parent directories of
+ * files).  Such strings must not be modified.  Returns the copy or NULL on
+ * error. */
+char * slab_intern(slab_t *slab, const char str[]);
+
+#endif /* VIFM__UTILS__SLAB_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -18,69 +18,114 @@
 
 #include "trie.h"
 
-#include <stdlib.h> /* calloc() free() */
+#include <ctype.h> /* tolower() */
+#include <stdint.h> /* INT32_MAX UINT32_MAX uint32_t */
+#include <stdlib.h> /* calloc() free() malloc() realloc() */
+#include <string.h> /* memcpy() strlen() */
+
+#include "../compat/reallocarray.h"
+
+/* The trie is path-compressed: every node holds a run of characters, so there
+ * are at most two nodes per key.  Nodes, their characters and data are stored
+ * in arrays owned by the trie and refer to each other by indexes, which makes
+ * cloning and freeing of a trie take constant number of operations. */
+
+/* Initial number of nodes. */
+#define INITIAL_NODES 16U
+
+/* Initial size of storage of characters. */
+#define INITIAL_CHARS 128U
+
+/* Node of the trie. */
+typedef struct
+{
+	uint32_t label;        /* Offset of characters of the node. */
+	unsigned int len:31;   /* Number of characters. */
+	unsigned int exists:1; /* Whether a key ends at this node. */
+	uint32_t child;        /* First child node or zero. */
+	uint32_t next;         /* Next sibling node or zero. */
+}
+node_t;
 
-/* Trie node. */
 struct trie_t
 {
-	trie_t *left;     /* Nodes with values less than value. */
-	trie_t *right;    /* Nodes with values greater than value. */
-	trie_t *children; /* Child nodes. */
-	void *data;       /* Data associated with the key. */
-	char value;       /* Value of the node. */
-	char exists;      /* Whether this node exists or it's an intermediate node. */
+	node_t *nodes;   /* Nodes, the first one is the root with empty label. */
+	uint32_t nnodes; /* Number of used nodes. */
+	uint32_t ncap;   /* Number of allocated nodes. */
+	char *chars;     /* Characters of all nodes. */
+	uint32_t nchars; /* Number of used characters. */
+	uint32_t ccap;   /* Number of allocated characters. */
+	void **data;     /* Data of nodes, allocated on first use of non-NULL data,
+	                    because many tries are just sets of strings. */
 };
 
-static trie_t *clone_nodes(trie_t *trie, int *error);
-static void get_or_create(trie_t *trie, const char str[], void *data,
-		int *result);
+static int get_or_create(trie_t *trie, const char str[], void *data);
+static uint32_t find_child(const trie_t *trie, uint32_t node, char c);
+static int split_node(trie_t *trie, uint32_t node, uint32_t at);
+static int add_leaf(trie_t *trie, uint32_t parent, const char str[]);
+static int alloc_node(trie_t *trie);
+static int alloc_data(trie_t *trie);
+static int find(const trie_t *trie, const char str[], int lower, void **data);
 
 trie_t *
 trie_create(void)
 {
-	return calloc(1U, sizeof(struct trie_t));
-}
-
-trie_t *
-trie_clone(trie_t *trie)
-{
-	int error = 0;
+	trie_t *const trie = calloc(1U, sizeof(*trie));
+	if(trie == NULL)
+	{
+		return NULL;
+	}
 
-	trie = clone_nodes(trie, &error);
-	if(error)
+	trie->nodes = calloc(INITIAL_NODES, sizeof(*trie->nodes));
+	trie->chars = malloc(INITIAL_CHARS);
+	if(trie->nodes == NULL || trie->chars == NULL)
 	{
 		trie_free(trie);
 		return NULL;
 	}
 
+	trie->nnodes = 1U;
+	trie->ncap = INITIAL_NODES;
+	trie->ccap = INITIAL_CHARS;
 	return trie;
 }
 
-/* Clones node and all its relatives.  Sets *error to non-zero on error.
- * Returns new node. */
-static trie_t *
-clone_nodes(trie_t *trie, int *error)
+trie_t *
+trie_clone(trie_t *trie)
 {
-	trie_t *new_trie;
-
 	if(trie == NULL)
 	{
 		return NULL;
 	}
 
-	new_trie = malloc(sizeof(*new_trie));
-	if(new_trie == NULL)
+	trie_t *const clone = malloc(sizeof(*clone));
+	if(clone == NULL)
 	{
-		*error = 1;
 		return NULL;
 	}
 
-	*new_trie = *trie;
-	new_trie->left = clone_nodes(trie->left, error);
-	new_trie->right = clone_nodes(trie->right, error);
-	new_trie->children = clone_nodes(trie->children, error);
+	*clone = *trie;
+	clone->nodes = reallocarray(NULL, trie->ncap, sizeof(*trie->nodes));
+	clone->chars = malloc(trie->ccap);
+	clone->data = NULL;
+	if(trie->data != NULL)
+	{
+		clone->data = reallocarray(NULL, trie->ncap, sizeof(*trie->data));
+	}
+	if(clone->nodes == NULL || clone->chars == NULL ||
+			(trie->data != NULL && clone->data == NULL))
+	{
+		trie_free(clone);
+		return NULL;
+	}
 
-	return new_trie;
+	memcpy(clone->nodes, trie->nodes, sizeof(*trie->nodes)*trie->nnodes);
+	memcpy(clone->chars, trie->chars, trie->nchars);
+	if(trie->data != NULL)
+	{
+		memcpy(clone->data, trie->data, sizeof(*trie->data)*trie->nnodes);
+	}
+	return clone;
 }
 
 void
@@ -88,9 +133,9 @@ trie_free(trie_t *trie)
 {
 	if(trie != NULL)
 	{
-		trie_free(trie->left);
-		trie_free(trie->right);
-		trie_free(trie->children);
+		free(trie->nodes);
+		free(trie->chars);
+		free(trie->data);
 		free(trie);
 	}
 }
@@ -100,11 +145,15 @@ trie_free_with_data(trie_t *trie, trie_free_func free_func)
 {
 	if(trie != NULL)
 	{
-		trie_free_with_data(trie->left, free_func);
-		trie_free_with_data(trie->right, free_func);
-		trie_free_with_data(trie->children, free_func);
-		free_func(trie->data);
-		free(trie);
+		uint32_t i;
+		for(i = 0U; i < trie->nnodes && trie->data != NULL; ++i)
+		{
+			if(trie->nodes[i].exists)
+			{
+				free_func(trie->data[i]);
+			}
+		}
+		trie_free(trie);
 	}
 }
 
@@ -117,91 +166,264 @@ trie_put(trie_t *trie, const char str[])
 int
 trie_set(trie_t *trie, const char str[], const void *data)
 {
-	int result;
-
 	if(trie == NULL)
 	{
 		return -1;
 	}
 
-	get_or_create(trie, str, (void *)data, &result);
-	return result;
+	return get_or_create(trie, str, (void *)data);
 }
 
-/* Gets node which might involve its creation.  Sets *return to negative value
- * on error, to zero on successful insertion and to positive number if element
- * was already in the trie. */
-static void
-get_or_create(trie_t *trie, const char str[], void *data, int *result)
+/* Finds node of the string creating it if necessary and sets its data.
+ * Returns negative value on error, zero on successful insertion and positive
+ * number if element was already in the trie. */
+static int
+get_or_create(trie_t *trie, const char str[], void *data)
 {
-	trie_t **link = &trie;
-	while(1)
+	uint32_t node = 0U;
+	while(*str != '\0')
 	{
-		/* Create inexistent node. */
-		if(trie == NULL)
+		const uint32_t child = find_child(trie, node, *str);
+		if(child == 0U)
 		{
-			trie = trie_create();
-			if(trie == NULL)
+			const int new_node = add_leaf(trie, node, str);
+			if(new_node < 0)
 			{
-				*result = -1;
-				break;
+				return -1;
 			}
-			trie->value = *str;
-			*link = trie;
+			node = new_node;
+			break;
+		}
+
+		const char *const label = &trie->chars[trie->nodes[child].label];
+		const uint32_t len = trie->nodes[child].len;
+		uint32_t matched = 1U;
+		while(matched < len && label[matched] == str[matched])
+		{
+			++matched;
+		}
+
+		if(matched < len && split_node(trie, child, matched) != 0)
+		{
+			return -1;
+		}
+
+		str += matched;
+		node = child;
+	}
+
+	if(data != NULL && trie->data == NULL && alloc_data(trie) != 0)
+	{
+		return -1;
+	}
+
+	node_t *const n = &trie->nodes[node];
+	const int result = (n->exists != 0);
+	n->exists = 1;
+	if(trie->data != NULL)
+	{
+		trie->data[node] = data;
+	}
+	return result;
+}
+
+/* Looks up child of the node whose label starts with the character.  Returns
+ * index of the child or zero if there is none. */
+static uint32_t
+find_child(const trie_t *trie, uint32_t node, char c)
+{
+	uint32_t child = trie->nodes[node].child;
+	while(child != 0U && trie->chars[trie->nodes[child].label] != c)
+	{
+		child = trie->nodes[child].next;
+	}
+	return child;
+}
+
+/* Splits label of the node in two, moving its tail to a new child node, which
+ * inherits children and data of the node.  Returns zero on success. */
+static int
+split_node(trie_t *trie, uint32_t node, uint32_t at)
+{
+	const int tail = alloc_node(trie);
+	if(tail < 0)
+	{
+		return 1;
+	}
+
+	node_t *const n = &trie->nodes[node];
+	node_t *const t = &trie->nodes[tail];
+
+	t->label = n->label + at;
+	t->len = n->len - at;
+	t->exists = n->exists;
+	t->child = n->child;
+	t->next = 0U;
+
+	n->len = at;
+	n->exists = 0;
+	n->child = tail;
+
+	if(trie->data != NULL)
+	{
+		trie->data[tail] = trie->data[node];
+		trie->data[node] = NULL;
+	}
+	return 0;
+}
+
+/* Adds child to the parent labeled with the string.  Returns index of the
+ * child or negative value on error. */
+static int
+add_leaf(trie_t *trie, uint32_t parent, const char str[])
+{
+	const size_t len = strlen(str);
+	if(len > UINT32_MAX/2U || trie->nchars > UINT32_MAX - len)
+	{
+		return -1;
+	}
+
+	if(trie->nchars + len > trie->ccap)
+	{
+		size_t ccap = (size_t)trie->ccap*2U;
+		while(ccap < trie->nchars + len)
+		{
+			ccap *= 2U;
+		}
+		if(ccap > UINT32_MAX)
+		{
+			ccap = UINT32_MAX;
 		}
 
-		if(trie->value == *str)
+		char *const chars = realloc(trie->chars, ccap);
+		if(chars == NULL)
 		{
-			if(*str == '\0')
+			return -1;
+		}
+		trie->chars = chars;
+		trie->ccap = ccap;
+	}
+
+	const int leaf = alloc_node(trie);
+	if(leaf < 0)
+	{
+		return -1;
+	}
+
+	node_t *const l = &trie->nodes[leaf];
+	l->label = trie->nchars;
+	l->len = len;
+	l->child = 0U;
+	l->next = trie->nodes[parent].child;
+	trie->nodes[parent].child = leaf;
+
+	memcpy(&trie->chars[trie->nchars], str, len);
+	trie->nchars += len;
+	return leaf;
+}
+
+/* Takes next unused node growing storage if needed.  Returns index of the node
+ * or negative value on error. */
+static int
+alloc_node(trie_t *trie)
+{
+	if(trie->nnodes == trie->ncap)
+	{
+		if(trie->ncap > INT32_MAX/2U)
+		{
+			return -1;
+		}
+
+		const uint32_t ncap = trie->ncap*2U;
+		if(trie->data != NULL)
+		{
+			void **const data = reallocarray(trie->data, ncap, sizeof(*data));
+			if(data == NULL)
 			{
-				/* Found full match. */
-				*result = (trie->exists != 0);
-				trie->exists = 1;
-				trie->data = data;
-				break;
+				return -1;
 			}
-
-			link = &trie->children;
-			++str;
+			trie->data = data;
 		}
-		else
+
+		node_t *const nodes = reallocarray(trie->nodes, ncap, sizeof(*nodes));
+		if(nodes == NULL)
 		{
-			link = (*str < trie->value) ? &trie->left : &trie->right;
+			return -1;
 		}
-		trie = *link;
+		trie->nodes = nodes;
+		trie->ncap = ncap;
 	}
+
+	trie->nodes[trie->nnodes].exists = 0;
+	if(trie->data != NULL)
+	{
+		trie->data[trie->nnodes] = NULL;
+	}
+	return trie->nnodes++;
+}
+
+/* Allocates storage for data of nodes.  Returns zero on success. */
+static int
+alloc_data(trie_t *trie)
+{
+	trie->data = calloc(trie->ncap, sizeof(*trie->data));
+	return (trie->data == NULL);
 }
 
 int
 trie_get(trie_t *trie, const char str[], void **data)
 {
-	while(1)
+	return find(trie, str, 0, data);
+}
+
+int
+trie_get_lower(trie_t *trie, const char str[], void **data)
+{
+	return find(trie, str, 1, data);
+}
+
+/* Looks up data for the str in the trie optionally converting it to lower
+ * case.  Returns zero when found and sets *data, otherwise returns non-zero. */
+static int
+find(const trie_t *trie, const char str[], int lower, void **data)
+{
+	if(trie == NULL)
+	{
+		return 1;
+	}
+
+	uint32_t node = 0U;
+	while(*str != '\0')
 	{
-		if(trie == NULL)
+		const char c = lower ? tolower((unsigned char)*str) : *str;
+		node = find_child(trie, node, c);
+		if(node == 0U)
 		{
 			return 1;
 		}
 
-		if(trie->value == *str)
+		const char *const label = &trie->chars[trie->nodes[node].label];
+		const uint32_t len = trie->nodes[node].len;
+		uint32_t i;
+		for(i = 1U; i < len; ++i)
 		{
-			if(*str == '\0')
+			const char ch = lower ? tolower((unsigned char)str[i]) : str[i];
+			if(ch != label[i])
 			{
-				/* Found full match. */
-				if(!trie->exists)
-				{
-					return 1;
-				}
-				*data = trie->data;
-				return 0;
+				return 1;
 			}
-
-			trie = trie->children;
-			++str;
-			continue;
 		}
 
-		trie = (*str < trie->value) ? trie->left : trie->right;
+		str += len;
 	}
+
+	if(!trie->nodes[node].exists)
+	{
+		return 1;
+	}
+
+	*data = (trie->data == NULL ? NULL : trie->data[node]);
+	return 0;
 }
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -54,6 +54,10 @@ int trie_set(trie_t *trie, const char str[], const void *data);
  * non-zero. */
 int trie_get(trie_t *trie, const char str[], void **data);
 
+/* Same as trie_get(), but converts str to lower case on the fly, which is
+ * useful for case-insensitive lookups in a trie of lower case strings. */
+int trie_get_lower(trie_t *trie, const char str[], void **data);
+
 #endif /* VIFM__UTILS__TRIE_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
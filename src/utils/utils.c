@@ -37,6 +37,7 @@
 #include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* free() malloc() qsort() */
 #include <string.h> /* memcpy() strdup() strchr() strlen() strpbrk() strtol() */
+#include <time.h> /* CLOCK_MONOTONIC clock_gettime() */
 #include <wchar.h> /* wcwidth() */
 
 #include "../cfg/config.h"
@@ -753,6 +754,18 @@ safe_qsort(void *base, size_t nmemb, size_t size,
 	}
 }
 
+long long
+time_in_ms(void)
+{
+	struct timespec current_time;
+	if(clock_gettime(CLOCK_MONOTONIC, &current_time) != 0)
+	{
+		return 0;
+	}
+
+	return current_time.tv_sec*1000 + current_time.tv_nsec/1000000;
+}
+
 void
 format_position(char buf[], size_t buf_len, int top, int total, int visible)
 {
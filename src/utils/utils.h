@@ -165,6 +165,10 @@ int def_count(int count);
 void safe_qsort(void *base, size_t nmemb, size_t size,
 		int (*compar)(const void *, const void *));
 
+/* Retrieves value of monotonic clock in milliseconds.  Returns the value or
+ * zero on error. */
+long long time_in_ms(void);
+
 /* Formats position within the viewport as one of the following: All, Top, xx%
  * or Bot. */
 void format_position(char buf[], size_t buf_len, int top, int total,
@@ -291,6 +291,7 @@ prepare_for_exec(void)
 	{
 		view_t *view = tab_info.view;
 		fswatch_free(view->watch);
+		fswatch_free(view->tree_watch);
 		fswatch_free(view->left_column.watch);
 		fswatch_free(view->right_column.watch);
 	}
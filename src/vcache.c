@@ -55,6 +55,7 @@ typedef struct
 	int max_lines;     /* Number of lines requested. */
 	int complete;      /* Whether cache contains complete output of the viewer. */
 	int truncated;     /* Whether last line is truncated. */
+	int output_eof;    /* Whether end of output of the job was reached. */
 }
 vcache_entry_t;
 
@@ -119,6 +120,41 @@ vcache_check(vcache_is_previewed_cb is_previewed)
 	return changed;
 }
 
+int
+vcache_add_to_selector(selector_t *selector)
+{
+	int poll = 0;
+
+	size_t i;
+	for(i = 0U; i < DA_SIZE(cache); ++i)
+	{
+		vcache_entry_t *const centry = &cache[i];
+		if(centry->job == NULL)
+		{
+			continue;
+		}
+
+		/* Waiting for termination of a job can only be done by polling its state
+		 * and so is reading from it once it doesn't need more data (that's when it
+		 * gets cancelled). */
+		if(centry->kill_timer != 0 || centry->output_eof ||
+				!need_more_async_output(centry))
+		{
+			poll = 1;
+			continue;
+		}
+
+#ifndef _WIN32
+		selector_add(selector, fileno(centry->job->output));
+#else
+		/* Anonymous pipes can't be waited on. */
+		poll = 1;
+#endif
+	}
+
+	return poll;
+}
+
 strlist_t
 vcache_lookup(const char full_path[], const char viewer[], ViewerKind kind,
 		int max_lines, int sync, const char **error)
@@ -440,6 +476,7 @@ read_async_output(vcache_entry_t *centry)
 
 	if(len == 0)
 	{
+		centry->output_eof = 1;
 		return -1;
 	}
 
@@ -539,6 +576,7 @@ get_data(vcache_entry_t *centry, const char **error)
 			ui_cancellation_pop();
 			centry->complete = 0;
 			centry->truncated = 0;
+			centry->output_eof = 0;
 
 #ifndef _WIN32
 			/* Enable non-blocking read from output pipe.  On Windows we read the
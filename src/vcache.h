@@ -38,6 +38,7 @@ enum
  * Should return non-zero if so and zero otherwise. */
 typedef int (*vcache_is_previewed_cb)(const char path[]);
 
+struct selector_t;
 struct strlist_t;
 
 /* Kills all asynchronous viewers. */
@@ -47,6 +48,11 @@ void vcache_finish(void);
  * be updated, otherwise zero is returned. */
 int vcache_check(vcache_is_previewed_cb is_previewed);
 
+/* Adds output streams of asynchronous viewers to the selector to be able to
+ * wait for their output instead of calling vcache_check() periodically.
+ * Returns non-zero if some of the viewers still need to be polled. */
+int vcache_add_to_selector(struct selector_t *selector);
+
 /* Looks up cached output of a viewer command (no macro expansion is performed)
  * or produces and caches it.  *error is set either to NULL or an error code on
  * failure.  Returns list of strings owned and managed by the unit, don't store
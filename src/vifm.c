@@ -648,6 +648,7 @@ vifm_finish(const char message[])
 void _gnuc_noreturn
 vifm_exit(int exit_code)
 {
+	(void)dcache_save();
 	vcache_finish();
 	plugs_free(curr_stats.plugs);
 	vlua_finish(curr_stats.vlua);
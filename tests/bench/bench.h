@@ -0,0 +1,53 @@
+#ifndef VIFM_TESTS__BENCH__BENCH_H__
+#define VIFM_TESTS__BENCH__BENCH_H__
+
+/* Benchmarks are built along with tests, but aren't run automatically.  Each
+ * one prints its timings to standard output. */
+
+/* Retrieves monotonic time in seconds. */
+double bench_now(void);
+
+/* Parses optional positive integer argument.  Returns def if argument is
+ * missing or invalid. */
+int bench_int_arg(int argc, char *argv[], int i, int def);
+
+/* Enables or disables counting of memory allocations.  Enabling resets the
+ * counter. */
+void bench_count_allocs(int enable);
+
+/* Retrieves number of memory allocations counted so far.  Returns the number or
+ * -1 if allocations can't be counted on this platform. */
+long bench_allocs(void);
+
+/* Retrieves number of bytes allocated on heap.  Returns the number or -1 if it
+ * can't be determined on this platform. */
+long long bench_heap_usage(void);
+
+/* Measures iterating over, selecting and filtering of a large list of
+ * entries. */
+int bench_entries(int argc, char *argv[]);
+
+/* Measures matching of many names against a matcher of many simple globs. */
+int bench_fglobs(int argc, char *argv[]);
+
+/* Measures loading of a large directory depending on the number of workers. */
+int bench_flist_load(int argc, char *argv[]);
+
+/* Measures indexing of names of entries on reload by a hash index and by a
+ * trie. */
+int bench_name_index(int argc, char *argv[]);
+
+/* Measures sorting of a large list of files by different keys. */
+int bench_sort(int argc, char *argv[]);
+
+/* Measures allocation and freeing of names and directories of entries with
+ * plain copies and with slab and interning. */
+int bench_strings(int argc, char *argv[]);
+
+/* Measures building, querying and freeing of a trie of many paths. */
+int bench_trie(int argc, char *argv[]);
+
+#endif /* VIFM_TESTS__BENCH__BENCH_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,115 @@
+#include <stdio.h> /* printf() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS */
+#include <string.h> /* strdup() */
+
+#include <test-utils.h>
+
+#include "../../src/ui/ui.h"
+#include "../../src/utils/dynarray.h"
+#include "../../src/utils/filter.h"
+#include "../../src/filtering.h"
+#include "../../src/flist_sel.h"
+#include "bench.h"
+
+/* Number of passes over the list for operations that are fast. */
+#define NPASSES 20
+
+static void populate(view_t *view, int nentries);
+static long iterate(const view_t *view);
+static int filter_list(view_t *view);
+
+int
+bench_entries(int argc, char *argv[])
+{
+	const int nentries = bench_int_arg(argc, argv, 0, 1000000);
+	int i;
+
+	view_setup(&lwin);
+	populate(&lwin, nentries);
+
+	printf("%d entries of %d bytes:\n", nentries, (int)sizeof(dir_entry_t));
+
+	double start = bench_now();
+	long sum = 0;
+	for(i = 0; i < NPASSES; ++i)
+	{
+		sum += iterate(&lwin);
+	}
+	const double iterate_time = (bench_now() - start)/NPASSES;
+
+	start = bench_now();
+	for(i = 0; i < NPASSES; ++i)
+	{
+		flist_sel_invert(&lwin);
+	}
+	const double select_time = (bench_now() - start)/NPASSES;
+
+	start = bench_now();
+	const int nmatched = filter_list(&lwin);
+	const double filter_time = bench_now() - start;
+
+	printf("iterate: %.4f s (%ld)\n", iterate_time, sum);
+	printf("select:  %.4f s (%d selected)\n", select_time, lwin.selected_files);
+	printf("filter:  %.4f s (%d matched)\n", filter_time, nmatched);
+
+	view_teardown(&lwin);
+	return EXIT_SUCCESS;
+}
+
+/* Fills the view with entries. */
+static void
+populate(view_t *view, int nentries)
+{
+	view->list_rows = nentries;
+	view->dir_entry = dynarray_cextend(NULL,
+			nentries*sizeof(*view->dir_entry));
+
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		dir_entry_t *const entry = &view->dir_entry[i];
+
+		char name[64];
+		snprintf(name, sizeof(name), "file-%d.txt", i);
+
+		entry->name = strdup(name);
+		entry->origin = view->curr_dir;
+		entry->type = (i%10 == 0) ? FT_DIR : FT_REG;
+		entry->hi_num = -1;
+		entry->name_dec_num = -1;
+	}
+}
+
+/* Visits fields of entries that are needed to draw them.  Returns value that
+ * depends on all of them to keep the loop from being optimized out. */
+static long
+iterate(const view_t *view)
+{
+	long sum = 0;
+	int i;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		const dir_entry_t *const entry = &view->dir_entry[i];
+		sum += entry->name[0] + entry->type + entry->selected + entry->hi_num
+		     + entry->name_dec_num + entry->search_match;
+	}
+	return sum;
+}
+
+/* Matches entries against local filter.  Returns number of matched entries. */
+static int
+filter_list(view_t *view)
+{
+	int nmatched = 0;
+	int i;
+
+	(void)filter_set(&view->local_filter.filter, "7\\.txt$");
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		nmatched += local_filter_matches(view, &view->dir_entry[i]);
+	}
+	return nmatched;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,114 @@
+#include <stdio.h> /* printf() puts() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS free() malloc() */
+#include <string.h> /* strlen() */
+
+#include "../../src/utils/matcher.h"
+#include "../../src/utils/str.h"
+#include "bench.h"
+
+static char * make_globs(int nglobs);
+static unsigned int next_random(void);
+
+/* State of pseudo-random number generator. */
+static unsigned int seed = 1U;
+
+int
+bench_fglobs(int argc, char *argv[])
+{
+	enum { NAME_LEN = 32 };
+
+	const int nnames = bench_int_arg(argc, argv, 0, 1000000);
+	const int nglobs = bench_int_arg(argc, argv, 1, 500);
+
+	char *const globs = make_globs(nglobs);
+	char *const expr = format_str("{%s}", globs);
+	free(globs);
+
+	char *error;
+	matcher_t *const m = matcher_alloc(expr, 0, 1, "", &error);
+	free(expr);
+	if(m == NULL)
+	{
+		printf("Failed to create matcher: %s\n", error);
+		free(error);
+		return EXIT_FAILURE;
+	}
+
+	char *const names = malloc((size_t)nnames*NAME_LEN);
+	if(names == NULL)
+	{
+		puts("Not enough memory");
+		matcher_free(m);
+		return EXIT_FAILURE;
+	}
+
+	/* Half of the names have extensions that are matched by some glob, few have
+	 * exact names from the list and the rest isn't matched. */
+	int i;
+	for(i = 0; i < nnames; ++i)
+	{
+		char *const name = &names[(size_t)i*NAME_LEN];
+		const unsigned int r = next_random();
+		if(r%64U == 0U)
+		{
+			snprintf(name, NAME_LEN, "Name%u", r%(unsigned int)nglobs);
+		}
+		else
+		{
+			snprintf(name, NAME_LEN, "file-%d.%s%u", i, (r%2U == 0U) ? "E" : "x",
+					r%(unsigned int)nglobs);
+		}
+	}
+
+	const double start = bench_now();
+	int nmatched = 0;
+	for(i = 0; i < nnames; ++i)
+	{
+		nmatched += matcher_matches(m, &names[(size_t)i*NAME_LEN]);
+	}
+	const double elapsed = bench_now() - start;
+
+	printf("Matched %d of %d names against %d globs in %.3f s\n", nmatched,
+			nnames, nglobs, elapsed);
+
+	free(names);
+	matcher_free(m);
+	return EXIT_SUCCESS;
+}
+
+/* Makes a list of globs that consists mostly of extensions and a bit of exact
+ * names.  Returns newly allocated string. */
+static char *
+make_globs(int nglobs)
+{
+	char *globs = NULL;
+	size_t len = 0U;
+
+	int i;
+	for(i = 0; i < nglobs; ++i)
+	{
+		char glob[32];
+		if(i%8 == 0)
+		{
+			snprintf(glob, sizeof(glob), "%sname%d", (i == 0 ? "" : ","), i);
+		}
+		else
+		{
+			snprintf(glob, sizeof(glob), "%s*.e%d", (i == 0 ? "" : ","), i);
+		}
+		(void)strappend(&globs, &len, glob);
+	}
+
+	return globs;
+}
+
+/* Generates next pseudo-random number.  Returns the number. */
+static unsigned int
+next_random(void)
+{
+	seed = seed*1103515245U + 12345U;
+	return (seed >> 1);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
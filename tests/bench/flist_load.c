@@ -0,0 +1,111 @@
+#include <fcntl.h> /* O_CREAT O_WRONLY open() */
+#include <unistd.h> /* chdir() close() rmdir() unlink() */
+
+#include <stdio.h> /* printf() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/compat/fs_limits.h"
+#include "../../src/compat/os.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/parallel.h"
+#include "../../src/utils/str.h"
+#include "../../src/filelist.h"
+#include "bench.h"
+
+static int populate(const char dir[], int nentries);
+static void cleanup(const char dir[], int nentries);
+
+int
+bench_flist_load(int argc, char *argv[])
+{
+	const int nentries = bench_int_arg(argc, argv, 0, 500000);
+	const int max_workers = bench_int_arg(argc, argv, 1, 16);
+
+	char dir[PATH_MAX + 1];
+	snprintf(dir, sizeof(dir), "%s/flist_load", SANDBOX_PATH);
+
+	if(populate(dir, nentries) != 0)
+	{
+		cleanup(dir, nentries);
+		return EXIT_FAILURE;
+	}
+
+	update_string(&cfg.slow_fs_list, "");
+	view_setup(&lwin);
+	copy_str(lwin.curr_dir, sizeof(lwin.curr_dir), dir);
+
+	printf("Loading %d entries:\n", nentries);
+
+	int nworkers;
+	for(nworkers = 1; nworkers <= max_workers; nworkers *= 2)
+	{
+		par_set_nworkers(nworkers);
+
+		double start = bench_now();
+		populate_dir_list(&lwin, 0);
+		double load = bench_now() - start;
+
+		start = bench_now();
+		populate_dir_list(&lwin, 1);
+		double reload = bench_now() - start;
+
+		printf("%2d worker(s): load %.3f s, reload %.3f s\n", nworkers, load,
+				reload);
+	}
+
+	view_teardown(&lwin);
+	update_string(&cfg.slow_fs_list, NULL);
+
+	cleanup(dir, nentries);
+	return EXIT_SUCCESS;
+}
+
+/* Creates directory with specified number of empty files.  Returns zero on
+ * success. */
+static int
+populate(const char dir[], int nentries)
+{
+	if(os_mkdir(dir, 0700) != 0 || chdir(dir) != 0)
+	{
+		printf("Failed to create %s\n", dir);
+		return 1;
+	}
+
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "file-%07d", i);
+
+		const int fd = open(name, O_CREAT | O_WRONLY, 0600);
+		if(fd == -1)
+		{
+			printf("Failed to create %s/%s\n", dir, name);
+			return 1;
+		}
+		close(fd);
+	}
+
+	return 0;
+}
+
+/* Removes directory created by populate(). */
+static void
+cleanup(const char dir[], int nentries)
+{
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		char path[PATH_MAX + 1];
+		snprintf(path, sizeof(path), "%s/file-%07d", dir, i);
+		(void)unlink(path);
+	}
+	(void)rmdir(dir);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
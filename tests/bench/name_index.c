@@ -0,0 +1,167 @@
+#include <stdio.h> /* printf() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS free() malloc() */
+#include <string.h> /* strdup() */
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/utils/name_index.h"
+#include "../../src/utils/path.h"
+#include "../../src/utils/trie.h"
+#include "bench.h"
+
+/* Number of different directories in custom view. */
+#define NDIRS 64
+
+/* Minimal version of directory entry. */
+typedef struct
+{
+	char *name;         /* Name of the file. */
+	const char *origin; /* Directory of the file. */
+}
+entry_t;
+
+static void run(const char descr[], int (*func)(const entry_t[], int, int),
+		const entry_t entries[], int nentries, int paths);
+static int reload_trie(const entry_t entries[], int nentries, int paths);
+static int reload_nindex(const entry_t entries[], int nentries, int paths);
+static const char * get_key(const entry_t *entry, int paths, char buf[],
+		size_t buf_len);
+
+int
+bench_name_index(int argc, char *argv[])
+{
+	const int nentries = bench_int_arg(argc, argv, 0, 200000);
+
+	char dirs[NDIRS][64];
+	int i;
+	for(i = 0; i < NDIRS; ++i)
+	{
+		snprintf(dirs[i], sizeof(dirs[i]), "/home/user/projects/vifm/dir%02d", i);
+	}
+
+	entry_t *const entries = malloc(sizeof(*entries)*nentries);
+	if(entries == NULL)
+	{
+		return EXIT_FAILURE;
+	}
+
+	for(i = 0; i < nentries; ++i)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "file-%d.txt", i);
+		entries[i].name = strdup(name);
+		entries[i].origin = dirs[i%NDIRS];
+	}
+
+	printf("Reloading %d entries (checking uniqueness and merging):\n",
+			nentries);
+	run("trie, names", &reload_trie, entries, nentries, 0);
+	run("hash, names", &reload_nindex, entries, nentries, 0);
+	run("trie, paths", &reload_trie, entries, nentries, 1);
+	run("hash, paths", &reload_nindex, entries, nentries, 1);
+
+	for(i = 0; i < nentries; ++i)
+	{
+		free(entries[i].name);
+	}
+	free(entries);
+	return EXIT_SUCCESS;
+}
+
+/* Runs single measurement and prints its results. */
+static void
+run(const char descr[], int (*func)(const entry_t[], int, int),
+		const entry_t entries[], int nentries, int paths)
+{
+	bench_count_allocs(1);
+	const double start = bench_now();
+	const int nfound = func(entries, nentries, paths);
+	const double elapsed = bench_now() - start;
+	bench_count_allocs(0);
+
+	printf("%s: %.3f s, %ld allocations, %d found\n", descr, elapsed,
+			bench_allocs(), nfound);
+}
+
+/* Does what reload used to do with tries: fills one trie with new entries to
+ * find duplicates, then fills another one with old entries and looks new
+ * entries up in it.  Returns number of found entries. */
+static int
+reload_trie(const entry_t entries[], int nentries, int paths)
+{
+	char buf[PATH_MAX + 1];
+	int nfound = 0;
+	int i;
+
+	trie_t *const unique = trie_create();
+	for(i = 0; i < nentries; ++i)
+	{
+		const char *const key = get_key(&entries[i], paths, buf, sizeof(buf));
+		(void)trie_set(unique, key, &entries[i]);
+	}
+	trie_free(unique);
+
+	trie_t *const prev = trie_create();
+	for(i = 0; i < nentries; ++i)
+	{
+		const char *const key = get_key(&entries[i], paths, buf, sizeof(buf));
+		(void)trie_set(prev, key, &entries[i]);
+	}
+	for(i = 0; i < nentries; ++i)
+	{
+		void *data;
+		const char *const key = get_key(&entries[i], paths, buf, sizeof(buf));
+		nfound += (trie_get(prev, key, &data) == 0);
+	}
+	trie_free(prev);
+
+	return nfound;
+}
+
+/* Same as reload_trie(), but uses hash index.  Returns number of found
+ * entries. */
+static int
+reload_nindex(const entry_t entries[], int nentries, int paths)
+{
+	int nfound = 0;
+	int i;
+
+	nindex_t *const unique = nindex_alloc(nentries);
+	for(i = 0; i < nentries; ++i)
+	{
+		const char *const dir = (paths ? entries[i].origin : NULL);
+		(void)nindex_put(unique, dir, entries[i].name, i);
+	}
+	nindex_free(unique);
+
+	nindex_t *const prev = nindex_alloc(nentries);
+	for(i = 0; i < nentries; ++i)
+	{
+		const char *const dir = (paths ? entries[i].origin : NULL);
+		(void)nindex_put(prev, dir, entries[i].name, i);
+	}
+	for(i = 0; i < nentries; ++i)
+	{
+		const char *const dir = (paths ? entries[i].origin : NULL);
+		nfound += (nindex_get(prev, dir, entries[i].name) >= 0);
+	}
+	nindex_free(prev);
+
+	return nfound;
+}
+
+/* Makes key of an entry for a trie, which is either its name or full path.
+ * Returns the key. */
+static const char *
+get_key(const entry_t *entry, int paths, char buf[], size_t buf_len)
+{
+	if(!paths)
+	{
+		return entry->name;
+	}
+
+	build_path(buf, buf_len, entry->origin, entry->name);
+	return buf;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
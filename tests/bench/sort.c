@@ -0,0 +1,136 @@
+#include <stdio.h> /* printf() puts() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS */
+#include <string.h> /* memset() strdup() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/dynarray.h"
+#include "../../src/sort.h"
+#include "../../src/status.h"
+#include "bench.h"
+
+static void populate(view_t *view, int nentries);
+static void shuffle(view_t *view);
+static unsigned int next_random(void);
+
+/* State of pseudo-random number generator. */
+static unsigned int seed = 1U;
+
+int
+bench_sort(int argc, char *argv[])
+{
+	static const struct
+	{
+		const char *name;
+		SortingKey key;
+	}
+	keys[] = {
+		{ "name", SK_BY_NAME },
+		{ "iname", SK_BY_INAME },
+		{ "extension", SK_BY_EXTENSION },
+		{ "fileext", SK_BY_FILEEXT },
+		{ "size", SK_BY_SIZE },
+		{ "mtime", SK_BY_TIME_MODIFIED },
+		{ "type", SK_BY_TYPE },
+#ifndef _WIN32
+		{ "inode", SK_BY_INODE },
+		{ "perms", SK_BY_PERMISSIONS },
+#endif
+	};
+
+	const int nentries = bench_int_arg(argc, argv, 0, 500000);
+
+	cfg.sort_numbers = 0;
+	if(stats_init(&cfg) != 0)
+	{
+		puts("Failed to initialize state");
+		return EXIT_FAILURE;
+	}
+
+	view_setup(&lwin);
+	populate(&lwin, nentries);
+
+	printf("Sorting %d entries:\n", nentries);
+
+	size_t i;
+	for(i = 0U; i < sizeof(keys)/sizeof(keys[0]); ++i)
+	{
+		memset(&lwin.sort[0], SK_NONE, sizeof(lwin.sort));
+		lwin.sort[0] = keys[i].key;
+
+		shuffle(&lwin);
+		double start = bench_now();
+		sort_view(&lwin);
+		const double shuffled = bench_now() - start;
+
+		start = bench_now();
+		sort_view(&lwin);
+		const double sorted = bench_now() - start;
+
+		printf("%10s: shuffled %.3f s, sorted %.3f s\n", keys[i].name, shuffled,
+				sorted);
+	}
+
+	view_teardown(&lwin);
+	return EXIT_SUCCESS;
+}
+
+/* Fills the view with entries that have a variety of names and attributes. */
+static void
+populate(view_t *view, int nentries)
+{
+	static const char *exts[] = { "c", "h", "txt", "tar.gz", "", "md", "o" };
+
+	view->list_rows = nentries;
+	view->dir_entry = dynarray_cextend(NULL,
+			nentries*sizeof(*view->dir_entry));
+
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		dir_entry_t *const entry = &view->dir_entry[i];
+
+		const char *const ext = exts[next_random()%(sizeof(exts)/sizeof(exts[0]))];
+		char name[64];
+		snprintf(name, sizeof(name), "File%u-%d%s%s", next_random()%1000U, i,
+				(ext[0] == '\0' ? "" : "."), ext);
+
+		entry->name = strdup(name);
+		entry->origin = view->curr_dir;
+		entry->type = (next_random()%10U == 0U) ? FT_DIR : FT_REG;
+		entry->size = next_random();
+		entry->mtime = next_random();
+#ifndef _WIN32
+		entry->inode = next_random();
+		entry->mode = next_random()%0777;
+#endif
+		entry->name_dec_num = -1;
+	}
+}
+
+/* Puts entries of the view in random order. */
+static void
+shuffle(view_t *view)
+{
+	int i;
+	for(i = view->list_rows - 1; i > 0; --i)
+	{
+		const int j = next_random()%(i + 1);
+		const dir_entry_t tmp = view->dir_entry[i];
+		view->dir_entry[i] = view->dir_entry[j];
+		view->dir_entry[j] = tmp;
+	}
+}
+
+/* Generates next pseudo-random number.  Returns the number. */
+static unsigned int
+next_random(void)
+{
+	seed = seed*1103515245U + 12345U;
+	return (seed >> 1);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
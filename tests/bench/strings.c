@@ -0,0 +1,140 @@
+#include <stdio.h> /* printf() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS free() malloc() */
+#include <string.h> /* strdup() */
+
+#include "../../src/utils/slab.h"
+#include "bench.h"
+
+/* Number of different directories in custom view. */
+#define NDIRS 64
+
+/* Minimal version of directory entry. */
+typedef struct
+{
+	char *name;   /* Name of the file. */
+	char *origin; /* Directory of the file. */
+}
+entry_t;
+
+static void run(const char descr[], void (*fill)(entry_t[], int),
+		void (*release)(entry_t[], int), entry_t entries[], int nentries);
+static void fill_plain(entry_t entries[], int nentries);
+static void release_plain(entry_t entries[], int nentries);
+static void fill_packed(entry_t entries[], int nentries);
+static void release_packed(entry_t entries[], int nentries);
+static void make_name(int i, char buf[], size_t buf_len);
+static void make_origin(int i, char buf[], size_t buf_len);
+
+/* Arena used by fill_packed() and release_packed(). */
+static slab_t *slab;
+
+int
+bench_strings(int argc, char *argv[])
+{
+	const int nentries = bench_int_arg(argc, argv, 0, 500000);
+
+	entry_t *const entries = malloc(sizeof(*entries)*nentries);
+	if(entries == NULL)
+	{
+		return EXIT_FAILURE;
+	}
+
+	printf("Strings of %d entries from %d directories:\n", nentries, NDIRS);
+	run("strdup()      ", &fill_plain, &release_plain, entries, nentries);
+	run("slab          ", &fill_packed, &release_packed, entries, nentries);
+
+	free(entries);
+	return EXIT_SUCCESS;
+}
+
+/* Runs single measurement and prints its results. */
+static void
+run(const char descr[], void (*fill)(entry_t[], int),
+		void (*release)(entry_t[], int), entry_t entries[], int nentries)
+{
+	const long long heap_before = bench_heap_usage();
+	bench_count_allocs(1);
+	double start = bench_now();
+	fill(entries, nentries);
+	const double fill_time = bench_now() - start;
+	bench_count_allocs(0);
+	const long long heap = bench_heap_usage() - heap_before;
+
+	start = bench_now();
+	release(entries, nentries);
+	const double free_time = bench_now() - start;
+
+	printf("%s: fill %.3f s, free %.3f s, %ld allocations, %lld bytes on heap\n",
+			descr, fill_time, free_time, bench_allocs(), heap);
+}
+
+/* Copies strings in the way entries used to be filled. */
+static void
+fill_plain(entry_t entries[], int nentries)
+{
+	char buf[128];
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		make_name(i, buf, sizeof(buf));
+		entries[i].name = strdup(buf);
+		make_origin(i, buf, sizeof(buf));
+		entries[i].origin = strdup(buf);
+	}
+}
+
+/* Frees strings allocated by fill_plain(). */
+static void
+release_plain(entry_t entries[], int nentries)
+{
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		free(entries[i].name);
+		free(entries[i].origin);
+	}
+}
+
+/* Copies names into an arena and interns origins in it the way lists of
+ * entries are filled.  All entries share the same arena. */
+static void
+fill_packed(entry_t entries[], int nentries)
+{
+	slab = slab_create();
+	slab_ref(slab, nentries - 1);
+
+	char buf[128];
+	int i;
+	for(i = 0; i < nentries; ++i)
+	{
+		make_name(i, buf, sizeof(buf));
+		entries[i].name = slab_strdup(slab, buf);
+		make_origin(i, buf, sizeof(buf));
+		entries[i].origin = slab_intern(slab, buf);
+	}
+}
+
+/* Frees strings allocated by fill_packed() by releasing the arena on behalf of
+ * all entries at once. */
+static void
+release_packed(entry_t entries[], int nentries)
+{
+	slab_release(slab, nentries);
+}
+
+/* Makes name of a file. */
+static void
+make_name(int i, char buf[], size_t buf_len)
+{
+	snprintf(buf, buf_len, "file-%d.txt", i);
+}
+
+/* Makes path to parent directory of a file. */
+static void
+make_origin(int i, char buf[], size_t buf_len)
+{
+	snprintf(buf, buf_len, "/home/user/projects/vifm/dir%02d", i%NDIRS);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
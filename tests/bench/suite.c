@@ -0,0 +1,175 @@
+#include <stddef.h> /* size_t */
+#include <stdio.h> /* printf() puts() */
+#include <stdlib.h> /* EXIT_FAILURE strtol() */
+#include <string.h> /* strcmp() */
+#include <time.h> /* CLOCK_MONOTONIC clock_gettime() */
+
+#ifdef __GLIBC__
+#include <malloc.h> /* mallinfo2() */
+#endif
+
+#include <test-utils.h>
+
+#include "../../src/ui/tabs.h"
+#include "../../src/utils/macros.h"
+#include "bench.h"
+
+/* Usage: bench <name> [args...]
+ *
+ * Benchmarks operate on files in the sandbox unless noted otherwise. */
+
+/* Description of a single benchmark. */
+typedef struct
+{
+	const char *name;                  /* Name to invoke it by. */
+	const char *args;                  /* Description of arguments. */
+	int (*func)(int argc, char *argv[]); /* Entry point. */
+}
+bench_t;
+
+/* Whether allocations are being counted. */
+static int count_allocs;
+/* Number of allocations since counting was enabled. */
+static long nallocs;
+
+static const bench_t benchmarks[] = {
+	{ "entries", "[nentries]", &bench_entries },
+	{ "fglobs", "[nnames [nglobs]]", &bench_fglobs },
+	{ "flist_load", "[nentries [max-workers]]", &bench_flist_load },
+	{ "name_index", "[nentries]", &bench_name_index },
+	{ "sort", "[nentries]", &bench_sort },
+	{ "strings", "[nentries]", &bench_strings },
+	{ "trie", "[npaths]", &bench_trie },
+};
+
+int
+main(int argc, char *argv[])
+{
+	size_t i;
+
+	if(argc >= 2)
+	{
+		for(i = 0U; i < ARRAY_LEN(benchmarks); ++i)
+		{
+			if(strcmp(argv[1], benchmarks[i].name) == 0)
+			{
+				fix_environ();
+				stub_colmgr();
+				tabs_init();
+				return benchmarks[i].func(argc - 2, argv + 2);
+			}
+		}
+	}
+
+	puts("Usage: bench <name> [args...]");
+	puts("");
+	puts("Available benchmarks:");
+	for(i = 0U; i < ARRAY_LEN(benchmarks); ++i)
+	{
+		printf(" * %s %s\n", benchmarks[i].name, benchmarks[i].args);
+	}
+	return EXIT_FAILURE;
+}
+
+double
+bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+int
+bench_int_arg(int argc, char *argv[], int i, int def)
+{
+	if(i >= argc)
+	{
+		return def;
+	}
+
+	char *end;
+	const long value = strtol(argv[i], &end, 10);
+	return (*end == '\0' && value > 0) ? value : def;
+}
+
+void
+bench_count_allocs(int enable)
+{
+	count_allocs = enable;
+	if(enable)
+	{
+		nallocs = 0L;
+	}
+}
+
+long
+bench_allocs(void)
+{
+#ifdef __GLIBC__
+	return nallocs;
+#else
+	return -1L;
+#endif
+}
+
+long long
+bench_heap_usage(void)
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+	const struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+#else
+	return -1LL;
+#endif
+}
+
+#ifdef __GLIBC__
+
+/* Allocation functions are replaced to count calls to them.  glibc supports
+ * this and provides its implementations under different names. */
+
+extern void * __libc_malloc(size_t size);
+extern void * __libc_calloc(size_t nmemb, size_t size);
+extern void * __libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *
+malloc(size_t size)
+{
+	if(count_allocs)
+	{
+		++nallocs;
+	}
+	return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	if(count_allocs)
+	{
+		++nallocs;
+	}
+	return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+	if(count_allocs)
+	{
+		++nallocs;
+	}
+	return __libc_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+	__libc_free(ptr);
+}
+
+#endif
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,67 @@
+#include <stdio.h> /* printf() snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS */
+
+#include "../../src/utils/trie.h"
+#include "bench.h"
+
+static void make_path(int i, char buf[], size_t buf_len);
+
+int
+bench_trie(int argc, char *argv[])
+{
+	const int npaths = bench_int_arg(argc, argv, 0, 1000000);
+	char path[128];
+	int i;
+
+	printf("Trie of %d paths:\n", npaths);
+
+	const long long heap_before = bench_heap_usage();
+	bench_count_allocs(1);
+	double start = bench_now();
+
+	trie_t *const trie = trie_create();
+	for(i = 0; i < npaths; ++i)
+	{
+		make_path(i, path, sizeof(path));
+		if(trie_put(trie, path) < 0)
+		{
+			puts("Failed to insert a path");
+			return EXIT_FAILURE;
+		}
+	}
+
+	const double build = bench_now() - start;
+	bench_count_allocs(0);
+	const long long heap = bench_heap_usage() - heap_before;
+
+	start = bench_now();
+	int nfound = 0;
+	for(i = 0; i < npaths; ++i)
+	{
+		void *data;
+		make_path(i, path, sizeof(path));
+		nfound += (trie_get(trie, path, &data) == 0);
+	}
+	const double lookup = bench_now() - start;
+
+	start = bench_now();
+	trie_free(trie);
+	const double free_time = bench_now() - start;
+
+	printf("build:  %.3f s, %ld allocations, %lld bytes on heap\n", build,
+			bench_allocs(), heap);
+	printf("lookup: %.3f s, %d found\n", lookup, nfound);
+	printf("free:   %.3f s\n", free_time);
+	return EXIT_SUCCESS;
+}
+
+/* Makes path that looks like one from a custom view of a deep tree. */
+static void
+make_path(int i, char buf[], size_t buf_len)
+{
+	snprintf(buf, buf_len, "/home/user/src/project/module%02d/sub%03d/file-%d.c",
+			i%37, i%501, i);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
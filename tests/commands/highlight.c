@@ -266,6 +266,25 @@ TEST(records_can_be_removed)
 	assert_int_equal(0, cfg.cs.file_hi_count);
 }
 
+TEST(removed_records_are_not_matched)
+{
+	assert_success(exec_commands("highlight {*.jpg} ctermfg=red", &lwin,
+				CIT_COMMAND));
+	assert_success(exec_commands("highlight {*.png} ctermfg=blue", &lwin,
+				CIT_COMMAND));
+	assert_success(exec_commands("highlight clear {*.jpg}", &lwin, CIT_COMMAND));
+
+	int hint = -1;
+	assert_null(cs_get_file_hi(&cfg.cs, "a.jpg", &hint));
+	assert_int_equal(INT_MAX, hint);
+
+	hint = -1;
+	const col_attr_t *const hi = cs_get_file_hi(&cfg.cs, "a.png", &hint);
+	assert_non_null(hi);
+	assert_int_equal(0, hint);
+	assert_int_equal(COLOR_BLUE, hi->fg);
+}
+
 TEST(incorrect_highlight_groups_are_not_added)
 {
 	const char *const COMMANDS = "highlight {*.jpg} ctersmfg=red";
@@ -1,7 +1,7 @@
 #include <stic.h>
 
 #include <sys/stat.h> /* stat */
-#include <unistd.h> /* rmdir() symlink() unlink() */
+#include <unistd.h> /* link() rmdir() symlink() unlink() */
 
 #include <string.h> /* strcpy() strdup() */
 #include <time.h> /* time_t */
@@ -11,6 +11,7 @@
 #include "../../src/cfg/config.h"
 #include "../../src/compat/fs_limits.h"
 #include "../../src/compat/os.h"
+#include "../../src/utils/cancellation.h"
 #include "../../src/utils/dynarray.h"
 #include "../../src/utils/fs.h"
 #include "../../src/filelist.h"
@@ -19,6 +20,7 @@
 
 static void setup_single_entry(view_t *view, const char name[]);
 static uint64_t wait_for_size(const char path[]);
+static uint64_t cached_size(const char path[]);
 
 SETUP()
 {
@@ -111,6 +113,86 @@ TEST(symlinks_to_dirs, IF(not_windows))
 	assert_success(rmdir(SANDBOX_PATH "/dir"));
 }
 
+TEST(sizes_of_subdirectories_are_cached)
+{
+	create_dir(SANDBOX_PATH "/dir");
+	create_dir(SANDBOX_PATH "/dir/sub1");
+	create_dir(SANDBOX_PATH "/dir/sub1/nested");
+	create_dir(SANDBOX_PATH "/dir/sub2");
+	make_file(SANDBOX_PATH "/dir/sub1/nested/file", "text");
+	make_file(SANDBOX_PATH "/dir/sub2/file", "ab");
+	make_file(SANDBOX_PATH "/dir/file", "a");
+
+	assert_ulong_equal(7, fops_dir_size(SANDBOX_PATH "/dir", 0,
+				&no_cancellation));
+	assert_ulong_equal(4, cached_size(SANDBOX_PATH "/dir/sub1/nested"));
+	assert_ulong_equal(4, cached_size(SANDBOX_PATH "/dir/sub1"));
+	assert_ulong_equal(2, cached_size(SANDBOX_PATH "/dir/sub2"));
+	assert_ulong_equal(7, cached_size(SANDBOX_PATH "/dir"));
+
+	remove_file(SANDBOX_PATH "/dir/file");
+	remove_file(SANDBOX_PATH "/dir/sub2/file");
+	remove_file(SANDBOX_PATH "/dir/sub1/nested/file");
+	remove_dir(SANDBOX_PATH "/dir/sub2");
+	remove_dir(SANDBOX_PATH "/dir/sub1/nested");
+	remove_dir(SANDBOX_PATH "/dir/sub1");
+	remove_dir(SANDBOX_PATH "/dir");
+}
+
+TEST(hard_links_are_counted_once, IF(not_windows))
+{
+	create_dir(SANDBOX_PATH "/dir");
+	create_dir(SANDBOX_PATH "/dir/sub");
+	make_file(SANDBOX_PATH "/dir/file", "text");
+#ifndef _WIN32
+	assert_success(link(SANDBOX_PATH "/dir/file", SANDBOX_PATH "/dir/link"));
+	assert_success(link(SANDBOX_PATH "/dir/file", SANDBOX_PATH "/dir/sub/link"));
+#endif
+
+	assert_ulong_equal(4, fops_dir_size(SANDBOX_PATH "/dir", 1,
+				&no_cancellation));
+
+	remove_file(SANDBOX_PATH "/dir/sub/link");
+	remove_file(SANDBOX_PATH "/dir/link");
+	remove_file(SANDBOX_PATH "/dir/file");
+	remove_dir(SANDBOX_PATH "/dir/sub");
+	remove_dir(SANDBOX_PATH "/dir");
+}
+
+TEST(sizes_missing_hard_links_are_not_cached, IF(not_windows))
+{
+	create_dir(SANDBOX_PATH "/dir");
+	create_dir(SANDBOX_PATH "/dir/a");
+	create_dir(SANDBOX_PATH "/dir/b");
+	create_dir(SANDBOX_PATH "/dir/b/c");
+	make_file(SANDBOX_PATH "/dir/a/file", "text");
+#ifndef _WIN32
+	assert_success(link(SANDBOX_PATH "/dir/a/file",
+				SANDBOX_PATH "/dir/b/c/link"));
+#endif
+
+	assert_ulong_equal(4, fops_dir_size(SANDBOX_PATH "/dir", 1,
+				&no_cancellation));
+	assert_ulong_equal(4, cached_size(SANDBOX_PATH "/dir"));
+
+	/* Which of the links is counted depends on the order of processing, but
+	 * directories that didn't count it must not be cached. */
+	const uint64_t a = cached_size(SANDBOX_PATH "/dir/a");
+	const uint64_t b = cached_size(SANDBOX_PATH "/dir/b");
+	const uint64_t c = cached_size(SANDBOX_PATH "/dir/b/c");
+	assert_true(a == 4 || a == DCACHE_UNKNOWN);
+	assert_true(b == 4 || b == DCACHE_UNKNOWN);
+	assert_true(c == 4 || c == DCACHE_UNKNOWN);
+	assert_true(a == 4 || (b == 4 && c == 4));
+
+	remove_file(SANDBOX_PATH "/dir/b/c/link");
+	remove_file(SANDBOX_PATH "/dir/a/file");
+	remove_dir(SANDBOX_PATH "/dir/b/c");
+	remove_dir(SANDBOX_PATH "/dir/b");
+	remove_dir(SANDBOX_PATH "/dir/a");
+	remove_dir(SANDBOX_PATH "/dir");
+}
+
 static void
 setup_single_entry(view_t *view, const char name[])
 {
@@ -127,7 +209,12 @@ static uint64_t
 wait_for_size(const char path[])
 {
 	wait_for_bg();
+	return cached_size(path);
+}
 
+static uint64_t
+cached_size(const char path[])
+{
 	time_t mtime = 10;
 	uint64_t inode = DCACHE_UNKNOWN;
 #ifndef _WIN32
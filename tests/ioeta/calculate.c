@@ -1,13 +1,22 @@
 #include <stic.h>
 
 #include <stddef.h> /* NULL */
+#include <stdint.h> /* uint64_t */
+#include <string.h> /* strcmp() */
 
 #include "../../src/io/private/ioeta.h"
 #include "../../src/io/ioeta.h"
 #include "../../src/io/iop.h"
 
+static int dir_size_hook(const char path[], uint64_t *size);
+
 static const io_cancellation_t no_cancellation;
 
+TEARDOWN()
+{
+	ioeta_register_dir_size_hook(NULL);
+}
+
 TEST(non_existent_path_yields_zero_size)
 {
 	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
@@ -64,6 +73,71 @@ TEST(shallow_estimation_does_not_recur)
 	ioeta_free(estim);
 }
 
+TEST(calculation_on_a_thread_yields_same_result)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_calculate_bg(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_calculate_bg(estim, TEST_DATA_PATH "/existing-files", 1);
+	ioeta_wait(estim);
+
+	assert_int_equal(8, estim->total_items);
+	assert_int_equal(0, estim->current_item);
+	assert_int_equal(73728, estim->total_bytes);
+	assert_int_equal(0, estim->current_byte);
+
+	ioeta_free(estim);
+}
+
+TEST(freeing_stops_calculation_on_a_thread)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_calculate_bg(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_calculate_bg(estim, TEST_DATA_PATH "/existing-files", 0);
+
+	ioeta_free(estim);
+}
+
+TEST(progress_ahead_of_calculation_is_not_counted_twice)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_calc_begin(estim);
+
+	ioeta_update(estim, "file", "file", 1, 10);
+	assert_int_equal(1, estim->total_items);
+	assert_int_equal(10, estim->total_bytes);
+
+	ioeta_add_found(estim, 1, 10);
+	assert_int_equal(1, estim->total_items);
+	assert_int_equal(10, estim->total_bytes);
+
+	ioeta_add_found(estim, 2, 5);
+	assert_int_equal(3, estim->total_items);
+	assert_int_equal(15, estim->total_bytes);
+
+	ioeta_calc_end(estim);
+
+	ioeta_free(estim);
+}
+
+TEST(known_sizes_of_directories_are_used)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_register_dir_size_hook(&dir_size_hook);
+
+	ioeta_calculate(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_calculate_bg(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_wait(estim);
+
+	assert_int_equal(14, estim->total_items);
+	assert_int_equal(200, estim->total_bytes);
+
+	ioeta_free(estim);
+}
+
 #ifndef _WIN32
 
 TEST(symlink_calculated_as_zero_bytes)
@@ -97,5 +171,18 @@ TEST(symlink_calculated_as_zero_bytes)
 
 #endif
 
+/* Reports fixed size for the directory with files of various sizes. */
+static int
+dir_size_hook(const char path[], uint64_t *size)
+{
+	if(strcmp(path, TEST_DATA_PATH "/various-sizes") != 0)
+	{
+		return 0;
+	}
+
+	*size = 100;
+	return 1;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
@@ -2,9 +2,15 @@
 
 #include <stddef.h> /* NULL */
 
+#include "../../src/compat/pthread.h"
 #include "../../src/io/private/ioeta.h"
 #include "../../src/io/ioeta.h"
 
+/* Number of updates done by a thread in concurrent test. */
+#define NUPDATES 10000
+
+static void * update_thread(void *arg);
+
 static ioeta_estim_t *estim;
 
 SETUP()
@@ -101,5 +107,36 @@ TEST(finished_update_increments_current_item)
 	assert_int_equal(prev + 1, estim->current_item);
 }
 
+TEST(concurrent_updates_are_not_lost)
+{
+	pthread_t threads[4];
+
+	int i;
+	for(i = 0; i < 4; ++i)
+	{
+		assert_success(pthread_create(&threads[i], NULL, &update_thread, NULL));
+	}
+	for(i = 0; i < 4; ++i)
+	{
+		assert_success(pthread_join(threads[i], NULL));
+	}
+
+	assert_int_equal(4*NUPDATES, estim->current_item);
+	assert_int_equal(4*NUPDATES, estim->total_items);
+	assert_ulong_equal(4*2*NUPDATES, estim->current_byte);
+}
+
+/* Entry point of a thread that reports progress.  Returns NULL. */
+static void *
+update_thread(void *arg)
+{
+	int i;
+	for(i = 0; i < NUPDATES; ++i)
+	{
+		ioeta_update(estim, "file", "target", 1, 2);
+	}
+	return NULL;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
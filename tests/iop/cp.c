@@ -9,16 +9,21 @@
 #include <unistd.h> /* _Exit() lstat() */
 
 #include <signal.h> /* SIGXFSZ SIG_IGN signal() */
+#include <stdio.h> /* FILE fclose() fopen() fputc() */
 #include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS */
 
 #include "../../src/compat/fs_limits.h"
 #include "../../src/compat/os.h"
+#include "../../src/io/ioeta.h"
 #include "../../src/io/iop.h"
 #include "../../src/utils/fs.h"
 
 #include "utils.h"
 
 static void file_is_copied(const char original[]);
+static void make_large_file(const char path[], int size);
+
+static const io_cancellation_t no_cancellation;
 
 TEST(dir_is_not_copied)
 {
@@ -174,6 +179,80 @@ file_is_copied(const char original[])
 	delete_test_file(SANDBOX_PATH "/copy");
 }
 
+TEST(large_file_is_copied_and_accounted)
+{
+	/* Larger than buffers and chunks used for copying. */
+	const int size = 17*1024*1024 + 3;
+	make_large_file(SANDBOX_PATH "/large", size);
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/large",
+			.arg2.dst = SANDBOX_PATH "/large-copy",
+
+			.estim = ioeta_alloc(NULL, no_cancellation),
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		ioeta_calculate(args.estim, SANDBOX_PATH "/large", 0);
+		assert_success(iop_cp(&args));
+
+		assert_int_equal(0, args.result.errors.error_count);
+		assert_int_equal(size, args.estim->current_byte);
+		assert_int_equal(size, args.estim->total_bytes);
+
+		ioeta_free(args.estim);
+	}
+
+	assert_true(files_are_identical(SANDBOX_PATH "/large",
+				SANDBOX_PATH "/large-copy"));
+
+	delete_test_file(SANDBOX_PATH "/large");
+	delete_test_file(SANDBOX_PATH "/large-copy");
+}
+
+TEST(large_file_is_appended)
+{
+	const int size = 2*1024*1024 + 5;
+	make_large_file(SANDBOX_PATH "/large", size);
+	/* Beginning of the same file. */
+	make_large_file(SANDBOX_PATH "/appending", 10000);
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/large",
+			.arg2.dst = SANDBOX_PATH "/appending",
+			.arg3.crs = IO_CRS_APPEND_TO_FILES,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_success(iop_cp(&args));
+
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_int_equal(size, get_file_size(SANDBOX_PATH "/appending"));
+	assert_true(files_are_identical(SANDBOX_PATH "/large",
+				SANDBOX_PATH "/appending"));
+
+	delete_test_file(SANDBOX_PATH "/large");
+	delete_test_file(SANDBOX_PATH "/appending");
+}
+
+static void
+make_large_file(const char path[], int size)
+{
+	FILE *const fp = fopen(path, "wb");
+	assert_non_null(fp);
+
+	int i;
+	for(i = 0; i < size; ++i)
+	{
+		fputc((i*7 + i/4096) & 0xff, fp);
+	}
+	fclose(fp);
+}
+
 TEST(appending_works_for_files)
 {
 	uint64_t size;
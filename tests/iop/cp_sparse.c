@@ -0,0 +1,158 @@
+#include <stic.h>
+
+#ifndef _WIN32
+
+#include <sys/stat.h> /* stat */
+#include <fcntl.h> /* O_CREAT O_WRONLY open() */
+#include <unistd.h> /* close() ftruncate() pwrite() */
+
+#include <stdint.h> /* uint64_t */
+#include <stdio.h> /* EOF FILE fclose() fopen() fread() fseek() remove() */
+
+#include "../../src/compat/os.h"
+#include "../../src/io/ioeta.h"
+#include "../../src/io/iop.h"
+#include "../../src/utils/fs.h"
+
+#include "utils.h"
+
+/* Apparent size of sparse file. */
+#define SIZE (16*1024*1024)
+
+static int make_sparse_file(const char path[]);
+static void copy(int dense_copy);
+static uint64_t allocated_size(const char path[]);
+static int byte_at(const char path[], long offset);
+static int sparse_files_supported(void);
+
+static const io_cancellation_t no_cancellation;
+
+SETUP()
+{
+	assert_success(make_sparse_file(SANDBOX_PATH "/sparse"));
+}
+
+TEARDOWN()
+{
+	delete_test_file(SANDBOX_PATH "/sparse");
+}
+
+TEST(holes_are_preserved, IF(sparse_files_supported))
+{
+	copy(0);
+
+	assert_int_equal(SIZE, get_file_size(SANDBOX_PATH "/copy"));
+	assert_true(allocated_size(SANDBOX_PATH "/copy") < SIZE/2);
+
+	assert_int_equal('a', byte_at(SANDBOX_PATH "/copy", 0));
+	assert_int_equal('\0', byte_at(SANDBOX_PATH "/copy", SIZE/4));
+	assert_int_equal('b', byte_at(SANDBOX_PATH "/copy", SIZE/2));
+	assert_int_equal('\0', byte_at(SANDBOX_PATH "/copy", SIZE - 1));
+
+	delete_test_file(SANDBOX_PATH "/copy");
+}
+
+TEST(holes_are_filled_in_dense_copy, IF(sparse_files_supported))
+{
+	copy(1);
+
+	assert_int_equal(SIZE, get_file_size(SANDBOX_PATH "/copy"));
+	assert_true(allocated_size(SANDBOX_PATH "/copy") >= SIZE);
+
+	assert_int_equal('a', byte_at(SANDBOX_PATH "/copy", 0));
+	assert_int_equal('\0', byte_at(SANDBOX_PATH "/copy", SIZE/4));
+	assert_int_equal('b', byte_at(SANDBOX_PATH "/copy", SIZE/2));
+	assert_int_equal('\0', byte_at(SANDBOX_PATH "/copy", SIZE - 1));
+
+	delete_test_file(SANDBOX_PATH "/copy");
+}
+
+TEST(only_data_is_counted_by_estimation, IF(sparse_files_supported))
+{
+	assert_true(get_file_data_size(SANDBOX_PATH "/sparse") < SIZE/2);
+	assert_true(get_file_data_size(SANDBOX_PATH "/sparse") >= 2);
+}
+
+/* Creates a file with data at its beginning and in the middle.  Returns zero on
+ * success. */
+static int
+make_sparse_file(const char path[])
+{
+	const int fd = open(path, O_WRONLY | O_CREAT, 0600);
+	if(fd == -1)
+	{
+		return 1;
+	}
+
+	int error = (pwrite(fd, "a", 1, 0) != 1);
+	error |= (pwrite(fd, "b", 1, SIZE/2) != 1);
+	error |= (ftruncate(fd, SIZE) != 0);
+	error |= (close(fd) != 0);
+	return error;
+}
+
+/* Copies sparse file and checks that estimation accounts only for data. */
+static void
+copy(int dense_copy)
+{
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/sparse",
+		.arg2.dst = SANDBOX_PATH "/copy",
+		.arg4.dense_copy = dense_copy,
+
+		.estim = ioeta_alloc(NULL, no_cancellation),
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	ioeta_calculate(args.estim, SANDBOX_PATH "/sparse", 0);
+	assert_success(iop_cp(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	assert_true(args.estim->total_bytes < SIZE/2);
+	assert_ulong_equal(args.estim->total_bytes, args.estim->current_byte);
+
+	ioeta_free(args.estim);
+}
+
+/* Retrieves amount of space allocated for the file.  Returns the size. */
+static uint64_t
+allocated_size(const char path[])
+{
+	struct stat st;
+	assert_success(os_stat(path, &st));
+	return (uint64_t)st.st_blocks*512U;
+}
+
+/* Reads a byte of the file.  Returns the byte or EOF on error. */
+static int
+byte_at(const char path[], long offset)
+{
+	FILE *const fp = fopen(path, "rb");
+	if(fp == NULL)
+	{
+		return EOF;
+	}
+
+	unsigned char c;
+	const int ok = (fseek(fp, offset, SEEK_SET) == 0 && fread(&c, 1, 1, fp) == 1);
+	fclose(fp);
+	return ok ? c : EOF;
+}
+
+/* Checks whether file system of the sandbox leaves holes in files.  Returns
+ * non-zero if so. */
+static int
+sparse_files_supported(void)
+{
+	struct stat st;
+	const int supported = make_sparse_file(SANDBOX_PATH "/probe") == 0
+	                   && os_stat(SANDBOX_PATH "/probe", &st) == 0
+	                   && (uint64_t)st.st_blocks*512U < SIZE/2;
+	(void)remove(SANDBOX_PATH "/probe");
+	return supported;
+}
+
+#endif
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,293 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* chmod() */
+
+#include <stdio.h> /* FILE fclose() fgets() fopen() fputs() snprintf() */
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/compat/os.h"
+#include "../../src/compat/pthread.h"
+#include "../../src/io/ioeta.h"
+#include "../../src/io/ior.h"
+#include "../../src/utils/fs.h"
+
+#include "utils.h"
+
+/* Number of files in each directory of the tree. */
+#define NFILES 20
+
+static void make_tree(const char root[]);
+static void check_tree(const char root[]);
+static void make_file(const char path[], const char contents[]);
+static void file_is(const char path[], const char contents[]);
+static int confirm_overwrite(io_args_t *args, const char src[],
+		const char dst[]);
+static IoErrCbResult handle_errors(struct io_args_t *args,
+		const ioe_err_t *err);
+
+static pthread_t main_thread;
+static int confirm_calls;
+static int error_calls;
+static int foreign_calls;
+static IoErrCbResult error_response;
+
+SETUP()
+{
+	main_thread = pthread_self();
+	confirm_calls = 0;
+	error_calls = 0;
+	foreign_calls = 0;
+
+	make_tree(SANDBOX_PATH "/src");
+}
+
+TEARDOWN()
+{
+	delete_tree(SANDBOX_PATH "/src");
+}
+
+TEST(tree_is_copied_by_several_workers)
+{
+	static const io_cancellation_t no_cancellation;
+
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/src",
+		.arg2.dst = SANDBOX_PATH "/dst",
+		.par.nworkers = 3,
+		.par.queue_depth = 1,
+
+		.estim = ioeta_alloc(NULL, no_cancellation),
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	ioeta_calculate(args.estim, SANDBOX_PATH "/src", 0);
+	assert_success(ior_cp(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	check_tree(SANDBOX_PATH "/dst");
+	assert_int_equal(args.estim->total_items, args.estim->current_item);
+	assert_ulong_equal(args.estim->total_bytes, args.estim->current_byte);
+
+	ioeta_free(args.estim);
+	delete_tree(SANDBOX_PATH "/dst");
+}
+
+TEST(tree_is_moved_by_several_workers)
+{
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/src",
+		.arg2.dst = SANDBOX_PATH "/dst",
+		.arg3.crs = IO_CRS_REPLACE_FILES,
+		.par.nworkers = 3,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	/* Make destination exist to cause merging. */
+	create_empty_dir(SANDBOX_PATH "/dst");
+	create_empty_dir(SANDBOX_PATH "/dst/sub");
+
+	assert_success(ior_mv(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	check_tree(SANDBOX_PATH "/dst");
+	assert_false(path_exists(SANDBOX_PATH "/src", NODEREF));
+
+	delete_tree(SANDBOX_PATH "/dst");
+	make_tree(SANDBOX_PATH "/src");
+}
+
+TEST(overwrites_are_confirmed_by_calling_thread)
+{
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/src",
+		.arg2.dst = SANDBOX_PATH "/dst",
+		.arg3.crs = IO_CRS_REPLACE_FILES,
+		.par.nworkers = 4,
+
+		.confirm = &confirm_overwrite,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	create_empty_dir(SANDBOX_PATH "/dst");
+	make_file(SANDBOX_PATH "/dst/0", "old");
+	make_file(SANDBOX_PATH "/dst/1", "old");
+
+	assert_success(ior_cp(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+	assert_int_equal(2, confirm_calls);
+	assert_int_equal(0, foreign_calls);
+
+	check_tree(SANDBOX_PATH "/dst");
+
+	delete_tree(SANDBOX_PATH "/dst");
+}
+
+TEST(errors_are_handled_by_calling_thread)
+{
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/src",
+		.arg2.dst = SANDBOX_PATH "/dst",
+		.arg3.crs = IO_CRS_REPLACE_FILES,
+		.par.nworkers = 4,
+
+		.result.errors_cb = &handle_errors,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	/* Directories in place of files can't be overwritten by files. */
+	create_empty_dir(SANDBOX_PATH "/dst");
+	create_non_empty_dir(SANDBOX_PATH "/dst/0", "file");
+	create_non_empty_dir(SANDBOX_PATH "/dst/1", "file");
+
+	error_response = IO_ECR_IGNORE;
+	assert_success(ior_cp(&args));
+	assert_int_equal(2, args.result.errors.error_count);
+	assert_int_equal(2, error_calls);
+	assert_int_equal(0, foreign_calls);
+	ioe_errlst_free(&args.result.errors);
+
+	assert_true(is_dir(SANDBOX_PATH "/dst/0"));
+	assert_true(is_regular_file(SANDBOX_PATH "/dst/2"));
+
+	delete_tree(SANDBOX_PATH "/dst");
+}
+
+TEST(aborting_on_error_fails_operation)
+{
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/src",
+		.arg2.dst = SANDBOX_PATH "/dst",
+		.arg3.crs = IO_CRS_REPLACE_FILES,
+		.par.nworkers = 2,
+
+		.result.errors_cb = &handle_errors,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	create_empty_dir(SANDBOX_PATH "/dst");
+	create_non_empty_dir(SANDBOX_PATH "/dst/0", "file");
+
+	error_response = IO_ECR_BREAK;
+	assert_failure(ior_cp(&args));
+	assert_int_equal(1, args.result.errors.error_count);
+	assert_int_equal(1, error_calls);
+	assert_int_equal(0, foreign_calls);
+	ioe_errlst_free(&args.result.errors);
+
+	delete_tree(SANDBOX_PATH "/dst");
+}
+
+TEST(permissions_of_directories_are_set_after_copying_files, IF(not_windows))
+{
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/src",
+		.arg2.dst = SANDBOX_PATH "/dst",
+		.par.nworkers = 3,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	assert_success(chmod(SANDBOX_PATH "/src/sub", 0500));
+
+	assert_success(ior_cp(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	struct stat st;
+	assert_success(os_stat(SANDBOX_PATH "/dst/sub", &st));
+	assert_int_equal(0500, st.st_mode & 0777);
+
+	assert_success(chmod(SANDBOX_PATH "/src/sub", 0700));
+	assert_success(chmod(SANDBOX_PATH "/dst/sub", 0700));
+	check_tree(SANDBOX_PATH "/dst");
+
+	delete_tree(SANDBOX_PATH "/dst");
+}
+
+/* Creates directory with a subdirectory each of which has NFILES files. */
+static void
+make_tree(const char root[])
+{
+	char path[PATH_MAX + 1];
+
+	create_empty_dir(root);
+	snprintf(path, sizeof(path), "%s/sub", root);
+	create_empty_dir(path);
+
+	int i;
+	for(i = 0; i < NFILES; ++i)
+	{
+		char contents[16];
+		snprintf(contents, sizeof(contents), "%d", i);
+
+		snprintf(path, sizeof(path), "%s/%d", root, i);
+		make_file(path, contents);
+		snprintf(path, sizeof(path), "%s/sub/%d", root, i);
+		make_file(path, contents);
+	}
+}
+
+/* Checks that tree created by make_tree() was reproduced at the root. */
+static void
+check_tree(const char root[])
+{
+	char path[PATH_MAX + 1];
+
+	int i;
+	for(i = 0; i < NFILES; ++i)
+	{
+		char contents[16];
+		snprintf(contents, sizeof(contents), "%d", i);
+
+		snprintf(path, sizeof(path), "%s/%d", root, i);
+		file_is(path, contents);
+		snprintf(path, sizeof(path), "%s/sub/%d", root, i);
+		file_is(path, contents);
+	}
+}
+
+/* Creates a file with specified contents. */
+static void
+make_file(const char path[], const char contents[])
+{
+	FILE *const fp = fopen(path, "w");
+	assert_non_null(fp);
+	fputs(contents, fp);
+	fclose(fp);
+}
+
+/* Checks contents of a file. */
+static void
+file_is(const char path[], const char contents[])
+{
+	char buf[16] = "";
+
+	FILE *const fp = fopen(path, "r");
+	assert_non_null(fp);
+	if(fp != NULL)
+	{
+		(void)fgets(buf, sizeof(buf), fp);
+		fclose(fp);
+	}
+
+	assert_string_equal(contents, buf);
+}
+
+/* Confirms everything and records the call. */
+static int
+confirm_overwrite(io_args_t *args, const char src[], const char dst[])
+{
+	++confirm_calls;
+	foreign_calls += !pthread_equal(pthread_self(), main_thread);
+	return 1;
+}
+
+/* Responds with error_response and records the call. */
+static IoErrCbResult
+handle_errors(struct io_args_t *args, const ioe_err_t *err)
+{
+	++error_calls;
+	foreign_calls += !pthread_equal(pthread_self(), main_thread);
+	return error_response;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
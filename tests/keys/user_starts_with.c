@@ -0,0 +1,37 @@
+#include <stic.h>
+
+#include "../../src/engine/keys.h"
+#include "../../src/modes/modes.h"
+
+TEST(empty_keys_are_not_mapped)
+{
+	assert_false(vle_keys_user_starts_with(L"", NORMAL_MODE));
+}
+
+TEST(builtin_keys_are_not_user_mappings)
+{
+	assert_false(vle_keys_user_starts_with(L"j", NORMAL_MODE));
+}
+
+TEST(mapping_and_its_beginning_are_recognized)
+{
+	assert_success(vle_keys_user_add(L",q", L"k", NORMAL_MODE, KEYS_FLAG_NONE));
+
+	assert_true(vle_keys_user_starts_with(L",", NORMAL_MODE));
+	assert_true(vle_keys_user_starts_with(L",q", NORMAL_MODE));
+	assert_false(vle_keys_user_starts_with(L",qq", NORMAL_MODE));
+	assert_false(vle_keys_user_starts_with(L"q", NORMAL_MODE));
+	assert_false(vle_keys_user_starts_with(L",", VISUAL_MODE));
+}
+
+TEST(removed_mapping_is_not_recognized)
+{
+	assert_success(vle_keys_user_add(L",q", L"k", NORMAL_MODE, KEYS_FLAG_NONE));
+	assert_success(vle_keys_user_remove(L",q", NORMAL_MODE));
+
+	assert_false(vle_keys_user_starts_with(L",", NORMAL_MODE));
+	assert_false(vle_keys_user_starts_with(L",q", NORMAL_MODE));
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0: */
+/* vim: set cinoptions+=t0 filetype=c : */
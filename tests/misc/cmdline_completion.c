@@ -787,6 +787,7 @@ TEST(plugin_is_completed)
 	vlua_finish(curr_stats.vlua);
 	curr_stats.plugs = NULL;
 	curr_stats.vlua = NULL;
+	cfg.config_dir[0] = '\0';
 
 	remove_file(SANDBOX_PATH "/plugins/plug1/init.lua");
 	remove_file(SANDBOX_PATH "/plugins/plug2/init.lua");
@@ -0,0 +1,140 @@
+#include <stic.h>
+
+#include <string.h> /* strcpy() */
+
+#include <test-utils.h>
+
+#include "../../src/engine/mode.h"
+#include "../../src/modes/modes.h"
+#include "../../src/ui/ui.h"
+#include "../../src/background.h"
+#include "../../src/compare.h"
+#include "../../src/filelist.h"
+
+SETUP()
+{
+	curr_view = &lwin;
+	other_view = &rwin;
+
+	view_setup(&lwin);
+	view_setup(&rwin);
+
+	opt_handlers_setup();
+
+	columns_setup_column(SK_BY_NAME);
+	columns_setup_column(SK_BY_SIZE);
+
+	vle_mode_set(NORMAL_MODE, VMT_PRIMARY);
+}
+
+TEARDOWN()
+{
+	columns_teardown();
+
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+
+	opt_handlers_teardown();
+}
+
+TEST(two_panes_are_compared_in_background)
+{
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	strcpy(rwin.curr_dir, TEST_DATA_PATH "/compare/b");
+	assert_success(compare_two_panes_bg(CT_NAME, LT_ALL, 0, 0));
+
+	wait_for_bg();
+	compare_check_bg();
+
+	assert_true(flist_custom_active(&lwin));
+	assert_true(flist_custom_active(&rwin));
+	assert_int_equal(CV_DIFF, lwin.custom.type);
+	assert_int_equal(CV_DIFF, rwin.custom.type);
+	assert_int_equal(4, lwin.list_rows);
+	assert_int_equal(4, rwin.list_rows);
+
+	assert_int_equal(1, lwin.dir_entry[0].id);
+	assert_int_equal(2, lwin.dir_entry[1].id);
+	assert_int_equal(3, lwin.dir_entry[2].id);
+	assert_int_equal(4, lwin.dir_entry[3].id);
+
+	assert_string_equal("same-content-different-name-1", lwin.dir_entry[0].name);
+	assert_string_equal("same-content-different-name-1", rwin.dir_entry[0].name);
+	assert_string_equal("same-name-different-content", lwin.dir_entry[1].name);
+	assert_string_equal("same-name-different-content", rwin.dir_entry[1].name);
+	assert_string_equal("same-name-same-content", lwin.dir_entry[2].name);
+	assert_string_equal("same-name-same-content", rwin.dir_entry[2].name);
+	assert_string_equal("", lwin.dir_entry[3].name);
+	assert_string_equal("same-content-different-name-2", rwin.dir_entry[3].name);
+}
+
+TEST(results_are_displayed_in_normal_mode_only)
+{
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	assert_success(compare_one_pane_bg(&lwin, CT_NAME, LT_ALL, 0));
+
+	vle_mode_set(CMDLINE_MODE, VMT_SECONDARY);
+	wait_for_bg();
+	compare_check_bg();
+	assert_false(flist_custom_active(&lwin));
+
+	vle_mode_set(NORMAL_MODE, VMT_PRIMARY);
+	compare_check_bg();
+	assert_int_equal(CV_COMPARE, lwin.custom.type);
+	assert_int_equal(3, lwin.list_rows);
+	assert_int_equal(1, lwin.dir_entry[0].id);
+	assert_int_equal(2, lwin.dir_entry[1].id);
+	assert_int_equal(3, lwin.dir_entry[2].id);
+}
+
+TEST(same_location_is_not_compared_in_background)
+{
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	strcpy(rwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	assert_failure(compare_two_panes_bg(CT_NAME, LT_ALL, 1, 0));
+
+	assert_false(bg_has_active_jobs(0));
+	compare_check_bg();
+	assert_false(flist_custom_active(&lwin));
+}
+
+TEST(results_are_dropped_if_location_changed)
+{
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	assert_success(compare_one_pane_bg(&lwin, CT_NAME, LT_ALL, 0));
+
+	wait_for_bg();
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/b");
+	compare_check_bg();
+
+	assert_false(flist_custom_active(&lwin));
+	assert_string_equal(TEST_DATA_PATH "/compare/b", lwin.curr_dir);
+}
+
+TEST(results_are_dropped_if_tab_changed)
+{
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	assert_success(compare_one_pane_bg(&lwin, CT_NAME, LT_ALL, 0));
+
+	wait_for_bg();
+	/* This is what switching to a tab at the same location looks like. */
+	++lwin.id;
+	compare_check_bg();
+
+	assert_false(flist_custom_active(&lwin));
+}
+
+TEST(results_are_dropped_if_view_is_freed)
+{
+	strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+	assert_success(compare_one_pane_bg(&lwin, CT_NAME, LT_ALL, 0));
+
+	compare_view_freed(&lwin);
+	wait_for_bg();
+	compare_check_bg();
+
+	assert_false(flist_custom_active(&lwin));
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
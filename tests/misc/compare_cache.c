@@ -0,0 +1,128 @@
+#include <stic.h>
+
+#include <unistd.h> /* F_OK */
+
+#include <stdio.h> /* remove() */
+#include <string.h> /* strcpy() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/compat/fs_limits.h"
+#include "../../src/compat/os.h"
+#include "../../src/ui/ui.h"
+#include "../../src/compare.h"
+#include "../../src/filelist.h"
+#include "../../src/running.h"
+
+SETUP()
+{
+	curr_view = &lwin;
+	other_view = &rwin;
+
+	view_setup(&lwin);
+	view_setup(&rwin);
+
+	opt_handlers_setup();
+
+	columns_setup_column(SK_BY_NAME);
+	columns_setup_column(SK_BY_SIZE);
+
+	create_dir(SANDBOX_PATH "/config");
+	strcpy(cfg.config_dir, SANDBOX_PATH "/config");
+}
+
+TEARDOWN()
+{
+	cfg.config_dir[0] = '\0';
+	(void)remove(SANDBOX_PATH "/config/compare-cache");
+	remove_dir(SANDBOX_PATH "/config");
+
+	columns_teardown();
+
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+
+	opt_handlers_teardown();
+}
+
+TEST(cache_does_not_change_results, IF(not_windows))
+{
+	char names[2][8][NAME_MAX + 1];
+	int ids[2][8];
+	int nrows = 0;
+
+	/* The first run is without the cache, the second one creates it and the third
+	 * one uses it. */
+	int run;
+	for(run = 0; run < 3; ++run)
+	{
+		strcpy(cfg.config_dir, (run == 0) ? "" : SANDBOX_PATH "/config");
+		strcpy(lwin.curr_dir, TEST_DATA_PATH "/compare/a");
+		strcpy(rwin.curr_dir, TEST_DATA_PATH "/compare/b");
+
+		compare_two_panes(CT_CONTENTS, LT_ALL, 1, 0);
+		assert_int_equal(CV_DIFF, lwin.custom.type);
+
+		if(run == 0)
+		{
+			nrows = lwin.list_rows;
+			assert_true(nrows <= 8);
+		}
+		assert_int_equal(nrows, lwin.list_rows);
+
+		int i;
+		for(i = 0; i < nrows; ++i)
+		{
+			view_t *const views[] = { &lwin, &rwin };
+			int side;
+			for(side = 0; side < 2; ++side)
+			{
+				const dir_entry_t *const entry = &views[side]->dir_entry[i];
+				if(run == 0)
+				{
+					strcpy(names[side][i], entry->name);
+					ids[side][i] = entry->id;
+				}
+				assert_string_equal(names[side][i], entry->name);
+				assert_int_equal(ids[side][i], entry->id);
+			}
+		}
+
+		view_teardown(&lwin);
+		view_teardown(&rwin);
+		view_setup(&lwin);
+		view_setup(&rwin);
+	}
+
+	assert_success(os_access(SANDBOX_PATH "/config/compare-cache", F_OK));
+}
+
+TEST(changed_files_are_hashed_anew, IF(not_windows))
+{
+	create_dir(SANDBOX_PATH "/files");
+	make_file(SANDBOX_PATH "/files/a", "abc");
+	make_file(SANDBOX_PATH "/files/b", "abc");
+
+	strcpy(lwin.curr_dir, SANDBOX_PATH "/files");
+	compare_one_pane(&lwin, CT_CONTENTS, LT_ALL, 0);
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(lwin.dir_entry[0].id, lwin.dir_entry[1].id);
+	rn_leave(&lwin, 1);
+
+	/* Same size, but different contents and modification time. */
+	make_file(SANDBOX_PATH "/files/b", "abd");
+	reset_timestamp(SANDBOX_PATH "/files/b");
+
+	compare_one_pane(&lwin, CT_CONTENTS, LT_ALL, 0);
+	assert_int_equal(2, lwin.list_rows);
+	assert_true(lwin.dir_entry[0].id != lwin.dir_entry[1].id);
+	rn_leave(&lwin, 1);
+
+	assert_success(remove(SANDBOX_PATH "/files/a"));
+	assert_success(remove(SANDBOX_PATH "/files/b"));
+	remove_dir(SANDBOX_PATH "/files");
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
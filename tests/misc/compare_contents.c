@@ -0,0 +1,144 @@
+#include <stic.h>
+
+#include <stdio.h> /* FILE fclose() fopen() fputc() remove() snprintf() */
+#include <string.h> /* strcpy() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/parallel.h"
+#include "../../src/compare.h"
+#include "../../src/filelist.h"
+#include "../../src/running.h"
+
+static void check_ids(void);
+static void write_file(const char path[], char first, char last, int size);
+
+SETUP()
+{
+	curr_view = &lwin;
+	other_view = &rwin;
+
+	view_setup(&lwin);
+	view_setup(&rwin);
+
+	opt_handlers_setup();
+
+	columns_setup_column(SK_BY_NAME);
+	columns_setup_column(SK_BY_SIZE);
+
+	par_set_nworkers(4);
+
+	create_dir(SANDBOX_PATH "/files");
+	write_file(SANDBOX_PATH "/files/a", 'x', 'x', 5000);
+	write_file(SANDBOX_PATH "/files/b", 'x', 'x', 5000);
+	write_file(SANDBOX_PATH "/files/c", 'x', 'y', 5000);
+	write_file(SANDBOX_PATH "/files/d", 'y', 'x', 5000);
+	write_file(SANDBOX_PATH "/files/e", 'x', 'x', 10);
+	write_file(SANDBOX_PATH "/files/f", 'x', 'y', 5000);
+	write_file(SANDBOX_PATH "/files/g", 'x', 'x', 5000);
+
+	strcpy(lwin.curr_dir, SANDBOX_PATH "/files");
+}
+
+TEARDOWN()
+{
+	const char *const names[] = { "a", "b", "c", "d", "e", "f", "g" };
+	int i;
+	for(i = 0; i < (int)(sizeof(names)/sizeof(names[0])); ++i)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "%s/files/%s", SANDBOX_PATH, names[i]);
+		assert_success(remove(path));
+	}
+	remove_dir(SANDBOX_PATH "/files");
+
+	par_set_nworkers(0);
+
+	columns_teardown();
+
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+
+	opt_handlers_teardown();
+}
+
+TEST(contents_are_compared_byte_by_byte_without_cache)
+{
+	compare_one_pane(&lwin, CT_CONTENTS, LT_ALL, 0);
+	check_ids();
+}
+
+TEST(contents_are_compared_by_digests_with_cache, IF(not_windows))
+{
+	create_dir(SANDBOX_PATH "/config");
+	strcpy(cfg.config_dir, SANDBOX_PATH "/config");
+
+	compare_one_pane(&lwin, CT_CONTENTS, LT_ALL, 0);
+	check_ids();
+
+	view_teardown(&lwin);
+	view_setup(&lwin);
+	strcpy(lwin.curr_dir, SANDBOX_PATH "/files");
+
+	compare_one_pane(&lwin, CT_CONTENTS, LT_ALL, 0);
+	check_ids();
+
+	cfg.config_dir[0] = '\0';
+	assert_success(remove(SANDBOX_PATH "/config/compare-cache"));
+	remove_dir(SANDBOX_PATH "/config");
+}
+
+TEST(unique_files_are_found_among_duplicates)
+{
+	compare_one_pane(&lwin, CT_CONTENTS, LT_UNIQUE, 0);
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_string_equal("d", lwin.dir_entry[0].name);
+	assert_string_equal("e", lwin.dir_entry[1].name);
+}
+
+/* Checks ids assigned to files in the order in which they were listed. */
+static void
+check_ids(void)
+{
+	assert_int_equal(CV_COMPARE, lwin.custom.type);
+	assert_int_equal(7, lwin.list_rows);
+
+	/* Files are grouped by their ids. */
+	assert_string_equal("a", lwin.dir_entry[0].name);
+	assert_string_equal("b", lwin.dir_entry[1].name);
+	assert_string_equal("g", lwin.dir_entry[2].name);
+	assert_string_equal("c", lwin.dir_entry[3].name);
+	assert_string_equal("f", lwin.dir_entry[4].name);
+	assert_string_equal("d", lwin.dir_entry[5].name);
+	assert_string_equal("e", lwin.dir_entry[6].name);
+
+	assert_int_equal(1, lwin.dir_entry[0].id);
+	assert_int_equal(1, lwin.dir_entry[1].id);
+	assert_int_equal(1, lwin.dir_entry[2].id);
+	assert_int_equal(2, lwin.dir_entry[3].id);
+	assert_int_equal(2, lwin.dir_entry[4].id);
+	assert_int_equal(3, lwin.dir_entry[5].id);
+	assert_int_equal(4, lwin.dir_entry[6].id);
+}
+
+/* Creates a file of the specified size filled with 'x' except for its first
+ * and last characters. */
+static void
+write_file(const char path[], char first, char last, int size)
+{
+	FILE *const fp = fopen(path, "wb");
+	assert_non_null(fp);
+
+	int i;
+	for(i = 0; i < size; ++i)
+	{
+		fputc(i == size - 1 ? last : (i == 0 ? first : 'x'), fp);
+	}
+	fclose(fp);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
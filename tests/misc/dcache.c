@@ -23,6 +23,7 @@ SETUP()
 TEARDOWN()
 {
 	update_string(&cfg.shell, NULL);
+	cfg.config_dir[0] = '\0';
 }
 
 TEST(size_does_not_clobber_nitems)
@@ -92,6 +93,62 @@ TEST(can_query_one_parameter_at_a_time)
 	assert_ulong_equal(11, data.value);
 }
 
+TEST(cache_is_persistent)
+{
+	uint64_t size, nitems;
+
+	strcpy(cfg.config_dir, SANDBOX_PATH);
+
+	dcache_set_at(TEST_DATA_PATH "/read", 0, 10, 11);
+	assert_success(dcache_save());
+
+	/* Drop what's in memory. */
+	assert_success(stats_reset(&cfg));
+
+	dcache_get_at(TEST_DATA_PATH "/read", time(NULL) - 10, 0, &size, &nitems);
+	assert_ulong_equal(10, size);
+	assert_ulong_equal(11, nitems);
+
+	remove_file(SANDBOX_PATH "/dir-cache");
+}
+
+TEST(cache_is_not_saved_without_changes)
+{
+	strcpy(cfg.config_dir, SANDBOX_PATH);
+
+	assert_success(stats_reset(&cfg));
+	assert_success(dcache_save());
+	no_remove_file(SANDBOX_PATH "/dir-cache");
+}
+
+TEST(persistent_parent_sizes_are_updated)
+{
+	uint64_t size;
+
+	strcpy(cfg.config_dir, SANDBOX_PATH);
+	create_dir(SANDBOX_PATH "/dir");
+	create_dir(SANDBOX_PATH "/dir/sub");
+
+	dcache_set_at(SANDBOX_PATH "/dir", 0, 10, DCACHE_UNKNOWN);
+	dcache_set_at(SANDBOX_PATH "/dir/sub", 0, 5, DCACHE_UNKNOWN);
+	assert_success(dcache_save());
+	assert_success(stats_reset(&cfg));
+
+	dcache_update_parent_sizes(SANDBOX_PATH "/dir/sub", 3);
+	dcache_get_at(SANDBOX_PATH "/dir", time(NULL) - 10, 0, &size, NULL);
+	assert_ulong_equal(13, size);
+
+	assert_success(dcache_save());
+	assert_success(stats_reset(&cfg));
+
+	dcache_get_at(SANDBOX_PATH "/dir", time(NULL) - 10, 0, &size, NULL);
+	assert_ulong_equal(13, size);
+
+	remove_dir(SANDBOX_PATH "/dir/sub");
+	remove_dir(SANDBOX_PATH "/dir");
+	remove_file(SANDBOX_PATH "/dir-cache");
+}
+
 #ifndef _WIN32
 
 TEST(symlink_inode_resolution, IF(not_windows))
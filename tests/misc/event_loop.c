@@ -73,6 +73,22 @@ TEST(pending_flags_are_reset)
 	rwin.pending_marking = 0;
 }
 
+TEST(ungot_key_is_processed_before_queued_ones)
+{
+	keys_add_info_t keys = { WK_x, { {&x_key} } };
+	vle_keys_add(&keys, 1U, NORMAL_MODE);
+
+	feed_keys(L"w");
+	unget_key(L'x');
+
+	quit = 0;
+	event_loop(&quit);
+
+	wchar_t c;
+	assert_true(get_pending_key(&c));
+	assert_true(c == L'w');
+}
+
 static void
 x_key(key_info_t key_info, keys_info_t *keys_info)
 {
@@ -1,5 +1,7 @@
 #include <stic.h>
 
+#include <stdint.h> /* uint32_t */
+#include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* free() */
 #include <string.h> /* strcpy() strdup() */
 
@@ -526,5 +528,98 @@ TEST(case_is_ignored_by_noninteractive_local_filter)
 	cfg.ignore_case = 0;
 }
 
+TEST(extending_interactive_filter_rescans_only_previous_matches)
+{
+	char path[PATH_MAX + 1];
+	int i;
+
+	flist_custom_start(&lwin, "test");
+	for(i = 0; i < 70; ++i)
+	{
+		snprintf(path, sizeof(path), "%s/file%02d", SANDBOX_PATH, i);
+		create_file(path);
+		flist_custom_add(&lwin, path);
+	}
+	assert_true(flist_custom_finish(&lwin, CV_REGULAR, 0) == 0);
+
+	assert_int_equal(0, local_filter_set(&lwin, "1"));
+	assert_int_equal(16, lwin.list_rows);
+	assert_string_equal("1", lwin.local_filter.matches_for);
+	const uint32_t *const matches = lwin.local_filter.matches;
+
+	assert_int_equal(0, local_filter_set(&lwin, "11"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_true(lwin.local_filter.matches == matches);
+	assert_string_equal("file11", lwin.dir_entry[0].name);
+
+	/* Going back requires full rescan. */
+	assert_int_equal(0, local_filter_set(&lwin, "1"));
+	assert_int_equal(16, lwin.list_rows);
+
+	/* Alternation extends set of matches. */
+	assert_int_equal(0, local_filter_set(&lwin, "1|2"));
+	assert_int_equal(30, lwin.list_rows);
+
+	/* So does quantifier. */
+	assert_int_equal(0, local_filter_set(&lwin, "11"));
+	assert_int_equal(0, local_filter_set(&lwin, "11*"));
+	assert_int_equal(16, lwin.list_rows);
+
+	assert_int_equal(0, local_filter_set(&lwin, "file6"));
+	assert_int_equal(10, lwin.list_rows);
+	assert_int_equal(0, local_filter_set(&lwin, "file6."));
+	assert_int_equal(10, lwin.list_rows);
+	assert_int_equal(1, local_filter_set(&lwin, "file6.0"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("..", lwin.dir_entry[0].name);
+
+	/* Temporary entry of parent directory doesn't break anything. */
+	assert_int_equal(1, local_filter_set(&lwin, "file6.00"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_int_equal(0, local_filter_set(&lwin, "file6"));
+	assert_int_equal(10, lwin.list_rows);
+
+	local_filter_cancel(&lwin);
+	assert_int_equal(70, lwin.list_rows);
+	assert_null(lwin.local_filter.matches);
+
+	for(i = 0; i < 70; ++i)
+	{
+		snprintf(path, sizeof(path), "%s/file%02d", SANDBOX_PATH, i);
+		remove_file(path);
+	}
+}
+
+TEST(turning_filter_case_insensitive_causes_rescan)
+{
+	char path[PATH_MAX + 1];
+
+	cfg.ignore_case = 1;
+	cfg.smart_case = 1;
+
+	flist_custom_start(&lwin, "test");
+	snprintf(path, sizeof(path), "%s/Ab", SANDBOX_PATH);
+	create_file(path);
+	flist_custom_add(&lwin, path);
+	snprintf(path, sizeof(path), "%s/ab", SANDBOX_PATH);
+	create_file(path);
+	flist_custom_add(&lwin, path);
+	assert_true(flist_custom_finish(&lwin, CV_REGULAR, 0) == 0);
+
+	assert_int_equal(0, local_filter_set(&lwin, "A"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_int_equal(0, local_filter_set(&lwin, "Ab"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_int_equal(0, local_filter_set(&lwin, "b"));
+	assert_int_equal(2, lwin.list_rows);
+	local_filter_cancel(&lwin);
+
+	remove_file(SANDBOX_PATH "/Ab");
+	remove_file(SANDBOX_PATH "/ab");
+
+	cfg.ignore_case = 0;
+	cfg.smart_case = 0;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
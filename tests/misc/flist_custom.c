@@ -315,6 +315,7 @@ TEST(unsorted_view_remains_one_on_vifminfo_reread_on_restart)
 	assert_int_equal(SK_NONE, lwin.sort[0]);
 
 	opt_handlers_teardown();
+	cfg.config_dir[0] = '\0';
 
 	assert_success(remove(SANDBOX_PATH "/vifminfo"));
 }
@@ -0,0 +1,153 @@
+#include <stic.h>
+
+#include <unistd.h> /* chdir() rmdir() symlink() unlink() */
+
+#include <stdio.h> /* snprintf() */
+#include <string.h> /* strcmp() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/compat/fs_limits.h"
+#include "../../src/compat/os.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/parallel.h"
+#include "../../src/utils/str.h"
+#include "../../src/filelist.h"
+
+/* Enough files to be split into several batches. */
+#define NFILES 1000
+
+static void check_list(void);
+
+static view_t *const view = &lwin;
+
+SETUP()
+{
+	char cwd[PATH_MAX + 1];
+
+	assert_success(chdir(SANDBOX_PATH));
+	assert_true(get_cwd(cwd, sizeof(cwd)) == cwd);
+
+	update_string(&cfg.slow_fs_list, "");
+	cfg.dot_dirs = DD_TREE_LEAFS_PARENT;
+
+	view_setup(view);
+	copy_str(view->curr_dir, sizeof(view->curr_dir), cwd);
+
+	int i;
+	for(i = 0; i < NFILES; ++i)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "%04d", i);
+		create_file(name);
+	}
+
+	create_dir("dir");
+	assert_success(make_symlink("dir", "link-dir"));
+	assert_success(make_symlink("no-such-target", "link-broken"));
+}
+
+TEARDOWN()
+{
+	view_teardown(view);
+
+	int i;
+	for(i = 0; i < NFILES; ++i)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "%04d", i);
+		remove_file(name);
+	}
+
+	remove_dir("dir");
+	remove_file("link-dir");
+	remove_file("link-broken");
+
+	update_string(&cfg.slow_fs_list, NULL);
+	cfg.dot_dirs = 0;
+	par_set_nworkers(0);
+}
+
+TEST(list_is_loaded_by_single_thread)
+{
+	par_set_nworkers(1);
+	populate_dir_list(view, 0);
+	check_list();
+}
+
+TEST(list_is_loaded_by_multiple_threads)
+{
+	par_set_nworkers(4);
+	populate_dir_list(view, 0);
+	check_list();
+}
+
+TEST(list_is_reloaded_by_multiple_threads)
+{
+	par_set_nworkers(4);
+	populate_dir_list(view, 0);
+	populate_dir_list(view, 1);
+	check_list();
+}
+
+TEST(states_of_links_are_cached_until_reload)
+{
+	populate_dir_list(view, 0);
+
+	dir_entry_t *link_dir = &view->dir_entry[1];
+	dir_entry_t *link_broken = &view->dir_entry[NFILES + 2];
+	assert_int_equal(LS_UNKNOWN, link_dir->link_state);
+	assert_int_equal(LS_UNKNOWN, link_broken->link_state);
+
+	assert_int_equal(LS_VALID, ui_get_link_state(link_dir));
+	assert_int_equal(LS_BROKEN, ui_get_link_state(link_broken));
+
+	/* Cached state doesn't change on its own. */
+	create_file("no-such-target");
+	assert_int_equal(LS_BROKEN, ui_get_link_state(link_broken));
+
+	ui_view_reset_link_cache(view);
+	assert_int_equal(LS_UNKNOWN, link_dir->link_state);
+	assert_int_equal(LS_VALID, ui_get_link_state(link_broken));
+
+	remove_file("no-such-target");
+	assert_int_equal(LS_VALID, ui_get_link_state(link_broken));
+
+	/* Reloading drops cached state. */
+	populate_dir_list(view, 1);
+	link_broken = &view->dir_entry[NFILES + 2];
+	assert_string_equal("link-broken", link_broken->name);
+	assert_int_equal(LS_UNKNOWN, link_broken->link_state);
+	assert_int_equal(LS_BROKEN, ui_get_link_state(link_broken));
+}
+
+static void
+check_list(void)
+{
+	assert_int_equal(NFILES + 3, view->list_rows);
+
+	assert_string_equal("dir", view->dir_entry[0].name);
+	assert_int_equal(FT_DIR, view->dir_entry[0].type);
+
+	assert_string_equal("link-dir", view->dir_entry[1].name);
+	assert_int_equal(FT_LINK, view->dir_entry[1].type);
+	assert_true(view->dir_entry[1].dir_link);
+
+	int i;
+	for(i = 0; i < NFILES; ++i)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "%04d", i);
+		assert_string_equal(name, view->dir_entry[2 + i].name);
+		assert_int_equal(FT_REG, view->dir_entry[2 + i].type);
+	}
+
+	assert_string_equal("link-broken", view->dir_entry[NFILES + 2].name);
+	assert_int_equal(FT_LINK, view->dir_entry[NFILES + 2].type);
+	assert_false(view->dir_entry[NFILES + 2].dir_link);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
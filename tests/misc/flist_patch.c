@@ -0,0 +1,183 @@
+#include <stic.h>
+
+#include <unistd.h> /* chdir() */
+
+#include <stdio.h> /* FILE fclose() fopen() fputs() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/compat/fs_limits.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/macros.h"
+#include "../../src/utils/str.h"
+#include "../../src/filelist.h"
+
+static void check_names(int count, const char *names[]);
+static int using_inotify(void);
+
+static view_t *const view = &lwin;
+
+SETUP()
+{
+	char cwd[PATH_MAX + 1];
+
+	assert_success(chdir(SANDBOX_PATH));
+	assert_true(get_cwd(cwd, sizeof(cwd)) == cwd);
+
+	update_string(&cfg.slow_fs_list, "");
+
+	view_setup(view);
+	copy_str(view->curr_dir, sizeof(view->curr_dir), cwd);
+	view->has_dups = 0;
+
+	create_file("a");
+	create_file("c");
+	create_file("e");
+	create_file("g");
+	create_dir("dir");
+
+	populate_dir_list(view, 0);
+	(void)ui_view_query_scheduled_event(view);
+}
+
+TEARDOWN()
+{
+	view_teardown(view);
+
+	(void)remove("a");
+	(void)remove("b");
+	(void)remove("c");
+	(void)remove("d");
+	(void)remove("e");
+	(void)remove("f");
+	(void)remove("g");
+	(void)remove(".hidden");
+	(void)remove("dir");
+
+	update_string(&cfg.slow_fs_list, NULL);
+}
+
+TEST(created_files_are_inserted_at_sorted_positions, IF(using_inotify))
+{
+	create_file("d");
+	create_file("b");
+
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+
+	const char *names[] = { "dir", "a", "b", "c", "d", "e", "g" };
+	check_names(ARRAY_LEN(names), names);
+}
+
+TEST(deleted_files_are_removed, IF(using_inotify))
+{
+	view->dir_entry[2].selected = 1;
+	view->selected_files = 1;
+
+	remove_file("c");
+
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+
+	const char *names[] = { "dir", "a", "e", "g" };
+	check_names(ARRAY_LEN(names), names);
+	assert_int_equal(0, view->selected_files);
+}
+
+TEST(changed_files_are_updated_and_keep_selection, IF(using_inotify))
+{
+	view->dir_entry[3].selected = 1;
+	view->selected_files = 1;
+
+	FILE *const fp = fopen("e", "w");
+	assert_non_null(fp);
+	fputs("content", fp);
+	fclose(fp);
+
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+
+	const char *names[] = { "dir", "a", "c", "e", "g" };
+	check_names(ARRAY_LEN(names), names);
+	assert_int_equal(7, view->dir_entry[3].size);
+	assert_true(view->dir_entry[3].selected);
+	assert_int_equal(1, view->selected_files);
+}
+
+TEST(renamed_file_is_moved, IF(using_inotify))
+{
+	assert_success(rename("a", "f"));
+
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+
+	const char *names[] = { "dir", "c", "e", "f", "g" };
+	check_names(ARRAY_LEN(names), names);
+}
+
+TEST(cursor_stays_on_the_same_file, IF(using_inotify))
+{
+	view->list_pos = 2;
+
+	create_file("b");
+
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+
+	assert_string_equal("c", view->dir_entry[view->list_pos].name);
+}
+
+TEST(filtered_files_are_counted, IF(using_inotify))
+{
+	view->hide_dot = 1;
+
+	create_file(".hidden");
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+	assert_int_equal(5, view->list_rows);
+	assert_int_equal(1, view->filtered);
+
+	remove_file(".hidden");
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_REDRAW, ui_view_query_scheduled_event(view));
+	assert_int_equal(5, view->list_rows);
+	assert_int_equal(0, view->filtered);
+}
+
+TEST(massive_changes_cause_reload, IF(using_inotify))
+{
+	create_file("b");
+	create_file("d");
+	create_file("f");
+
+	check_if_filelist_has_changed(view);
+	assert_int_equal(UUE_RELOAD, ui_view_query_scheduled_event(view));
+	assert_int_equal(5, view->list_rows);
+}
+
+static void
+check_names(int count, const char *names[])
+{
+	assert_int_equal(count, view->list_rows);
+
+	int i;
+	for(i = 0; i < count && i < view->list_rows; ++i)
+	{
+		assert_string_equal(names[i], view->dir_entry[i].name);
+	}
+}
+
+static int
+using_inotify(void)
+{
+#ifdef HAVE_INOTIFY
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -15,6 +15,7 @@
 #include "../../src/ui/fileview.h"
 #include "../../src/ui/ui.h"
 #include "../../src/utils/fs.h"
+#include "../../src/utils/parallel.h"
 #include "../../src/utils/str.h"
 #include "../../src/utils/utils.h"
 #include "../../src/event_loop.h"
@@ -32,6 +33,7 @@ static void verify_tree_node(column_data_t *cdt, int idx,
 static void column_line_print(const void *data, int column_id, const char buf[],
 		size_t offset, AlignType align, const char full_column[]);
 static int remove_selected(view_t *view, const dir_entry_t *entry, void *arg);
+static int using_inotify(void);
 
 static char cwd[PATH_MAX + 1], test_data[PATH_MAX + 1];
 
@@ -94,6 +96,36 @@ TEST(complex_tree_is_built_correctly)
 	validate_tree(&lwin);
 }
 
+TEST(tree_built_by_many_threads_is_the_same)
+{
+	int i;
+	char names[12][NAME_MAX + 1];
+	int child_counts[12], child_poses[12];
+
+	par_set_nworkers(1);
+	assert_success(load_tree(&lwin, TEST_DATA_PATH "/tree", cwd));
+	assert_int_equal(12, lwin.list_rows);
+	for(i = 0; i < 12; ++i)
+	{
+		copy_str(names[i], sizeof(names[i]), lwin.dir_entry[i].name);
+		child_counts[i] = lwin.dir_entry[i].child_count;
+		child_poses[i] = lwin.dir_entry[i].child_pos;
+	}
+
+	par_set_nworkers(4);
+	assert_success(load_tree(&lwin, TEST_DATA_PATH "/tree", cwd));
+	par_set_nworkers(0);
+
+	assert_int_equal(12, lwin.list_rows);
+	validate_tree(&lwin);
+	for(i = 0; i < 12; ++i)
+	{
+		assert_string_equal(names[i], lwin.dir_entry[i].name);
+		assert_int_equal(child_counts[i], lwin.dir_entry[i].child_count);
+		assert_int_equal(child_poses[i], lwin.dir_entry[i].child_pos);
+	}
+}
+
 TEST(symlinks_are_loaded_as_files, IF(not_windows))
 {
 	/* symlink() is not available on Windows, but other code is fine. */
@@ -481,6 +513,49 @@ TEST(tree_prefixes_are_correct)
 	verify_tree_node(&cdt, 9, "`-- file5");
 }
 
+TEST(nested_directory_changes_are_watched, IF(using_inotify))
+{
+	assert_success(os_mkdir(SANDBOX_PATH "/nested-dir", 0700));
+	create_file(SANDBOX_PATH "/nested-dir/a");
+
+	assert_success(load_tree(&lwin, SANDBOX_PATH, cwd));
+	assert_int_equal(2, lwin.list_rows);
+
+	/* Discard results of the first check. */
+	check_if_filelist_has_changed(&lwin);
+	(void)ui_view_query_scheduled_event(&lwin);
+
+	/* This check sets up the watcher. */
+	check_if_filelist_has_changed(&lwin);
+	assert_int_equal(UUE_NONE, ui_view_query_scheduled_event(&lwin));
+	assert_non_null(lwin.tree_watch);
+
+	/* Change that doesn't affect list of files. */
+	assert_success(os_chmod(SANDBOX_PATH "/nested-dir/a", 0600));
+	check_if_filelist_has_changed(&lwin);
+	assert_int_equal(UUE_NONE, ui_view_query_scheduled_event(&lwin));
+
+	create_file(SANDBOX_PATH "/nested-dir/b");
+	check_if_filelist_has_changed(&lwin);
+	assert_int_equal(UUE_RELOAD, ui_view_query_scheduled_event(&lwin));
+
+	/* Reloading sets up new watcher. */
+	load_dir_list(&lwin, 1);
+	assert_int_equal(3, lwin.list_rows);
+	assert_null(lwin.tree_watch);
+	(void)ui_view_query_scheduled_event(&lwin);
+	check_if_filelist_has_changed(&lwin);
+	assert_int_equal(UUE_NONE, ui_view_query_scheduled_event(&lwin));
+	assert_non_null(lwin.tree_watch);
+
+	assert_success(remove(SANDBOX_PATH "/nested-dir/b"));
+	check_if_filelist_has_changed(&lwin);
+	assert_int_equal(UUE_RELOAD, ui_view_query_scheduled_event(&lwin));
+
+	assert_success(remove(SANDBOX_PATH "/nested-dir/a"));
+	assert_success(rmdir(SANDBOX_PATH "/nested-dir"));
+}
+
 TEST(dotdirs_do_not_mess_up_change_detection)
 {
 	cfg.dot_dirs |= DD_NONROOT_PARENT;
@@ -654,5 +729,15 @@ remove_selected(view_t *view, const dir_entry_t *entry, void *arg)
 	return !entry->selected;
 }
 
+static int
+using_inotify(void)
+{
+#ifdef HAVE_INOTIFY
+	return 1;
+#else
+	return 0;
+#endif
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
@@ -43,6 +43,8 @@ SETUP()
 
 TEARDOWN()
 {
+	cfg.config_dir[0] = '\0';
+
 	remove_file(SANDBOX_PATH "/plugins/plug1/init.lua");
 	remove_file(SANDBOX_PATH "/plugins/plug2/init.lua");
 	remove_dir(SANDBOX_PATH "/plugins/plug1");
@@ -3,13 +3,17 @@
 #include <unistd.h> /* chdir() unlink() */
 
 #include <locale.h> /* LC_ALL setlocale() */
-#include <string.h> /* memset() strcpy() */
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* memset() strcpy() strdup() */
+#include <time.h> /* time_t */
 
 #include <test-utils.h>
 
 #include "../../src/cfg/config.h"
 #include "../../src/ui/ui.h"
 #include "../../src/utils/dynarray.h"
+#include "../../src/utils/parallel.h"
 #include "../../src/utils/str.h"
 #include "../../src/sort.h"
 #include "../../src/status.h"
@@ -463,6 +467,117 @@ TEST(groups_sorting_works)
 	update_string(&lwin.sort_groups, NULL);
 }
 
+TEST(entries_are_inserted_according_to_all_keys)
+{
+	lwin.sort[0] = -SK_BY_TIME_MODIFIED;
+	lwin.sort[1] = SK_BY_NAME;
+	memset(&lwin.sort[2], SK_NONE, sizeof(lwin.sort) - 2);
+
+	lwin.dir_entry[0].mtime = 1;
+	lwin.dir_entry[1].mtime = 2;
+	lwin.dir_entry[2].mtime = 2;
+	sort_view(&lwin);
+
+	dir_entry_t entries[3] = {
+		{ .name = strdup("b"), .type = FT_REG, .mtime = 2 },
+		{ .name = strdup("z"), .type = FT_REG, .mtime = 0 },
+		{ .name = strdup("dir"), .type = FT_DIR, .mtime = 0 },
+	};
+	assert_success(sort_insert_entries(&lwin, entries, 3));
+
+	assert_int_equal(6, lwin.list_rows);
+	assert_string_equal("dir", lwin.dir_entry[0].name);
+	assert_string_equal("A", lwin.dir_entry[1].name);
+	assert_string_equal("_", lwin.dir_entry[2].name);
+	assert_string_equal("b", lwin.dir_entry[3].name);
+	assert_string_equal("a", lwin.dir_entry[4].name);
+	assert_string_equal("z", lwin.dir_entry[5].name);
+}
+
+TEST(descending_sorting_keeps_order_of_equal_entries)
+{
+	lwin.dir_entry[0].size = 1;
+	lwin.dir_entry[1].size = 2;
+	lwin.dir_entry[2].size = 1;
+
+	lwin.sort[0] = -SK_BY_SIZE;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	sort_view(&lwin);
+
+	assert_string_equal("_", lwin.dir_entry[0].name);
+	assert_string_equal("a", lwin.dir_entry[1].name);
+	assert_string_equal("A", lwin.dir_entry[2].name);
+}
+
+TEST(parent_directory_is_first_in_descending_order)
+{
+	free(lwin.dir_entry[1].name);
+	lwin.dir_entry[1].name = strdup("..");
+	lwin.dir_entry[1].type = FT_DIR;
+
+	lwin.sort[0] = -SK_BY_NAME;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	sort_view(&lwin);
+
+	assert_string_equal("..", lwin.dir_entry[0].name);
+	assert_string_equal("a", lwin.dir_entry[1].name);
+	assert_string_equal("A", lwin.dir_entry[2].name);
+}
+
+TEST(sorting_by_time_handles_distant_dates)
+{
+	lwin.dir_entry[0].mtime = (time_t)-1;
+	lwin.dir_entry[1].mtime = (time_t)0x7fffffff;
+	lwin.dir_entry[2].mtime = (time_t)0;
+
+	lwin.sort[0] = SK_BY_TIME_MODIFIED;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	sort_view(&lwin);
+
+	assert_string_equal("a", lwin.dir_entry[0].name);
+	assert_string_equal("A", lwin.dir_entry[1].name);
+	assert_string_equal("_", lwin.dir_entry[2].name);
+}
+
+TEST(large_lists_are_sorted_by_many_threads_stably)
+{
+	enum { N = 40000 };
+
+	view_teardown(&lwin);
+	view_setup(&lwin);
+
+	lwin.list_rows = N;
+	lwin.dir_entry = dynarray_cextend(NULL,
+			lwin.list_rows*sizeof(*lwin.dir_entry));
+	int i;
+	for(i = 0; i < N; ++i)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "file-name-%03d", (i*7919)%1000);
+		lwin.dir_entry[i].name = strdup(name);
+		lwin.dir_entry[i].type = FT_REG;
+		lwin.dir_entry[i].inode = i;
+	}
+
+	lwin.sort[0] = SK_BY_NAME;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	par_set_nworkers(4);
+	sort_view(&lwin);
+	par_set_nworkers(0);
+
+	for(i = 1; i < N; ++i)
+	{
+		const dir_entry_t *const prev = &lwin.dir_entry[i - 1];
+		const dir_entry_t *const curr = &lwin.dir_entry[i];
+		const int cmp = strcmp(prev->name, curr->name);
+		assert_true(cmp < 0 || (cmp == 0 && prev->inode < curr->inode));
+	}
+}
+
 #ifndef _WIN32
 
 TEST(inode_sorting_works)
@@ -495,6 +610,22 @@ TEST(inode_sorting_works)
 	assert_string_equal("read", lwin.dir_entry[2].name);
 }
 
+TEST(large_inode_numbers_are_sorted_correctly)
+{
+	lwin.dir_entry[0].inode = (ino_t)1 << 40;
+	lwin.dir_entry[1].inode = 1;
+	lwin.dir_entry[2].inode = ((ino_t)1 << 40) + 1;
+
+	lwin.sort[0] = SK_BY_INODE;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	sort_view(&lwin);
+
+	assert_string_equal("_", lwin.dir_entry[0].name);
+	assert_string_equal("a", lwin.dir_entry[1].name);
+	assert_string_equal("A", lwin.dir_entry[2].name);
+}
+
 #endif
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -27,6 +27,7 @@ SETUP_ONCE()
 
 TEARDOWN_ONCE()
 {
+	cfg.config_dir[0] = '\0';
 	columns_teardown();
 
 	curr_view = NULL;
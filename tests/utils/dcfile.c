@@ -0,0 +1,209 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* stat */
+
+#include <stddef.h> /* NULL */
+#include <stdio.h> /* remove() */
+
+#include <test-utils.h>
+
+#include "../../src/compat/os.h"
+#include "../../src/utils/dcfile.h"
+
+#define FILE_PATH SANDBOX_PATH "/dcache"
+
+/* Number of seconds in a day. */
+#define DAY (24*60*60)
+
+static dcfile_value_t value(uint64_t value, int64_t timestamp);
+
+TEARDOWN()
+{
+	(void)remove(FILE_PATH);
+}
+
+TEST(missing_file_is_empty)
+{
+	dcfile_record_t rec;
+
+	dcfile_t *const file = dcfile_open(FILE_PATH);
+	assert_non_null(file);
+	assert_true(dcfile_is_empty(file));
+	assert_false(dcfile_get(file, "/", &rec));
+	dcfile_free(file);
+}
+
+TEST(records_are_persistent)
+{
+	dcfile_record_t rec;
+	dcfile_record_t recs[] = {
+		{ .path = "/b", .size = value(10, 1), .nitems = value(2, 1) },
+		{ .path = "/a", .size = value(20, 1) },
+	};
+
+	assert_success(dcfile_save(FILE_PATH, recs, 2, 0));
+
+	dcfile_t *const file = dcfile_open(FILE_PATH);
+	assert_false(dcfile_is_empty(file));
+
+	assert_true(dcfile_get(file, "/a", &rec));
+	assert_string_equal("/a", rec.path);
+	assert_ulong_equal(20, rec.size.value);
+	assert_int_equal(0, rec.nitems.timestamp);
+
+	assert_true(dcfile_get(file, "/b", &rec));
+	assert_string_equal("/b", rec.path);
+	assert_ulong_equal(10, rec.size.value);
+	assert_ulong_equal(2, rec.nitems.value);
+
+	assert_false(dcfile_get(file, "/c", &rec));
+
+	dcfile_free(file);
+}
+
+TEST(saving_merges_with_contents_of_the_file)
+{
+	dcfile_record_t rec;
+	dcfile_record_t old_recs[] = {
+		{ .path = "/a", .size = value(1, 5), .nitems = value(2, 5) },
+		{ .path = "/b", .size = value(3, 5) },
+	};
+	dcfile_record_t new_recs[] = {
+		{ .path = "/c", .size = value(4, 5) },
+		{ .path = "/a", .size = value(5, 4), .nitems = value(6, 6) },
+	};
+
+	assert_success(dcfile_save(FILE_PATH, old_recs, 2, 0));
+	assert_success(dcfile_save(FILE_PATH, new_recs, 2, 0));
+
+	dcfile_t *const file = dcfile_open(FILE_PATH);
+
+	assert_true(dcfile_get(file, "/a", &rec));
+	assert_ulong_equal(1, rec.size.value);
+	assert_ulong_equal(6, rec.nitems.value);
+	assert_true(dcfile_get(file, "/b", &rec));
+	assert_ulong_equal(3, rec.size.value);
+	assert_true(dcfile_get(file, "/c", &rec));
+	assert_ulong_equal(4, rec.size.value);
+
+	dcfile_free(file);
+}
+
+TEST(records_of_the_same_path_are_folded)
+{
+	dcfile_record_t rec;
+	dcfile_record_t recs[] = {
+		{ .path = "/a", .size = value(1, 1) },
+		{ .path = "/a", .nitems = value(2, 1) },
+	};
+
+	assert_success(dcfile_save(FILE_PATH, recs, 2, 0));
+
+	dcfile_t *const file = dcfile_open(FILE_PATH);
+	assert_true(dcfile_get(file, "/a", &rec));
+	assert_ulong_equal(1, rec.size.value);
+	assert_ulong_equal(2, rec.nitems.value);
+	dcfile_free(file);
+}
+
+TEST(broken_file_is_ignored)
+{
+	dcfile_record_t rec;
+	dcfile_record_t recs[] = {
+		{ .path = "/a", .size = value(1, 1) },
+	};
+
+	make_file(FILE_PATH, "not a cache");
+
+	dcfile_t *file = dcfile_open(FILE_PATH);
+	assert_non_null(file);
+	assert_false(dcfile_get(file, "/a", &rec));
+	dcfile_free(file);
+
+	assert_success(dcfile_save(FILE_PATH, recs, 1, 0));
+
+	file = dcfile_open(FILE_PATH);
+	assert_true(dcfile_get(file, "/a", &rec));
+	dcfile_free(file);
+}
+
+TEST(records_that_are_not_seen_for_long_are_dropped)
+{
+	dcfile_record_t rec;
+	dcfile_record_t old_recs[] = {
+		{ .path = "/old", .size = value(1, 1), .seen = 0 },
+		{ .path = "/used", .size = value(2, 1), .seen = 0 },
+		{ .path = "/recent", .size = value(3, 1), .seen = 50*DAY },
+	};
+	dcfile_record_t new_recs[] = {
+		{ .path = "/used", .seen = 100*DAY },
+	};
+
+	assert_success(dcfile_save(FILE_PATH, old_recs, 3, 0));
+	assert_success(dcfile_save(FILE_PATH, new_recs, 1, 100*DAY));
+
+	dcfile_t *const file = dcfile_open(FILE_PATH);
+	assert_false(dcfile_get(file, "/old", &rec));
+	assert_true(dcfile_get(file, "/used", &rec));
+	assert_ulong_equal(2, rec.size.value);
+	assert_true(rec.seen == 100*DAY);
+	assert_true(dcfile_get(file, "/recent", &rec));
+	assert_ulong_equal(3, rec.size.value);
+	dcfile_free(file);
+}
+
+TEST(time_of_use_is_updated_with_limited_precision)
+{
+	dcfile_record_t rec;
+	dcfile_record_t recs[] = {
+		{ .path = "/a", .size = value(1, 1), .seen = DAY },
+	};
+
+	assert_success(dcfile_save(FILE_PATH, recs, 1, DAY));
+	recs[0].seen = DAY + 60;
+	assert_success(dcfile_save(FILE_PATH, recs, 1, DAY + 60));
+
+	dcfile_t *file = dcfile_open(FILE_PATH);
+	assert_true(dcfile_get(file, "/a", &rec));
+	assert_true(rec.seen == DAY);
+	dcfile_free(file);
+
+	recs[0].seen = 3*DAY;
+	assert_success(dcfile_save(FILE_PATH, recs, 1, 3*DAY));
+
+	file = dcfile_open(FILE_PATH);
+	assert_true(dcfile_get(file, "/a", &rec));
+	assert_true(rec.seen == 3*DAY);
+	dcfile_free(file);
+}
+
+TEST(file_is_not_rewritten_without_changes, IF(not_windows))
+{
+	struct stat before, after;
+	dcfile_record_t recs[] = {
+		{ .path = "/a", .size = value(1, 1), .seen = DAY },
+	};
+
+	assert_success(dcfile_save(FILE_PATH, recs, 1, DAY));
+	assert_success(os_stat(FILE_PATH, &before));
+
+	recs[0].seen = DAY + 60;
+	assert_success(dcfile_save(FILE_PATH, recs, 1, DAY + 60));
+	assert_success(os_stat(FILE_PATH, &after));
+	assert_true(before.st_ino == after.st_ino);
+
+	recs[0].size = value(2, 2);
+	assert_success(dcfile_save(FILE_PATH, recs, 1, DAY + 60));
+	assert_success(os_stat(FILE_PATH, &after));
+	assert_false(before.st_ino == after.st_ino);
+}
+
+/* Makes a value with the specified timestamp. */
+static dcfile_value_t
+value(uint64_t value, int64_t timestamp)
+{
+	return (dcfile_value_t){ .value = value, .timestamp = timestamp };
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,92 @@
+#include <stic.h>
+
+#include <stddef.h> /* NULL */
+
+#include "../../src/utils/fglobs.h"
+
+static fglobs_t *fglobs;
+
+SETUP()
+{
+	fglobs = fglobs_alloc();
+	assert_non_null(fglobs);
+}
+
+TEARDOWN()
+{
+	fglobs_free(fglobs);
+}
+
+TEST(supported_globs_are_recognized)
+{
+	assert_true(fglobs_supported("name"));
+	assert_true(fglobs_supported("*.c,*.h,Makefile,*"));
+	assert_true(fglobs_supported("a,,b"));
+	assert_false(fglobs_supported("*.c,a*"));
+	assert_false(fglobs_supported("?.c"));
+	assert_false(fglobs_supported("*.[ch]"));
+	assert_false(fglobs_supported("**.c"));
+}
+
+TEST(empty_set_matches_nothing)
+{
+	assert_int_equal(-1, fglobs_find(fglobs, "name"));
+	assert_int_equal(-1, fglobs_find(fglobs, ""));
+}
+
+TEST(names_are_matched_ignoring_case)
+{
+	assert_success(fglobs_add(fglobs, "Makefile,README", 0));
+
+	assert_int_equal(0, fglobs_find(fglobs, "makefile"));
+	assert_int_equal(0, fglobs_find(fglobs, "ReadMe"));
+	assert_int_equal(-1, fglobs_find(fglobs, "Makefile.am"));
+	assert_int_equal(-1, fglobs_find(fglobs, "akefile"));
+}
+
+TEST(suffixes_are_matched_ignoring_case)
+{
+	assert_success(fglobs_add(fglobs, "*.c,*.TAR.gz,*~", 0));
+
+	assert_int_equal(0, fglobs_find(fglobs, "a.C"));
+	assert_int_equal(0, fglobs_find(fglobs, "a.tar.GZ"));
+	assert_int_equal(0, fglobs_find(fglobs, "file~"));
+	assert_int_equal(-1, fglobs_find(fglobs, "a.gz"));
+	assert_int_equal(-1, fglobs_find(fglobs, "a.cc"));
+}
+
+TEST(star_does_not_match_leading_dot_or_empty_string)
+{
+	assert_success(fglobs_add(fglobs, "*.c,*,.vimrc", 0));
+
+	assert_int_equal(-1, fglobs_find(fglobs, ".c"));
+	assert_int_equal(-1, fglobs_find(fglobs, ".hidden.c"));
+	assert_int_equal(-1, fglobs_find(fglobs, ""));
+	assert_int_equal(0, fglobs_find(fglobs, ".vimrc"));
+	assert_int_equal(0, fglobs_find(fglobs, "x"));
+}
+
+TEST(escaped_commas_are_part_of_globs)
+{
+	assert_success(fglobs_add(fglobs, "a,,b", 0));
+
+	assert_int_equal(0, fglobs_find(fglobs, "a,b"));
+	assert_int_equal(-1, fglobs_find(fglobs, "a"));
+	assert_int_equal(-1, fglobs_find(fglobs, "b"));
+}
+
+TEST(smallest_id_is_returned)
+{
+	assert_success(fglobs_add(fglobs, "*.gz", 3));
+	assert_success(fglobs_add(fglobs, "*.tar.gz,name", 1));
+	assert_success(fglobs_add(fglobs, "*.gz,*", 2));
+	assert_success(fglobs_add(fglobs, "name", 0));
+
+	assert_int_equal(1, fglobs_find(fglobs, "a.tar.gz"));
+	assert_int_equal(2, fglobs_find(fglobs, "a.gz"));
+	assert_int_equal(2, fglobs_find(fglobs, "a"));
+	assert_int_equal(0, fglobs_find(fglobs, "name"));
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -3,6 +3,7 @@
 #include <unistd.h> /* rmdir() */
 
 #include <stddef.h> /* NULL */
+#include <string.h> /* strcat() */
 
 #include "../../src/compat/os.h"
 #include "../../src/utils/fsdata.h"
@@ -16,6 +17,7 @@
 static void visitor(void *data, void *arg);
 static int traverser(const char name[], int valid, const void *parent_data,
 		void *data, void *arg);
+static void path_visitor(const char path[], const void *data, void *arg);
 
 static int nnodes;
 
@@ -273,6 +275,25 @@ TEST(cancellation)
 	fsdata_free(fsd);
 }
 
+TEST(paths_of_valid_nodes_are_traversed)
+{
+	int data = 0;
+	char paths[64] = "";
+	fsdata_t *const fsd = fsdata_create(0, 0);
+
+	fsdata_traverse_paths(fsd, &path_visitor, paths);
+	assert_string_equal("", paths);
+
+	assert_success(fsdata_set(fsd, ROOT "a/b/c", &data, sizeof(data)));
+	assert_success(fsdata_set(fsd, ROOT "a", &data, sizeof(data)));
+	assert_success(fsdata_set(fsd, ROOT "d", &data, sizeof(data)));
+
+	fsdata_traverse_paths(fsd, &path_visitor, paths);
+	assert_string_equal(ROOT "a;" ROOT "a/b/c;" ROOT "d;", paths);
+
+	fsdata_free(fsd);
+}
+
 static void
 visitor(void *data, void *arg)
 {
@@ -287,5 +308,13 @@ traverser(const char name[], int valid, const void *parent_data, void *data,
 	return (++nnodes == 0);
 }
 
+static void
+path_visitor(const char path[], const void *data, void *arg)
+{
+	char *paths = arg;
+	strcat(paths, path);
+	strcat(paths, ";");
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
@@ -1,5 +1,7 @@
 #include <stic.h>
 
+#include <unistd.h> /* rmdir() */
+
 #include <stdio.h> /* remove() snprintf() */
 
 #include "../../src/compat/fs_limits.h"
@@ -7,6 +9,7 @@
 #include "../../src/utils/fs.h"
 #include "../../src/utils/fswatch.h"
 #include "../../src/utils/path.h"
+#include "../../src/utils/selector.h"
 
 static int using_inotify(void);
 
@@ -82,6 +85,104 @@ TEST(handles_several_events_in_a_row, IF(using_inotify))
 	fswatch_free(watch);
 }
 
+TEST(changes_of_files_are_reported, IF(using_inotify))
+{
+	fswatch_t *watch;
+	assert_non_null(watch = fswatch_create(sandbox));
+
+	int count;
+	assert_int_equal(FSWS_UNCHANGED, fswatch_poll(watch));
+	assert_non_null(fswatch_get_changes(watch, &count));
+	assert_int_equal(0, count);
+
+	os_mkdir(SANDBOX_PATH "/testdir", 0700);
+	os_chmod(SANDBOX_PATH "/testdir", 0777);
+	assert_success(rename(SANDBOX_PATH "/testdir", SANDBOX_PATH "/newdir"));
+	assert_int_equal(FSWS_UPDATED, fswatch_poll(watch));
+
+	const fswatch_change_t *changes = fswatch_get_changes(watch, &count);
+	assert_non_null(changes);
+	assert_int_equal(4, count);
+	assert_string_equal("testdir", changes[0].name);
+	assert_int_equal(FSWC_CREATED, changes[0].kind);
+	assert_string_equal("testdir", changes[1].name);
+	assert_int_equal(FSWC_CHANGED, changes[1].kind);
+	assert_string_equal("testdir", changes[2].name);
+	assert_int_equal(FSWC_DELETED, changes[2].kind);
+	assert_string_equal("newdir", changes[3].name);
+	assert_int_equal(FSWC_CREATED, changes[3].kind);
+
+	assert_success(remove(SANDBOX_PATH "/newdir"));
+	assert_int_equal(FSWS_UPDATED, fswatch_poll(watch));
+
+	changes = fswatch_get_changes(watch, &count);
+	assert_non_null(changes);
+	assert_int_equal(1, count);
+	assert_string_equal("newdir", changes[0].name);
+	assert_int_equal(FSWC_DELETED, changes[0].kind);
+
+	fswatch_free(watch);
+}
+
+TEST(changes_of_files_are_unknown_on_replacement, IF(using_inotify))
+{
+	assert_success(os_mkdir(SANDBOX_PATH "/testdir", 0700));
+
+	fswatch_t *watch;
+	assert_non_null(watch = fswatch_create(SANDBOX_PATH "/testdir"));
+
+	assert_success(remove(SANDBOX_PATH "/testdir"));
+	assert_success(os_mkdir(SANDBOX_PATH "/eatinode", 0700));
+	assert_success(os_mkdir(SANDBOX_PATH "/testdir", 0700));
+
+	int count;
+	assert_int_equal(FSWS_REPLACED, fswatch_poll(watch));
+	assert_null(fswatch_get_changes(watch, &count));
+
+	fswatch_free(watch);
+
+	assert_success(remove(SANDBOX_PATH "/testdir"));
+	assert_success(remove(SANDBOX_PATH "/eatinode"));
+}
+
+TEST(set_of_directories_is_watched, IF(using_inotify))
+{
+	assert_success(os_mkdir(SANDBOX_PATH "/dir1", 0700));
+	assert_success(os_mkdir(SANDBOX_PATH "/dir2", 0700));
+
+	fswatch_t *watch;
+	assert_non_null(watch = fswatch_create_set());
+	assert_success(fswatch_add(watch, SANDBOX_PATH "/dir1"));
+	assert_success(fswatch_add(watch, SANDBOX_PATH "/dir2"));
+	assert_success(fswatch_add(watch, SANDBOX_PATH "/dir2/"));
+	assert_failure(fswatch_add(watch, SANDBOX_PATH "/no-such-dir"));
+
+	assert_int_equal(FSWS_UNCHANGED, fswatch_poll(watch));
+
+	/* Changes of attributes are ignored. */
+	os_chmod(SANDBOX_PATH "/dir1", 0777);
+	assert_int_equal(FSWS_UNCHANGED, fswatch_poll(watch));
+
+	assert_success(os_mkdir(SANDBOX_PATH "/dir2/sub", 0700));
+	assert_int_equal(FSWS_UPDATED, fswatch_poll(watch));
+
+	int count;
+	const fswatch_change_t *changes = fswatch_get_changes(watch, &count);
+	assert_non_null(changes);
+	assert_int_equal(1, count);
+	assert_string_equal(SANDBOX_PATH "/dir2/sub", changes[0].name);
+	assert_int_equal(FSWC_CREATED, changes[0].kind);
+
+	assert_success(rmdir(SANDBOX_PATH "/dir2/sub"));
+	assert_int_equal(FSWS_UPDATED, fswatch_poll(watch));
+	assert_int_equal(FSWS_UNCHANGED, fswatch_poll(watch));
+
+	fswatch_free(watch);
+
+	assert_success(rmdir(SANDBOX_PATH "/dir1"));
+	assert_success(rmdir(SANDBOX_PATH "/dir2"));
+}
+
 TEST(target_replacement_is_detected, IF(using_inotify))
 {
 	assert_success(os_mkdir(SANDBOX_PATH "/testdir", 0700));
@@ -181,6 +282,27 @@ TEST(file_recreation_removes_ban, IF(using_inotify))
 	assert_success(remove(SANDBOX_PATH "/testdir"));
 }
 
+TEST(watch_wakes_up_selector_on_change, IF(using_inotify))
+{
+	fswatch_t *watch;
+	assert_non_null(watch = fswatch_create(sandbox));
+
+	selector_t *selector = selector_alloc();
+	assert_non_null(selector);
+
+	assert_false(fswatch_add_to_selector(watch, selector));
+	assert_false(selector_wait(selector, 0));
+
+	os_mkdir(SANDBOX_PATH "/testdir", 0700);
+	assert_true(selector_wait(selector, 1000));
+	assert_int_equal(FSWS_UPDATED, fswatch_poll(watch));
+
+	selector_free(selector);
+	fswatch_free(watch);
+
+	assert_success(remove(SANDBOX_PATH "/testdir"));
+}
+
 static int
 using_inotify(void)
 {
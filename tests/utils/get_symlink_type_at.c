@@ -0,0 +1,73 @@
+#include <stic.h>
+
+#ifndef _WIN32
+
+#include <fcntl.h> /* O_DIRECTORY O_RDONLY open() */
+#include <unistd.h> /* chdir() close() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/str.h"
+
+static int dir_fd;
+
+SETUP()
+{
+	update_string(&cfg.slow_fs_list, "");
+
+	create_dir(SANDBOX_PATH "/dir");
+	assert_success(make_symlink("dir", SANDBOX_PATH "/link-dir"));
+	create_file(SANDBOX_PATH "/file");
+	assert_success(make_symlink("file", SANDBOX_PATH "/link-file"));
+	assert_success(make_symlink("no-such-target", SANDBOX_PATH "/link-broken"));
+
+	/* Make sure relative paths don't resolve against current directory. */
+	assert_success(chdir(TEST_DATA_PATH "/existing-files"));
+
+	dir_fd = open(SANDBOX_PATH, O_RDONLY | O_DIRECTORY);
+	assert_true(dir_fd != -1);
+}
+
+TEARDOWN()
+{
+	close(dir_fd);
+
+	remove_dir(SANDBOX_PATH "/dir");
+	remove_file(SANDBOX_PATH "/link-dir");
+	remove_file(SANDBOX_PATH "/file");
+	remove_file(SANDBOX_PATH "/link-file");
+	remove_file(SANDBOX_PATH "/link-broken");
+
+	update_string(&cfg.slow_fs_list, NULL);
+}
+
+TEST(link_to_dir_is_detected)
+{
+	assert_int_equal(SLT_DIR,
+			get_symlink_type_at(dir_fd, SANDBOX_PATH, "link-dir"));
+}
+
+TEST(link_to_file_is_not_a_dir)
+{
+	assert_int_equal(SLT_UNKNOWN,
+			get_symlink_type_at(dir_fd, SANDBOX_PATH, "link-file"));
+}
+
+TEST(broken_link_is_not_a_dir)
+{
+	assert_int_equal(SLT_UNKNOWN,
+			get_symlink_type_at(dir_fd, SANDBOX_PATH, "link-broken"));
+}
+
+TEST(non_link_is_unknown)
+{
+	assert_int_equal(SLT_UNKNOWN,
+			get_symlink_type_at(dir_fd, SANDBOX_PATH, "dir"));
+}
+
+#endif
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
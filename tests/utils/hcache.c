@@ -0,0 +1,192 @@
+#include <stic.h>
+
+#include <stdint.h> /* uint64_t */
+#include <stdio.h> /* remove() */
+
+#include <test-utils.h>
+
+#include "../../src/utils/hcache.h"
+
+#define CACHE_PATH SANDBOX_PATH "/cache"
+
+static hcache_key_t key_a = { 1, 10, 100, 1000, 1001 };
+static hcache_key_t key_b = { 1, 11, 100, 1000, 1001 };
+static hcache_t *cache;
+
+SETUP()
+{
+	cache = hcache_open(CACHE_PATH, 64);
+	assert_non_null(cache);
+}
+
+TEARDOWN()
+{
+	hcache_free(cache);
+	(void)remove(CACHE_PATH);
+}
+
+TEST(empty_cache_has_no_records)
+{
+	uint64_t hash, digest[2];
+	assert_false(hcache_get_prefix(cache, &key_a, &hash));
+	assert_false(hcache_get_digest(cache, &key_a, digest));
+
+	assert_success(hcache_save(cache));
+	no_remove_file(CACHE_PATH);
+}
+
+TEST(records_are_available_before_saving)
+{
+	uint64_t hash, digest[2];
+	const uint64_t digest_a[2] = { 5, 6 };
+
+	hcache_set_prefix(cache, &key_a, 4);
+	assert_true(hcache_get_prefix(cache, &key_a, &hash));
+	assert_false(hcache_get_digest(cache, &key_a, digest));
+	assert_ulong_equal(4, hash);
+
+	hcache_set_digest(cache, &key_a, digest_a);
+	assert_true(hcache_get_digest(cache, &key_a, digest));
+	assert_ulong_equal(5, digest[0]);
+	assert_ulong_equal(6, digest[1]);
+
+	assert_false(hcache_get_prefix(cache, &key_b, &hash));
+}
+
+TEST(records_are_persistent)
+{
+	uint64_t hash, digest[2];
+	const uint64_t digest_b[2] = { 7, 8 };
+
+	hcache_set_prefix(cache, &key_a, 4);
+	hcache_set_digest(cache, &key_b, digest_b);
+	assert_success(hcache_save(cache));
+
+	hcache_free(cache);
+	cache = hcache_open(CACHE_PATH, 64);
+	assert_non_null(cache);
+
+	assert_true(hcache_get_prefix(cache, &key_a, &hash));
+	assert_ulong_equal(4, hash);
+	assert_false(hcache_get_digest(cache, &key_a, digest));
+
+	assert_false(hcache_get_prefix(cache, &key_b, &hash));
+	assert_true(hcache_get_digest(cache, &key_b, digest));
+	assert_ulong_equal(7, digest[0]);
+	assert_ulong_equal(8, digest[1]);
+}
+
+TEST(stored_records_can_be_extended)
+{
+	uint64_t hash, digest[2];
+	const uint64_t digest_a[2] = { 5, 6 };
+
+	hcache_set_prefix(cache, &key_a, 4);
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 64);
+	hcache_set_digest(cache, &key_a, digest_a);
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 64);
+	assert_true(hcache_get_prefix(cache, &key_a, &hash));
+	assert_true(hcache_get_digest(cache, &key_a, digest));
+	assert_ulong_equal(4, hash);
+	assert_ulong_equal(5, digest[0]);
+	assert_ulong_equal(6, digest[1]);
+}
+
+TEST(many_records_are_stored)
+{
+	uint64_t hash;
+	hcache_key_t key = key_a;
+
+	int i;
+	for(i = 0; i < 1000; ++i)
+	{
+		key.inode = 1000 - i;
+		hcache_set_prefix(cache, &key, i);
+	}
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 64);
+	for(i = 0; i < 1000; ++i)
+	{
+		key.inode = 1000 - i;
+		assert_true(hcache_get_prefix(cache, &key, &hash));
+		assert_ulong_equal(i, hash);
+	}
+}
+
+TEST(old_states_of_files_in_use_are_dropped)
+{
+	uint64_t hash;
+	hcache_key_t new_a = key_a;
+	++new_a.mtime;
+
+	hcache_set_prefix(cache, &key_a, 1);
+	hcache_set_prefix(cache, &key_b, 2);
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 64);
+	hcache_set_prefix(cache, &new_a, 3);
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 64);
+	assert_false(hcache_get_prefix(cache, &key_a, &hash));
+	assert_true(hcache_get_prefix(cache, &new_a, &hash));
+	assert_ulong_equal(3, hash);
+	assert_true(hcache_get_prefix(cache, &key_b, &hash));
+	assert_ulong_equal(2, hash);
+}
+
+TEST(cache_of_different_kind_is_ignored)
+{
+	uint64_t hash;
+
+	hcache_set_prefix(cache, &key_a, 1);
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 32);
+	assert_false(hcache_get_prefix(cache, &key_a, &hash));
+}
+
+TEST(broken_cache_is_ignored)
+{
+	uint64_t hash;
+
+	make_file(CACHE_PATH, "not a cache");
+
+	hcache_free(cache);
+	cache = hcache_open(CACHE_PATH, 64);
+	assert_non_null(cache);
+	assert_false(hcache_get_prefix(cache, &key_a, &hash));
+
+	hcache_set_prefix(cache, &key_a, 1);
+	assert_success(hcache_save(cache));
+	hcache_free(cache);
+
+	cache = hcache_open(CACHE_PATH, 64);
+	assert_true(hcache_get_prefix(cache, &key_a, &hash));
+}
+
+TEST(keys_identify_only_regular_files, IF(not_windows))
+{
+	hcache_key_t key1, key2;
+
+	assert_failure(hcache_key_of(SANDBOX_PATH, &key1));
+	assert_failure(hcache_key_of(SANDBOX_PATH "/no-such-file", &key1));
+
+	assert_success(hcache_key_of(TEST_DATA_PATH "/existing-files/a", &key1));
+	assert_success(hcache_key_of(TEST_DATA_PATH "/existing-files/b", &key2));
+	assert_true(key1.inode != key2.inode);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
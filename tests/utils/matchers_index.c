@@ -0,0 +1,154 @@
+#include <stic.h>
+
+#include <stddef.h> /* size_t */
+#include <stdio.h> /* snprintf() */
+
+#include "../../src/utils/macros.h"
+#include "../../src/utils/matchers.h"
+#include "../../src/utils/matchers_index.h"
+
+static void add(const char expr[]);
+static int find_linearly(const char path[]);
+
+static mindex_t *mi;
+static matchers_t *lists[32];
+static int nlists;
+
+SETUP()
+{
+	mi = mindex_alloc();
+	assert_non_null(mi);
+	nlists = 0;
+}
+
+TEARDOWN()
+{
+	mindex_free(mi);
+
+	int i;
+	for(i = 0; i < nlists; ++i)
+	{
+		matchers_free(lists[i]);
+	}
+}
+
+TEST(empty_index_matches_nothing)
+{
+	assert_int_equal(-1, mindex_find(mi, "name"));
+}
+
+TEST(exact_names_and_suffixes_are_found)
+{
+	add("{*.c,*.h}");
+	add("{Makefile}");
+	add("{*}");
+
+	assert_int_equal(0, mindex_find(mi, "/some/dir/file.C"));
+	assert_int_equal(0, mindex_find(mi, "file.h"));
+	assert_int_equal(1, mindex_find(mi, "makefile"));
+	assert_int_equal(2, mindex_find(mi, "file.cpp"));
+	assert_int_equal(-1, mindex_find(mi, ".c"));
+	assert_int_equal(-1, mindex_find(mi, ".hidden"));
+}
+
+TEST(the_first_match_wins)
+{
+	add("/^a/");
+	add("{*.txt}");
+	add("{b*t}");
+	add("{*.txt}{b*}");
+
+	assert_int_equal(0, mindex_find(mi, "a.txt"));
+	assert_int_equal(1, mindex_find(mi, "b.txt"));
+	assert_int_equal(2, mindex_find(mi, "bat"));
+	assert_int_equal(-1, mindex_find(mi, "c.tx"));
+}
+
+TEST(globs_with_wildcards_are_matched)
+{
+	add("{*.tar.*}");
+	add("{?.c,x*y*z}");
+	add("{*~,#*#}");
+
+	assert_int_equal(0, mindex_find(mi, "a.TAR.gz"));
+	assert_int_equal(-1, mindex_find(mi, ".tar.gz"));
+	assert_int_equal(1, mindex_find(mi, "a.c"));
+	assert_int_equal(-1, mindex_find(mi, "ab.c"));
+	assert_int_equal(1, mindex_find(mi, "xyz"));
+	assert_int_equal(1, mindex_find(mi, "x1y2z"));
+	assert_int_equal(-1, mindex_find(mi, "x1y2z3"));
+	assert_int_equal(2, mindex_find(mi, "file~"));
+	assert_int_equal(2, mindex_find(mi, "#file#"));
+	assert_int_equal(2, mindex_find(mi, "##"));
+}
+
+TEST(results_match_those_of_matchers)
+{
+	static const char *const exprs[] = {
+		"!{*.c}{*.*}", "{{*/dir/*}}", "{[ab]*}", "{*.jpg,*.png}", "{README}",
+		"/\\.md$/", "{*/}", "{.*rc}", "{*.tar.*,*.t?z}", "{*}", "<text/*>",
+		"{*.ЖЖ}", "{ж*}", "{*s}",
+	};
+
+	static const char *const paths[] = {
+		"a.c", "b.c", "c.c", "x.y", "/some/dir/file", "file.JPG", "x.png",
+		"readme", "README.md", "dir/", "/path/to/sub/", ".vimrc", ".bashrc",
+		"a.tar.xz", "a.tgz", ".tgz", "plain", ".hidden", "Файл.жж", "ЖЖ",
+		"жук", "Жук", "files", "/a/b/files/", "с.ЖЖ",
+	};
+
+	size_t i;
+	for(i = 0U; i < ARRAY_LEN(exprs); ++i)
+	{
+		add(exprs[i]);
+	}
+
+	for(i = 0U; i < ARRAY_LEN(paths); ++i)
+	{
+		assert_int_equal(find_linearly(paths[i]), mindex_find(mi, paths[i]));
+	}
+}
+
+TEST(many_globs_are_matched)
+{
+	int i;
+	for(i = 0; i < 30; ++i)
+	{
+		char expr[64];
+		snprintf(expr, sizeof(expr), "{*.%d*x,a%d?b}", i, i);
+		add(expr);
+	}
+
+	assert_int_equal(0, mindex_find(mi, "file.0x"));
+	assert_int_equal(2, mindex_find(mi, "file.29yx"));
+	assert_int_equal(29, mindex_find(mi, "a29zb"));
+	assert_int_equal(1, mindex_find(mi, "a15b"));
+	assert_int_equal(find_linearly("x.2x.3x"), mindex_find(mi, "x.2x.3x"));
+}
+
+static void
+add(const char expr[])
+{
+	char *error = NULL;
+	lists[nlists] = matchers_alloc(expr, 0, 1, "", &error);
+	assert_string_equal(NULL, error);
+	assert_success(mindex_add(mi, lists[nlists]));
+	++nlists;
+}
+
+static int
+find_linearly(const char path[])
+{
+	int i;
+	for(i = 0; i < nlists; ++i)
+	{
+		if(matchers_match(lists[i], path))
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,94 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+
+#include "../../src/utils/name_index.h"
+
+static nindex_t *ni;
+
+SETUP()
+{
+	ni = nindex_alloc(0);
+	assert_non_null(ni);
+}
+
+TEARDOWN()
+{
+	nindex_free(ni);
+}
+
+TEST(empty_index_has_no_keys)
+{
+	assert_int_equal(-1, nindex_get(ni, NULL, "name"));
+	assert_int_equal(-1, nindex_get(ni, "/dir", "name"));
+	assert_int_equal(-1, nindex_get(ni, NULL, ""));
+}
+
+TEST(names_are_found)
+{
+	assert_int_equal(0, nindex_put(ni, NULL, "a", 1));
+	assert_int_equal(0, nindex_put(ni, NULL, "b", 2));
+	assert_int_equal(0, nindex_put(ni, NULL, "", 3));
+
+	assert_int_equal(1, nindex_get(ni, NULL, "a"));
+	assert_int_equal(2, nindex_get(ni, NULL, "b"));
+	assert_int_equal(3, nindex_get(ni, NULL, ""));
+	assert_int_equal(-1, nindex_get(ni, NULL, "c"));
+	assert_int_equal(-1, nindex_get(ni, NULL, "ab"));
+}
+
+TEST(existing_keys_are_not_replaced)
+{
+	assert_int_equal(0, nindex_put(ni, NULL, "a", 1));
+	assert_int_equal(1, nindex_put(ni, NULL, "a", 2));
+	assert_int_equal(1, nindex_get(ni, NULL, "a"));
+}
+
+TEST(keys_are_copied)
+{
+	char name[] = "name";
+	assert_int_equal(0, nindex_put(ni, NULL, name, 1));
+	name[0] = 'N';
+	assert_int_equal(-1, nindex_get(ni, NULL, name));
+	assert_int_equal(1, nindex_get(ni, NULL, "name"));
+}
+
+TEST(dir_and_name_form_a_path)
+{
+	assert_int_equal(0, nindex_put(ni, "/a", "b", 1));
+	assert_int_equal(0, nindex_put(ni, "/", "c", 2));
+
+	assert_int_equal(1, nindex_get(ni, "/a", "b"));
+	assert_int_equal(1, nindex_get(ni, "/a/", "b"));
+	assert_int_equal(1, nindex_get(ni, NULL, "/a/b"));
+	assert_int_equal(1, nindex_get(ni, "/", "a/b"));
+	assert_int_equal(2, nindex_get(ni, NULL, "/c"));
+
+	assert_int_equal(-1, nindex_get(ni, NULL, "b"));
+	assert_int_equal(-1, nindex_get(ni, "/ab", ""));
+	assert_int_equal(-1, nindex_get(ni, "/a", "bc"));
+
+	assert_int_equal(1, nindex_put(ni, "/a/", "b", 3));
+}
+
+TEST(many_keys_are_stored)
+{
+	char name[32];
+
+	int i;
+	for(i = 0; i < 10000; ++i)
+	{
+		snprintf(name, sizeof(name), "file%d", i);
+		assert_int_equal(0, nindex_put(ni, "/dir", name, i));
+	}
+
+	for(i = 0; i < 10000; ++i)
+	{
+		snprintf(name, sizeof(name), "file%d", i);
+		assert_int_equal(i, nindex_get(ni, "/dir", name));
+		assert_int_equal(-1, nindex_get(ni, "/other", name));
+	}
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
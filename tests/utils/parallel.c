@@ -0,0 +1,147 @@
+#include <stic.h>
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* intptr_t */
+#include <string.h> /* memset() */
+
+#include "../../src/compat/pthread.h"
+#include "../../src/utils/parallel.h"
+
+static void mark_range(size_t from, size_t to, void *arg);
+static void count_calls(size_t from, size_t to, void *arg);
+static void spawn_tasks(par_tasks_t *tasks, void *task, void *arg);
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+TEARDOWN()
+{
+	par_set_nworkers(0);
+}
+
+TEST(default_number_of_workers_is_positive)
+{
+	assert_true(par_get_nworkers() > 0);
+}
+
+TEST(number_of_workers_can_be_changed_and_reset)
+{
+	const int def = par_get_nworkers();
+
+	par_set_nworkers(3);
+	assert_int_equal(3, par_get_nworkers());
+
+	par_set_nworkers(-1);
+	assert_int_equal(def, par_get_nworkers());
+}
+
+TEST(nothing_is_done_for_empty_range)
+{
+	int ncalls = 0;
+	par_for(0, 10, &count_calls, &ncalls);
+	assert_int_equal(0, ncalls);
+}
+
+TEST(zero_batch_size_is_handled)
+{
+	char marks[5] = { };
+	par_set_nworkers(2);
+	par_for(sizeof(marks), 0, &mark_range, marks);
+	assert_int_equal(0, memcmp(marks, "\1\1\1\1\1", sizeof(marks)));
+}
+
+TEST(every_item_is_processed_exactly_once_by_single_thread)
+{
+	char marks[1000];
+	memset(marks, 0, sizeof(marks));
+
+	par_set_nworkers(1);
+	par_for(sizeof(marks), 7, &mark_range, marks);
+
+	size_t i;
+	for(i = 0; i < sizeof(marks); ++i)
+	{
+		assert_int_equal(1, marks[i]);
+	}
+}
+
+TEST(every_item_is_processed_exactly_once_by_many_threads)
+{
+	char marks[1000];
+	memset(marks, 0, sizeof(marks));
+
+	par_set_nworkers(8);
+	par_for(sizeof(marks), 7, &mark_range, marks);
+
+	size_t i;
+	for(i = 0; i < sizeof(marks); ++i)
+	{
+		assert_int_equal(1, marks[i]);
+	}
+}
+
+TEST(batches_do_not_exceed_requested_size)
+{
+	int ncalls = 0;
+	par_set_nworkers(4);
+	par_for(100, 10, &count_calls, &ncalls);
+	assert_int_equal(10, ncalls);
+}
+
+TEST(spawned_tasks_are_processed_by_single_thread)
+{
+	int ncalls = 0;
+	par_set_nworkers(1);
+	par_run_tasks((void *)(intptr_t)5, &spawn_tasks, &ncalls);
+	assert_int_equal(364, ncalls);
+}
+
+TEST(spawned_tasks_are_processed_by_many_threads)
+{
+	int ncalls = 0;
+	par_set_nworkers(8);
+	par_run_tasks((void *)(intptr_t)5, &spawn_tasks, &ncalls);
+	assert_int_equal(364, ncalls);
+}
+
+static void
+mark_range(size_t from, size_t to, void *arg)
+{
+	char *const marks = arg;
+	while(from < to)
+	{
+		++marks[from++];
+	}
+}
+
+static void
+count_calls(size_t from, size_t to, void *arg)
+{
+	int *const ncalls = arg;
+	pthread_mutex_lock(&lock);
+	++*ncalls;
+	assert_true(to - from <= 10);
+	pthread_mutex_unlock(&lock);
+}
+
+static void
+spawn_tasks(par_tasks_t *tasks, void *task, void *arg)
+{
+	int *const ncalls = arg;
+	const intptr_t depth = (intptr_t)task;
+
+	pthread_mutex_lock(&lock);
+	++*ncalls;
+	pthread_mutex_unlock(&lock);
+
+	if(depth > 0)
+	{
+		int i;
+		for(i = 0; i < 3; ++i)
+		{
+			par_tasks_add(tasks, (void *)(depth - 1));
+		}
+	}
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
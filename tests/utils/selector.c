@@ -0,0 +1,135 @@
+#include <stic.h>
+
+#ifndef _WIN32
+
+#include <fcntl.h> /* O_RDONLY open() */
+#include <unistd.h> /* close() pipe() write() */
+
+#include "../../src/utils/selector.h"
+
+static selector_t *selector;
+static int fds[2];
+
+SETUP()
+{
+	selector = selector_alloc();
+	assert_non_null(selector);
+	assert_success(pipe(fds));
+}
+
+TEARDOWN()
+{
+	close(fds[0]);
+	close(fds[1]);
+	selector_free(selector);
+}
+
+TEST(empty_pipe_is_not_ready)
+{
+	selector_add(selector, fds[0]);
+	assert_false(selector_wait(selector, 0));
+	assert_false(selector_is_ready(selector, fds[0]));
+}
+
+TEST(pipe_with_data_is_ready)
+{
+	selector_add(selector, fds[0]);
+	assert_int_equal(1, write(fds[1], "x", 1));
+	assert_true(selector_wait(selector, 1000));
+	assert_true(selector_is_ready(selector, fds[0]));
+}
+
+TEST(only_ready_item_is_reported)
+{
+	int other[2];
+	assert_success(pipe(other));
+
+	selector_add(selector, other[0]);
+	selector_add(selector, fds[0]);
+	assert_int_equal(1, write(fds[1], "x", 1));
+	assert_true(selector_wait(selector, 1000));
+	assert_true(selector_is_ready(selector, fds[0]));
+	assert_false(selector_is_ready(selector, other[0]));
+
+	close(other[0]);
+	close(other[1]);
+}
+
+TEST(removed_item_is_not_waited_for)
+{
+	selector_add(selector, fds[0]);
+	selector_remove(selector, fds[0]);
+	assert_int_equal(1, write(fds[1], "x", 1));
+	assert_false(selector_wait(selector, 0));
+	assert_false(selector_is_ready(selector, fds[0]));
+}
+
+TEST(reset_removes_all_items)
+{
+	selector_add(selector, fds[0]);
+	selector_reset(selector);
+	assert_int_equal(1, write(fds[1], "x", 1));
+	assert_false(selector_wait(selector, 0));
+
+	selector_add(selector, fds[0]);
+	assert_true(selector_wait(selector, 0));
+	assert_true(selector_is_ready(selector, fds[0]));
+}
+
+TEST(items_survive_reset_if_added_again)
+{
+	selector_add(selector, fds[0]);
+	assert_false(selector_wait(selector, 0));
+
+	selector_reset(selector);
+	selector_add(selector, fds[0]);
+	assert_int_equal(1, write(fds[1], "x", 1));
+	assert_true(selector_wait(selector, 0));
+	assert_true(selector_is_ready(selector, fds[0]));
+}
+
+TEST(reused_descriptor_is_watched)
+{
+	selector_add(selector, fds[0]);
+	assert_false(selector_wait(selector, 0));
+
+	/* New pipe gets the same descriptor numbers. */
+	close(fds[0]);
+	close(fds[1]);
+	int new_fds[2];
+	assert_success(pipe(new_fds));
+	assert_int_equal(fds[0], new_fds[0]);
+	fds[1] = new_fds[1];
+
+	selector_reset(selector);
+	selector_add(selector, fds[0]);
+	assert_int_equal(1, write(fds[1], "x", 1));
+	assert_true(selector_wait(selector, 1000));
+	assert_true(selector_is_ready(selector, fds[0]));
+}
+
+TEST(closed_write_end_makes_pipe_ready)
+{
+	selector_add(selector, fds[0]);
+	close(fds[1]);
+	fds[1] = -1;
+	assert_true(selector_wait(selector, 1000));
+	assert_true(selector_is_ready(selector, fds[0]));
+}
+
+TEST(regular_file_is_always_ready)
+{
+	const int fd = open(TEST_DATA_PATH "/read/two-lines", O_RDONLY);
+	assert_true(fd >= 0);
+
+	selector_add(selector, fd);
+	assert_true(selector_wait(selector, 1000));
+	assert_true(selector_is_ready(selector, fd));
+
+	close(fd);
+}
+
+#endif
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
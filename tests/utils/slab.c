@@ -0,0 +1,143 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+#include <string.h> /* memset() strcmp() */
+
+#include "../../src/utils/slab.h"
+
+static slab_t *slab;
+
+SETUP()
+{
+	slab = slab_create();
+	assert_non_null(slab);
+}
+
+TEARDOWN()
+{
+	slab_release(slab, 1);
+}
+
+TEST(releasing_null_is_ok)
+{
+	slab_release(NULL, 1);
+}
+
+TEST(strings_are_copied)
+{
+	char str[] = "string";
+	char *const copy = slab_strdup(slab, str);
+	assert_string_equal("string", copy);
+	assert_false(copy == str);
+
+	str[0] = 'S';
+	assert_string_equal("string", copy);
+}
+
+TEST(strings_do_not_overlap)
+{
+	char *const a = slab_strdup(slab, "a");
+	char *const empty = slab_strdup(slab, "");
+	char *const b = slab_strdup(slab, "bb");
+
+	assert_string_equal("a", a);
+	assert_string_equal("", empty);
+	assert_string_equal("bb", b);
+}
+
+TEST(many_strings_span_several_chunks)
+{
+	char *strs[10000];
+	char buf[32];
+
+	int i;
+	for(i = 0; i < 10000; ++i)
+	{
+		snprintf(buf, sizeof(buf), "name-%d", i);
+		strs[i] = slab_strdup(slab, buf);
+		assert_non_null(strs[i]);
+	}
+
+	for(i = 0; i < 10000; ++i)
+	{
+		snprintf(buf, sizeof(buf), "name-%d", i);
+		assert_string_equal(buf, strs[i]);
+	}
+}
+
+TEST(long_strings_are_supported)
+{
+	static char buf[100*1024];
+	memset(buf, 'x', sizeof(buf) - 1U);
+
+	char *const small = slab_strdup(slab, "small");
+	char *const large = slab_strdup(slab, buf);
+	char *const next = slab_strdup(slab, "next");
+	assert_int_equal(0, strcmp(buf, large));
+	assert_string_equal("small", small);
+	assert_string_equal("next", next);
+}
+
+TEST(strings_live_while_slab_is_referenced)
+{
+	slab_ref(slab, 2);
+	char *const str = slab_strdup(slab, "str");
+
+	slab_release(slab, 2);
+	assert_string_equal("str", str);
+}
+
+TEST(equal_interned_strings_are_shared)
+{
+	char str[] = "/some/path";
+
+	char *const a = slab_intern(slab, str);
+	char *const b = slab_intern(slab, "/some/path");
+	char *const c = slab_intern(slab, "/other/path");
+
+	assert_string_equal("/some/path", a);
+	assert_true(a != str);
+	assert_true(a == b);
+	assert_true(a != c);
+	assert_string_equal("/other/path", c);
+}
+
+TEST(interning_is_per_slab)
+{
+	slab_t *const other = slab_create();
+	assert_non_null(other);
+
+	char *const a = slab_intern(slab, "/path");
+	char *const b = slab_intern(other, "/path");
+	assert_true(a != b);
+
+	slab_release(other, 1);
+	assert_string_equal("/path", a);
+}
+
+TEST(many_strings_are_interned)
+{
+	char *strs[1000];
+	char buf[32];
+
+	int i;
+	for(i = 0; i < 1000; ++i)
+	{
+		snprintf(buf, sizeof(buf), "/dir/%d", i);
+		strs[i] = slab_intern(slab, buf);
+		assert_non_null(strs[i]);
+
+		/* Mix in strings that aren't interned. */
+		assert_non_null(slab_strdup(slab, buf));
+	}
+
+	for(i = 0; i < 1000; ++i)
+	{
+		snprintf(buf, sizeof(buf), "/dir/%d", i);
+		assert_true(slab_intern(slab, buf) == strs[i]);
+		assert_string_equal(buf, strs[i]);
+	}
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -1,6 +1,7 @@
 #include <stic.h>
 
 #include <stddef.h> /* NULL */
+#include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* free() */
 #include <string.h> /* strdup() */
 
@@ -164,5 +165,94 @@ TEST(trie_cloning_works)
 	trie_free(trie);
 }
 
+TEST(lookup_can_be_case_insensitive)
+{
+	trie_t *const trie = trie_create();
+	void *data;
+
+	assert_int_equal(0, trie_set(trie, "str", trie));
+	assert_int_equal(0, trie_set(trie, "ab", NULL));
+
+	data = NULL;
+	assert_success(trie_get_lower(trie, "sTR", &data));
+	assert_true(data == trie);
+	assert_success(trie_get_lower(trie, "AB", &data));
+	assert_failure(trie_get(trie, "Str", &data));
+	assert_failure(trie_get_lower(trie, "ABC", &data));
+	assert_failure(trie_get_lower(trie, "S", &data));
+
+	trie_free(trie);
+}
+
+TEST(prefixes_and_extensions_of_keys_are_not_keys)
+{
+	trie_t *const trie = trie_create();
+	void *data;
+
+	assert_int_equal(0, trie_set(trie, "abcdef", trie));
+	assert_failure(trie_get(trie, "abc", &data));
+	assert_failure(trie_get(trie, "abcdefg", &data));
+	assert_failure(trie_get(trie, "abcdeg", &data));
+	assert_failure(trie_get(trie, "", &data));
+
+	assert_int_equal(0, trie_set(trie, "abc", NULL));
+	assert_success(trie_get(trie, "abc", &data));
+	assert_null(data);
+	assert_success(trie_get(trie, "abcdef", &data));
+	assert_true(data == trie);
+	assert_failure(trie_get(trie, "ab", &data));
+
+	trie_free(trie);
+}
+
+TEST(many_keys_are_stored)
+{
+	trie_t *const trie = trie_create();
+	char key[64];
+	void *data;
+
+	int i;
+	for(i = 0; i < 5000; ++i)
+	{
+		snprintf(key, sizeof(key), "/some/path/%d/file%d", i%7, i);
+		assert_int_equal(0, trie_set(trie, key, &key[i%64]));
+	}
+
+	for(i = 0; i < 5000; ++i)
+	{
+		snprintf(key, sizeof(key), "/some/path/%d/file%d", i%7, i);
+		assert_success(trie_get(trie, key, &data));
+		assert_true(data == &key[i%64]);
+
+		snprintf(key, sizeof(key), "/some/path/%d/file%d", (i + 1)%7, i);
+		assert_failure(trie_get(trie, key, &data));
+	}
+
+	trie_free(trie);
+}
+
+TEST(clone_is_independent_of_original)
+{
+	trie_t *const trie = trie_create();
+	void *data;
+
+	assert_int_equal(0, trie_set(trie, "string", trie));
+
+	trie_t *const clone = trie_clone(trie);
+	assert_int_equal(0, trie_put(clone, "str"));
+	assert_true(trie_set(clone, "string", NULL) > 0);
+
+	assert_failure(trie_get(trie, "str", &data));
+	assert_success(trie_get(trie, "string", &data));
+	assert_true(data == trie);
+
+	assert_success(trie_get(clone, "str", &data));
+	assert_success(trie_get(clone, "string", &data));
+	assert_null(data);
+
+	trie_free(clone);
+	trie_free(trie);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */